@@ -0,0 +1,135 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometricModelResource;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.Ifc4.TopologyResource;
+using Xbim.IO.Memory;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class BooleanToolSkipTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<BooleanToolSkipTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        //keeps the warnings so the test can read which tools the Boolean skipped
+        private class WarningLogger : ILogger
+        {
+            public readonly List<string> Warnings = new List<string>();
+
+            public IDisposable BeginScope<TState>(TState state) => null;
+
+            public bool IsEnabled(LogLevel logLevel) => true;
+
+            public void Log<TState>(LogLevel logLevel, EventId eventId, TState state, Exception exception, Func<TState, Exception, string> formatter)
+            {
+                if (logLevel != LogLevel.Warning) return;
+                lock (Warnings)
+                    Warnings.Add(formatter(state, exception));
+            }
+        }
+
+        private static IfcBlock MakeBox(MemoryModel m, double x, double y, double z, XbimPoint3D at)
+        {
+            var block = IfcModelBuilder.MakeBlock(m, x, y, z);
+            block.Position.Axis = m.Instances.New<IfcDirection>(d => d.SetXYZ(0, 0, 1));
+            block.Position.RefDirection = m.Instances.New<IfcDirection>(d => d.SetXYZ(1, 0, 0));
+            block.Position.Location.SetXYZ(at.X, at.Y, at.Z);
+            return block;
+        }
+
+        private static IfcFace MakeFace(MemoryModel m, params XbimPoint3D[] points)
+        {
+            var loop = m.Instances.New<IfcPolyLoop>(l =>
+            {
+                foreach (var p in points)
+                    l.Polygon.Add(m.Instances.New<IfcCartesianPoint>(c => c.SetXYZ(p.X, p.Y, p.Z)));
+            });
+            return m.Instances.New<IfcFace>(f => f.Bounds.Add(m.Instances.New<IfcFaceOuterBound>(b => { b.Bound = loop; b.Orientation = true; })));
+        }
+
+        //a prism through the wall whose cross section is a bowtie, its sides cross each other so the shell intersects itself
+        private static IfcFacetedBrep MakeBowtie(MemoryModel m)
+        {
+            var section = new[] { new XbimPoint3D(3.5, -1, 0), new XbimPoint3D(4.5, 3, 0), new XbimPoint3D(4.5, -1, 0), new XbimPoint3D(3.5, 3, 0) };
+            var bottom = section.Select(p => new XbimPoint3D(p.X, p.Y, 1)).ToArray();
+            var top = section.Select(p => new XbimPoint3D(p.X, p.Y, 2)).ToArray();
+            var shell = m.Instances.New<IfcClosedShell>();
+            shell.CfsFaces.Add(MakeFace(m, bottom.Reverse().ToArray()));
+            shell.CfsFaces.Add(MakeFace(m, top));
+            for (int i = 0; i < section.Length; i++)
+            {
+                var j = (i + 1) % section.Length;
+                shell.CfsFaces.Add(MakeFace(m, bottom[i], bottom[j], top[j], top[i]));
+            }
+            return m.Instances.New<IfcFacetedBrep>(b => b.Outer = shell);
+        }
+
+        [TestMethod]
+        public void SkippedToolIsNamedInTheWarning()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var wall = geomEngine.CreateSolid(MakeBox(m, 10, 2, 3, new XbimPoint3D(0, 0, 0)), logger);
+                    wall.IsValid.Should().BeTrue();
+
+                    //two openings that cut cleanly through the wall and the bowtie between them, each tool tagged with its entity
+                    var good1 = MakeBox(m, 1, 4, 1, new XbimPoint3D(2, -1, 1));
+                    var good2 = MakeBox(m, 1, 4, 1, new XbimPoint3D(6, -1, 1));
+                    var bad = MakeBowtie(m);
+                    var tools = geomEngine.CreateSolidSet();
+                    foreach (var item in new IfcSolidModel[] { good1, good2 })
+                    {
+                        var solid = geomEngine.CreateSolid(item, logger);
+                        solid.Tag = item;
+                        tools.Add(solid);
+                    }
+                    var bowtie = geomEngine.CreateSolidSet(bad, logger);
+                    foreach (var solid in bowtie)
+                    {
+                        solid.Tag = bad;
+                        tools.Add(solid);
+                    }
+
+                    var warnings = new WarningLogger();
+                    var body = geomEngine.CreateSolidSet();
+                    body.Add(wall);
+                    var result = body.Cut(tools, m.ModelFactors.PrecisionBoolean, warnings);
+
+                    var skipped = warnings.Warnings.Where(w => w.Contains("were skipped")).ToList();
+                    skipped.Should().HaveCount(1);
+                    skipped[0].Should().Contain("#" + bad.EntityLabel);
+                    skipped[0].Should().NotContain("#" + good1.EntityLabel).And.NotContain("#" + good2.EntityLabel);
+
+                    //the good openings are still cut, each takes 1 x 2 x 1 out of the wall
+                    result.Should().NotBeEmpty();
+                    result.Sum(s => s.Volume).Should().BeApproximately(wall.Volume - 4, 1e-6);
+                }
+            }
+        }
+    }
+}
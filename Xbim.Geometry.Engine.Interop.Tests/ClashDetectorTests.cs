@@ -0,0 +1,151 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System.Linq;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class ClashDetectorTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<ClashDetectorTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        [TestMethod]
+        public void OverlappingBoxesAreAHardClash()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        store.AddBlock(0.5, 0.25, 0.25, 1, 0.5, 0.5);
+                        var instances = store.Commit();
+                        var clashes = new XbimClashDetector(m, logger).Detect(instances).ToList();
+                        clashes.Should().HaveCount(1);
+                        clashes[0].Type.Should().Be(XbimClashType.Hard);
+                        clashes[0].Distance.Should().Be(0);
+                        new[] { clashes[0].A.IfcProductLabel, clashes[0].B.IfcProductLabel }.Should().BeEquivalentTo(1, 2);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ABoxInsideAnotherIsAHardClash()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        //no triangles cross, only the containment test finds it
+                        store.AddBlock(0, 0, 0, 10, 10, 10);
+                        store.AddBlock(4, 4, 4, 1, 1, 1);
+                        var clashes = new XbimClashDetector(m, logger).Detect(store.Commit()).ToList();
+                        clashes.Should().HaveCount(1);
+                        clashes[0].Type.Should().Be(XbimClashType.Hard);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void SeparatedBoxesOnlyClashWithinTheClearance()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        //a gap of 0.3 along x
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        store.AddBlock(1.3, 0, 0, 1, 1, 1);
+                        var instances = store.Commit();
+                        var detector = new XbimClashDetector(m, logger);
+                        detector.Detect(instances).Should().BeEmpty();
+
+                        detector.Clearance = 0.2;
+                        detector.Detect(instances).Should().BeEmpty();
+
+                        detector.Clearance = 0.5;
+                        var clashes = detector.Detect(instances).ToList();
+                        clashes.Should().HaveCount(1);
+                        clashes[0].Type.Should().Be(XbimClashType.Clearance);
+                        clashes[0].Distance.Should().BeApproximately(0.3, 1e-6);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void TouchingBoxesAreNotAHardClash()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        store.AddBlock(1, 0, 0, 1, 1, 1);
+                        var instances = store.Commit();
+                        var detector = new XbimClashDetector(m, logger);
+                        detector.Detect(instances).Should().BeEmpty();
+
+                        detector.Clearance = 0.1;
+                        var clashes = detector.Detect(instances).ToList();
+                        clashes.Should().HaveCount(1);
+                        clashes[0].Type.Should().Be(XbimClashType.Clearance);
+                        clashes[0].Distance.Should().BeApproximately(0, 1e-6);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void SetsAreOnlyTestedAgainstEachOther()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        //the first two overlap each other but are both in set A, the third overlaps only the second
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        store.AddBlock(0.5, 0, 0, 1, 1, 1);
+                        store.AddBlock(1.25, 0, 0, 1, 1, 1);
+                        var instances = store.Commit();
+                        var clashes = new XbimClashDetector(m, logger).Detect(instances.Take(2), instances.Skip(2)).ToList();
+                        clashes.Should().HaveCount(1);
+                        clashes[0].A.IfcProductLabel.Should().Be(2);
+                        clashes[0].B.IfcProductLabel.Should().Be(3);
+                    }
+                }
+            }
+        }
+    }
+}
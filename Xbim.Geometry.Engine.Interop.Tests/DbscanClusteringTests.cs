@@ -0,0 +1,142 @@
+﻿using FluentAssertions;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.ModelGeometry.Scene.Clustering;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class DbscanClusteringTests
+    {
+        private static XbimBBoxClusterElement Box(int id, double x, double y, double z, double size = 1)
+        {
+            return new XbimBBoxClusterElement(id, new XbimRect3D(x, y, z, size, size, size));
+        }
+
+        //the clusters as sorted sets of their geometry ids, in order of their first id
+        private static List<List<int>> Partition(IEnumerable<XbimBBoxClusterElement> clusters)
+        {
+            return clusters.Select(c => c.GeometryIds.OrderBy(id => id).ToList()).OrderBy(ids => ids[0]).ToList();
+        }
+
+        private static double AxisDistance(double c1, double s1, double c2, double s2)
+        {
+            return c1 < c2 ? c2 - (c1 + s1) : c1 - (c2 + s2);
+        }
+
+        //merges any two clusters whose bounds are within eps on every axis until none are left, the definition the grid has to match
+        private static List<List<int>> BruteForce(IList<XbimBBoxClusterElement> items, double eps)
+        {
+            var clusters = items.Select(i => Tuple.Create(new List<int>(i.GeometryIds), i.Bound)).ToList();
+            var merged = true;
+            while (merged)
+            {
+                merged = false;
+                for (var i = 0; i < clusters.Count && !merged; i++)
+                {
+                    for (var j = i + 1; j < clusters.Count && !merged; j++)
+                    {
+                        var a = clusters[i].Item2;
+                        var b = clusters[j].Item2;
+                        var distance = Math.Max(Math.Max(AxisDistance(a.X, a.SizeX, b.X, b.SizeX), AxisDistance(a.Y, a.SizeY, b.Y, b.SizeY)), AxisDistance(a.Z, a.SizeZ, b.Z, b.SizeZ));
+                        if (distance >= eps) continue;
+                        a.Union(b);
+                        clusters[i].Item1.AddRange(clusters[j].Item1);
+                        clusters[i] = Tuple.Create(clusters[i].Item1, a);
+                        clusters.RemoveAt(j);
+                        merged = true;
+                    }
+                }
+            }
+            return clusters.Select(c => c.Item1.OrderBy(id => id).ToList()).OrderBy(ids => ids[0]).ToList();
+        }
+
+        [TestMethod]
+        public void KnownClustersAndNoiseAreFound()
+        {
+            var items = new List<XbimBBoxClusterElement>();
+            var id = 0;
+            //three rows of boxes half a unit apart, each row ten units from the next
+            for (var row = 0; row < 3; row++)
+                for (var i = 0; i < 5; i++)
+                    items.Add(Box(id++, i * 1.5, row * 11, 0));
+            //isolated boxes, each stays a cluster of its own
+            items.Add(Box(id++, 100, 0, 0));
+            items.Add(Box(id++, 0, 100, 0));
+            items.Add(Box(id++, 0, 0, 100));
+
+            var clusters = Partition(XbimDbscan.GetClusters(items, 1));
+            clusters.Should().HaveCount(6);
+            clusters[0].Should().Equal(0, 1, 2, 3, 4);
+            clusters[1].Should().Equal(5, 6, 7, 8, 9);
+            clusters[2].Should().Equal(10, 11, 12, 13, 14);
+            clusters[3].Should().Equal(15);
+            clusters[4].Should().Equal(16);
+            clusters[5].Should().Equal(17);
+        }
+
+        [TestMethod]
+        public void MergedBoundsAreComparedAgain()
+        {
+            //a and b are merged in the first pass, c is only within eps of the bound that covers both of them
+            var items = new List<XbimBBoxClusterElement>
+            {
+                Box(0, 0, 0, 0),
+                Box(1, 1.5, 1.5, 0),
+                new XbimBBoxClusterElement(2, new XbimRect3D(3, -3, 0, 1, 2.5, 1))
+            };
+            Partition(XbimDbscan.GetClusters(items, 1)).Should().HaveCount(1);
+        }
+
+        [TestMethod]
+        public void LargeBoundJoinsTheBoxesItReaches()
+        {
+            //the slab covers far more grid cells than a small box so it is compared with every cluster instead
+            var items = new List<XbimBBoxClusterElement>
+            {
+                Box(0, 0, 0, 0),
+                Box(1, 500, 0, 0),
+                Box(2, 250, 50, 0),
+                new XbimBBoxClusterElement(3, new XbimRect3D(0, 1.5, 0, 501, 1, 1))
+            };
+            var clusters = Partition(XbimDbscan.GetClusters(items, 1));
+            clusters.Should().HaveCount(2);
+            clusters[0].Should().Equal(0, 1, 3);
+            clusters[1].Should().Equal(2);
+        }
+
+        [TestMethod]
+        public void ClustersAreSplitToTheMaximumSize()
+        {
+            //a chain of twenty boxes is one cluster, split until no part is longer than six units
+            var items = Enumerable.Range(0, 20).Select(i => Box(i, i * 1.5, 0, 0)).ToList();
+            var clusters = XbimDbscan.GetClusters(items, 1, 6);
+            clusters.Should().HaveCountGreaterThan(1);
+            clusters.Should().OnlyContain(c => c.Bound.SizeX <= 6);
+            clusters.SelectMany(c => c.GeometryIds).OrderBy(i => i).Should().Equal(Enumerable.Range(0, 20));
+        }
+
+        [TestMethod]
+        public void RandomBoxesMatchTheBruteForceClusters()
+        {
+            var random = new Random(42);
+            for (var run = 0; run < 20; run++)
+            {
+                var count = random.Next(1, 200);
+                var items = new List<XbimBBoxClusterElement>();
+                for (var i = 0; i < count; i++)
+                {
+                    //mostly small boxes with the odd long one
+                    var size = random.NextDouble() < 0.05 ? 40 : random.NextDouble() * 3;
+                    items.Add(new XbimBBoxClusterElement(i, new XbimRect3D(random.NextDouble() * 100, random.NextDouble() * 100, random.NextDouble() * 10,
+                        size, random.NextDouble() * 3, random.NextDouble() * 3)));
+                }
+                var expected = BruteForce(items, 2);
+                Partition(XbimDbscan.GetClusters(items, 2)).Should().BeEquivalentTo(expected, o => o.WithStrictOrdering());
+            }
+        }
+    }
+}
@@ -2,7 +2,10 @@
 using Microsoft.VisualStudio.TestTools.UnitTesting;
 using System;
 using System.Diagnostics;
+using System.IO;
+using System.Linq;
 using Xbim.Common.Geometry;
+using Xbim.Common.XbimExtensions;
 using Xbim.Ifc4.Interfaces;
 
 namespace Xbim.Geometry.Engine.Interop.Tests
@@ -106,6 +109,56 @@ namespace Xbim.Geometry.Engine.Interop.Tests
         //    return sw.ElapsedMilliseconds;
         //}
 
+        /// <summary>
+        /// Signed volume enclosed by a PolyhedronBinary mesh, positive if the triangles face outwards
+        /// </summary>
+        public static double MeshVolume(byte[] shapeData)
+        {
+            using (var br = new BinaryReader(new MemoryStream(shapeData)))
+            {
+                var triangulation = br.ReadShapeTriangulation();
+                var vertices = triangulation.Vertices.ToList();
+                var volume = 0.0;
+                foreach (var face in triangulation.Faces)
+                {
+                    var indices = face.Indices;
+                    for (var i = 0; i + 2 < indices.Count; i += 3)
+                    {
+                        var a = vertices[indices[i]];
+                        var b = vertices[indices[i + 1]];
+                        var c = vertices[indices[i + 2]];
+                        volume += (a.X * (b.Y * c.Z - b.Z * c.Y) - a.Y * (b.X * c.Z - b.Z * c.X) + a.Z * (b.X * c.Y - b.Y * c.X)) / 6;
+                    }
+                }
+                return volume;
+            }
+        }
+
+        /// <summary>
+        /// Total area of the triangles of a PolyhedronBinary mesh
+        /// </summary>
+        public static double MeshArea(byte[] shapeData)
+        {
+            using (var br = new BinaryReader(new MemoryStream(shapeData)))
+            {
+                var triangulation = br.ReadShapeTriangulation();
+                var vertices = triangulation.Vertices.ToList();
+                var area = 0.0;
+                foreach (var face in triangulation.Faces)
+                {
+                    var indices = face.Indices;
+                    for (var i = 0; i + 2 < indices.Count; i += 3)
+                    {
+                        var a = vertices[indices[i]];
+                        var u = vertices[indices[i + 1]] - a;
+                        var v = vertices[indices[i + 2]] - a;
+                        area += u.CrossProduct(v).Length / 2;
+                    }
+                }
+                return area;
+            }
+        }
+
         public static void IsValidSolid(IXbimSolid solid, bool ignoreVolume = false, bool isHalfSpace = false, int entityLabel = 0)
         {
             // ReSharper disable once CompareOfFloatsByEqualityOperator
@@ -1104,6 +1104,49 @@ namespace Xbim.Geometry.Engine.Interop.Tests
                 }
             }
         }
+
+        [TestMethod]
+        public void LocalisedUnifyKeepsTheShellClosed()
+        {
+            using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction("Populate"))
+                {
+                    //a long I section, the notch at its far end only changes a few of its faces and leaves the rest untouched
+                    var beam = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeIShapeProfileDef(m, 200, 100, 10, 6), 1000);
+                    beam.Position.Axis = m.Instances.New<IfcDirection>(d => d.SetXYZ(0, 0, 1));
+                    beam.Position.RefDirection = m.Instances.New<IfcDirection>(d => d.SetXYZ(1, 0, 0));
+                    var body = geomEngine.CreateSolid(beam);
+                    Assert.AreEqual(14, body.Faces.Count, "An I section without fillets should have 14 faces");
+
+                    Func<double, double, IXbimSolid> makeTool = (from, to) =>
+                    {
+                        var block = IfcModelBuilder.MakeBlock(m, 120, 15, to - from);
+                        block.Position.Axis = m.Instances.New<IfcDirection>(d => d.SetXYZ(0, 0, 1));
+                        block.Position.RefDirection = m.Instances.New<IfcDirection>(d => d.SetXYZ(1, 0, 0));
+                        block.Position.Location.SetXYZ(-60, 95, from);
+                        return geomEngine.CreateSolid(block);
+                    };
+                    //two tools that meet half way along the notch split its floor and sides, the unify has to join the pieces again
+                    var tools = geomEngine.CreateSolidSet();
+                    tools.Add(makeTool(900, 950));
+                    tools.Add(makeTool(950, 1010));
+                    var bodySet = geomEngine.CreateSolidSet();
+                    bodySet.Add(body);
+                    var result = bodySet.Cut(tools, m.ModelFactors.PrecisionBoolean);
+
+                    Assert.AreEqual(1, result.Count, "The notched beam should be one solid");
+                    var notched = result.First;
+                    Assert.IsTrue(notched.IsValid, "The notched beam is not valid");
+                    Assert.IsTrue(notched.IsClosed, "The shell of the notched beam is not closed");
+                    Assert.IsTrue(notched.HasValidTopology, "BRepCheck reports the notched beam as invalid");
+                    //the notch adds its floor and the step at its start, the pieces left by the two tools are one face each
+                    Assert.AreEqual(16, notched.Faces.Count, "The faces of the notch have not been unified");
+                    Assert.AreEqual(body.Volume - 100 * 5 * 100, notched.Volume, 1e-3, "Volume is incorrect");
+                    txn.Commit();
+                }
+            }
+        }
         #endregion
 
     }
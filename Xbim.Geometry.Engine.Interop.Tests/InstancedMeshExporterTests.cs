@@ -0,0 +1,87 @@
+﻿using FluentAssertions;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Common.XbimExtensions;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class InstancedMeshExporterTests
+    {
+        [DataTestMethod]
+        [DataRow("LargeTriangulatedCoordinates.ifc")]
+        [DataRow("SweptDiskSolid_1.ifc")]
+        [DataRow("multi_boolean_opening_operations_test.ifc")]
+        public void ExportReadsBackAsStored(string file)
+        {
+            using (var m = MemoryModel.OpenRead(Path.Combine("TestFiles", file)))
+            {
+                var c = new Xbim3DModelContext(m);
+                c.CreateContext(null, false);
+                var exporter = new XbimInstancedMeshExporter(m);
+                var output = new MemoryStream();
+                exporter.Export(output);
+                exporter.GeometryCount.Should().BePositive();
+
+                using (var store = m.GeometryStore.BeginRead())
+                {
+                    //instances of geometries with no mesh are left out of the export
+                    var expected = store.ShapeInstances
+                        .Where(i => i.RepresentationType == XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded)
+                        .Where(i => ((IXbimShapeGeometryData)store.ShapeGeometry(i.ShapeGeometryLabel))?.ShapeData?.Length > 0)
+                        .ToDictionary(i => i.InstanceLabel);
+                    var read = new HashSet<int>();
+                    var geometries = 0;
+
+                    output.Position = 0;
+                    var br = new BinaryReader(output);
+                    br.ReadByte().Should().Be(XbimInstancedMeshExporter.Version);
+                    var geometryLabel = -1;
+                    for (var record = br.ReadByte(); record != XbimInstancedMeshExporter.EndRecord; record = br.ReadByte())
+                    {
+                        if (record == XbimInstancedMeshExporter.GeometryRecord)
+                        {
+                            geometryLabel = br.ReadInt32();
+                            var stored = store.ShapeGeometry(geometryLabel);
+                            ((XbimGeometryType)br.ReadByte()).Should().Be(stored.Format);
+                            var data = br.ReadBytes(br.ReadInt32());
+                            data.Should().Equal(((IXbimShapeGeometryData)stored).ShapeData);
+                            if (stored.Format == XbimGeometryType.PolyhedronBinary)
+                                new BinaryReader(new MemoryStream(data)).ReadShapeTriangulation().Vertices.Should().NotBeEmpty();
+                            geometries++;
+                            continue;
+                        }
+                        record.Should().Be(XbimInstancedMeshExporter.InstanceBatchRecord);
+                        br.ReadInt32().Should().Be(geometryLabel, "a batch follows the geometry it uses");
+                        var style = br.ReadInt32();
+                        var count = br.ReadInt32();
+                        for (var i = 0; i < count; i++)
+                        {
+                            var product = br.ReadInt32();
+                            var instance = expected[br.ReadInt32()];
+                            read.Add(instance.InstanceLabel).Should().BeTrue();
+                            instance.ShapeGeometryLabel.Should().Be(geometryLabel);
+                            instance.StyleLabel.Should().Be(style);
+                            instance.IfcProductLabel.Should().Be(product);
+                            var t = instance.Transformation;
+                            foreach (var value in new[] { t.M11, t.M12, t.M13, t.M21, t.M22, t.M23, t.M31, t.M32, t.M33 })
+                                br.ReadSingle().Should().Be((float)value);
+                            br.ReadDouble().Should().Be(t.OffsetX);
+                            br.ReadDouble().Should().Be(t.OffsetY);
+                            br.ReadDouble().Should().Be(t.OffsetZ);
+                        }
+                    }
+                    output.Position.Should().Be(output.Length);
+                    geometries.Should().Be(exporter.GeometryCount);
+                    read.Count.Should().Be(exporter.InstanceCount);
+                    read.Should().BeEquivalentTo(expected.Keys);
+                }
+            }
+        }
+    }
+}
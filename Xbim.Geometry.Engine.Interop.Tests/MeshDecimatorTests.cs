@@ -0,0 +1,346 @@
+﻿using FluentAssertions;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class MeshDecimatorTests
+    {
+        /// <summary>
+        /// A face of a test mesh, planar faces have one normal, curved ones the normal of the surface at each vertex
+        /// </summary>
+        private class TestFace
+        {
+            public List<int> Triangles = new List<int>();
+            public XbimVector3D? Normal;
+        }
+
+        /// <summary>
+        /// Builds a mesh in the PolyhedronBinary format, vertices at the same position are shared between faces
+        /// </summary>
+        private class TestMesh
+        {
+            public readonly List<XbimPoint3D> Vertices = new List<XbimPoint3D>();
+            public readonly List<XbimVector3D> VertexNormals = new List<XbimVector3D>();
+            public readonly List<TestFace> Faces = new List<TestFace>();
+            private readonly Dictionary<Tuple<double, double, double>, int> _lookup = new Dictionary<Tuple<double, double, double>, int>();
+
+            private int Vertex(XbimPoint3D p, XbimVector3D normal)
+            {
+                var key = Tuple.Create(p.X, p.Y, p.Z);
+                if (_lookup.TryGetValue(key, out var index))
+                    return index;
+                index = Vertices.Count;
+                Vertices.Add(p);
+                VertexNormals.Add(normal);
+                _lookup.Add(key, index);
+                return index;
+            }
+
+            /// <summary>
+            /// Adds a face meshed as a grid of cells x cells over u and v in 0 to 1, wound anticlockwise about the normal of the surface
+            /// </summary>
+            public void AddGrid(int cells, Func<double, double, XbimPoint3D> surface, Func<double, double, XbimVector3D> normal, bool planar)
+            {
+                var face = new TestFace { Normal = planar ? normal(0, 0) : (XbimVector3D?)null };
+                var grid = new int[(cells + 1) * (cells + 1)];
+                for (var j = 0; j <= cells; j++)
+                    for (var i = 0; i <= cells; i++)
+                        grid[j * (cells + 1) + i] = Vertex(surface((double)i / cells, (double)j / cells), normal((double)i / cells, (double)j / cells));
+                for (var j = 0; j < cells; j++)
+                {
+                    for (var i = 0; i < cells; i++)
+                    {
+                        var a = grid[j * (cells + 1) + i];
+                        var b = grid[j * (cells + 1) + i + 1];
+                        var c = grid[(j + 1) * (cells + 1) + i + 1];
+                        var d = grid[(j + 1) * (cells + 1) + i];
+                        face.Triangles.AddRange(new[] { a, b, c, a, c, d });
+                    }
+                }
+                Faces.Add(face);
+            }
+
+            public byte[] ToShapeData()
+            {
+                var memStream = new MemoryStream();
+                using (var bw = new BinaryWriter(memStream))
+                {
+                    bw.Write((byte)1);
+                    bw.Write(Vertices.Count);
+                    bw.Write(Faces.Sum(f => f.Triangles.Count / 3));
+                    foreach (var p in Vertices)
+                    {
+                        bw.Write((float)p.X);
+                        bw.Write((float)p.Y);
+                        bw.Write((float)p.Z);
+                    }
+                    bw.Write(Faces.Count);
+                    foreach (var face in Faces)
+                    {
+                        if (face.Normal.HasValue)
+                        {
+                            bw.Write(face.Triangles.Count / 3);
+                            new XbimPackedNormal(face.Normal.Value.X, face.Normal.Value.Y, face.Normal.Value.Z).Write(bw);
+                            foreach (var index in face.Triangles)
+                                WriteIndex(bw, index);
+                        }
+                        else
+                        {
+                            bw.Write(-face.Triangles.Count / 3);
+                            foreach (var index in face.Triangles)
+                            {
+                                WriteIndex(bw, index);
+                                var normal = VertexNormals[index];
+                                new XbimPackedNormal(normal.X, normal.Y, normal.Z).Write(bw);
+                            }
+                        }
+                    }
+                }
+                return memStream.ToArray();
+            }
+
+            private void WriteIndex(BinaryWriter bw, int index)
+            {
+                if (Vertices.Count <= 0xFF)
+                    bw.Write((byte)index);
+                else if (Vertices.Count <= 0xFFFF)
+                    bw.Write((ushort)index);
+                else
+                    bw.Write(index);
+            }
+        }
+
+        //a 10 x 10 x 10 box, each side a planar face meshed as a 10 x 10 grid
+        private static TestMesh GriddedBox()
+        {
+            var mesh = new TestMesh();
+            const double size = 10;
+            const int cells = 10;
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(v * size, u * size, 0), (u, v) => new XbimVector3D(0, 0, -1), true);
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(u * size, v * size, size), (u, v) => new XbimVector3D(0, 0, 1), true);
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(u * size, 0, v * size), (u, v) => new XbimVector3D(0, -1, 0), true);
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(v * size, size, u * size), (u, v) => new XbimVector3D(0, 1, 0), true);
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(0, v * size, u * size), (u, v) => new XbimVector3D(-1, 0, 0), true);
+            mesh.AddGrid(cells, (u, v) => new XbimPoint3D(size, u * size, v * size), (u, v) => new XbimVector3D(1, 0, 0), true);
+            return mesh;
+        }
+
+        //an open, curved face, a bump of height 2 over the square -5 to 5 in x and y
+        private static TestMesh GriddedBump()
+        {
+            var mesh = new TestMesh();
+            Func<double, double, double> height = (x, y) => 2 * Math.Exp(-(x * x + y * y) / 8);
+            mesh.AddGrid(40,
+                (u, v) => new XbimPoint3D(10 * u - 5, 10 * v - 5, height(10 * u - 5, 10 * v - 5)),
+                (u, v) =>
+                {
+                    double x = 10 * u - 5, y = 10 * v - 5, h = height(x, y);
+                    return new XbimVector3D(x * h / 4, y * h / 4, 1).Normalized();
+                },
+                false);
+            return mesh;
+        }
+
+        /// <summary>
+        /// The counts in the header must describe the data exactly, every index must be a vertex and every vertex used
+        /// </summary>
+        private static XbimShapeMeshView CheckHeader(byte[] shapeData)
+        {
+            var view = new XbimShapeMeshView(shapeData);
+            var indexSize = view.VertexCount <= 0xFF ? 1 : view.VertexCount <= 0xFFFF ? 2 : 4;
+            var length = 1 + 4 + 4 + view.VertexCount * 12 + 4;
+            var triangles = 0;
+            for (var f = 0; f < view.FaceCount; f++)
+            {
+                triangles += view.FaceTriangleCount(f);
+                length += 4 + (view.IsPlanar(f) ? 2 + view.FaceTriangleCount(f) * 3 * indexSize : view.FaceTriangleCount(f) * 3 * (indexSize + 2));
+            }
+            shapeData.Length.Should().Be(length);
+            view.TriangleCount.Should().Be(triangles);
+            var indices = new int[view.TriangleCount * 3];
+            view.CopyTriangleIndices(indices, 0).Should().Be(indices.Length);
+            indices.Should().OnlyContain(i => i >= 0 && i < view.VertexCount);
+            indices.Distinct().Count().Should().Be(view.VertexCount, "unused vertices are dropped");
+            return view;
+        }
+
+        private static IEnumerable<XbimPoint3D[]> Triangles(XbimShapeMeshView view)
+        {
+            for (var f = 0; f < view.FaceCount; f++)
+                for (var t = 0; t < view.FaceTriangleCount(f); t++)
+                    yield return new[] { view.Vertex(view.Index(f, t, 0)), view.Vertex(view.Index(f, t, 1)), view.Vertex(view.Index(f, t, 2)) };
+        }
+
+        private static XbimVector3D TriangleNormal(XbimPoint3D[] triangle)
+        {
+            return (triangle[1] - triangle[0]).CrossProduct(triangle[2] - triangle[0]);
+        }
+
+        //the vertices of the mesh, with the mid points of the edges and the centroids of the triangles
+        private static IEnumerable<XbimPoint3D> SamplePoints(XbimShapeMeshView view)
+        {
+            for (var v = 0; v < view.VertexCount; v++)
+                yield return view.Vertex(v);
+            foreach (var t in Triangles(view))
+            {
+                yield return new XbimPoint3D((t[0].X + t[1].X) / 2, (t[0].Y + t[1].Y) / 2, (t[0].Z + t[1].Z) / 2);
+                yield return new XbimPoint3D((t[0].X + t[1].X + t[2].X) / 3, (t[0].Y + t[1].Y + t[2].Y) / 3, (t[0].Z + t[1].Z + t[2].Z) / 3);
+            }
+        }
+
+        private static double Distance(XbimPoint3D p, List<XbimPoint3D[]> triangles)
+        {
+            return triangles.Min(t => DistanceToTriangle(p, t[0], t[1], t[2]));
+        }
+
+        //distance to the closest point on the triangle (Ericson, Real-Time Collision Detection 5.1.5)
+        private static double DistanceToTriangle(XbimPoint3D p, XbimPoint3D a, XbimPoint3D b, XbimPoint3D c)
+        {
+            var ab = b - a;
+            var ac = c - a;
+            var ap = p - a;
+            double d1 = ab.DotProduct(ap), d2 = ac.DotProduct(ap);
+            if (d1 <= 0 && d2 <= 0)
+                return ap.Length;
+            var bp = p - b;
+            double d3 = ab.DotProduct(bp), d4 = ac.DotProduct(bp);
+            if (d3 >= 0 && d4 <= d3)
+                return bp.Length;
+            var vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                return (ap - ab * (d1 / (d1 - d3))).Length;
+            var cp = p - c;
+            double d5 = ab.DotProduct(cp), d6 = ac.DotProduct(cp);
+            if (d6 >= 0 && d5 <= d6)
+                return cp.Length;
+            var vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                return (ap - ac * (d2 / (d2 - d6))).Length;
+            var va = d3 * d6 - d5 * d4;
+            if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+                return (bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))).Length;
+            var denom = 1 / (va + vb + vc);
+            return (ap - ab * (vb * denom) - ac * (vc * denom)).Length;
+        }
+
+        [TestMethod]
+        public void DecimatedBoxKeepsItsCreasesAndNormals()
+        {
+            var box = GriddedBox();
+            var original = box.ToShapeData();
+            CheckHeader(original).TriangleCount.Should().Be(1200);
+            var decimated = new XbimMeshDecimator(0.01).Decimate(original);
+            decimated.Should().NotBeNull();
+            var view = CheckHeader(decimated);
+            view.TriangleCount.Should().BeLessThan(1200 / 4);
+
+            //the sides are flat and meet at right angles, any collapse across an edge of the box would change its volume
+            HelperFunctions.MeshVolume(decimated).Should().BeApproximately(1000, 1e-3);
+            HelperFunctions.MeshArea(decimated).Should().BeApproximately(600, 1e-3);
+            var vertices = Enumerable.Range(0, view.VertexCount).Select(v => view.Vertex(v)).ToList();
+            foreach (var corner in new[] { 0.0, 10.0 }.SelectMany(x => new[] { 0.0, 10.0 }.SelectMany(y => new[] { 0.0, 10.0 }.Select(z => new XbimPoint3D(x, y, z)))))
+                vertices.Should().Contain(v => (v - corner).Length < 1e-6);
+
+            view.FaceCount.Should().Be(6);
+            for (var f = 0; f < view.FaceCount; f++)
+            {
+                view.IsPlanar(f).Should().BeTrue();
+                var normal = view.Normal(f, 0, 0).Normal;
+                var faceNormal = box.Faces[f].Normal.Value;
+                normal.DotProduct(faceNormal).Should().BeApproximately(1, 1e-3, "a planar face keeps its normal");
+                for (var t = 0; t < view.FaceTriangleCount(f); t++)
+                {
+                    var triangle = new[] { view.Vertex(view.Index(f, t, 0)), view.Vertex(view.Index(f, t, 1)), view.Vertex(view.Index(f, t, 2)) };
+                    TriangleNormal(triangle).Normalized().DotProduct(faceNormal).Should().BeApproximately(1, 1e-6, "no triangle may be folded over");
+                }
+            }
+        }
+
+        [TestMethod]
+        public void DecimatedCurvedFaceKeepsItsBoundaryAndError()
+        {
+            const double maxError = 0.05;
+            var bump = GriddedBump();
+            var original = bump.ToShapeData();
+            var decimated = new XbimMeshDecimator(maxError).Decimate(original);
+            decimated.Should().NotBeNull();
+            var view = CheckHeader(decimated);
+            view.TriangleCount.Should().BeLessThan(new XbimShapeMeshView(original).TriangleCount / 2);
+
+            //the outline is held, its edges stay on the sides of the square and its corners are kept, to within the rounding of
+            //the positions of the vertices the collapses move
+            const double onOutline = 1e-4;
+            var vertices = Enumerable.Range(0, view.VertexCount).Select(v => view.Vertex(v)).ToList();
+            foreach (var corner in new[] { new XbimPoint3D(-5, -5, 0), new XbimPoint3D(5, -5, 0), new XbimPoint3D(5, 5, 0), new XbimPoint3D(-5, 5, 0) })
+                vertices.Should().Contain(v => Math.Abs(v.X - corner.X) < onOutline && Math.Abs(v.Y - corner.Y) < onOutline);
+            var edgeUses = new Dictionary<Tuple<int, int>, int>();
+            for (var t = 0; t < view.FaceTriangleCount(0); t++)
+            {
+                for (var c = 0; c < 3; c++)
+                {
+                    int a = view.Index(0, t, c), b = view.Index(0, t, (c + 1) % 3);
+                    var key = Tuple.Create(Math.Min(a, b), Math.Max(a, b));
+                    edgeUses.TryGetValue(key, out var uses);
+                    edgeUses[key] = uses + 1;
+                }
+            }
+            foreach (var edge in edgeUses.Where(e => e.Value == 1).Select(e => e.Key))
+            {
+                XbimPoint3D a = view.Vertex(edge.Item1), b = view.Vertex(edge.Item2);
+                var onSide = (Math.Abs(Math.Abs(a.X) - 5) < onOutline && Math.Abs(b.X - a.X) < onOutline) || (Math.Abs(Math.Abs(a.Y) - 5) < onOutline && Math.Abs(b.Y - a.Y) < onOutline);
+                onSide.Should().BeTrue("boundary edges must stay on the outline of the face");
+            }
+
+            //the Hausdorff distance between the meshes, measured both ways at the vertices, edge mid points and centroids
+            var originalTriangles = Triangles(new XbimShapeMeshView(original)).ToList();
+            var decimatedTriangles = Triangles(view).ToList();
+            SamplePoints(view).Max(p => Distance(p, originalTriangles)).Should().BeLessOrEqualTo(maxError);
+            SamplePoints(new XbimShapeMeshView(original)).Max(p => Distance(p, decimatedTriangles)).Should().BeLessOrEqualTo(maxError);
+
+            //the normals of a curved face are recalculated, they must be unit vectors on the side the triangles face
+            view.IsPlanar(0).Should().BeFalse();
+            for (var t = 0; t < view.FaceTriangleCount(0); t++)
+            {
+                var triangle = new[] { view.Vertex(view.Index(0, t, 0)), view.Vertex(view.Index(0, t, 1)), view.Vertex(view.Index(0, t, 2)) };
+                var triangleNormal = TriangleNormal(triangle).Normalized();
+                for (var c = 0; c < 3; c++)
+                {
+                    var normal = view.Normal(0, t, c).Normal;
+                    normal.Length.Should().BeApproximately(1, 1e-3);
+                    normal.DotProduct(triangleNormal).Should().BePositive();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ShapeGeometryIsDecimatedInPlace()
+        {
+            var original = GriddedBox().ToShapeData();
+            var shapeGeometry = new XbimShapeGeometry { Format = XbimGeometryType.PolyhedronBinary };
+            ((IXbimShapeGeometryData)shapeGeometry).ShapeData = original;
+            var decimator = new XbimMeshDecimator(0.01);
+            decimator.TryDecimate(shapeGeometry).Should().BeTrue();
+
+            var decimated = ((IXbimShapeGeometryData)shapeGeometry).ShapeData;
+            CheckHeader(decimated).TriangleCount.Should().BeLessThan(1200 / 4);
+            HelperFunctions.MeshVolume(decimated).Should().BeApproximately(1000, 1e-3);
+            var bounds = shapeGeometry.BoundingBox;
+            new[] { bounds.X, bounds.Y, bounds.Z }.Should().OnlyContain(c => Math.Abs(c) < 1e-6);
+            new[] { bounds.SizeX, bounds.SizeY, bounds.SizeZ }.Should().OnlyContain(s => Math.Abs(s - 10) < 1e-6);
+
+            //other formats and empty geometries are left as they are
+            var text = new XbimShapeGeometry { Format = XbimGeometryType.Polyhedron };
+            ((IXbimShapeGeometryData)text).ShapeData = original;
+            decimator.TryDecimate(text).Should().BeFalse();
+            ((IXbimShapeGeometryData)text).ShapeData.Should().BeSameAs(original);
+            decimator.TryDecimate(new XbimShapeGeometry { Format = XbimGeometryType.PolyhedronBinary }).Should().BeFalse();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using Xbim.Common.Geometry;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class MeshingPolicyTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<MeshingPolicyTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        private static int TriangleCount(IXbimShapeGeometryData geometry)
+        {
+            return new XbimShapeMeshView(geometry.ShapeData).TriangleCount;
+        }
+
+        [TestMethod]
+        public void BudgetRemeshLowersTheTriangleCount()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var sphere = geomEngine.CreateSolid(IfcModelBuilder.MakeSphere(m, 10), logger);
+                    const double deflection = 0.05;
+                    const double angle = 0.5;
+                    var fine = TriangleCount(geomEngine.CreateShapeGeometry(sphere, m.ModelFactors.Precision, deflection, angle, XbimGeometryType.PolyhedronBinary, logger));
+
+                    //the deflections as coarsened for a mesh 1.2 times over its budget, the sphere already carries the finer mesh
+                    const double factor = 1.2;
+                    var coarse = TriangleCount(geomEngine.CreateShapeGeometry(sphere, m.ModelFactors.Precision, deflection * factor * factor, angle * factor, XbimGeometryType.PolyhedronBinary, logger));
+                    coarse.Should().BeLessThan(fine);
+
+                    //the coarser mesh was made on a copy, the mesh of the sphere is unchanged
+                    TriangleCount(geomEngine.CreateShapeGeometry(sphere, m.ModelFactors.Precision, deflection, angle, XbimGeometryType.PolyhedronBinary, logger)).Should().Be(fine);
+                }
+            }
+        }
+    }
+}
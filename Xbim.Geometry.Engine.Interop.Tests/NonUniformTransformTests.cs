@@ -0,0 +1,224 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.IO.Memory;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class NonUniformTransformTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        //surface types as numbered in the OCC BRep format
+        private const int Plane = 1;
+        private const int Cylinder = 2;
+        private const int Sphere = 4;
+        private const int LinearExtrusion = 6;
+        private const int BSpline = 9;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<NonUniformTransformTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        private static IfcCartesianTransformationOperator3DnonUniform MakeScale(MemoryModel m, double x, double y, double z)
+        {
+            var transform = IfcModelBuilder.MakeCartesianTransformationOperator3DnonUniform(m);
+            transform.Scale = x;
+            transform.Scale2 = y;
+            transform.Scale3 = z;
+            return transform;
+        }
+
+        //scales the solid, checks the result with BRepCheck_Analyzer and that its volume is scaled by the determinant, to a relative
+        //tolerance that allows for the numeric integration of curved faces, returns the types of its surfaces
+        private static List<int> TransformAndCheck(MemoryModel m, IXbimSolid solid, double x, double y, double z, double volumeTolerance = 1e-4)
+        {
+            solid.IsValid.Should().BeTrue();
+            var transformed = geomEngine.Transformed(solid, MakeScale(m, x, y, z)) as IXbimSolid;
+            transformed.Should().NotBeNull();
+            transformed.IsValid.Should().BeTrue();
+            transformed.HasValidTopology.Should().BeTrue();
+            transformed.Volume.Should().BeApproximately(Math.Abs(x * y * z) * solid.Volume, volumeTolerance * solid.Volume * Math.Abs(x * y * z));
+            return SurfaceTypes(geomEngine.ToBrep(transformed));
+        }
+
+        #region BRep surfaces
+
+        //the type of each entry in the Surfaces section of the BRep text, the other entries are read only as far as to skip them
+        private static List<int> SurfaceTypes(string brep)
+        {
+            var tokens = brep.Substring(brep.IndexOf("\nSurfaces ", StringComparison.Ordinal)).Split((char[])null, StringSplitOptions.RemoveEmptyEntries);
+            var count = int.Parse(tokens[1], CultureInfo.InvariantCulture);
+            var pos = 2;
+            var types = new List<int>(count);
+            for (int i = 0; i < count; i++)
+                types.Add(SkipSurface(tokens, ref pos));
+            return types;
+        }
+
+        private static int Next(string[] tokens, ref int pos)
+        {
+            return int.Parse(tokens[pos++], CultureInfo.InvariantCulture);
+        }
+
+        private static int SkipSurface(string[] tokens, ref int pos)
+        {
+            var type = Next(tokens, ref pos);
+            switch (type)
+            {
+                case 1: pos += 12; break; //plane, location and three directions
+                case 2: case 4: pos += 13; break; //cylinder and sphere add a radius
+                case 3: case 5: pos += 14; break; //cone and torus add a second number
+                case 6: pos += 3; SkipCurve(tokens, ref pos); break; //extrusion direction and basis curve
+                case 7: pos += 6; SkipCurve(tokens, ref pos); break; //revolution axis and basis curve
+                case 8:
+                    {
+                        var rational = Next(tokens, ref pos) + Next(tokens, ref pos) > 0;
+                        var poles = (Next(tokens, ref pos) + 1) * (Next(tokens, ref pos) + 1);
+                        pos += poles * (rational ? 4 : 3);
+                        break;
+                    }
+                case 9:
+                    {
+                        var rational = Next(tokens, ref pos) + Next(tokens, ref pos) > 0;
+                        pos += 4; //periodic flags and degrees
+                        var poles = Next(tokens, ref pos) * Next(tokens, ref pos);
+                        var knots = Next(tokens, ref pos) + Next(tokens, ref pos);
+                        pos += poles * (rational ? 4 : 3) + 2 * knots;
+                        break;
+                    }
+                case 10: pos += 4; SkipSurface(tokens, ref pos); break; //trimmed by parameter ranges
+                case 11: pos += 1; SkipSurface(tokens, ref pos); break; //offset
+                default: Assert.Fail("Unknown surface type {0}", type); break;
+            }
+            return type;
+        }
+
+        private static void SkipCurve(string[] tokens, ref int pos)
+        {
+            var type = Next(tokens, ref pos);
+            switch (type)
+            {
+                case 1: pos += 6; break; //line
+                case 2: case 4: pos += 13; break; //circle and parabola
+                case 3: case 5: pos += 14; break; //ellipse and hyperbola
+                case 6:
+                    {
+                        var rational = Next(tokens, ref pos) > 0;
+                        pos += (Next(tokens, ref pos) + 1) * (rational ? 4 : 3);
+                        break;
+                    }
+                case 7:
+                    {
+                        var rational = Next(tokens, ref pos) > 0;
+                        pos += 2; //periodic flag and degree
+                        var poles = Next(tokens, ref pos);
+                        var knots = Next(tokens, ref pos);
+                        pos += poles * (rational ? 4 : 3) + 2 * knots;
+                        break;
+                    }
+                case 8: pos += 2; SkipCurve(tokens, ref pos); break; //trimmed
+                case 9: pos += 4; SkipCurve(tokens, ref pos); break; //offset distance and direction
+                default: Assert.Fail("Unknown curve type {0}", type); break;
+            }
+        }
+
+        #endregion
+
+        [TestMethod]
+        public void ScaledBoxKeepsItsPlanes()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var block = IfcModelBuilder.MakeBlock(m, 10, 20, 30);
+                    var types = TransformAndCheck(m, geomEngine.CreateSolid(block, logger), 2, 3, 0.5);
+                    types.Should().HaveCount(6).And.OnlyContain(t => t == Plane);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void UprightCylinderStaysACylinder()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    //the cross section is scaled the same in x and y so it stays round
+                    var cylinder = IfcModelBuilder.MakeRightCircularCylinder(m, 10, 20);
+                    cylinder.Position.Axis.SetXYZ(0, 0, 1);
+                    var types = TransformAndCheck(m, geomEngine.CreateSolid(cylinder, logger), 2, 2, 3);
+                    types.Should().OnlyContain(t => t == Plane || t == Cylinder).And.Contain(Cylinder);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ObliqueCylinderBecomesAnEllipticExtrusion()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    //the axis is tilted so the scale shears the cylinder, the cross section becomes an ellipse no longer square to the axis
+                    var cylinder = IfcModelBuilder.MakeRightCircularCylinder(m, 10, 20);
+                    cylinder.Position.Axis.SetXYZ(1, 0, 1);
+                    var types = TransformAndCheck(m, geomEngine.CreateSolid(cylinder, logger), 1, 1, 2);
+                    types.Should().OnlyContain(t => t == Plane || t == LinearExtrusion).And.Contain(LinearExtrusion);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void MirroredCylinderIsNotInsideOut()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    //a negative determinant, the faces have to be reversed for the volume to come out positive
+                    var cylinder = IfcModelBuilder.MakeRightCircularCylinder(m, 10, 20);
+                    cylinder.Position.Axis.SetXYZ(0, 0, 1);
+                    var types = TransformAndCheck(m, geomEngine.CreateSolid(cylinder, logger), -2, 2, 1);
+                    types.Should().OnlyContain(t => t == Plane || t == Cylinder).And.Contain(Cylinder);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ScaledSphereFallsBackToBSplines()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    //a sphere has no exact image of its kind, the whole shape is left to BRepBuilderAPI_GTransform
+                    var sphere = IfcModelBuilder.MakeSphere(m, 10);
+                    var types = TransformAndCheck(m, geomEngine.CreateSolid(sphere, logger), 1, 1, 2, 1e-3);
+                    types.Should().NotContain(Sphere).And.Contain(BSpline);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.Ifc4.ProfileResource;
+using Xbim.IO.Memory;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class PlanarFaceTriangulationTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<PlanarFaceTriangulationTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        private static IfcPolyline MakePolyline(MemoryModel m, params double[] xy)
+        {
+            var polyline = m.Instances.New<IfcPolyline>();
+            for (int i = 0; i < xy.Length; i += 2)
+            {
+                var x = xy[i];
+                var y = xy[i + 1];
+                polyline.Points.Add(m.Instances.New<IfcCartesianPoint>(c => c.SetXY(x, y)));
+            }
+            polyline.Points.Add(polyline.Points.First()); //closed
+            return polyline;
+        }
+
+        //extrudes the profile by 1 and checks the triangles written cover the end faces exactly
+        private static void MeshAndCheck(MemoryModel m, IfcProfileDef profile, double profileArea, double profilePerimeter)
+        {
+            var extrusion = IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 1);
+            var solid = geomEngine.CreateSolid(extrusion, logger);
+            solid.IsValid.Should().BeTrue();
+            solid.Volume.Should().BeApproximately(profileArea, 1e-5);
+            var shapeGeometry = geomEngine.CreateShapeGeometry(solid, m.ModelFactors.Precision, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+            var shapeData = ((IXbimShapeGeometryData)shapeGeometry).ShapeData;
+            HelperFunctions.MeshVolume(shapeData).Should().BeApproximately(profileArea, 1e-5, "no triangle may be missing or overlap another");
+            HelperFunctions.MeshArea(shapeData).Should().BeApproximately(2 * profileArea + profilePerimeter, 1e-5);
+        }
+
+        [TestMethod]
+        public void RepeatedPointsAreTriangulated()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var profile = m.Instances.New<IfcArbitraryClosedProfileDef>();
+                    profile.OuterCurve = MakePolyline(m, 0, 0, 0, 0, 4, 0, 4, 0, 4, 4, 4, 4, 0, 4, 0, 4);
+                    MeshAndCheck(m, profile, 16, 16);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void CollinearRunsAreTriangulated()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var profile = m.Instances.New<IfcArbitraryClosedProfileDef>();
+                    profile.OuterCurve = MakePolyline(m, 0, 0, 1, 0, 2, 0, 3, 0, 4, 0, 4, 1, 4, 2, 4, 4, 2, 4, 0, 4, 0, 2);
+                    MeshAndCheck(m, profile, 16, 16);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void HolesAreTriangulated()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var profile = m.Instances.New<IfcArbitraryProfileDefWithVoids>();
+                    //the outer loop has a collinear point level with the holes and the second hole a repeated point
+                    profile.OuterCurve = MakePolyline(m, 0, 0, 10, 0, 10, 5, 10, 10, 0, 10);
+                    profile.InnerCurves.Add(MakePolyline(m, 2, 2, 4, 2, 4, 4, 2, 4));
+                    profile.InnerCurves.Add(MakePolyline(m, 6, 4, 8, 4, 8, 4, 8, 6, 6, 6));
+                    MeshAndCheck(m, profile, 100 - 4 - 4, 40 + 8 + 8);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using Xbim.Common.Geometry;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class QuantityTakeOffTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<QuantityTakeOffTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        [TestMethod]
+        public void UnitCubeQuantities()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        store.AddBlock(2, 3, 4, 1, 1, 1);
+                        store.AddBlock(0, 0, 0, 2, 3, 4);
+                        var quantities = new XbimQuantityTakeOff(m).Calculate(store.Commit());
+                        quantities.Should().HaveCount(3);
+
+                        var cube = quantities[1];
+                        cube.Volume.Should().BeApproximately(1, 1e-6);
+                        cube.SurfaceArea.Should().BeApproximately(6, 1e-6);
+                        cube.FootprintArea.Should().BeApproximately(1, 1e-6);
+                        cube.Centroid.X.Should().BeApproximately(0.5, 1e-6);
+                        cube.Centroid.Y.Should().BeApproximately(0.5, 1e-6);
+                        cube.Centroid.Z.Should().BeApproximately(0.5, 1e-6);
+                        cube.IsApproximate.Should().BeFalse();
+
+                        //the same cube moved, only the centroid changes
+                        var moved = quantities[2];
+                        moved.Volume.Should().BeApproximately(1, 1e-6);
+                        moved.SurfaceArea.Should().BeApproximately(6, 1e-6);
+                        moved.FootprintArea.Should().BeApproximately(1, 1e-6);
+                        moved.Centroid.X.Should().BeApproximately(2.5, 1e-6);
+                        moved.Centroid.Y.Should().BeApproximately(3.5, 1e-6);
+                        moved.Centroid.Z.Should().BeApproximately(4.5, 1e-6);
+
+                        var block = quantities[3];
+                        block.Volume.Should().BeApproximately(24, 1e-5);
+                        block.SurfaceArea.Should().BeApproximately(52, 1e-5);
+                        block.FootprintArea.Should().BeApproximately(6, 1e-5);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ScaledCubeQuantities()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        var cube = geomEngine.CreateSolid(IfcModelBuilder.MakeBlock(m, 1, 1, 1), logger);
+                        //a uniform scale scales the cached area, a non-uniform one has the area taken from the transformed mesh
+                        store.AddSolid(cube, new XbimMatrix3D(2, 0, 0, 0, 0, 2, 0, 0, 0, 0, 2, 0, 0, 0, 0, 1));
+                        store.AddSolid(cube, new XbimMatrix3D(1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 1));
+                        var quantities = new XbimQuantityTakeOff(m).Calculate(store.Commit());
+                        quantities[1].Volume.Should().BeApproximately(8, 1e-5);
+                        quantities[1].SurfaceArea.Should().BeApproximately(24, 1e-5);
+                        quantities[2].Volume.Should().BeApproximately(6, 1e-5);
+                        quantities[2].SurfaceArea.Should().BeApproximately(22, 1e-5);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,193 @@
+﻿using FluentAssertions;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class SceneIndexTests
+    {
+        private static List<XbimShapeInstance> RandomInstances(Random random, int count, double extent)
+        {
+            var instances = new List<XbimShapeInstance>(count);
+            for (var i = 0; i < count; i++)
+            {
+                instances.Add(new XbimShapeInstance
+                {
+                    InstanceLabel = i,
+                    Transformation = XbimMatrix3D.Identity,
+                    BoundingBox = RandomBox(random, extent, 5)
+                });
+            }
+            return instances;
+        }
+
+        private static XbimRect3D RandomBox(Random random, double extent, double size)
+        {
+            return new XbimRect3D(random.NextDouble() * extent, random.NextDouble() * extent, random.NextDouble() * extent,
+                random.NextDouble() * size, random.NextDouble() * size, random.NextDouble() * size);
+        }
+
+        private static bool Overlaps(XbimRect3D a, XbimRect3D b)
+        {
+            return a.X <= b.X + b.SizeX && a.X + a.SizeX >= b.X &&
+                   a.Y <= b.Y + b.SizeY && a.Y + a.SizeY >= b.Y &&
+                   a.Z <= b.Z + b.SizeZ && a.Z + a.SizeZ >= b.Z;
+        }
+
+        //the parameter where the ray enters the box, 0 if it starts inside and -1 if it misses, by clipping the ray to each slab in turn
+        private static double RayDistance(XbimRect3D box, XbimPoint3D origin, XbimVector3D direction)
+        {
+            var tMin = 0.0;
+            var tMax = double.PositiveInfinity;
+            var min = new[] { box.X, box.Y, box.Z };
+            var max = new[] { box.X + box.SizeX, box.Y + box.SizeY, box.Z + box.SizeZ };
+            var o = new[] { origin.X, origin.Y, origin.Z };
+            var d = new[] { direction.X, direction.Y, direction.Z };
+            for (var axis = 0; axis < 3; axis++)
+            {
+                if (d[axis] == 0)
+                {
+                    if (o[axis] < min[axis] || o[axis] > max[axis]) return -1;
+                    continue;
+                }
+                var t1 = (min[axis] - o[axis]) / d[axis];
+                var t2 = (max[axis] - o[axis]) / d[axis];
+                tMin = Math.Max(tMin, Math.Min(t1, t2));
+                tMax = Math.Min(tMax, Math.Max(t1, t2));
+                if (tMin > tMax) return -1;
+            }
+            return tMin;
+        }
+
+        private static List<int> Labels(IEnumerable<XbimShapeInstance> instances)
+        {
+            return instances.Select(i => i.InstanceLabel).OrderBy(l => l).ToList();
+        }
+
+        [TestMethod]
+        public void OverlappingMatchesBruteForce()
+        {
+            var random = new Random(7);
+            foreach (var count in new[] { 1, 2, 3, 17, 1000 })
+            {
+                var instances = RandomInstances(random, count, 100);
+                var index = new XbimSceneIndex(instances);
+                index.Count.Should().Be(count);
+                var queries = Enumerable.Range(0, 50).Select(q => RandomBox(random, 100, 20)).ToList();
+                var batch = index.Overlapping(queries);
+                for (var q = 0; q < queries.Count; q++)
+                {
+                    var expected = Labels(instances.Where(i => Overlaps(i.BoundingBox, queries[q])));
+                    Labels(index.Overlapping(queries[q])).Should().Equal(expected);
+                    Labels(batch[q]).Should().Equal(expected);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void CoincidentBoxesAreAllFound()
+        {
+            //every centre has the same Morton code, the instance index alone orders the leaves
+            var instances = Enumerable.Range(0, 100).Select(i => new XbimShapeInstance
+            {
+                InstanceLabel = i,
+                Transformation = XbimMatrix3D.Identity,
+                BoundingBox = new XbimRect3D(0, 0, 0, 1, 1, 1)
+            }).ToList();
+            var index = new XbimSceneIndex(instances);
+            Labels(index.Overlapping(new XbimRect3D(0.5, 0.5, 0.5, 0.1, 0.1, 0.1))).Should().Equal(Enumerable.Range(0, 100));
+            index.Overlapping(new XbimRect3D(2, 2, 2, 1, 1, 1)).Should().BeEmpty();
+        }
+
+        [TestMethod]
+        public void EmptyIndexFindsNothing()
+        {
+            var index = new XbimSceneIndex(new XbimShapeInstance[0]);
+            index.Count.Should().Be(0);
+            index.Overlapping(new XbimRect3D(0, 0, 0, 1, 1, 1)).Should().BeEmpty();
+            index.Pick(new XbimPoint3D(0, 0, 0), new XbimVector3D(1, 0, 0)).Should().BeEmpty();
+        }
+
+        [TestMethod]
+        public void VisibleMatchesBruteForce()
+        {
+            var random = new Random(11);
+            var instances = RandomInstances(random, 1000, 100);
+            var index = new XbimSceneIndex(instances);
+            for (var f = 0; f < 20; f++)
+            {
+                //a box of axis aligned planes cut by one oblique plane through its centre
+                var region = new XbimRect3D(random.NextDouble() * 60, random.NextDouble() * 60, random.NextDouble() * 60, 20 + random.NextDouble() * 20, 20 + random.NextDouble() * 20, 20 + random.NextDouble() * 20);
+                var normal = new XbimVector3D(random.NextDouble() - 0.5, random.NextDouble() - 0.5, random.NextDouble() - 0.5);
+                var centre = new XbimPoint3D(region.X + region.SizeX / 2, region.Y + region.SizeY / 2, region.Z + region.SizeZ / 2);
+                var planes = new List<Tuple<XbimVector3D, double>>
+                {
+                    Tuple.Create(new XbimVector3D(1, 0, 0), -region.X),
+                    Tuple.Create(new XbimVector3D(-1, 0, 0), region.X + region.SizeX),
+                    Tuple.Create(new XbimVector3D(0, 1, 0), -region.Y),
+                    Tuple.Create(new XbimVector3D(0, -1, 0), region.Y + region.SizeY),
+                    Tuple.Create(new XbimVector3D(0, 0, 1), -region.Z),
+                    Tuple.Create(new XbimVector3D(0, 0, -1), region.Z + region.SizeZ),
+                    Tuple.Create(normal, -(normal.X * centre.X + normal.Y * centre.Y + normal.Z * centre.Z))
+                };
+                //a box is culled when it is wholly behind one of the planes
+                var expected = Labels(instances.Where(i =>
+                {
+                    var b = i.BoundingBox;
+                    return planes.All(p =>
+                    {
+                        var n = p.Item1;
+                        var x = n.X >= 0 ? b.X + b.SizeX : b.X;
+                        var y = n.Y >= 0 ? b.Y + b.SizeY : b.Y;
+                        var z = n.Z >= 0 ? b.Z + b.SizeZ : b.Z;
+                        return n.X * x + n.Y * y + n.Z * z + p.Item2 >= 0;
+                    });
+                }));
+                expected.Should().NotBeEmpty();
+                Labels(index.Visible(new XbimSceneIndex.Frustum(planes))).Should().Equal(expected);
+            }
+        }
+
+        [TestMethod]
+        public void PickMatchesBruteForce()
+        {
+            var random = new Random(13);
+            var instances = RandomInstances(random, 1000, 100);
+            var index = new XbimSceneIndex(instances);
+            var origins = new List<XbimPoint3D>();
+            var directions = new List<XbimVector3D>();
+            for (var r = 0; r < 50; r++)
+            {
+                origins.Add(new XbimPoint3D(random.NextDouble() * 100, random.NextDouble() * 100, -10));
+                directions.Add(new XbimVector3D(random.NextDouble() - 0.5, random.NextDouble() - 0.5, 1));
+            }
+            //rays parallel to the axes take the path for directions with zero components
+            origins.Add(new XbimPoint3D(-10, 50, 50));
+            directions.Add(new XbimVector3D(1, 0, 0));
+            origins.Add(new XbimPoint3D(50, 50, 50));
+            directions.Add(new XbimVector3D(0, -1, 0));
+
+            var nearest = index.Pick(origins, directions);
+            for (var r = 0; r < origins.Count; r++)
+            {
+                var expected = instances
+                    .Select(i => new { i.InstanceLabel, Distance = RayDistance(i.BoundingBox, origins[r], directions[r]) })
+                    .Where(h => h.Distance >= 0).ToList();
+                var hits = index.Pick(origins[r], directions[r]);
+                Labels(hits.Select(h => h.Instance)).Should().Equal(expected.Select(h => h.InstanceLabel).OrderBy(l => l));
+                hits.Select(h => h.Distance).Should().BeInAscendingOrder();
+                foreach (var hit in hits)
+                    hit.Distance.Should().BeApproximately(expected.First(h => h.InstanceLabel == hit.Instance.InstanceLabel).Distance, 1e-9);
+                if (expected.Count == 0)
+                    nearest[r].Should().BeNull();
+                else
+                    nearest[r].Value.Distance.Should().BeApproximately(expected.Min(h => h.Distance), 1e-9);
+            }
+        }
+    }
+}
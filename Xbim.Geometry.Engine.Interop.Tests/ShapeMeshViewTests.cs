@@ -0,0 +1,100 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Common.XbimExtensions;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class ShapeMeshViewTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<ShapeMeshViewTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        //compares the view with the triangulation read by the Xbim.Common reader, index by index
+        private static void ShouldMatchTheReader(XbimShapeMeshView view, byte[] shapeData)
+        {
+            var triangulation = new BinaryReader(new MemoryStream(shapeData)).ReadShapeTriangulation();
+            var vertices = triangulation.Vertices.ToList();
+            var faces = triangulation.Faces.ToList();
+            view.VertexCount.Should().Be(vertices.Count);
+            view.FaceCount.Should().Be(faces.Count);
+            view.TriangleCount.Should().Be(faces.Sum(f => f.TriangleCount));
+            for (var v = 0; v < vertices.Count; v++)
+                view.Vertex(v).Should().Be(vertices[v]);
+            for (var f = 0; f < faces.Count; f++)
+            {
+                view.FaceTriangleCount(f).Should().Be(faces[f].TriangleCount);
+                view.IsPlanar(f).Should().Be(faces[f].IsPlanar);
+                for (var t = 0; t < faces[f].TriangleCount; t++)
+                {
+                    for (var corner = 0; corner < 3; corner++)
+                    {
+                        view.Index(f, t, corner).Should().Be(faces[f].Indices[t * 3 + corner]);
+                        var expected = faces[f].IsPlanar ? faces[f].Normals[0] : faces[f].Normals[t * 3 + corner];
+                        view.Normal(f, t, corner).Normal.Should().Be(expected.Normal);
+                    }
+                }
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow("LargeTriangulatedCoordinates.ifc")]
+        [DataRow("SweptDiskSolid_1.ifc")]
+        public void StoredMeshesAreViewedAsWritten(string file)
+        {
+            using (var m = MemoryModel.OpenRead(Path.Combine("TestFiles", file)))
+            {
+                var c = new Xbim3DModelContext(m);
+                c.CreateContext(null, false);
+                var geometries = c.ShapeGeometries().Where(g => g.Format == XbimGeometryType.PolyhedronBinary).ToList();
+                geometries.Should().NotBeEmpty();
+                foreach (var geometry in geometries)
+                    ShouldMatchTheReader(c.ShapeGeometryMeshView(geometry), ((IXbimShapeGeometryData)geometry).ShapeData);
+            }
+        }
+
+        [TestMethod]
+        public void IndicesAreReadAtEachWidth()
+        {
+            //the finer the sphere is meshed the more vertices it has, enough at each step for byte, ushort and int indices
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var c = new Xbim3DModelContext(m);
+                    var sphere = geomEngine.CreateSolid(IfcModelBuilder.MakeSphere(m, 10), logger);
+                    var widths = new[] { new { Deflection = 1.0, Min = 1, Max = 0xFF }, new { Deflection = 0.01, Min = 0x100, Max = 0xFFFF }, new { Deflection = 1e-4, Min = 0x10000, Max = int.MaxValue } };
+                    foreach (var width in widths)
+                    {
+                        var geometry = geomEngine.CreateShapeGeometry(sphere, m.ModelFactors.Precision, width.Deflection, 0.5, XbimGeometryType.PolyhedronBinary, logger);
+                        var view = c.ShapeGeometryMeshView(geometry);
+                        view.VertexCount.Should().BeInRange(width.Min, width.Max);
+                        ShouldMatchTheReader(view, ((IXbimShapeGeometryData)geometry).ShapeData);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Microsoft.Extensions.Logging;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.IO.Memory;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    /// <summary>
+    /// Writes meshed solids straight into the geometry store of a model, for the scene classes that only read the store
+    /// </summary>
+    internal class ShapeStoreBuilder : IDisposable
+    {
+        private readonly MemoryModel _model;
+        private readonly IXbimGeometryEngine _engine;
+        private readonly ILogger _logger;
+        private readonly IGeometryStoreInitialiser _txn;
+        private int _nextProductLabel = 1;
+
+        public ShapeStoreBuilder(MemoryModel model, IXbimGeometryEngine engine, ILogger logger)
+        {
+            _model = model;
+            _engine = engine;
+            _logger = logger;
+            _txn = model.GeometryStore.BeginInit();
+        }
+
+        /// <summary>
+        /// Stores a block with its lowest corner at the location as a product of its own, must be called in a model transaction
+        /// </summary>
+        public void AddBlock(double x, double y, double z, double sizeX, double sizeY, double sizeZ)
+        {
+            var block = IfcModelBuilder.MakeBlock(_model, sizeX, sizeY, sizeZ);
+            block.Position.Axis = _model.Instances.New<IfcDirection>(d => d.SetXYZ(0, 0, 1));
+            block.Position.RefDirection = _model.Instances.New<IfcDirection>(d => d.SetXYZ(1, 0, 0));
+            AddSolid(_engine.CreateSolid(block, _logger), XbimMatrix3D.CreateTranslation(x, y, z));
+        }
+
+        /// <summary>
+        /// Stores the mesh of the solid with the transformation as a product of its own
+        /// </summary>
+        public void AddSolid(IXbimSolid solid, XbimMatrix3D transformation)
+        {
+            var factors = _model.ModelFactors;
+            var geometry = _engine.CreateShapeGeometry(solid, factors.Precision, factors.DeflectionTolerance, factors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, _logger);
+            var geometryLabel = _txn.AddShapeGeometry(geometry);
+            var instance = new XbimShapeInstance
+            {
+                InstanceLabel = _nextProductLabel,
+                IfcProductLabel = _nextProductLabel++,
+                ShapeGeometryLabel = geometryLabel,
+                RepresentationType = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded,
+                Transformation = transformation,
+                BoundingBox = solid.BoundingBox
+            };
+            _txn.AddShapeInstance(instance, geometryLabel);
+        }
+
+        /// <summary>
+        /// Commits the store and returns its instances in the order they were added
+        /// </summary>
+        public List<XbimShapeInstance> Commit()
+        {
+            _txn.Commit();
+            using (var reader = _model.GeometryStore.BeginRead())
+                return reader.ShapeInstances.OrderBy(i => i.IfcProductLabel).ToList();
+        }
+
+        public void Dispose()
+        {
+            _txn.Dispose();
+        }
+    }
+}
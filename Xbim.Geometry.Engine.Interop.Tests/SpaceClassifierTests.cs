@@ -0,0 +1,115 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System.Linq;
+using System.Threading;
+using Xbim.Common.Geometry;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class SpaceClassifierTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<SpaceClassifierTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        [TestMethod]
+        public void PointsInsideAndOutsideAreClassified()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        //two spaces that overlap between x 1 and 2
+                        store.AddBlock(0, 0, 0, 2, 1, 1);
+                        store.AddBlock(1, 0, 0, 2, 1, 1);
+                        var spaces = store.Commit();
+                        var classifier = new XbimSpaceClassifier(m, spaces) { BoundaryDistance = 1e-3 };
+                        var points = new[]
+                        {
+                            new XbimPoint3D(0.5, 0.5, 0.5),
+                            new XbimPoint3D(2.5, 0.5, 0.5),
+                            new XbimPoint3D(1.5, 0.5, 0.5),
+                            new XbimPoint3D(1.5, 1.5, 0.5),
+                            new XbimPoint3D(-0.01, 0.5, 0.5),
+                            new XbimPoint3D(0.01, 0.99, 0.99)
+                        };
+                        var results = classifier.Classify(points);
+                        results[0].Select(s => s.IfcProductLabel).Should().Equal(1);
+                        results[1].Select(s => s.IfcProductLabel).Should().Equal(2);
+                        results[2].Select(s => s.IfcProductLabel).Should().BeEquivalentTo(1, 2);
+                        results[3].Should().BeEmpty();
+                        results[4].Should().BeEmpty();
+                        results[5].Select(s => s.IfcProductLabel).Should().Equal(1);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void PointsOnTheBoundaryArePassedToTheBoundaryClassifier()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    using (var store = new ShapeStoreBuilder(m, geomEngine, logger))
+                    {
+                        store.AddBlock(0, 0, 0, 1, 1, 1);
+                        var spaces = store.Commit();
+                        var calls = 0;
+                        var inside = true;
+                        var classifier = new XbimSpaceClassifier(m, spaces)
+                        {
+                            BoundaryDistance = 1e-3,
+                            BoundaryClassifier = (space, point) =>
+                            {
+                                Interlocked.Increment(ref calls);
+                                return inside;
+                            }
+                        };
+                        //on a face, on an edge, on a corner and just inside a face
+                        var boundary = new[]
+                        {
+                            new XbimPoint3D(1, 0.5, 0.5),
+                            new XbimPoint3D(0, 0, 0.5),
+                            new XbimPoint3D(1, 1, 1),
+                            new XbimPoint3D(0.5, 0.5, 0.9995)
+                        };
+                        classifier.Classify(boundary).Should().OnlyContain(r => r.Count == 1);
+                        calls.Should().Be(boundary.Length);
+
+                        inside = false;
+                        classifier.Classify(boundary).Should().OnlyContain(r => r.Count == 0);
+                        calls.Should().Be(2 * boundary.Length);
+
+                        //clear of the boundary the winding number decides
+                        classifier.Classify(new XbimPoint3D(0.5, 0.5, 0.5)).Should().HaveCount(1);
+                        classifier.Classify(new XbimPoint3D(0.5, 0.5, 0.99)).Should().HaveCount(1);
+                        calls.Should().Be(2 * boundary.Length);
+                    }
+                }
+            }
+        }
+    }
+}
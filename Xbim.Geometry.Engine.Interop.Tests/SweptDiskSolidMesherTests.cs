@@ -0,0 +1,78 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.Interfaces;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class SweptDiskSolidMesherTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<SweptDiskSolidMesherTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        [DataTestMethod]
+        [DataRow("SweptDiskSolid_3", DisplayName = "Directrix is indexed polyline with arcs")]
+        [DataRow("SweptDiskSolid_4", DisplayName = "Ifc reference test")]
+        public void DirectMeshMatchesGeometryEngineMesh(string fileName)
+        {
+            using (var model = MemoryModel.OpenRead($@"TestFiles\{fileName}.ifc"))
+            {
+                var sweptDisk = model.Instances.OfType<IIfcSweptDiskSolid>().FirstOrDefault();
+                sweptDisk.Should().NotBeNull();
+                var precision = model.ModelFactors.Precision;
+                var deflection = model.ModelFactors.DeflectionTolerance;
+                var deflectionAngle = model.ModelFactors.DeflectionAngle;
+
+                var solid = geomEngine.CreateSolid(sweptDisk, logger);
+                solid.Should().NotBeNull();
+                var occGeometry = geomEngine.CreateShapeGeometry(solid, precision, deflection, deflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+
+                var mesher = new XbimSweptDiskSolidMesher(model, deflection, deflectionAngle);
+                mesher.TryMesh(sweptDisk, out var directGeometry).Should().BeTrue();
+                directGeometry.Format.Should().Be(XbimGeometryType.PolyhedronBinary);
+
+                //both are chordal approximations of the same solid, they must agree with each other and with the B-rep to within the chordal error
+                var occVolume = HelperFunctions.MeshVolume(((IXbimShapeGeometryData)occGeometry).ShapeData);
+                var directVolume = HelperFunctions.MeshVolume(((IXbimShapeGeometryData)directGeometry).ShapeData);
+                directVolume.Should().BePositive("the direct mesh must face outwards");
+                directVolume.Should().BeApproximately(occVolume, occVolume * 0.02);
+                directVolume.Should().BeApproximately(solid.Volume, solid.Volume * 0.02);
+                var occArea = HelperFunctions.MeshArea(((IXbimShapeGeometryData)occGeometry).ShapeData);
+                HelperFunctions.MeshArea(((IXbimShapeGeometryData)directGeometry).ShapeData).Should().BeApproximately(occArea, occArea * 0.02);
+
+                var radius = (double)sweptDisk.Radius;
+                var occBounds = occGeometry.BoundingBox;
+                var directBounds = directGeometry.BoundingBox;
+                var tolerance = radius * 0.05 + precision;
+                directBounds.X.Should().BeApproximately(occBounds.X, tolerance);
+                directBounds.Y.Should().BeApproximately(occBounds.Y, tolerance);
+                directBounds.Z.Should().BeApproximately(occBounds.Z, tolerance);
+                directBounds.SizeX.Should().BeApproximately(occBounds.SizeX, 2 * tolerance);
+                directBounds.SizeY.Should().BeApproximately(occBounds.SizeY, 2 * tolerance);
+                directBounds.SizeZ.Should().BeApproximately(occBounds.SizeZ, 2 * tolerance);
+            }
+        }
+    }
+}
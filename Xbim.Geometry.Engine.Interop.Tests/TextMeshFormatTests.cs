@@ -0,0 +1,174 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class TextMeshFormatTests
+    {
+        static private IXbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<TextMeshFormatTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        private static string WriteText(MemoryModel m, IXbimGeometryObject shape)
+        {
+            using (var sw = new StringWriter())
+            {
+                geomEngine.WriteTriangulation(sw, shape, m.ModelFactors.Precision, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle);
+                return sw.ToString();
+            }
+        }
+
+        //writes the numbers read back from the text with the String.Format calls the writer used before the native encoder, a number of
+        //15 significant digits reads back to a double that formats to the same digits, so any difference is a token the encoder got wrong
+        private static string FormatAsBefore(string text)
+        {
+            var sb = new StringBuilder();
+            foreach (var line in text.Split(new[] { Environment.NewLine }, StringSplitOptions.RemoveEmptyEntries))
+            {
+                var tokens = line.Split(' ');
+                switch (tokens[0])
+                {
+                    case "P":
+                        var header = tokens.Skip(1).Select(t => (object)int.Parse(t, CultureInfo.InvariantCulture)).ToArray();
+                        sb.Append(string.Format(CultureInfo.InvariantCulture, "P {0} {1} {2} {3} {4}", header));
+                        break;
+                    case "V":
+                    case "N":
+                        sb.Append(tokens[0]);
+                        foreach (var token in tokens.Skip(1))
+                        {
+                            var xyz = token.Split(',').Select(t => double.Parse(t, CultureInfo.InvariantCulture)).ToArray();
+                            sb.Append(string.Format(CultureInfo.InvariantCulture, " {0},{1},{2}", xyz[0], xyz[1], xyz[2]));
+                        }
+                        break;
+                    case "T":
+                        sb.Append("T");
+                        foreach (var token in tokens.Skip(1))
+                        {
+                            var corners = token.Split(',').Select(c => c.Split('/').Select(i => int.Parse(i, CultureInfo.InvariantCulture)).ToArray()).ToArray();
+                            if (corners.All(c => c.Length == 2))
+                                sb.Append(string.Format(CultureInfo.InvariantCulture, " {0}/{3},{1}/{4},{2}/{5}", corners[0][0], corners[1][0], corners[2][0], corners[0][1], corners[1][1], corners[2][1]));
+                            else if (corners[0].Length == 2)
+                                sb.Append(string.Format(CultureInfo.InvariantCulture, " {0}/{3},{1},{2}", corners[0][0], corners[1][0], corners[2][0], corners[0][1]));
+                            else
+                                sb.Append(string.Format(CultureInfo.InvariantCulture, " {0},{1},{2}", corners[0][0], corners[1][0], corners[2][0]));
+                        }
+                        break;
+                    default:
+                        Assert.Fail("Unexpected line '{0}'", line);
+                        break;
+                }
+                sb.Append(Environment.NewLine);
+            }
+            return sb.ToString();
+        }
+
+        [TestMethod]
+        public void EncodedTextMatchesTheFormattedText()
+        {
+            var culture = Thread.CurrentThread.CurrentCulture;
+            try
+            {
+                //the text is invariant whatever the culture, the previous writer followed it and wrote commas here
+                Thread.CurrentThread.CurrentCulture = new CultureInfo("de-DE");
+                using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+                {
+                    using (var txn = m.BeginTransaction(""))
+                    {
+                        //the corners of the block have coordinates in exponent form, with 15 digits and one that rounds to 15 digits
+                        var block = IfcModelBuilder.MakeBlock(m, 1, 123456789012345, 1e15);
+                        block.Position.Axis = m.Instances.New<IfcDirection>(d => d.SetXYZ(0, 0, 1));
+                        block.Position.RefDirection = m.Instances.New<IfcDirection>(d => d.SetXYZ(1, 0, 0));
+                        block.Position.Location.SetXYZ(1.2345e-5, 0.1 + 0.2, 0);
+                        var solid = geomEngine.CreateSolid(block, logger);
+                        solid.IsValid.Should().BeTrue();
+                        var text = WriteText(m, solid);
+                        var coordinates = text.Split(new[] { Environment.NewLine }, StringSplitOptions.None)
+                            .First(l => l.StartsWith("V")).Split(' ').Skip(1).SelectMany(t => t.Split(',')).ToList();
+                        coordinates.Should().Contain(new[] { "1.2345E-05", "1.000012345", "0.3", "123456789012345", "1E+15", "0" });
+                        text.Should().Be(FormatAsBefore(text));
+
+                        //the cylinder is turned on to the x axis, the zero components of its normals come out of the rotation with either sign
+                        var cylinder = IfcModelBuilder.MakeRightCircularCylinder(m, 10, 20);
+                        solid = geomEngine.CreateSolid(cylinder, logger);
+                        solid.IsValid.Should().BeTrue();
+                        text = WriteText(m, solid);
+                        text.Split(new[] { Environment.NewLine, " ", ",", "/" }, StringSplitOptions.None).Should().NotContain("-0");
+                        text.Should().Be(FormatAsBefore(text));
+                    }
+                }
+            }
+            finally
+            {
+                Thread.CurrentThread.CurrentCulture = culture;
+            }
+        }
+
+        [TestMethod]
+        public void NumbersOutsideTheExactRangeReadBackAsParsed()
+        {
+            var culture = Thread.CurrentThread.CurrentCulture;
+            try
+            {
+                Thread.CurrentThread.CurrentCulture = new CultureInfo("de-DE");
+                //more than 15 significant digits, exponents beyond 22 and the ends of the range are left to the framework as are the
+                //indices with a sign or more than 9 digits, the rest and negative zero are read in place
+                var numbers = new[]
+                {
+                    "0.12345678901234567", "-1.5E+300", "1E-30",
+                    "-0", "1.7976931348623157E+308", "4.94065645841247E-324",
+                    "123456789012345678", "1.23456789012345E+20", "1E-05",
+                    "-1234.5", "3", "0"
+                };
+                var text = new StringBuilder("P 1 4 1 2 1\r\nV");
+                for (int i = 0; i < numbers.Length; i += 3)
+                    text.AppendFormat(" {0},{1},{2}", numbers[i], numbers[i + 1], numbers[i + 2]);
+                text.Append("\r\nN 0,0,1\r\nT 0/0,+1,0000000002 0000000002,3,0\r\n");
+
+                var mesh = new XbimMeshGeometry3D();
+                mesh.Read(text.ToString()).Should().BeTrue();
+                mesh.TriangleIndices.Should().Equal(0, 1, 2, 2, 3, 0);
+                mesh.Positions.Count.Should().Be(4);
+                for (int i = 0; i < mesh.Positions.Count; i++)
+                {
+                    var p = mesh.Positions[i];
+                    p.X.Should().Be(double.Parse(numbers[3 * i], CultureInfo.InvariantCulture));
+                    p.Y.Should().Be(double.Parse(numbers[3 * i + 1], CultureInfo.InvariantCulture));
+                    p.Z.Should().Be(double.Parse(numbers[3 * i + 2], CultureInfo.InvariantCulture));
+                }
+                mesh.Normals.Should().OnlyContain(n => n.Equals(new XbimVector3D(0, 0, 1)));
+            }
+            finally
+            {
+                Thread.CurrentThread.CurrentCulture = culture;
+            }
+        }
+    }
+}
@@ -0,0 +1,223 @@
+﻿using FluentAssertions;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class TriangulatedModelStreamTests
+    {
+        /// <summary>
+        /// The sections of a stream, see the layout at the top of XbimTriangulatedModelStream
+        /// </summary>
+        private class Fragment
+        {
+            public List<XbimPoint3D> Positions = new List<XbimPoint3D>();
+            public List<XbimVector3D> Normals = new List<XbimVector3D>();
+            public List<uint> UniquePositions = new List<uint>();
+            public List<uint> UniqueNormals = new List<uint>();
+            public List<List<uint>> Triangles = new List<List<uint>>();
+        }
+
+        private static int IndexSize(int count)
+        {
+            return count <= 0xFF ? 1 : count <= 0xFFFF ? 2 : 4;
+        }
+
+        private static void WriteIndex(BinaryWriter bw, uint index, int size)
+        {
+            if (size == 1) bw.Write((byte)index);
+            else if (size == 2) bw.Write((ushort)index);
+            else bw.Write(index);
+        }
+
+        private static uint ReadIndex(BinaryReader br, int size)
+        {
+            return size == 1 ? br.ReadByte() : size == 2 ? br.ReadUInt16() : br.ReadUInt32();
+        }
+
+        private static byte[] Encode(Fragment f)
+        {
+            using (var ms = new MemoryStream())
+            using (var bw = new BinaryWriter(ms))
+            {
+                bw.Write((uint)f.Positions.Count);
+                bw.Write((uint)f.Normals.Count);
+                bw.Write((uint)f.UniquePositions.Count);
+                bw.Write((uint)f.Triangles.Sum(t => t.Count / 3));
+                bw.Write((uint)f.Triangles.Count);
+                foreach (var p in f.Positions)
+                {
+                    bw.Write((float)p.X);
+                    bw.Write((float)p.Y);
+                    bw.Write((float)p.Z);
+                }
+                foreach (var n in f.Normals)
+                {
+                    bw.Write((float)n.X);
+                    bw.Write((float)n.Y);
+                    bw.Write((float)n.Z);
+                }
+                foreach (var i in f.UniquePositions)
+                    WriteIndex(bw, i, IndexSize(f.Positions.Count));
+                foreach (var i in f.UniqueNormals)
+                    WriteIndex(bw, i, IndexSize(f.Normals.Count));
+                foreach (var polygon in f.Triangles)
+                {
+                    bw.Write((byte)TriangleType.GL_Triangles);
+                    bw.Write(polygon.Count);
+                    foreach (var i in polygon)
+                        WriteIndex(bw, i, IndexSize(f.UniquePositions.Count));
+                }
+                bw.Flush();
+                return ms.ToArray();
+            }
+        }
+
+        private static Fragment Decode(MemoryStream stream)
+        {
+            var br = new BinaryReader(new MemoryStream(stream.ToArray()));
+            var f = new Fragment();
+            var positions = br.ReadInt32();
+            var normals = br.ReadInt32();
+            var uniques = br.ReadInt32();
+            var triangles = br.ReadInt32();
+            var polygons = br.ReadInt32();
+            for (var i = 0; i < positions; i++)
+                f.Positions.Add(new XbimPoint3D(br.ReadSingle(), br.ReadSingle(), br.ReadSingle()));
+            for (var i = 0; i < normals; i++)
+                f.Normals.Add(new XbimVector3D(br.ReadSingle(), br.ReadSingle(), br.ReadSingle()));
+            for (var i = 0; i < uniques; i++)
+                f.UniquePositions.Add(ReadIndex(br, IndexSize(positions)));
+            for (var i = 0; i < uniques; i++)
+                f.UniqueNormals.Add(ReadIndex(br, IndexSize(normals)));
+            for (var p = 0; p < polygons; p++)
+            {
+                br.ReadByte().Should().Be((byte)TriangleType.GL_Triangles);
+                var count = br.ReadInt32();
+                f.Triangles.Add(Enumerable.Range(0, count).Select(i => ReadIndex(br, IndexSize(uniques))).ToList());
+            }
+            f.Triangles.Sum(t => t.Count / 3).Should().Be(triangles);
+            br.BaseStream.Position.Should().Be(br.BaseStream.Length, "the header must account for every byte of the stream");
+            return f;
+        }
+
+        //a strip of quads along x, each quad has its own normal so every corner is a unique position and normal pair, the
+        //coordinates are exact in single precision so they read back unchanged
+        private static Fragment Strip(int quads, double y)
+        {
+            var f = new Fragment();
+            for (var q = 0; q <= quads; q++)
+            {
+                f.Positions.Add(new XbimPoint3D(q, y, 0));
+                f.Positions.Add(new XbimPoint3D(q, y + 1, 0));
+            }
+            var triangles = new List<uint>();
+            for (var q = 0; q < quads; q++)
+            {
+                f.Normals.Add(q % 2 == 0 ? new XbimVector3D(0, 0, 1) : new XbimVector3D(0, -1, 0));
+                var first = (uint)f.UniquePositions.Count;
+                foreach (var corner in new[] { 0, 1, 2, 3 })
+                {
+                    f.UniquePositions.Add((uint)(2 * q + corner));
+                    f.UniqueNormals.Add((uint)q);
+                }
+                triangles.AddRange(new[] { first, first + 2, first + 1, first + 1, first + 2, first + 3 });
+            }
+            f.Triangles.Add(triangles);
+            return f;
+        }
+
+        [TestMethod]
+        public void MergedLengthMatchesTheMergedStream()
+        {
+            var streams = new List<XbimTriangulatedModelStream>
+            {
+                new XbimTriangulatedModelStream(Encode(Strip(1, 0))),
+                new XbimTriangulatedModelStream(),
+                null,
+                new XbimTriangulatedModelStream(Encode(Strip(150, 5)))
+            };
+            var merged = XbimTriangulatedModelStream.Merge(streams);
+            merged.DataStream.Length.Should().Be(XbimTriangulatedModelStream.MergedLength(streams));
+            var buffer = new byte[XbimTriangulatedModelStream.MergedLength(streams) + 10];
+            XbimTriangulatedModelStream.Merge(streams, null, buffer, 10).Should().Be(XbimTriangulatedModelStream.MergedLength(streams));
+            buffer.Skip(10).Should().Equal(merged.DataStream.ToArray());
+            XbimTriangulatedModelStream.MergedLength(new XbimTriangulatedModelStream[] { null, new XbimTriangulatedModelStream() }).Should().Be(0);
+        }
+
+        [TestMethod]
+        public void IndicesAreRemappedAcrossFragments()
+        {
+            //the small fragment has byte indices, the merged stream has more than 255 positions and uniques so its indices are wider
+            var small = Strip(1, 0);
+            var large = Strip(150, 5);
+            var merged = Decode(XbimTriangulatedModelStream.Merge(new[] { new XbimTriangulatedModelStream(Encode(small)), new XbimTriangulatedModelStream(Encode(large)) }).DataStream);
+
+            merged.Positions.Should().Equal(small.Positions.Concat(large.Positions));
+            merged.Normals.Should().Equal(small.Normals.Concat(large.Normals));
+            merged.UniquePositions.Should().Equal(small.UniquePositions.Concat(large.UniquePositions.Select(i => i + (uint)small.Positions.Count)));
+            merged.UniqueNormals.Should().Equal(small.UniqueNormals.Concat(large.UniqueNormals.Select(i => i + (uint)small.Normals.Count)));
+            merged.Triangles.Should().HaveCount(2);
+            merged.Triangles[0].Should().Equal(small.Triangles[0]);
+            merged.Triangles[1].Should().Equal(large.Triangles[0].Select(i => i + (uint)small.UniquePositions.Count));
+        }
+
+        [TestMethod]
+        public void TransformedFragmentsAreMovedAndTurned()
+        {
+            //a quarter turn about z and a translation, points are row vectors so x goes to y and y to -x
+            var transform = new XbimMatrix3D(0, 1, 0, 0, -1, 0, 0, 0, 0, 0, 1, 0, 10, 20, 30, 1);
+            var first = Strip(2, 0);
+            var second = Strip(3, 4);
+            var merged = Decode(XbimTriangulatedModelStream.Merge(
+                new[] { new XbimTriangulatedModelStream(Encode(first)), new XbimTriangulatedModelStream(Encode(second)) },
+                new XbimMatrix3D?[] { null, transform }).DataStream);
+
+            merged.Positions.Take(first.Positions.Count).Should().Equal(first.Positions);
+            var moved = merged.Positions.Skip(first.Positions.Count).ToList();
+            moved.Should().HaveCount(second.Positions.Count);
+            for (var i = 0; i < moved.Count; i++)
+            {
+                moved[i].X.Should().BeApproximately(10 - second.Positions[i].Y, 1e-5);
+                moved[i].Y.Should().BeApproximately(20 + second.Positions[i].X, 1e-5);
+                moved[i].Z.Should().BeApproximately(30 + second.Positions[i].Z, 1e-5);
+            }
+            var turned = merged.Normals.Skip(first.Normals.Count).ToList();
+            turned.Should().HaveCount(second.Normals.Count);
+            for (var i = 0; i < turned.Count; i++)
+            {
+                turned[i].X.Should().BeApproximately(-second.Normals[i].Y, 1e-6);
+                turned[i].Y.Should().BeApproximately(second.Normals[i].X, 1e-6);
+                turned[i].Z.Should().BeApproximately(second.Normals[i].Z, 1e-6);
+            }
+        }
+
+        [TestMethod]
+        public void MergeStreamMatchesOneMergeOfAllFragments()
+        {
+            var fragments = Enumerable.Range(0, 20).Select(i => Encode(Strip(i + 1, 2 * i))).ToList();
+            Func<XbimTriangulatedModelStream> appendAll = () =>
+            {
+                var stream = new XbimTriangulatedModelStream();
+                foreach (var fragment in fragments)
+                    stream.MergeStream(new XbimTriangulatedModelStream(fragment));
+                stream.MergeStream(new XbimTriangulatedModelStream());
+                return stream;
+            };
+            var expected = XbimTriangulatedModelStream.Merge(fragments.Select(f => new XbimTriangulatedModelStream(f)).ToList());
+
+            var appended = appendAll();
+            appended.IsEmpty.Should().BeFalse();
+            appended.DataStream.ToArray().Should().Equal(expected.DataStream.ToArray());
+            //a stream passed to Merge has its appended streams merged first
+            XbimTriangulatedModelStream.MergedLength(new[] { appendAll() }).Should().Be((int)expected.DataStream.Length);
+            XbimTriangulatedModelStream.Merge(new[] { appendAll() }).DataStream.ToArray().Should().Equal(expected.DataStream.ToArray());
+        }
+    }
+}
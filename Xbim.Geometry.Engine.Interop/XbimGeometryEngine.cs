@@ -13,6 +13,12 @@ namespace Xbim.Geometry.Engine.Interop
     public class XbimGeometryEngine : IXbimGeometryEngine
     {
         private readonly IXbimGeometryEngine _engine;
+        // ReadBrep with the tolerance to give compounds, this is not part of IXbimGeometryEngine
+        private readonly Func<string, double, IXbimGeometryObject> _readBrepWithTolerance;
+        // ClearModelCaches, this is not part of IXbimGeometryEngine
+        private readonly Action<IModel> _clearModelCaches;
+        // LimitTolerance, this is not part of IXbimGeometryEngine
+        private readonly Action<IXbimGeometryObject, double> _limitTolerance;
 
         private readonly ILogger<XbimGeometryEngine> _logger;
 
@@ -56,6 +62,15 @@ namespace Xbim.Geometry.Engine.Interop
                 {
                     throw new Exception("Failed to cast Geometry Engine to IXbimGeometryEngine");
                 }
+                var readBrep = t.GetMethod("ReadBrep", new[] { typeof(string), typeof(double) });
+                if (readBrep != null)
+                    _readBrepWithTolerance = (Func<string, double, IXbimGeometryObject>)Delegate.CreateDelegate(typeof(Func<string, double, IXbimGeometryObject>), obj, readBrep);
+                var clearModelCaches = t.GetMethod("ClearModelCaches", new[] { typeof(IModel) });
+                if (clearModelCaches != null)
+                    _clearModelCaches = (Action<IModel>)Delegate.CreateDelegate(typeof(Action<IModel>), obj, clearModelCaches);
+                var limitTolerance = t.GetMethod("LimitTolerance", new[] { typeof(IXbimGeometryObject), typeof(double) });
+                if (limitTolerance != null)
+                    _limitTolerance = (Action<IXbimGeometryObject, double>)Delegate.CreateDelegate(typeof(Action<IXbimGeometryObject, double>), obj, limitTolerance);
 
                 _logger.LogDebug("XbimGeometryEngine constructed successfully");
             }
@@ -848,6 +863,31 @@ namespace Xbim.Geometry.Engine.Interop
             // no logger is provided so no tracing is started for this function
             return _engine.ReadBrep(filename);
 		}
+
+        /// <summary>
+        /// Reads a brep written by WriteBrep, a compound is given the tolerance, normally the precision of the model it was built for
+        /// </summary>
+        public IXbimGeometryObject ReadBrep(string filename, double tolerance)
+        {
+            return _readBrepWithTolerance != null ? _readBrepWithTolerance(filename, tolerance) : _engine.ReadBrep(filename);
+        }
+
+        /// <summary>
+        /// Forgets everything the engine keeps between calls that was built from the model, call it when the model has been edited or is finished with
+        /// </summary>
+        public void ClearModelCaches(IModel model)
+        {
+            _clearModelCaches?.Invoke(model);
+        }
+
+        /// <summary>
+        /// Raises the tolerances of the geometry that are below the tolerance to it, in place. Boolean operations do this to their
+        /// operands, done once to a shape before it is shared between threads the operations find nothing left to change
+        /// </summary>
+        public void LimitTolerance(IXbimGeometryObject geometryObject, double tolerance)
+        {
+            _limitTolerance?.Invoke(geometryObject, tolerance);
+        }
 	}
 
     public static class LogHelper
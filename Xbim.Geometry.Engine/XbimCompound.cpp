@@ -18,7 +18,6 @@
 #include <TopTools_IndexedMapOfShape.hxx>
 #include <TopExp.hxx>
 #include <BRepPrim_Builder.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepAlgoAPI_Common.hxx>
@@ -35,7 +34,7 @@
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <ShapeFix_Shell.hxx>
-#include <BRepCheck_Analyzer.hxx>
+#include "XbimShapeValidator.h"
 #include <ShapeFix_Edge.hxx>
 #include <ShapeFix_Face.hxx>
 #include <ShapeFix_FixSmallSolid.hxx>
@@ -49,7 +48,6 @@
 #include <BRepBuilderAPI_VertexInspector.hxx>
 #include <BRepAdaptor_CompCurve.hxx>
 #include <ShapeUpgrade_RemoveInternalWires.hxx>
-#include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepMesh_VertexInspector.hxx>
 #include <Geom_BSplineCurve.hxx>
 #include <ShapeAnalysis.hxx>
@@ -58,6 +56,7 @@
 #include <TopTools_DataMapOfShapeInteger.hxx>
 #include <TopTools_DataMapOfShapeInteger.hxx>
 #include <TopTools_DataMapOfShapeListOfInteger.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
 #include <GeomLib_Tool.hxx>
 #include <BRepGProp_Face.hxx>
 #include <TColStd_DataMapOfIntegerListOfInteger.hxx>
@@ -68,6 +67,9 @@
 #include <BRepBuilderAPI_FindPlane.hxx>
 #include <Geom_Plane.hxx>
 #include "XbimNativeApi.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimShapeOrientation.h"
+#include "XbimToleranceNormalizer.h"
 #include <BRepFill_Filling.hxx>
 #include <BRepTools_WireExplorer.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
@@ -157,9 +159,12 @@ namespace Xbim
 
 		IXbimGeometryObject^ XbimCompound::TransformShallow(XbimMatrix3D matrix3D)
 		{
-			TopoDS_Compound shallowCopy = TopoDS::Compound(pCompound->Moved(XbimConvert::ToTransform(matrix3D)));
+			TopoDS_Shape instance;
+			std::string errMsg;
+			if (!XbimNativeApi::InstanceShape(*pCompound, XbimConvert::ToGTransform(matrix3D), instance, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
 			GC::KeepAlive(this);
-			return gcnew XbimCompound(shallowCopy, IsSewn, _sewingTolerance);
+			return gcnew XbimCompound(TopoDS::Compound(instance), IsSewn, _sewingTolerance);
 		}
 
 		XbimRect3D XbimCompound::BoundingBox::get()
@@ -287,9 +292,9 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
 				GC::KeepAlive(this);
-				return gcnew XbimCompound(TopoDS::Compound(tr.Shape()), _isSewn, _sewingTolerance);
+				return gcnew XbimCompound(TopoDS::Compound(transformed), _isSewn, _sewingTolerance);
 			}
 			else
 			{
@@ -484,9 +489,7 @@ namespace Xbim
 						b.Add(solid, shell);
 						if (BRep_Tool::IsClosed(shell))
 						{
-							BRepClass3d_SolidClassifier class3d(solid);
-							class3d.PerformInfinitePoint(Precision::Confusion());
-							if (class3d.State() == TopAbs_IN) solid.Reverse();
+							if (XbimShapeOrientation::IsInsideOut(solid)) solid.Reverse();
 						}
 
 						b.Add(*pCompound, solid);
@@ -623,9 +626,7 @@ namespace Xbim
 					if (solidmaker.IsDone())
 					{
 						TopoDS_Solid s = solidmaker.Solid();
-						BRepClass3d_SolidClassifier class3d(s);
-						class3d.PerformInfinitePoint(Precision::Confusion());
-						if (class3d.State() == TopAbs_IN) s.Reverse();
+						if (XbimShapeOrientation::IsInsideOut(s)) s.Reverse();
 						b.Add(*pCompound, s);
 					}
 				}
@@ -711,7 +712,6 @@ namespace Xbim
 				IIfcFace^ aFace = Enumerable::FirstOrDefault(faces);
 				if (aFace == nullptr) return shell;
 				IModel^ model = aFace->Model;
-				ShapeFix_ShapeTolerance FTol;
 
 				_sewingTolerance = model->ModelFactors->Precision;
 
@@ -905,9 +905,7 @@ namespace Xbim
 							if (wireFixer.FixReorder())
 								loopWire = wireFixer.Wire();
 							loopWire.Closed(true);
-							BRepCheck_Analyzer analyser(loopWire, Standard_True);
-
-							if (!analyser.IsValid())
+							if (!XbimShapeValidator::IsValid(loopWire))
 							{
 								ShapeFix_Wire sfw(loopWire, topoAdvancedFace, _sewingTolerance);
 								if (sfw.Perform())
@@ -973,8 +971,7 @@ namespace Xbim
 								topoOuterLoop = wf.Wire();
 							}
 							faceMaker.Add(topoOuterLoop);
-							BRepCheck_Analyzer analyser(faceMaker.Face(), Standard_True);
-							buildFromLoop = !analyser.IsValid();
+							buildFromLoop = !XbimShapeValidator::IsValid(faceMaker.Face());
 						}
 						if (buildFromLoop)
 						{
@@ -1084,8 +1081,7 @@ namespace Xbim
 					try
 					{
 
-						BRepCheck_Analyzer analyser(topoAdvancedFace, Standard_False);
-						if (!analyser.IsValid())
+						if (!XbimShapeValidator::IsValid(topoAdvancedFace, false))
 						{
 							ShapeFix_Shape sfs(topoAdvancedFace);
 							if (sfs.Perform())
@@ -1327,13 +1323,38 @@ namespace Xbim
 			builder.MakeCompound(*pCompound);
 			if (faceCount < MaxFacesToSew)
 			{
-				ShapeUpgrade_UnifySameDomain unifier(shell);
-				unifier.SetAngularTolerance(0.00174533); //1 tenth of a degree
-				unifier.SetLinearTolerance(_sewingTolerance);
+				double angularTolerance = 0.00174533; //1 tenth of a degree
+				//only triangles with a coplanar neighbour can be merged, the rest of the shell is passed through
+				TopTools_MapOfShape coplanarFaces;
+				TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+				TopExp::MapShapesAndAncestors(shell, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+				for (int i = 1; i <= edgeFaces.Extent(); i++)
+				{
+					const TopTools_ListOfShape& faces = edgeFaces(i);
+					if (faces.Extent() != 2) continue;
+					Handle(Geom_Plane) plane1 = Handle(Geom_Plane)::DownCast(BRep_Tool::Surface(TopoDS::Face(faces.First())));
+					Handle(Geom_Plane) plane2 = Handle(Geom_Plane)::DownCast(BRep_Tool::Surface(TopoDS::Face(faces.Last())));
+					if (plane1.IsNull() || plane2.IsNull()) continue;
+					gp_Pln pln1 = plane1->Pln();
+					gp_Pln pln2 = plane2->Pln();
+					if (pln1.Axis().IsParallel(pln2.Axis(), angularTolerance) && pln1.Distance(pln2.Location()) <= _sewingTolerance)
+					{
+						coplanarFaces.Add(faces.First());
+						coplanarFaces.Add(faces.Last());
+					}
+				}
 				try
 				{
-					unifier.Build();
-					builder.Add(*pCompound, unifier.Shape());
+					TopoDS_Shape unified = shell;
+					if (!coplanarFaces.IsEmpty() && !UnifyChangedFaces(unified, coplanarFaces, _sewingTolerance, angularTolerance))
+					{
+						ShapeUpgrade_UnifySameDomain unifier(shell);
+						unifier.SetAngularTolerance(angularTolerance);
+						unifier.SetLinearTolerance(_sewingTolerance);
+						unifier.Build();
+						unified = unifier.Shape();
+					}
+					builder.Add(*pCompound, unified);
 				}
 				catch (...)
 				{
@@ -1805,11 +1826,10 @@ namespace Xbim
 				HashSet<XbimSolid^>^ connected = gcnew HashSet<XbimSolid^>();
 				XbimCompound::GetConnected(connected, clustersSparse, clusterAround);
 
-				ShapeFix_ShapeTolerance fixTol;
 				TopoDS_Shape unionedShape;
 				for each (XbimSolid ^ toConnect in connected) //join up the connected
 				{
-					fixTol.SetTolerance(toConnect, tolerance);
+					XbimToleranceNormalizer::Set(toConnect, tolerance);
 					if (unionedShape.IsNull()) unionedShape = toConnect;
 					else
 					{
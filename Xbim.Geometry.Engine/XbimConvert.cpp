@@ -434,6 +434,16 @@ namespace Xbim
 			return trsf;
 		}
 
+		gp_GTrsf XbimConvert::ToGTransform(XbimMatrix3D m3D)
+		{
+			gp_GTrsf trsf;
+			trsf.SetVectorialPart(gp_Mat(m3D.M11, m3D.M21, m3D.M31,
+										 m3D.M12, m3D.M22, m3D.M32,
+										 m3D.M13, m3D.M23, m3D.M33));
+			trsf.SetTranslationPart(gp_XYZ(m3D.OffsetX, m3D.OffsetY, m3D.OffsetZ));
+			return trsf;
+		}
+
 		XbimMatrix3D XbimConvert::ToMatrix3D(const TopLoc_Location& location)
 		{
 			const gp_Trsf& trsf = location.Transformation();
@@ -46,6 +46,8 @@ namespace Xbim
 			static gp_Trsf ToTransform(IIfcCartesianTransformationOperator2D^ ct2D);
 			// Converts an Matrix3D into a gp_GTrsf
 			static gp_Trsf ToTransform(XbimMatrix3D m3D);
+			// Converts an Matrix3D into a gp_GTrsf, the matrix may scale non uniformly
+			static gp_GTrsf ToGTransform(XbimMatrix3D m3D);
 			// Converts an Axis2Placement3D to a Plane
 			static gp_Pln ToPlane(IIfcAxis2Placement3D^ axis3D);
 			//converts an Axis2Placement2D into a Transform matrix
@@ -20,7 +20,6 @@
 #include <BndLib_Add3dCurve.hxx>
 #include <Bnd_Box.hxx>
 #include <Extrema_ExtPC.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <GeomConvert_CompCurveToBSplineCurve.hxx>
 #include <GCPnts_AbscissaPoint.hxx>
 #include <GC_MakeArcOfCircle.hxx>
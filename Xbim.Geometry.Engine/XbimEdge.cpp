@@ -7,6 +7,8 @@
 #include "XbimConvert.h"
 #include "XbimWire.h"
 #include "XbimFace.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimToleranceNormalizer.h"
 #include <BRepBuilderAPI_Transform.hxx> 
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <TopExp_Explorer.hxx>
@@ -20,7 +22,6 @@
 #include <GC_MakeCircle.hxx>
 #include <gp_Elips.hxx>
 #include <GC_MakeEllipse.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <BRep_Tool.hxx>
 #include <GProp_GProps.hxx>
 #include <BRepGProp.hxx>
@@ -179,7 +180,6 @@ namespace Xbim
 			double edgeTol = BRep_Tool::Tolerance(edgeCurve);
 			tolerance = Math::Max(tolerance, edgeTol);
 			//double currentTolerance = tolerance;
-			ShapeFix_ShapeTolerance FTol;
 			gp_Pnt startPnt = BRep_Tool::Pnt(start);
 			gp_Pnt endPnt = BRep_Tool::Pnt(end);
 
@@ -231,7 +231,7 @@ namespace Xbim
 					}
 				}
 			}
-			FTol.LimitTolerance(*pEdge, tolerance);
+			XbimToleranceNormalizer::Limit(*pEdge, tolerance);
 		}
 
 		XbimEdge::XbimEdge(IIfcCurve^ edgeCurve, XbimVertex^ start, XbimVertex^ end, ILogger^ logger)
@@ -245,7 +245,6 @@ namespace Xbim
 				Standard_Real p1, p2;
 				Handle(Geom_Curve)  curve = BRep_Tool::Curve(this, p1, p2);
 				curve = BRep_Tool::Curve(this, p1, p2);
-				ShapeFix_ShapeTolerance FTol;
 
 			TryMakeEdge:
 				BRepBuilderAPI_MakeEdge edgeMaker(curve, start, end);
@@ -257,8 +256,8 @@ namespace Xbim
 					currentTolerance *= 10;
 					if (currentTolerance <= toleranceMax)
 					{
-						FTol.LimitTolerance(start, currentTolerance);
-						FTol.LimitTolerance(end, currentTolerance);
+						XbimToleranceNormalizer::Limit(start, currentTolerance);
+						XbimToleranceNormalizer::Limit(end, currentTolerance);
 						goto TryMakeEdge;
 					}
 				}
@@ -272,7 +271,7 @@ namespace Xbim
 				{
 					*pEdge = edgeMaker.Edge();
 				}
-				FTol.LimitTolerance(*pEdge, tolerance);
+				XbimToleranceNormalizer::Limit(*pEdge, tolerance);
 			}
 		}
 
@@ -838,8 +837,8 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
-				return gcnew XbimEdge(TopoDS::Edge(tr.Shape()), Tag);
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
+				return gcnew XbimEdge(TopoDS::Edge(transformed), Tag);
 			}
 			else
 			{
@@ -996,8 +995,7 @@ namespace Xbim
 				}
 				pEdge = new TopoDS_Edge();
 				*pEdge = edgeMaker.Edge();
-				ShapeFix_ShapeTolerance FTol;
-				FTol.LimitTolerance(*pEdge, curve->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pEdge, curve->Model->ModelFactors->Precision);
 			}
 		}
 
@@ -5,8 +5,10 @@
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <BRepTools_WireExplorer.hxx>
 #include <BRepBuilderAPI_MakeWire.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
-#include <BRepCheck_Analyzer.hxx>
+#include "XbimShapeValidator.h"
+#include "XbimNativeApi.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimToleranceNormalizer.h"
 #include "XbimGeometryCreator.h"
 #include "XbimConvert.h" 
 #include <TopExp_Explorer.hxx>
@@ -16,7 +18,6 @@
 #include <TopoDS.hxx>
 #include <GProp_GProps.hxx>
 #include <BRepGProp.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <BRepGProp_Face.hxx>
 #include <gp_Circ.hxx>
 #include <GC_MakeCircle.hxx>
@@ -193,7 +194,7 @@ namespace Xbim
 
 		XbimFace::XbimFace(IIfcProfileDef^ profile, ILogger^ logger)
 		{
-			Init(profile, logger);
+			InitShared(profile, logger);
 		}
 
 
@@ -286,8 +287,7 @@ namespace Xbim
 				{
 					faceMaker.Add(inner);
 				}
-				BRepCheck_Analyzer analyser(faceMaker.Face(), Standard_False);
-				if (!analyser.IsValid())
+				if (!XbimShapeValidator::IsValid(faceMaker.Face(), false))
 				{
 					ShapeFix_Face sfs(faceMaker.Face());
 					sfs.Perform();
@@ -538,12 +538,6 @@ namespace Xbim
 			}
 			//check orientation
 			if (!surface->SameSense) Reverse();
-			BRepCheck_Analyzer analyser(this, Standard_True);
-
-			if (!analyser.IsValid())
-			{
-				analyser.IsValid();
-			}
 			ShapeFix_Face faceFixer(*pFace);
 			if (faceFixer.Perform())
 				*pFace = faceFixer.Face();
@@ -658,8 +652,7 @@ namespace Xbim
 				TopoDS_Face theFace = BRepBuilderAPI_MakeFace(thePlane, theWire, false);
 
 				//limit the tolerances for the vertices and edges
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(theWire, tolerance); //set all tolerances
+				XbimToleranceNormalizer::Limit(theWire, tolerance); //set all tolerances
 				//adjust vertex tolerances for bad planar fit if we have anything more than a triangle (which will alway fit a plane)
 
 				if (pointSeq.Length() > 3)
@@ -721,7 +714,7 @@ namespace Xbim
 				gp_Pln plane(gp_Pnt(pointOnFace.X, pointOnFace.Y, pointOnFace.Z), gp_Dir(faceNormal.X, faceNormal.Y, faceNormal.Z));
 				BRepBuilderAPI_MakeFace faceMaker(plane, wire, Standard_False);
 				TopoDS_Face resultFace = faceMaker.Face();
-				if (BRepCheck_Analyzer(resultFace, Standard_True).IsValid() == Standard_False)
+				if (!XbimShapeValidator::IsValid(resultFace))
 				{
 					ShapeFix_Face faceFixer(faceMaker.Face());
 					faceFixer.Perform();
@@ -784,7 +777,6 @@ namespace Xbim
 			double tolerance = ifcFace->Model->ModelFactors->Precision;
 			double angularTolerance = 0.00174533; //1 tenth of a degree
 			double outerLoopArea = 0;
-			ShapeFix_ShapeTolerance tolFixer;
 			TopoDS_Face theFace;
 			TopoDS_ListOfShape innerBounds;
 			for each (IIfcFaceBound ^ bound in ifcFace->Bounds)
@@ -888,7 +880,7 @@ namespace Xbim
 					gp_Pnt centre = GProp_PGProps::Barycentre(pointArray);
 					gp_Pln thePlane(centre, normal);
 					TopoDS_Wire theWire = polyMaker.Wire();
-					tolFixer.LimitTolerance(theWire, tolerance); //set all tolerances
+					XbimToleranceNormalizer::Limit(theWire, tolerance); //set all tolerances
 
 					TopoDS_Face aFace = BRepBuilderAPI_MakeFace(thePlane, theWire, false);
 					//need to check for self intersecting edges to comply with Ifc rules
@@ -977,7 +969,7 @@ namespace Xbim
 				theFace = faceMaker.Face();
 				//limit the tolerances for the vertices and edges
 
-				tolFixer.LimitTolerance(theFace, tolerance); //set all tolerances
+				XbimToleranceNormalizer::Limit(theFace, tolerance); //set all tolerances
 				//adjust vertex tolerances for bad planar fit if we have anything more than a triangle (which will alway fit a plane)
 
 
@@ -998,7 +990,7 @@ namespace Xbim
 			}
 			else
 			{
-				tolFixer.LimitTolerance(theFace, tolerance); //set all tolerances
+				XbimToleranceNormalizer::Limit(theFace, tolerance); //set all tolerances
 			}
 			pFace = new TopoDS_Face();
 			*pFace = theFace;
@@ -1023,6 +1015,138 @@ namespace Xbim
 			*pFace = faceMaker.Face();
 		}
 
+		//The faces of profiles are cached for each model by profile label and, for parameterised profiles, by the values of
+		//their parameters, as exporters often write the same section as thousands of identical profile definitions.
+		//Faces that fail to build are not cached so each user builds them again and logs the warnings to its own logger
+		ref class XbimFace::ProfileFaceBuilder
+		{
+		private:
+			IIfcProfileDef^ profile;
+			ILogger^ logger;
+		public:
+			ProfileFaceBuilder(IIfcProfileDef^ profile, ILogger^ logger) : profile(profile), logger(logger) {};
+			XbimFace^ Build()
+			{
+				XbimFace^ face = gcnew XbimFace();
+				face->Init(profile, logger);
+				return face;
+			}
+		};
+
+		XbimFace::ProfileFaceCache^ XbimFace::CreateProfileFaceCache(Xbim::Common::IModel^ /*model*/)
+		{
+			return gcnew ProfileFaceCache();
+		}
+
+		void XbimFace::ClearProfileFaceCache(Xbim::Common::IModel^ model)
+		{
+			if (model != nullptr)
+				profileFaceCaches->Remove(model);
+		}
+
+		void XbimFace::InitShared(IIfcProfileDef^ profile, ILogger^ logger)
+		{
+			ProfileFaceCache^ cache = profileFaceCaches->GetValue(profile->Model,
+				gcnew ConditionalWeakTable<Xbim::Common::IModel^, ProfileFaceCache^>::CreateValueCallback(&XbimFace::CreateProfileFaceCache));
+			Lazy<XbimFace^>^ shared;
+			String^ key = nullptr;
+			if (!cache->ByLabel->TryGetValue(profile->EntityLabel, shared))
+			{
+				ProfileFaceBuilder^ builder = gcnew ProfileFaceBuilder(profile, logger);
+				shared = gcnew Lazy<XbimFace^>(gcnew Func<XbimFace^>(builder, &ProfileFaceBuilder::Build), System::Threading::LazyThreadSafetyMode::ExecutionAndPublication);
+				key = ProfileParameterKey(profile);
+				if (key != nullptr)
+					shared = cache->ByParameters->GetOrAdd(key, shared);
+				shared = cache->ByLabel->GetOrAdd(profile->EntityLabel, shared);
+			}
+			XbimFace^ face;
+			try
+			{
+				face = shared->Value;
+			}
+			catch (Exception^)
+			{
+				//a Lazy keeps its exception, it is dropped so the next user builds the face again
+				ForgetProfileFace(cache, profile, key);
+				throw;
+			}
+			if (!face->IsValid)
+			{
+				ForgetProfileFace(cache, profile, key);
+				return;
+			}
+			//the cached face is only read, each user gets its own topology so fixing the tolerances of a solid built
+			//from it cannot change the cached face, the curves and surface are shared
+			BRepBuilderAPI_Copy copier(face, Standard_False);
+			pFace = new TopoDS_Face();
+			*pFace = TopoDS::Face(copier.Shape());
+		}
+
+		void XbimFace::ForgetProfileFace(ProfileFaceCache^ cache, IIfcProfileDef^ profile, String^ key)
+		{
+			Lazy<XbimFace^>^ removed;
+			cache->ByLabel->TryRemove(profile->EntityLabel, removed);
+			if (key == nullptr)
+				key = ProfileParameterKey(profile);
+			if (key != nullptr)
+				cache->ByParameters->TryRemove(key, removed);
+		}
+
+		//returns null if the profile is not parameterised, the name and type of the profile do not change its face
+		String^ XbimFace::ProfileParameterKey(IIfcProfileDef^ profile)
+		{
+			if (!dynamic_cast<IIfcParameterizedProfileDef^>(profile))
+				return nullptr;
+			System::Text::StringBuilder^ key = gcnew System::Text::StringBuilder(profile->ExpressType->ExpressName);
+			for each (Xbim::Common::Metadata::ExpressMetaProperty^ property in profile->ExpressType->Properties->Values)
+			{
+				if (property->Name == "ProfileName" || property->Name == "ProfileType")
+					continue;
+				key->Append('|');
+				AppendParameter(key, property->PropertyInfo->GetValue(profile, nullptr));
+			}
+			return key->ToString();
+		}
+
+		void XbimFace::AppendParameter(System::Text::StringBuilder^ key, Object^ value)
+		{
+			if (value == nullptr)
+			{
+				key->Append('$');
+				return;
+			}
+			Xbim::Common::IPersistEntity^ entity = dynamic_cast<Xbim::Common::IPersistEntity^>(value);
+			if (entity != nullptr) //the position of the profile
+			{
+				key->Append(entity->ExpressType->ExpressName)->Append('(');
+				for each (Xbim::Common::Metadata::ExpressMetaProperty^ property in entity->ExpressType->Properties->Values)
+				{
+					AppendParameter(key, property->PropertyInfo->GetValue(entity, nullptr));
+					key->Append(',');
+				}
+				key->Append(')');
+				return;
+			}
+			Xbim::Common::IExpressValueType^ expressValue = dynamic_cast<Xbim::Common::IExpressValueType^>(value);
+			if (expressValue != nullptr)
+				return AppendParameter(key, expressValue->Value);
+			if (dynamic_cast<String^>(value) == nullptr && dynamic_cast<System::Collections::IEnumerable^>(value) != nullptr)
+			{
+				key->Append('(');
+				for each (Object^ item in (System::Collections::IEnumerable^)value)
+				{
+					AppendParameter(key, item);
+					key->Append(',');
+				}
+				key->Append(')');
+				return;
+			}
+			if (dynamic_cast<Double^>(value) != nullptr)
+				key->Append(safe_cast<double>(value).ToString("R", System::Globalization::CultureInfo::InvariantCulture));
+			else
+				key->Append(Convert::ToString(value, System::Globalization::CultureInfo::InvariantCulture));
+		}
+
 		void XbimFace::Init(IIfcProfileDef^ profile, ILogger^ logger)
 		{
 			IIfcArbitraryProfileDefWithVoids^ arbProfDefVoids = dynamic_cast<IIfcArbitraryProfileDefWithVoids^>(profile);
@@ -1118,8 +1242,7 @@ namespace Xbim
 							const TopoDS_Edge edge = TopoDS::Edge(map(i));
 							ef.FixVertexTolerance(edge, *pFace);
 						}
-						ShapeFix_ShapeTolerance fTol;
-						fTol.LimitTolerance(*pFace, tolerance);
+						XbimToleranceNormalizer::Limit(*pFace, tolerance);
 					}
 				}
 
@@ -1160,7 +1283,6 @@ namespace Xbim
 			//Z must be up
 			double tolerance = profile->Model->ModelFactors->Precision;
 			double toleranceMax = profile->Model->ModelFactors->PrecisionMax;
-			ShapeFix_ShapeTolerance FTol;
 			TopoDS_Face face;
 			XbimWire^ loop = gcnew XbimWire(profile->OuterCurve, logger, XbimConstraints::Closed | XbimConstraints::NotSelfIntersecting);
 			if (loop->IsValid)
@@ -1191,7 +1313,7 @@ namespace Xbim
 					currentFaceTolerance *= 10;
 					if (currentFaceTolerance <= toleranceMax)
 					{
-						FTol.SetTolerance(loop, currentFaceTolerance, TopAbs_WIRE);
+						XbimToleranceNormalizer::Set(loop, currentFaceTolerance, TopAbs_WIRE);
 						goto TryBuildFace;
 					}
 					String^ errMsg = XbimFace::GetBuildFaceErrorMessage(err);
@@ -1239,7 +1361,7 @@ namespace Xbim
 						TryBuildLoop:
 							faceMaker.Add(innerWire);
 							//check the face is ok
-							if (BRepCheck_Analyzer(faceMaker.Face(), Standard_True).IsValid() == Standard_False)
+							if (!XbimShapeValidator::IsValid(faceMaker.Face()))
 							{
 								XbimGeometryCreator::LogWarning(logger, profile, "Invalid void. Inner bound ignored", curve->EntityLabel);
 								continue;
@@ -1250,7 +1372,7 @@ namespace Xbim
 								currentloopTolerance *= 10; //try courser tolerance
 								if (currentloopTolerance <= toleranceMax)
 								{
-									FTol.SetTolerance(innerWire, currentloopTolerance, TopAbs_WIRE);
+									XbimToleranceNormalizer::Set(innerWire, currentloopTolerance, TopAbs_WIRE);
 									goto TryBuildLoop;
 								}
 
@@ -1459,8 +1581,7 @@ namespace Xbim
 				//apply the position transformation
 				if (rectProfile->Position != nullptr)
 					pFace->Move(XbimConvert::ToLocation(rectProfile->Position));
-				ShapeFix_ShapeTolerance fTol;
-				fTol.LimitTolerance(*pFace, rectProfile->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pFace, rectProfile->Model->ModelFactors->Precision);
 			}
 
 		}
@@ -1652,8 +1773,7 @@ namespace Xbim
 			BRepBuilderAPI_MakeFace  builder(pln);
 			pFace = new TopoDS_Face();
 			*pFace = builder.Face();
-			ShapeFix_ShapeTolerance fTol;
-			fTol.LimitTolerance(*pFace, plane->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pFace, plane->Model->ModelFactors->Precision);
 		}
 		void XbimFace::Init(IIfcSurfaceOfRevolution^ sRev, ILogger^ logger)
 		{
@@ -2000,9 +2120,12 @@ namespace Xbim
 
 		IXbimGeometryObject^ XbimFace::TransformShallow(XbimMatrix3D matrix3D)
 		{
-			TopoDS_Face face = TopoDS::Face(pFace->Moved(XbimConvert::ToTransform(matrix3D)));
+			TopoDS_Shape instance;
+			std::string errMsg;
+			if (!XbimNativeApi::InstanceShape(*pFace, XbimConvert::ToGTransform(matrix3D), instance, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
 			GC::KeepAlive(this);
-			return gcnew XbimFace(face);
+			return gcnew XbimFace(TopoDS::Face(instance));
 		}
 
 		bool XbimFace::IsQuadOrTriangle::get()
@@ -2254,9 +2377,9 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
 				GC::KeepAlive(this);
-				return gcnew XbimFace(TopoDS::Face(tr.Shape()), Tag);
+				return gcnew XbimFace(TopoDS::Face(transformed), Tag);
 			}
 			else
 			{
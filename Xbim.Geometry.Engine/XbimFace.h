@@ -9,6 +9,8 @@
 #include <TopTools_DataMapOfIntegerShape.hxx>
 #include <vector>
 using namespace System::Collections::Generic;
+using namespace System::Collections::Concurrent;
+using namespace System::Runtime::CompilerServices;
 using namespace Xbim::Ifc4::Interfaces;
 using namespace Xbim::Common::Geometry;
 namespace Xbim
@@ -27,7 +29,22 @@ namespace Xbim
 			}
 			void InstanceCleanup();
 
+			//faces built from profiles, shared by all threads building geometry for the same model until ClearProfileFaceCache is called
+			ref class ProfileFaceCache
+			{
+			public:
+				ConcurrentDictionary<int, Lazy<XbimFace^>^>^ ByLabel = gcnew ConcurrentDictionary<int, Lazy<XbimFace^>^>();
+				ConcurrentDictionary<String^, Lazy<XbimFace^>^>^ ByParameters = gcnew ConcurrentDictionary<String^, Lazy<XbimFace^>^>();
+			};
+			ref class ProfileFaceBuilder;
+			static ConditionalWeakTable<Xbim::Common::IModel^, ProfileFaceCache^>^ profileFaceCaches = gcnew ConditionalWeakTable<Xbim::Common::IModel^, ProfileFaceCache^>();
+			static ProfileFaceCache^ CreateProfileFaceCache(Xbim::Common::IModel^ model);
+			static String^ ProfileParameterKey(IIfcProfileDef^ profile);
+			static void ForgetProfileFace(ProfileFaceCache^ cache, IIfcProfileDef^ profile, String^ key);
+			static void AppendParameter(System::Text::StringBuilder^ key, Object^ value);
+
 			//initialisers
+			void InitShared(IIfcProfileDef^ profile, ILogger^ logger);
 			void Init(IIfcProfileDef^ profile, ILogger^ logger);
 			void Init(IIfcArbitraryProfileDefWithVoids^ profile, ILogger^ logger);
 			void Init(IIfcCircleHollowProfileDef ^ circProfile, ILogger^ logger);
@@ -65,6 +82,8 @@ namespace Xbim
 
 			//error logging
 			static String^ GetBuildFaceErrorMessage(BRepBuilderAPI_FaceError err);
+			//forgets the profile faces built for the model, called when its geometry is to be built again as the model may have been edited
+			static void ClearProfileFaceCache(Xbim::Common::IModel^ model);
 
 #pragma region operators
 			
@@ -33,7 +33,10 @@
 #include <IntAna2d_AnaIntersection.hxx>
 #include <GeomLib.hxx>
 #include "XbimMesh.h"
+#include "XbimNativeApi.h"
+#include "XbimToleranceNormalizer.h"
 using System::Runtime::InteropServices::Marshal;
+using namespace System::IO::MemoryMappedFiles;
 
 using namespace  System::Threading;
 using namespace  System::Linq;
@@ -101,16 +104,61 @@ namespace Xbim
 
 		void XbimGeometryCreator::WriteBrep(String^ filename, IXbimGeometryObject^ geomObj)
 		{
-			throw gcnew System::NotImplementedException();
-			// TODO: This is stubbed out until we merge the implementation from unpushed code.
-			// temp fix for broken build
+			array<Byte>^ brepData = ToBinaryBrep(geomObj);
+			if (brepData == nullptr)
+				throw gcnew ArgumentException("Geometry object cannot be written as a brep", "geomObj");
+			File::WriteAllBytes(filename, brepData);
 		}
 
 		IXbimGeometryObject^ XbimGeometryCreator::ReadBrep(String^ filename)
 		{
-			throw gcnew System::NotImplementedException();
-			// TODO: This is stubbed out until we merge the implementation from unpushed code.
-			// temp fix for broken build
+			return ReadBrep(filename, DefaultBrepTolerance);
+		}
+
+		void XbimGeometryCreator::ClearModelCaches(Xbim::Common::IModel^ model)
+		{
+			XbimFace::ClearProfileFaceCache(model);
+		}
+
+		void XbimGeometryCreator::LimitTolerance(IXbimGeometryObject^ geometryObject, double tolerance)
+		{
+			XbimToleranceNormalizer::Limit(ToShape(geometryObject), tolerance);
+		}
+
+		//the file is mapped in to memory and the shape is read straight from the mapped view
+		IXbimGeometryObject^ XbimGeometryCreator::ReadBrep(String^ filename, double tolerance)
+		{
+			FileInfo^ fileInfo = gcnew FileInfo(filename);
+			if (!fileInfo->Exists)
+				throw gcnew FileNotFoundException("Brep file not found", filename);
+			if (fileInfo->Length == 0)
+				return nullptr;
+			MemoryMappedFile^ mappedFile = MemoryMappedFile::CreateFromFile(filename, FileMode::Open, nullptr, 0, MemoryMappedFileAccess::Read);
+			try
+			{
+				MemoryMappedViewAccessor^ view = mappedFile->CreateViewAccessor(0, 0, MemoryMappedFileAccess::Read);
+				try
+				{
+					unsigned char* pointer = nullptr;
+					view->SafeMemoryMappedViewHandle->AcquirePointer(pointer);
+					try
+					{
+						return ReadBinaryBrep((const char*)(pointer + view->PointerOffset), (size_t)fileInfo->Length, tolerance);
+					}
+					finally
+					{
+						view->SafeMemoryMappedViewHandle->ReleasePointer();
+					}
+				}
+				finally
+				{
+					delete view;
+				}
+			}
+			finally
+			{
+				delete mappedFile;
+			}
 		}
 
 		void XbimGeometryCreator::LogError(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
@@ -1321,25 +1369,7 @@ namespace Xbim
 			{
 				std::istringstream iss(cStr);
 				BRepTools::Read(result, iss, builder);
-				switch (result.ShapeType())
-				{
-				case TopAbs_VERTEX:
-					return gcnew XbimVertex(TopoDS::Vertex(result));
-				case TopAbs_EDGE:
-					return gcnew XbimEdge(TopoDS::Edge(result));
-				case TopAbs_WIRE:
-					return gcnew XbimWire(TopoDS::Wire(result));
-				case TopAbs_FACE:
-					return gcnew XbimFace(TopoDS::Face(result));
-				case TopAbs_SHELL:
-					return gcnew XbimShell(TopoDS::Shell(result));
-				case TopAbs_SOLID:
-					return gcnew XbimSolid(TopoDS::Solid(result));
-				case TopAbs_COMPOUND:
-					return gcnew XbimCompound(TopoDS::Compound(result), true, 1e-5);
-				default:
-					return nullptr;
-				}
+				return FromShape(result, DefaultBrepTolerance);
 			}
 			catch (...)
 			{
@@ -1351,6 +1381,85 @@ namespace Xbim
 			}
 		}
 
+		IXbimGeometryObject^ XbimGeometryCreator::FromBrep(array<Byte>^ brepData)
+		{
+			if (brepData == nullptr || brepData->Length == 0)
+				return nullptr;
+			pin_ptr<Byte> pinned = &brepData[0];
+			return ReadBinaryBrep((const char*)pinned, brepData->Length, DefaultBrepTolerance);
+		}
+
+		array<Byte>^ XbimGeometryCreator::ToBinaryBrep(IXbimGeometryObject^ geometryObject)
+		{
+			TopoDS_Shape shape = ToShape(geometryObject);
+			if (shape.IsNull())
+				return nullptr;
+			std::ostringstream oss(std::ios::out | std::ios::binary);
+			std::string errMsg;
+			if (!XbimNativeApi::WriteBinaryBrep(shape, oss, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
+			const std::string& data = oss.str();
+			array<Byte>^ brepData = gcnew array<Byte>((int)data.size());
+			if (brepData->Length > 0)
+				Marshal::Copy(IntPtr((void*)data.data()), brepData, 0, brepData->Length);
+			return brepData;
+		}
+
+		TopoDS_Shape XbimGeometryCreator::ToShape(IXbimGeometryObject^ geometryObject)
+		{
+			XbimOccShape^ occShape = dynamic_cast<XbimOccShape^>(geometryObject);
+			if (occShape != nullptr)
+				return occShape->IsValid ? (const TopoDS_Shape&)occShape : TopoDS_Shape();
+			IEnumerable<IXbimGeometryObject^>^ geomSet = dynamic_cast<IEnumerable<IXbimGeometryObject^>^>(geometryObject);
+			if (geomSet == nullptr)
+				return TopoDS_Shape();
+			//sets, including solid sets, are written as a compound
+			BRep_Builder builder;
+			TopoDS_Compound compound;
+			builder.MakeCompound(compound);
+			for each (IXbimGeometryObject^ geom in geomSet)
+			{
+				TopoDS_Shape shape = ToShape(geom);
+				if (!shape.IsNull())
+					builder.Add(compound, shape);
+			}
+			return compound;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::FromShape(const TopoDS_Shape& shape, double tolerance)
+		{
+			if (shape.IsNull())
+				return nullptr;
+			switch (shape.ShapeType())
+			{
+			case TopAbs_VERTEX:
+				return gcnew XbimVertex(TopoDS::Vertex(shape));
+			case TopAbs_EDGE:
+				return gcnew XbimEdge(TopoDS::Edge(shape));
+			case TopAbs_WIRE:
+				return gcnew XbimWire(TopoDS::Wire(shape));
+			case TopAbs_FACE:
+				return gcnew XbimFace(TopoDS::Face(shape));
+			case TopAbs_SHELL:
+				return gcnew XbimShell(TopoDS::Shell(shape));
+			case TopAbs_SOLID:
+				return gcnew XbimSolid(TopoDS::Solid(shape));
+			case TopAbs_COMPOUND:
+				return gcnew XbimCompound(TopoDS::Compound(shape), true, tolerance);
+			default:
+				return nullptr;
+			}
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::ReadBinaryBrep(const char* data, size_t length, double tolerance)
+		{
+			TopoDS_Shape shape;
+			std::string errMsg;
+			if (!XbimNativeApi::ReadBinaryBrep(data, length, shape, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
+			return FromShape(shape, tolerance);
+		}
+
 
 
 		String^ XbimGeometryCreator::ToBrep(IXbimGeometryObject^ geometryObject)
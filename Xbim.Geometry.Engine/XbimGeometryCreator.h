@@ -2,6 +2,8 @@
 #include "XbimVertex.h"
 #include "XbimVertex.h"
 #include "XbimEdge.h"
+#include "XbimShapeValidator.h"
+#include "XbimMeshingPolicy.h"
 using namespace System;
 using namespace System::IO;
 using namespace Xbim::Common;
@@ -66,6 +68,29 @@ namespace Xbim
 				if (!bool::TryParse(ignoreIfcSweptDiskSolidParamsString, IgnoreIfcSweptDiskSolidParams))
 					IgnoreIfcSweptDiskSolidParams = false;
 
+				//Topological, Sampled (default) or Full
+				String^ shapeValidationString = ConfigurationManager::AppSettings["ShapeValidation"];
+				if (String::Equals(shapeValidationString, "Topological", StringComparison::OrdinalIgnoreCase))
+					XbimShapeValidator::Level = XbimValidationTopological;
+				else if (String::Equals(shapeValidationString, "Full", StringComparison::OrdinalIgnoreCase))
+					XbimShapeValidator::Level = XbimValidationFull;
+				else
+					XbimShapeValidator::Level = XbimValidationSampled;
+
+				//adapts the deflections given for meshing to the size and curvature of each shape, off by default
+				String^ adaptiveMeshingString = ConfigurationManager::AppSettings["AdaptiveMeshing"];
+				bool adaptiveMeshing;
+				if (bool::TryParse(adaptiveMeshingString, adaptiveMeshing))
+					XbimMeshingPolicy::Adaptive = adaptiveMeshing;
+				double relativeDeflection;
+				if (double::TryParse(ConfigurationManager::AppSettings["AdaptiveMeshingRelativeDeflection"], relativeDeflection) && relativeDeflection >= 0)
+					XbimMeshingPolicy::RelativeDeflection = relativeDeflection;
+				double maxDeflectionFactor;
+				if (double::TryParse(ConfigurationManager::AppSettings["AdaptiveMeshingMaxDeflectionFactor"], maxDeflectionFactor) && maxDeflectionFactor >= 1)
+					XbimMeshingPolicy::MaxDeflectionFactor = maxDeflectionFactor;
+				double maxAngle;
+				if (double::TryParse(ConfigurationManager::AppSettings["AdaptiveMeshingMaxAngleInRadians"], maxAngle) && maxAngle > 0)
+					XbimMeshingPolicy::MaxAngle = maxAngle;
 			}
 		protected:
 			~XbimGeometryCreator()
@@ -83,6 +108,12 @@ namespace Xbim
 
 			virtual void WriteBrep(String^ filename, IXbimGeometryObject^ geomObj);
 			virtual IXbimGeometryObject^ ReadBrep(String^ filename);
+			//as ReadBrep, compounds are given the tolerance, normally the precision of the model the shape was built for
+			virtual IXbimGeometryObject^ ReadBrep(String^ filename, double tolerance);
+			//forgets everything built from the model that is kept between calls, such as the faces of shared profiles
+			virtual void ClearModelCaches(Xbim::Common::IModel^ model);
+			//raises the tolerances below the tolerance to it in place, for a shape that is not yet in use on other threads
+			virtual void LimitTolerance(IXbimGeometryObject^ geometryObject, double tolerance);
 
 			static int BooleanTimeOut;
 			static double FuzzyFactor;
@@ -253,6 +284,15 @@ namespace Xbim
 			virtual IXbimGeometryObject^ Moved(IXbimGeometryObject^ geometryObject, IIfcObjectPlacement^ objectPlacement, ILogger^ logger);
 			virtual IXbimGeometryObject^ FromBrep(String^ brepStr);
 			virtual String^ ToBrep(IXbimGeometryObject^ geometryObject);
+			//binary brep in the BinTools format, smaller and much faster to read and write than the text format
+			virtual IXbimGeometryObject^ FromBrep(array<Byte>^ brepData);
+			virtual array<Byte>^ ToBinaryBrep(IXbimGeometryObject^ geometryObject);
+		private:
+			static TopoDS_Shape ToShape(IXbimGeometryObject^ geometryObject);
+			//tolerance of compounds read from a brep when none is given
+			literal double DefaultBrepTolerance = 1e-5;
+			static IXbimGeometryObject^ FromShape(const TopoDS_Shape& shape, double tolerance);
+			static IXbimGeometryObject^ ReadBinaryBrep(const char* data, size_t length, double tolerance);
 
 		};
 			
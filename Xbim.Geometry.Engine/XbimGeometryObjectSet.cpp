@@ -11,12 +11,12 @@
 #include <BRep_Builder.hxx>
 
 #include <BRepBuilderAPI_Sewing.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Section.hxx>
 #include <BRepAlgoAPI_Common.hxx>
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepTools.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <Message_ProgressIndicator.hxx>
 #include <ShapeFix_Shape.hxx>
 #include <BRepCheck_Analyzer.hxx>
@@ -320,7 +320,6 @@ namespace Xbim
 		bool XbimGeometryObjectSet::ParseGeometry(IEnumerable<IXbimGeometryObject^>^ geomObjects, TopTools_ListOfShape& toBeProcessed, Bnd_Array1OfBox& aBoxes,
 			TopoDS_Shell& passThrough, double tolerance)
 		{
-			ShapeFix_ShapeTolerance FTol;
 			BRep_Builder builder;
 			TopoDS_Shell shellBeingBuilt;
 			builder.MakeShell(shellBeingBuilt);
@@ -337,8 +336,7 @@ namespace Xbim
 				// type 1
 				if (solid != nullptr)
 				{
-					FTol.LimitTolerance(solid, tolerance);
-					toBeProcessed.Append(solid);
+					toBeProcessed.Append(XbimNativeApi::LimitSharedTolerance(solid, tolerance));
 					hasContent = true;
 				}
 				// type 2
@@ -400,8 +398,8 @@ namespace Xbim
 					/*String^ err = gcnew String(errMsg.c_str());
 					XbimGeometryCreator::LogWarning(logger, nullptr, "Failed to sew shape: " + err);*/
 				}				
-				FTol.LimitTolerance(shape, tolerance);
-				toBeProcessed.Append(shape);
+				//the faces sewing left alone are still those of the shells
+				toBeProcessed.Append(XbimNativeApi::LimitSharedTolerance(shape, tolerance));
 			}
 			return hasContent;
 		}
@@ -450,7 +448,6 @@ namespace Xbim
 			try
 			{
 				BRep_Builder builder;
-				ShapeFix_ShapeTolerance FTol;
 
 				TopoDS_Compound comp = CreateCompound(geomObjects);
 				Bnd_Box bodyBox;
@@ -481,19 +478,20 @@ namespace Xbim
 						allBoxes(i).SetGap(-tolerance * 2); //reduce to only catch faces that are inside tolerance and not sitting on the opening
 						if (!bodyBox.IsOut(box)) //only try and cut it if it might intersect the body
 						{
-							FTol.LimitTolerance(solid, tolerance);
-							cuttingObjects.Append(solid);
+							//tools are often instances of one cached shape, shared by operations on other threads
+							cuttingObjects.Append(XbimNativeApi::LimitSharedTolerance(solid, tolerance));
 						}
 						i++;
 					}
 				}
 
+				//the result is meshed by the caller, what is returned unchanged is copied as it may be shared with other threads
 				if (cuttingObjects.Extent() == 0)
 				{
-					return gcnew XbimGeometryObjectSet(geomObjects);
+					return (IXbimGeometryObjectSet^)(gcnew XbimGeometryObjectSet(geomObjects))->Transform(XbimMatrix3D::Identity);
 				}
 				if (!ParseGeometry(geomObjects, toBeProcessed, allBoxes, toBePassedThrough, tolerance)) //nothing to do so just return what we had
-					return gcnew XbimGeometryObjectSet(geomObjects);
+					return (IXbimGeometryObjectSet^)(gcnew XbimGeometryObjectSet(geomObjects))->Transform(XbimMatrix3D::Identity);
 
 				
 				TopoDS_Compound occCompound;
@@ -504,12 +502,13 @@ namespace Xbim
 				for (; itl.More(); itl.Next())
 				{
 					int success;
+					TopTools_ListOfShape skippedTools;
 					try
 					{
 						TopoDS_Shape result;
 
 						const TopoDS_Shape& body = itl.Value();
-						success = Xbim::Geometry::DoBoolean(body, cuttingObjects, bop, tolerance, XbimGeometryCreator::FuzzyFactor, result, XbimGeometryCreator::BooleanTimeOut);
+						success = Xbim::Geometry::DoBoolean(body, cuttingObjects, bop, tolerance, XbimGeometryCreator::FuzzyFactor, result, XbimGeometryCreator::BooleanTimeOut, skippedTools);
 						if (success > 0)
 						{
 							builder.Add(occCompound, result);
@@ -527,7 +526,7 @@ namespace Xbim
 						msg = "Boolean operation has created a shape with invalid BREP Topology. The result may not be correct";
 						break;
 					case BOOLEAN_PARTIALSUCCESSSINGLECUT:
-						msg = "Boolean operation executed as one tool per operation with partial success. The result may not be correct";
+						msg = String::Format("Boolean operation recovered by bisecting the tools, {0} of {1} tools could not be applied and were skipped: {2}. The result may not be correct", skippedTools.Extent(), cuttingObjects.Extent(), XbimSolidSet::SkippedToolNames(skippedTools, solids));
 						break;
 					case BOOLEAN_TIMEDOUT:
 						msg = "Boolean operation timed out. No result whas been generated";
@@ -553,7 +552,7 @@ namespace Xbim
 					TopExp_Explorer expl(toBePassedThrough, TopAbs_FACE);
 
 					if (expl.More()) //only add if there are faces to consider
-						compound->Add(gcnew XbimShell(toBePassedThrough));
+						compound->Add(gcnew XbimShell(TopoDS::Shell(BRepBuilderAPI_Copy(toBePassedThrough).Shape())));
 				}
 
 				XbimGeometryObjectSet^ geomObjs = gcnew XbimGeometryObjectSet();
@@ -0,0 +1,162 @@
+#include "XbimMeshingPolicy.h"
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
+#include <Bnd_Box.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <gp_Cylinder.hxx>
+#include <gp_Sphere.hxx>
+#include <gp_Torus.hxx>
+#include <gp_Cone.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Elips.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <algorithm>
+#include <cmath>
+
+bool XbimMeshingPolicy::Adaptive = false;
+double XbimMeshingPolicy::RelativeDeflection = 0.002;
+double XbimMeshingPolicy::MaxDeflectionFactor = 4;
+double XbimMeshingPolicy::MaxAngle = 1.0472; //six segments to a full circle
+
+double XbimMeshingPolicy::MinimumRadius(const TopoDS_Shape& shape)
+{
+	double minRadius = Precision::Infinite();
+	TopTools_IndexedMapOfShape faceMap;
+	TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+	for (int f = 1; f <= faceMap.Extent(); f++)
+	{
+		const TopoDS_Face& face = TopoDS::Face(faceMap(f));
+		BRepAdaptor_Surface surface(face, Standard_False);
+		switch (surface.GetType())
+		{
+		case GeomAbs_Plane:
+			break;
+		case GeomAbs_Cylinder:
+			minRadius = std::min(minRadius, surface.Cylinder().Radius());
+			break;
+		case GeomAbs_Sphere:
+			minRadius = std::min(minRadius, surface.Sphere().Radius());
+			break;
+		case GeomAbs_Torus:
+		{
+			gp_Torus torus = surface.Torus();
+			double inner = torus.MajorRadius() - torus.MinorRadius();
+			minRadius = std::min(minRadius, inner > 0 ? std::min(torus.MinorRadius(), inner) : torus.MinorRadius());
+			break;
+		}
+		case GeomAbs_Cone:
+		{
+			//the radius changes along the cone, the apex is left to the mesher and the smaller end radius is taken
+			gp_Cone cone = surface.Cone();
+			double uMin, uMax, vMin, vMax;
+			BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+			double sinAngle = std::sin(cone.SemiAngle());
+			double r1 = std::abs(cone.RefRadius() + vMin * sinAngle);
+			double r2 = std::abs(cone.RefRadius() + vMax * sinAngle);
+			double r = std::min(r1, r2);
+			if (r <= Precision::Confusion()) r = std::max(r1, r2);
+			if (r > Precision::Confusion())
+				minRadius = std::min(minRadius, r);
+			break;
+		}
+		default:
+			return 0; //free form, the angle is left as asked
+		}
+	}
+	//curved edges on planar faces, e.g. round holes in a plate
+	TopTools_IndexedMapOfShape edgeMap;
+	TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+	for (int e = 1; e <= edgeMap.Extent(); e++)
+	{
+		const TopoDS_Edge& edge = TopoDS::Edge(edgeMap(e));
+		if (BRep_Tool::Degenerated(edge) || !BRep_Tool::IsGeometric(edge))
+			continue;
+		BRepAdaptor_Curve curve(edge);
+		switch (curve.GetType())
+		{
+		case GeomAbs_Line:
+			break;
+		case GeomAbs_Circle:
+			minRadius = std::min(minRadius, curve.Circle().Radius());
+			break;
+		case GeomAbs_Ellipse:
+		{
+			//tightest at the ends of the major axis
+			gp_Elips ellipse = curve.Ellipse();
+			minRadius = std::min(minRadius, ellipse.MinorRadius() * ellipse.MinorRadius() / ellipse.MajorRadius());
+			break;
+		}
+		default:
+			return 0;
+		}
+	}
+	return minRadius;
+}
+
+bool XbimMeshingPolicy::IsMeshedFiner(const TopoDS_Shape& shape, double deflection)
+{
+	TopTools_IndexedMapOfShape faceMap;
+	TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+	for (int f = 1; f <= faceMap.Extent(); f++)
+	{
+		TopLoc_Location loc;
+		const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(f)), loc);
+		if (!mesh.IsNull() && mesh->Deflection() < deflection)
+			return true;
+	}
+	return false;
+}
+
+void XbimMeshingPolicy::Parameters(const TopoDS_Shape& shape, double& deflection, double& angle)
+{
+	if (!Adaptive || deflection <= 0)
+		return;
+	Bnd_Box box;
+	BRepBndLib::Add(shape, box);
+	if (box.IsVoid())
+		return;
+	//small shapes keep the deflection asked for, large ones can take a coarser one
+	double sized = std::min(std::max(deflection, std::sqrt(box.SquareExtent()) * RelativeDeflection), deflection * MaxDeflectionFactor);
+	double radius = MinimumRadius(shape);
+	if (radius > 0 && !Precision::IsInfinite(radius))
+	{
+		//the sagitta of a segment spanning angle a on radius r is r(1 - cos(a/2)), beyond the angle where it equals the deflection
+		//the linear deflection limits the mesh of this curve anyway, on larger radii it still does so the chord error stays in bounds
+		double chordAngle = 2 * std::acos(1 - std::min(sized / radius, 1.0));
+		angle = std::max(angle, std::min(chordAngle, MaxAngle));
+	}
+	deflection = sized;
+}
+
+TopoDS_Shape XbimMeshingPolicy::Mesh(const TopoDS_Shape& shape, double deflection, double angle)
+{
+	//a coarser mesh than the existing one, e.g. to keep to a triangle budget, is made on a copy
+	Parameters(shape, deflection, angle);
+	if (IsMeshedFiner(shape, deflection))
+	{
+		try
+		{
+			BRepBuilderAPI_Copy copier(shape, Standard_False);
+			TopoDS_Shape copy = copier.Shape();
+			BRepMesh_IncrementalMesh incrementalMesh(copy, deflection, Standard_False, angle);
+			return copy;
+		}
+		catch (Standard_Failure)
+		{
+			//keep the existing mesh
+		}
+	}
+	BRepMesh_IncrementalMesh incrementalMesh(shape, deflection, Standard_False, angle);
+	return shape;
+}
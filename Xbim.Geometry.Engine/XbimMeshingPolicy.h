@@ -0,0 +1,32 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+
+//Chooses the linear and angular deflection used to mesh a shape. When adaptive meshing is on, the linear deflection
+//grows with the size of the shape and the angular deflection is relaxed to the angle at which the chord error on the
+//tightest curve of the shape equals the linear deflection, so small curved parts such as bolts and fittings are no longer
+//meshed with the segment count the default angle gives every circle. One set of values is used for the whole shape so
+//that the meshes of faces sharing an edge still meet
+class XbimMeshingPolicy
+{
+private:
+	//smallest radius of curvature of the curved faces and edges, infinite if there are none and 0 if any is of unknown curvature
+	static double MinimumRadius(const TopoDS_Shape& shape);
+	//true if any face already has a triangulation finer than the deflection, BRepMesh would keep it
+	static bool IsMeshedFiner(const TopoDS_Shape& shape, double deflection);
+public:
+	//set from the AdaptiveMeshing application setting, when false the deflections are used as given
+	static bool Adaptive;
+	//linear deflection as a fraction of the diagonal of the bounding box of the shape
+	static double RelativeDeflection;
+	//the linear deflection of large shapes is not raised beyond this multiple of the one asked for
+	static double MaxDeflectionFactor;
+	//the angular deflection of curves with a small radius is not relaxed beyond this, in radians
+	static double MaxAngle;
+
+	//adapts the deflections to the shape, never finer than those given
+	static void Parameters(const TopoDS_Shape& shape, double& deflection, double& angle);
+	//meshes the shape and returns the shape that carries the triangulation. This is the shape itself unless it was already
+	//meshed finer than the adapted deflection, then a copy of its topology is meshed so the coarser mesh does not replace the
+	//one on faces that may be shared with other shapes
+	static TopoDS_Shape Mesh(const TopoDS_Shape& shape, double deflection, double angle);
+};
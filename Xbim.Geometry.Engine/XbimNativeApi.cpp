@@ -1,7 +1,161 @@
 #include "XbimNativeApi.h"
 #include "XbimProgressMonitor.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimToleranceNormalizer.h"
 #include <ShapeFix_Shape.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
+#include <BinTools.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools_Modification.hxx>
+#include <BRepTools_Modifier.hxx>
+#include <BRep_Tool.hxx>
+#include <Geom_Surface.hxx>
+#include <Geom_Curve.hxx>
+#include <Geom2d_Curve.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <TopTools_MapIteratorOfMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopLoc_Location.hxx>
+#include <algorithm>
+#include <istream>
+#include <streambuf>
+
+namespace
+{
+	//read only stream buffer over memory owned by the caller, BinTools seeks when it reads triangulations so seeking is supported
+	class XbimMemoryStreamBuf : public std::streambuf
+	{
+	public:
+		XbimMemoryStreamBuf(const char* data, size_t length)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + length);
+		}
+	protected:
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+			char* target;
+			if (dir == std::ios_base::beg)
+				target = eback() + off;
+			else if (dir == std::ios_base::cur)
+				target = gptr() + off;
+			else
+				target = egptr() + off;
+			if (target < eback() || target > egptr())
+				return pos_type(off_type(-1));
+			setg(eback(), target, egptr());
+			return pos_type(target - eback());
+		}
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+
+	//adds the faces, edges and vertices of the shape without their location, so instances of one shape all match
+	void MapUnlocated(const TopoDS_Shape& shape, TopTools_MapOfShape& map)
+	{
+		for (TopAbs_ShapeEnum type : { TopAbs_FACE, TopAbs_EDGE, TopAbs_VERTEX })
+		{
+			for (TopExp_Explorer exp(shape, type); exp.More(); exp.Next())
+				map.Add(exp.Current().Located(TopLoc_Location()));
+		}
+	}
+
+	//replaces the faces that are in the modified shape by their images, the others are kept
+	template <typename TModifier>
+	void TrackFaces(const TModifier& modifier, const TopoDS_Shape& shape, TopTools_MapOfShape& faces)
+	{
+		TopTools_IndexedMapOfShape shapeFaces;
+		TopExp::MapShapes(shape, TopAbs_FACE, shapeFaces);
+		TopTools_MapOfShape tracked;
+		for (TopTools_MapIteratorOfMapOfShape it(faces); it.More(); it.Next())
+			tracked.Add(shapeFaces.Contains(it.Key()) ? modifier.ModifiedShape(it.Key()) : it.Key());
+		faces = tracked;
+	}
+}
+
+class XbimSharedCopyModification;
+DEFINE_STANDARD_HANDLE(XbimSharedCopyModification, BRepTools_Modification)
+
+//copies the faces, edges and vertices that are in the shared map, with their geometry as fixing may change it in place, and
+//leaves the rest, BRepTools_Modifier rebuilds the faces and edges that hold a copy
+class XbimSharedCopyModification : public BRepTools_Modification
+{
+private:
+	const TopTools_MapOfShape& shared;
+
+	bool IsShared(const TopoDS_Shape& shape) const
+	{
+		return shared.Contains(shape.Located(TopLoc_Location()));
+	}
+
+public:
+	XbimSharedCopyModification(const TopTools_MapOfShape& shared) : shared(shared)
+	{
+	}
+
+	virtual Standard_Boolean NewSurface(const TopoDS_Face& F, Handle(Geom_Surface)& S, TopLoc_Location& L, Standard_Real& Tol, Standard_Boolean& RevWires, Standard_Boolean& RevFace) Standard_OVERRIDE
+	{
+		if (!IsShared(F)) return Standard_False;
+		S = BRep_Tool::Surface(F, L);
+		if (!S.IsNull()) S = Handle(Geom_Surface)::DownCast(S->Copy());
+		Tol = BRep_Tool::Tolerance(F);
+		RevWires = Standard_False;
+		RevFace = Standard_False;
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewCurve(const TopoDS_Edge& E, Handle(Geom_Curve)& C, TopLoc_Location& L, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		if (!IsShared(E)) return Standard_False;
+		double first, last;
+		C = BRep_Tool::Curve(E, L, first, last);
+		if (!C.IsNull()) C = Handle(Geom_Curve)::DownCast(C->Copy()); //a degenerated edge has none
+		Tol = BRep_Tool::Tolerance(E);
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewPoint(const TopoDS_Vertex& V, gp_Pnt& P, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		if (!IsShared(V)) return Standard_False;
+		P = BRep_Tool::Pnt(V);
+		Tol = BRep_Tool::Tolerance(V);
+		return Standard_True;
+	}
+
+	//called for every edge of a rebuilt face, kept edges also need the curve on the rebuilt face
+	virtual Standard_Boolean NewCurve2d(const TopoDS_Edge& E, const TopoDS_Face& F, const TopoDS_Edge&, const TopoDS_Face&, Handle(Geom2d_Curve)& C, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		double first, last;
+		C = BRep_Tool::CurveOnSurface(E, F, first, last);
+		if (C.IsNull()) return Standard_False;
+		C = Handle(Geom2d_Curve)::DownCast(C->Copy());
+		Tol = BRep_Tool::Tolerance(E);
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewParameter(const TopoDS_Vertex& V, const TopoDS_Edge& E, Standard_Real& P, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		if (V.IsNull()) return Standard_False;
+		P = BRep_Tool::Parameter(V, E);
+		Tol = BRep_Tool::Tolerance(V);
+		return Standard_True;
+	}
+
+	virtual GeomAbs_Shape Continuity(const TopoDS_Edge& E, const TopoDS_Face& F1, const TopoDS_Face& F2, const TopoDS_Edge&, const TopoDS_Face&, const TopoDS_Face&) Standard_OVERRIDE
+	{
+		return BRep_Tool::Continuity(E, F1, F2);
+	}
+
+	DEFINE_STANDARD_RTTI_INLINE(XbimSharedCopyModification, BRepTools_Modification)
+};
 
 bool XbimNativeApi::FixShell(TopoDS_Shell& shell, double timeOut, std::string& errMsg)
 {
@@ -79,3 +233,131 @@ bool XbimNativeApi::SewShape(TopoDS_Shape& shape, double tolerance, double timeO
 		return false;
 	}
 }
+
+bool XbimNativeApi::ReadBinaryBrep(const char* data, size_t length, TopoDS_Shape& shape, std::string& errMsg)
+{
+	try
+	{
+		XbimMemoryStreamBuf buffer(data, length);
+		std::istream stream(&buffer);
+		BinTools::Read(shape, stream);
+		if (shape.IsNull())
+		{
+			errMsg = "Binary brep contains no shape";
+			return false;
+		}
+		return true;
+	}
+	catch (Standard_Failure sf)
+	{
+		errMsg = sf.GetMessageString();
+		if (errMsg.empty())
+			errMsg = "Standard Failure reading binary brep";
+		return false;
+	}
+}
+
+bool XbimNativeApi::WriteBinaryBrep(const TopoDS_Shape& shape, std::ostream& stream, std::string& errMsg)
+{
+	try
+	{
+		BinTools::Write(shape, stream);
+		if (!stream.good())
+		{
+			errMsg = "Failed to write binary brep";
+			return false;
+		}
+		return true;
+	}
+	catch (Standard_Failure sf)
+	{
+		errMsg = sf.GetMessageString();
+		if (errMsg.empty())
+			errMsg = "Standard Failure writing binary brep";
+		return false;
+	}
+}
+
+bool XbimNativeApi::InstanceShape(const TopoDS_Shape& shape, const gp_GTrsf& transform, TopoDS_Shape& result, std::string& errMsg)
+{
+	try
+	{
+		//the columns of the linear part are orthogonal and of equal length for a rigid or uniformly scaled transform
+		const gp_Mat& m = transform.VectorialPart();
+		gp_XYZ c1 = m.Column(1);
+		gp_XYZ c2 = m.Column(2);
+		gp_XYZ c3 = m.Column(3);
+		double l1 = c1.SquareModulus();
+		double l2 = c2.SquareModulus();
+		double l3 = c3.SquareModulus();
+		double eps = 1e-9 * std::max(l1, std::max(l2, l3));
+		bool uniform = Abs(l1 - l2) <= eps && Abs(l1 - l3) <= eps &&
+			Abs(c1.Dot(c2)) <= eps && Abs(c1.Dot(c3)) <= eps && Abs(c2.Dot(c3)) <= eps;
+		if (!uniform)
+		{
+			result = XbimNonUniformTransform::Transform(shape, transform);
+			return true;
+		}
+		const gp_XYZ& t = transform.TranslationPart();
+		gp_Trsf trsf;
+		trsf.SetValues(m.Value(1, 1), m.Value(1, 2), m.Value(1, 3), t.X(),
+			m.Value(2, 1), m.Value(2, 2), m.Value(2, 3), t.Y(),
+			m.Value(3, 1), m.Value(3, 2), m.Value(3, 3), t.Z());
+		//a mirror would invert the instance so it is treated as a scale
+		if (Abs(l1 - 1.0) <= 1e-9 && m.Determinant() > 0)
+		{
+			result = shape.Moved(TopLoc_Location(trsf));
+			return true;
+		}
+		BRepBuilderAPI_Transform tran(shape, trsf, Standard_True);
+		result = tran.Shape();
+		return true;
+	}
+	catch (Standard_Failure sf)
+	{
+		errMsg = sf.GetMessageString();
+		if (errMsg.empty())
+			errMsg = "Standard Failure placing a shape instance";
+		return false;
+	}
+}
+
+TopoDS_Shape XbimNativeApi::LimitSharedTolerance(const TopoDS_Shape& shape, double tolerance)
+{
+	//other threads may be reading the tolerances, they are only read here
+	if (XbimToleranceNormalizer::IsLimited(shape, tolerance))
+		return shape;
+	TopoDS_Shape copy = BRepBuilderAPI_Copy(shape).Shape();
+	XbimToleranceNormalizer::Limit(copy, tolerance);
+	return copy;
+}
+
+TopoDS_Shape XbimNativeApi::CopyShared(const TopoDS_Shape& shape, const TopTools_ListOfShape& sources, TopTools_MapOfShape& trackedFaces)
+{
+	TopTools_MapOfShape shared;
+	for (TopTools_ListIteratorOfListOfShape it(sources); it.More(); it.Next())
+		MapUnlocated(it.Value(), shared);
+	//a shared face or edge has shared vertices
+	bool sharesAny = false;
+	for (TopExp_Explorer exp(shape, TopAbs_VERTEX); exp.More() && !sharesAny; exp.Next())
+		sharesAny = shared.Contains(exp.Current().Located(TopLoc_Location()));
+	if (!sharesAny)
+		return shape;
+	try
+	{
+		Handle(XbimSharedCopyModification) modification = new XbimSharedCopyModification(shared);
+		BRepTools_Modifier modifier(shape, modification);
+		if (modifier.IsDone())
+		{
+			TrackFaces(modifier, shape, trackedFaces);
+			return modifier.ModifiedShape(shape);
+		}
+	}
+	catch (Standard_Failure)
+	{
+		//fall through to a copy of the whole shape
+	}
+	BRepBuilderAPI_Copy copier(shape);
+	TrackFaces(copier, shape, trackedFaces);
+	return copier.Shape();
+}
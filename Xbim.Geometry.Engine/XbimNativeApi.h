@@ -1,5 +1,9 @@
 #pragma once
 #include <ShapeFix_Shell.hxx>
+#include <gp_GTrsf.hxx>
+#include <TopTools_ListOfShape.hxx>
+#include <TopTools_MapOfShape.hxx>
+#include <iosfwd>
 
 class XbimNativeApi
 {
@@ -7,5 +11,17 @@ public:
 	static bool FixShell(TopoDS_Shell& shell, double timeOut, std::string& errMsg);
 	static bool FixShape(TopoDS_Shape& shape, double timeOut, std::string& errMsg);
 	static bool SewShape(TopoDS_Shape& shape, double tolerance, double timeOut, std::string& errMsg);
+	//reads a shape in the BinTools format directly from a block of memory, e.g. a mapped file, without copying it
+	static bool ReadBinaryBrep(const char* data, size_t length, TopoDS_Shape& shape, std::string& errMsg);
+	static bool WriteBinaryBrep(const TopoDS_Shape& shape, std::ostream& stream, std::string& errMsg);
+	//places an instance of the shape, a rigid transform only sets the location so the instance shares all of its geometry,
+	//a scaling transform changes the geometry and is applied to a copy
+	static bool InstanceShape(const TopoDS_Shape& shape, const gp_GTrsf& transform, TopoDS_Shape& result, std::string& errMsg);
+	//limits the tolerances of a shape whose sub-shapes may be shared by instances in use on other threads, the shape is returned
+	//if its tolerances are in range, otherwise a copy with them limited, the shape itself is never changed
+	static TopoDS_Shape LimitSharedTolerance(const TopoDS_Shape& shape, double tolerance);
+	//returns the shape with the faces, edges and vertices it shares with the sources replaced by copies, so it can be fixed and
+	//meshed while other threads use the sources, the rest of its topology is kept. The tracked faces are replaced by their images
+	static TopoDS_Shape CopyShared(const TopoDS_Shape& shape, const TopTools_ListOfShape& sources, TopTools_MapOfShape& trackedFaces);
 };
 
@@ -0,0 +1,511 @@
+#include "XbimNonUniformTransform.h"
+#include <BRepBuilderAPI_GTransform.hxx>
+#include <BRepTools_Modification.hxx>
+#include <BRepTools_Modifier.hxx>
+#include <BRep_Tool.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_Circle.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <Geom_Ellipse.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <Geom_SurfaceOfLinearExtrusion.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <Geom2d_BSplineCurve.hxx>
+#include <Geom2d_BezierCurve.hxx>
+#include <Geom2d_Circle.hxx>
+#include <Geom2d_Ellipse.hxx>
+#include <Geom2d_Line.hxx>
+#include <Geom2d_TrimmedCurve.hxx>
+#include <Geom2dConvert.hxx>
+#include <NCollection_DataMap.hxx>
+#include <TColStd_Array1OfReal.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_ShapeMapHasher.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <gp_Ax22d.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Lin2d.hxx>
+#include <gp_Mat2d.hxx>
+#include <Standard_Failure.hxx>
+#include <algorithm>
+#include <cmath>
+
+//relative size below which a length is taken as zero and a difference of radii as none
+static const double AffineEpsilon = 1e-9;
+//relative tolerance for the speed of a curve on a face to match the speed of its edge
+static const double ParameterEpsilon = 1e-6;
+
+//the parameter t of a transformed curve becomes Scale * t + Shift
+struct XbimParameterMap
+{
+	double Scale;
+	double Shift;
+	XbimParameterMap() : Scale(1), Shift(0) {}
+	double Map(double t) const { return Scale * t + Shift; }
+};
+
+//the parameters (u, v) of a transformed surface become Linear * (u, v) + Translation
+struct XbimSurfaceParameterMap
+{
+	gp_Mat2d Linear;
+	gp_XY Translation;
+	XbimSurfaceParameterMap() : Translation(0, 0) { Linear.SetIdentity(); }
+	gp_XY MapPoint(const gp_XY& uv) const { gp_XY p = uv; p.Multiply(Linear); p.Add(Translation); return p; }
+	gp_XY MapVector(const gp_XY& uv) const { gp_XY p = uv; p.Multiply(Linear); return p; }
+};
+
+//cos(t)u + sin(t)v is an ellipse for any two independent u and v, the angle returned makes cos(t)major + sin(t)minor the same
+//ellipse parameterised by t - angle with major and minor its perpendicular semi axes, the major one first
+template <class XY>
+static double PrincipalAxes(const XY& u, const XY& v, XY& major, XY& minor)
+{
+	double angle = 0.5 * std::atan2(2 * u.Dot(v), u.SquareModulus() - v.SquareModulus());
+	double c = std::cos(angle), s = std::sin(angle);
+	major = u.Multiplied(c) + v.Multiplied(s);
+	minor = v.Multiplied(c) - u.Multiplied(s);
+	return angle;
+}
+
+static gp_XYZ TransformedPoint(const gp_Pnt& p, const gp_GTrsf& transform)
+{
+	gp_XYZ xyz = p.XYZ();
+	transform.Transforms(xyz);
+	return xyz;
+}
+
+static gp_XYZ TransformedVector(const gp_XYZ& v, const gp_GTrsf& transform)
+{
+	return v.Multiplied(transform.VectorialPart());
+}
+
+static bool TransformCurve(const Handle(Geom_Curve)& curve, const gp_GTrsf& transform, Handle(Geom_Curve)& result, XbimParameterMap& map)
+{
+	Handle(Standard_Type) type = curve->DynamicType();
+	if (type == STANDARD_TYPE(Geom_TrimmedCurve)) //the edge bounds the curve, the trim is not needed
+		return TransformCurve(Handle(Geom_TrimmedCurve)::DownCast(curve)->BasisCurve(), transform, result, map);
+	if (type == STANDARD_TYPE(Geom_Line))
+	{
+		gp_Lin line = Handle(Geom_Line)::DownCast(curve)->Lin();
+		gp_XYZ direction = TransformedVector(line.Direction().XYZ(), transform);
+		double length = direction.Modulus();
+		if (length <= AffineEpsilon) return false;
+		result = new Geom_Line(gp_Pnt(TransformedPoint(line.Location(), transform)), gp_Dir(direction));
+		map.Scale = length;
+		map.Shift = 0;
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_Circle) || type == STANDARD_TYPE(Geom_Ellipse))
+	{
+		Handle(Geom_Conic) conic = Handle(Geom_Conic)::DownCast(curve);
+		double a, b;
+		if (type == STANDARD_TYPE(Geom_Circle))
+			a = b = Handle(Geom_Circle)::DownCast(curve)->Radius();
+		else
+		{
+			a = Handle(Geom_Ellipse)::DownCast(curve)->MajorRadius();
+			b = Handle(Geom_Ellipse)::DownCast(curve)->MinorRadius();
+		}
+		gp_XYZ u = TransformedVector(conic->XAxis().Direction().XYZ() * a, transform);
+		gp_XYZ v = TransformedVector(conic->YAxis().Direction().XYZ() * b, transform);
+		gp_XYZ major, minor;
+		double angle = PrincipalAxes(u, v, major, minor);
+		double ra = major.Modulus(), rb = minor.Modulus();
+		if (rb <= AffineEpsilon * ra) return false;
+		gp_Ax2 axes(gp_Pnt(TransformedPoint(conic->Location(), transform)), gp_Dir(major.Crossed(minor)), gp_Dir(major));
+		if (ra - rb <= AffineEpsilon * ra)
+			result = new Geom_Circle(axes, 0.5 * (ra + rb));
+		else
+			result = new Geom_Ellipse(axes, ra, rb);
+		map.Scale = 1;
+		map.Shift = -angle;
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_BSplineCurve))
+	{
+		Handle(Geom_BSplineCurve) bspline = Handle(Geom_BSplineCurve)::DownCast(curve->Copy());
+		for (int i = 1; i <= bspline->NbPoles(); i++)
+			bspline->SetPole(i, gp_Pnt(TransformedPoint(bspline->Pole(i), transform)));
+		result = bspline;
+		map = XbimParameterMap();
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_BezierCurve))
+	{
+		Handle(Geom_BezierCurve) bezier = Handle(Geom_BezierCurve)::DownCast(curve->Copy());
+		for (int i = 1; i <= bezier->NbPoles(); i++)
+			bezier->SetPole(i, gp_Pnt(TransformedPoint(bezier->Pole(i), transform)));
+		result = bezier;
+		map = XbimParameterMap();
+		return true;
+	}
+	return false;
+}
+
+static bool TransformSurface(const Handle(Geom_Surface)& surface, const gp_GTrsf& transform, Handle(Geom_Surface)& result, XbimSurfaceParameterMap& map)
+{
+	Handle(Standard_Type) type = surface->DynamicType();
+	if (type == STANDARD_TYPE(Geom_RectangularTrimmedSurface)) //the wires bound the face, the trim is not needed
+		return TransformSurface(Handle(Geom_RectangularTrimmedSurface)::DownCast(surface)->BasisSurface(), transform, result, map);
+	if (type == STANDARD_TYPE(Geom_Plane))
+	{
+		//the new plane is placed on the images of the old axes, the parameters follow from the coordinates in its orthonormal axes
+		const gp_Ax3& position = Handle(Geom_Plane)::DownCast(surface)->Position();
+		gp_XYZ x = TransformedVector(position.XDirection().XYZ(), transform);
+		gp_XYZ y = TransformedVector(position.YDirection().XYZ(), transform);
+		gp_XYZ normal = x.Crossed(y);
+		if (normal.Modulus() <= AffineEpsilon * x.Modulus() * y.Modulus()) return false;
+		gp_Ax3 axes(gp_Pnt(TransformedPoint(position.Location(), transform)), gp_Dir(normal), gp_Dir(x));
+		result = new Geom_Plane(axes);
+		map.Linear = gp_Mat2d(gp_XY(x.Modulus(), 0), gp_XY(y.Dot(axes.XDirection().XYZ()), y.Dot(axes.YDirection().XYZ())));
+		map.Translation = gp_XY(0, 0);
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_CylindricalSurface))
+	{
+		Handle(Geom_CylindricalSurface) cylinder = Handle(Geom_CylindricalSurface)::DownCast(surface);
+		const gp_Ax3& position = cylinder->Position();
+		double radius = cylinder->Radius();
+		gp_XYZ u = TransformedVector(position.XDirection().XYZ() * radius, transform);
+		gp_XYZ v = TransformedVector(position.YDirection().XYZ() * radius, transform);
+		gp_XYZ z = TransformedVector(position.Direction().XYZ(), transform);
+		gp_XYZ major, minor;
+		double angle = PrincipalAxes(u, v, major, minor);
+		double ra = major.Modulus(), rb = minor.Modulus(), height = z.Modulus();
+		if (rb <= AffineEpsilon * ra || height <= AffineEpsilon) return false;
+		gp_XYZ normal = major.Crossed(minor);
+		gp_Pnt centre(TransformedPoint(position.Location(), transform));
+		if (ra - rb <= AffineEpsilon * ra && z.Crossed(normal).Modulus() <= AffineEpsilon * height * normal.Modulus())
+		{
+			//still round and upright
+			gp_Ax3 axes(centre, gp_Dir(z), gp_Dir(major));
+			if (axes.YDirection().XYZ().Dot(minor) < 0) axes.YReverse();
+			result = new Geom_CylindricalSurface(axes, 0.5 * (ra + rb));
+		}
+		else
+		{
+			gp_Ax2 axes(centre, gp_Dir(normal), gp_Dir(major));
+			Handle(Geom_Curve) section;
+			if (ra - rb <= AffineEpsilon * ra)
+				section = new Geom_Circle(axes, 0.5 * (ra + rb));
+			else
+				section = new Geom_Ellipse(axes, ra, rb);
+			result = new Geom_SurfaceOfLinearExtrusion(section, gp_Dir(z));
+		}
+		map.Linear = gp_Mat2d(gp_XY(1, 0), gp_XY(0, height));
+		map.Translation = gp_XY(-angle, 0);
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_SurfaceOfLinearExtrusion))
+	{
+		Handle(Geom_SurfaceOfLinearExtrusion) extrusion = Handle(Geom_SurfaceOfLinearExtrusion)::DownCast(surface);
+		Handle(Geom_Curve) basis;
+		XbimParameterMap basisMap;
+		if (!TransformCurve(extrusion->BasisCurve(), transform, basis, basisMap)) return false;
+		gp_XYZ z = TransformedVector(extrusion->Direction().XYZ(), transform);
+		double height = z.Modulus();
+		if (height <= AffineEpsilon) return false;
+		result = new Geom_SurfaceOfLinearExtrusion(basis, gp_Dir(z));
+		map.Linear = gp_Mat2d(gp_XY(basisMap.Scale, 0), gp_XY(0, height));
+		map.Translation = gp_XY(basisMap.Shift, 0);
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_BSplineSurface))
+	{
+		Handle(Geom_BSplineSurface) bspline = Handle(Geom_BSplineSurface)::DownCast(surface->Copy());
+		for (int i = 1; i <= bspline->NbUPoles(); i++)
+			for (int j = 1; j <= bspline->NbVPoles(); j++)
+				bspline->SetPole(i, j, gp_Pnt(TransformedPoint(bspline->Pole(i, j), transform)));
+		result = bspline;
+		map = XbimSurfaceParameterMap();
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom_BezierSurface))
+	{
+		Handle(Geom_BezierSurface) bezier = Handle(Geom_BezierSurface)::DownCast(surface->Copy());
+		for (int i = 1; i <= bezier->NbUPoles(); i++)
+			for (int j = 1; j <= bezier->NbVPoles(); j++)
+				bezier->SetPole(i, j, gp_Pnt(TransformedPoint(bezier->Pole(i, j), transform)));
+		result = bezier;
+		map = XbimSurfaceParameterMap();
+		return true;
+	}
+	return false;
+}
+
+//maps a curve on a face to the parameters of the transformed surface and reparameterises it to follow its transformed edge
+static bool TransformCurve2d(const Handle(Geom2d_Curve)& curve, const XbimSurfaceParameterMap& uvMap, const XbimParameterMap& map, Handle(Geom2d_Curve)& result)
+{
+	Handle(Standard_Type) type = curve->DynamicType();
+	if (type == STANDARD_TYPE(Geom2d_TrimmedCurve))
+		return TransformCurve2d(Handle(Geom2d_TrimmedCurve)::DownCast(curve)->BasisCurve(), uvMap, map, result);
+	if (type == STANDARD_TYPE(Geom2d_Line))
+	{
+		//P + tD becomes M(P) + ((s - shift) / scale)M(D), a line only if M(D) / scale is of unit length
+		gp_Lin2d line = Handle(Geom2d_Line)::DownCast(curve)->Lin2d();
+		gp_XY direction = uvMap.MapVector(line.Direction().XY()) / map.Scale;
+		if (std::abs(direction.Modulus() - 1) > ParameterEpsilon) return false;
+		gp_XY origin = uvMap.MapPoint(line.Location().XY()) - direction * map.Shift;
+		result = new Geom2d_Line(gp_Pnt2d(origin), gp_Dir2d(direction));
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom2d_Circle) || type == STANDARD_TYPE(Geom2d_Ellipse))
+	{
+		//cos(s - shift)U + sin(s - shift)V = cos(s)U' + sin(s)V', an ellipse in s if U' and V' are its semi axes
+		if (std::abs(map.Scale - 1) > ParameterEpsilon) return false;
+		Handle(Geom2d_Conic) conic = Handle(Geom2d_Conic)::DownCast(curve);
+		double a, b;
+		if (type == STANDARD_TYPE(Geom2d_Circle))
+			a = b = Handle(Geom2d_Circle)::DownCast(curve)->Radius();
+		else
+		{
+			a = Handle(Geom2d_Ellipse)::DownCast(curve)->MajorRadius();
+			b = Handle(Geom2d_Ellipse)::DownCast(curve)->MinorRadius();
+		}
+		gp_XY u = uvMap.MapVector(conic->XAxis().Direction().XY() * a);
+		gp_XY v = uvMap.MapVector(conic->YAxis().Direction().XY() * b);
+		double c = std::cos(map.Shift), s = std::sin(map.Shift);
+		gp_XY major = u * c - v * s;
+		gp_XY minor = u * s + v * c;
+		double ra = major.Modulus(), rb = minor.Modulus();
+		if (rb <= AffineEpsilon * ra || ra < rb * (1 - ParameterEpsilon) || std::abs(major.Dot(minor)) > ParameterEpsilon * ra * rb)
+			return false;
+		gp_Ax22d axes(gp_Pnt2d(uvMap.MapPoint(conic->Location().XY())), gp_Dir2d(major), gp_Dir2d(minor));
+		if (ra - rb <= ParameterEpsilon * ra)
+			result = new Geom2d_Circle(axes, 0.5 * (ra + rb));
+		else
+			result = new Geom2d_Ellipse(axes, ra, rb);
+		return true;
+	}
+	if (type == STANDARD_TYPE(Geom2d_BSplineCurve) || type == STANDARD_TYPE(Geom2d_BezierCurve))
+	{
+		//an affine map of the poles is exact, the knots take the change of parameter
+		Handle(Geom2d_BSplineCurve) bspline = Geom2dConvert::CurveToBSplineCurve(curve);
+		for (int i = 1; i <= bspline->NbPoles(); i++)
+			bspline->SetPole(i, gp_Pnt2d(uvMap.MapPoint(bspline->Pole(i).XY())));
+		if (map.Scale != 1 || map.Shift != 0)
+		{
+			TColStd_Array1OfReal knots(1, bspline->NbKnots());
+			bspline->Knots(knots);
+			for (int i = knots.Lower(); i <= knots.Upper(); i++)
+				knots(i) = map.Map(knots(i));
+			bspline->SetKnots(knots);
+		}
+		result = bspline;
+		return true;
+	}
+	return false;
+}
+
+static bool IsSupportedCurve(const Handle(Geom_Curve)& curve)
+{
+	Handle(Standard_Type) type = curve->DynamicType();
+	if (type == STANDARD_TYPE(Geom_TrimmedCurve))
+		return IsSupportedCurve(Handle(Geom_TrimmedCurve)::DownCast(curve)->BasisCurve());
+	return type == STANDARD_TYPE(Geom_Line) || type == STANDARD_TYPE(Geom_Circle) || type == STANDARD_TYPE(Geom_Ellipse) ||
+		type == STANDARD_TYPE(Geom_BSplineCurve) || type == STANDARD_TYPE(Geom_BezierCurve);
+}
+
+static bool IsSupportedSurface(const Handle(Geom_Surface)& surface)
+{
+	Handle(Standard_Type) type = surface->DynamicType();
+	if (type == STANDARD_TYPE(Geom_RectangularTrimmedSurface))
+		return IsSupportedSurface(Handle(Geom_RectangularTrimmedSurface)::DownCast(surface)->BasisSurface());
+	if (type == STANDARD_TYPE(Geom_SurfaceOfLinearExtrusion))
+		return IsSupportedCurve(Handle(Geom_SurfaceOfLinearExtrusion)::DownCast(surface)->BasisCurve());
+	return type == STANDARD_TYPE(Geom_Plane) || type == STANDARD_TYPE(Geom_CylindricalSurface) ||
+		type == STANDARD_TYPE(Geom_BSplineSurface) || type == STANDARD_TYPE(Geom_BezierSurface);
+}
+
+class XbimAffineModification;
+DEFINE_STANDARD_HANDLE(XbimAffineModification, BRepTools_Modification)
+
+//the modification made by the transform, anything it cannot map exactly marks it as failed and the result is not used
+class XbimAffineModification : public BRepTools_Modification
+{
+private:
+	gp_GTrsf transform;
+	double scale;
+	bool negative;
+	bool failed;
+	NCollection_DataMap<TopoDS_Shape, XbimSurfaceParameterMap, TopTools_ShapeMapHasher> surfaceMaps;
+	NCollection_DataMap<TopoDS_Shape, XbimParameterMap, TopTools_ShapeMapHasher> curveMaps;
+
+	bool SurfaceMap(const TopoDS_Face& face, Handle(Geom_Surface)& surface, XbimSurfaceParameterMap& map)
+	{
+		Handle(Geom_Surface) located = BRep_Tool::Surface(face);
+		if (located.IsNull() || !TransformSurface(located, transform, surface, map)) return false;
+		surfaceMaps.Bind(face, map);
+		return true;
+	}
+
+	bool CurveMap(const TopoDS_Edge& edge, Handle(Geom_Curve)& curve, XbimParameterMap& map)
+	{
+		double first, last;
+		Handle(Geom_Curve) located = BRep_Tool::Curve(edge, first, last);
+		if (located.IsNull() || !TransformCurve(located, transform, curve, map)) return false;
+		curveMaps.Bind(edge, map);
+		return true;
+	}
+
+public:
+	XbimAffineModification(const gp_GTrsf& transform) : transform(transform), failed(false)
+	{
+		const gp_Mat& m = transform.VectorialPart();
+		scale = std::max(m.Column(1).Modulus(), std::max(m.Column(2).Modulus(), m.Column(3).Modulus()));
+		negative = m.Determinant() < 0;
+	}
+
+	bool Failed() const { return failed; }
+
+	virtual Standard_Boolean NewSurface(const TopoDS_Face& F, Handle(Geom_Surface)& S, TopLoc_Location& L, Standard_Real& Tol, Standard_Boolean& RevWires, Standard_Boolean& RevFace) Standard_OVERRIDE
+	{
+		XbimSurfaceParameterMap map;
+		if (!SurfaceMap(F, S, map))
+		{
+			failed = true;
+			return Standard_False;
+		}
+		L.Identity();
+		Tol = BRep_Tool::Tolerance(F) * scale;
+		//the parameters keep their orientation so a mirror turns the surface normal inside out
+		RevWires = Standard_False;
+		RevFace = negative;
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewCurve(const TopoDS_Edge& E, Handle(Geom_Curve)& C, TopLoc_Location& L, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		Tol = BRep_Tool::Tolerance(E) * scale;
+		L.Identity();
+		if (BRep_Tool::Degenerated(E))
+		{
+			C.Nullify(); //it only has curves on its faces
+			return Standard_True;
+		}
+		XbimParameterMap map;
+		if (!CurveMap(E, C, map))
+		{
+			failed = true;
+			return Standard_False;
+		}
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewPoint(const TopoDS_Vertex& V, gp_Pnt& P, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		P = gp_Pnt(TransformedPoint(BRep_Tool::Pnt(V), transform));
+		Tol = BRep_Tool::Tolerance(V) * scale;
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewCurve2d(const TopoDS_Edge& E, const TopoDS_Face& F, const TopoDS_Edge&, const TopoDS_Face&, Handle(Geom2d_Curve)& C, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		Tol = BRep_Tool::Tolerance(E) * scale;
+		XbimSurfaceParameterMap uvMap;
+		XbimParameterMap map;
+		if (!surfaceMaps.Find(F, uvMap))
+		{
+			Handle(Geom_Surface) surface;
+			if (!SurfaceMap(F, surface, uvMap))
+			{
+				failed = true;
+				return Standard_False;
+			}
+		}
+		if (!BRep_Tool::Degenerated(E) && !curveMaps.Find(E, map))
+		{
+			Handle(Geom_Curve) curve;
+			if (!CurveMap(E, curve, map))
+			{
+				failed = true;
+				return Standard_False;
+			}
+		}
+		double first, last;
+		Handle(Geom2d_Curve) pcurve = BRep_Tool::CurveOnSurface(E, F, first, last);
+		if (pcurve.IsNull() || !TransformCurve2d(pcurve, uvMap, map, C))
+		{
+			failed = true;
+			return Standard_False;
+		}
+		return Standard_True;
+	}
+
+	virtual Standard_Boolean NewParameter(const TopoDS_Vertex& V, const TopoDS_Edge& E, Standard_Real& P, Standard_Real& Tol) Standard_OVERRIDE
+	{
+		Tol = BRep_Tool::Tolerance(V) * scale;
+		P = BRep_Tool::Parameter(V, E);
+		if (BRep_Tool::Degenerated(E))
+			return Standard_True;
+		XbimParameterMap map;
+		if (!curveMaps.Find(E, map))
+		{
+			Handle(Geom_Curve) curve;
+			if (!CurveMap(E, curve, map))
+			{
+				failed = true;
+				return Standard_False;
+			}
+		}
+		P = map.Map(P);
+		return Standard_True;
+	}
+
+	virtual GeomAbs_Shape Continuity(const TopoDS_Edge& E, const TopoDS_Face& F1, const TopoDS_Face& F2, const TopoDS_Edge&, const TopoDS_Face&, const TopoDS_Face&) Standard_OVERRIDE
+	{
+		return BRep_Tool::Continuity(E, F1, F2);
+	}
+
+	DEFINE_STANDARD_RTTI_INLINE(XbimAffineModification, BRepTools_Modification)
+};
+
+bool XbimNonUniformTransform::IsSupported(const TopoDS_Shape& shape, const gp_GTrsf& transform)
+{
+	if (std::abs(transform.VectorialPart().Determinant()) <= AffineEpsilon)
+		return false;
+	for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next())
+	{
+		Handle(Geom_Surface) surface = BRep_Tool::Surface(TopoDS::Face(faceExp.Current()));
+		if (surface.IsNull() || !IsSupportedSurface(surface))
+			return false;
+	}
+	for (TopExp_Explorer edgeExp(shape, TopAbs_EDGE); edgeExp.More(); edgeExp.Next())
+	{
+		const TopoDS_Edge& edge = TopoDS::Edge(edgeExp.Current());
+		if (BRep_Tool::Degenerated(edge))
+			continue;
+		double first, last;
+		Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
+		if (curve.IsNull() || !IsSupportedCurve(curve))
+			return false;
+	}
+	return true;
+}
+
+TopoDS_Shape XbimNonUniformTransform::Transform(const TopoDS_Shape& shape, const gp_GTrsf& transform)
+{
+	if (IsSupported(shape, transform))
+	{
+		try
+		{
+			Handle(XbimAffineModification) modification = new XbimAffineModification(transform);
+			BRepTools_Modifier modifier(shape, modification);
+			if (modifier.IsDone() && !modification->Failed())
+				return modifier.ModifiedShape(shape);
+		}
+		catch (Standard_Failure)
+		{
+			//fall through to the general transform
+		}
+	}
+	BRepBuilderAPI_GTransform gTran(shape, transform, Standard_True);
+	return gTran.Shape();
+}
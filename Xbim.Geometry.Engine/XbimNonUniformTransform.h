@@ -0,0 +1,19 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include <gp_GTrsf.hxx>
+
+//Applies a non-uniform scale, or any other affine transform, to a shape without turning its geometry in to B-splines as
+//BRepBuilderAPI_GTransform does. Vertices are moved, planes stay planes and lines stay lines, so faceted shapes keep all their
+//analytic geometry. Circles become ellipses and cylinders become extrusions of an ellipse, or cylinders again where the scale
+//leaves them round. B-spline and Bezier geometry has its poles transformed. The parameters of every new curve and surface are
+//an affine function of the old ones, so the curves on faces carry over exactly. Shapes with any other geometry, e.g. spheres,
+//cones or surfaces of revolution, are left to BRepBuilderAPI_GTransform
+class XbimNonUniformTransform
+{
+private:
+	//true if every surface and curve of the shape has an exact image of the same kind under an affine transform
+	static bool IsSupported(const TopoDS_Shape& shape, const gp_GTrsf& transform);
+public:
+	//returns a transformed copy of the shape, throws Standard_Failure as BRepBuilderAPI_GTransform does
+	static TopoDS_Shape Transform(const TopoDS_Shape& shape, const gp_GTrsf& transform);
+};
@@ -24,6 +24,10 @@
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <BRepBuilderAPI_Transform.hxx>
 #include <Geom_Plane.hxx>
+#include <TopoDS_Iterator.hxx>
+#include "XbimPolygonTriangulator.h"
+#include "XbimMeshingPolicy.h"
+#include "XbimTextMeshEncoder.h"
 
 using namespace System::Threading;
 using namespace System::Collections::Generic;
@@ -37,6 +41,14 @@ namespace Xbim
 		{
 		}
 
+		//passes the text encoded so far on to the writer, the encoded text is ASCII
+		static void WriteEncoded(XbimTextMeshEncoder& encoder, TextWriter^ textWriter)
+		{
+			if (encoder.Size() == 0) return;
+			textWriter->Write(gcnew String(const_cast<char*>(encoder.Data()), 0, (int)encoder.Size()));
+			encoder.Clear();
+		}
+
 
 
 		void XbimOccShape::WriteTriangulation(TextWriter^ textWriter, double tolerance, double deflection, double angle)
@@ -50,7 +62,8 @@ namespace Xbim
 			Monitor::Enter(this);
 			try
 			{
-				BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time				
+				TopoDS_Shape meshed = XbimMeshingPolicy::Mesh(this, deflection, angle); //triangulate the first time
+				if (!meshed.IsSame(this)) faces = gcnew XbimFaceSet(meshed); //a coarser mesh was made on a copy
 			}
 			finally
 			{
@@ -133,15 +146,27 @@ namespace Xbim
 				writtenFaces->Add(face);
 				faceIndex++;
 			}
+			//the tokens are formatted natively and passed to the writer a block at a time
+			std::string newLine;
+			for each (Char c in textWriter->NewLine) newLine.push_back((char)c);
+			XbimTextMeshEncoder encoder(newLine);
 			// Write out header
-			textWriter->WriteLine(String::Format("P {0} {1} {2} {3} {4}", 1, points->Count, faces->Count, triangleCount, normals->Count));
+			encoder.Header(1, points->Count, faces->Count, triangleCount, normals->Count);
 			//write out vertices and normals  
-			textWriter->Write("V");
-			for each (XbimPoint3D p in points) textWriter->Write(String::Format(" {0},{1},{2}", p.X, p.Y, p.Z));
-			textWriter->WriteLine();
-			textWriter->Write("N");
-			for each (XbimVector3D n in normals) textWriter->Write(String::Format(" {0},{1},{2}", n.X, n.Y, n.Z));
-			textWriter->WriteLine();
+			encoder.BeginLine('V');
+			for each (XbimPoint3D p in points)
+			{
+				encoder.Triple(p.X, p.Y, p.Z);
+				if (encoder.IsFull()) WriteEncoded(encoder, textWriter);
+			}
+			encoder.EndLine();
+			encoder.BeginLine('N');
+			for each (XbimVector3D n in normals)
+			{
+				encoder.Triple(n.X, n.Y, n.Z);
+				if (encoder.IsFull()) WriteEncoded(encoder, textWriter);
+			}
+			encoder.EndLine();
 
 			//now write out the faces
 			faceIndex = 0;
@@ -149,7 +174,7 @@ namespace Xbim
 			{
 				bool isPlanar = face->IsPlanar;
 				List<size_t>^ norms = normalLookup[faceIndex];
-				textWriter->Write("T");
+				encoder.BeginLine('T');
 				List<size_t>^ nodeLookup = pointLookup[faceIndex];
 				TopLoc_Location loc;
 				const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(face, loc);
@@ -166,15 +191,17 @@ namespace Xbim
 						triangles(i).Get(t[0], t[1], t[2]);
 					if (isPlanar)
 						if (i == 1)
-							textWriter->Write(String::Format(" {0}/{3},{1},{2}", nodeLookup[t[0] - 1], nodeLookup[t[1] - 1], nodeLookup[t[2] - 1], norms[0]));
+							encoder.Triangle(nodeLookup[t[0] - 1], nodeLookup[t[1] - 1], nodeLookup[t[2] - 1], norms[0]);
 						else
-							textWriter->Write(String::Format(" {0},{1},{2}", nodeLookup[t[0] - 1], nodeLookup[t[1] - 1], nodeLookup[t[2] - 1]));
+							encoder.Triangle(nodeLookup[t[0] - 1], nodeLookup[t[1] - 1], nodeLookup[t[2] - 1]);
 					else //need to write every one
-						textWriter->Write(String::Format(" {0}/{3},{1}/{4},{2}/{5}", nodeLookup[t[0] - 1], nodeLookup[t[1] - 1], nodeLookup[t[2] - 1], norms[t[0] - 1], norms[t[1] - 1], norms[t[2] - 1]));
+						encoder.Triangle(nodeLookup[t[0] - 1], norms[t[0] - 1], nodeLookup[t[1] - 1], norms[t[1] - 1], nodeLookup[t[2] - 1], norms[t[2] - 1]);
+					if (encoder.IsFull()) WriteEncoded(encoder, textWriter);
 				}
 				faceIndex++;
-				textWriter->WriteLine();
+				encoder.EndLine();
 			}
+			WriteEncoded(encoder, textWriter);
 			textWriter->Flush();
 			GC::KeepAlive(this);
 		}
@@ -187,7 +214,7 @@ namespace Xbim
 				try
 				{
 					Monitor::Enter(this);
-					BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time	
+					XbimMeshingPolicy::Mesh(this, deflection, angle); //triangulate the first time
 				}
 				finally
 				{
@@ -196,7 +223,7 @@ namespace Xbim
 				return;
 			}
 			TopTools_IndexedMapOfShape faceMap;
-			TopoDS_Shape shape = this; //hold on to it
+			TopoDS_Shape shape = XbimMeshingPolicy::Mesh(this, deflection, angle); //triangulate the first time, hold on to it
 			TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
 			int faceCount = faceMap.Extent();
 			if (faceCount == 0) return;
@@ -215,8 +242,6 @@ namespace Xbim
 				}
 			}
 
-			BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time		
-
 
 			for (int f = 1; f <= faceMap.Extent(); f++)
 			{
@@ -408,7 +433,16 @@ namespace Xbim
 			}
 
 			if (!isPolyhedron)
-				BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time							
+			{
+				TopoDS_Shape meshed = XbimMeshingPolicy::Mesh(shape, deflection, angle); //triangulate the first time
+				if (!meshed.IsSame(shape)) //a coarser mesh was made on a copy, its faces are in the same order
+				{
+					shape = meshed;
+					faceMap.Clear();
+					TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+				}
+			}
+			XbimPolygonTriangulator triangulator; //reused for every planar face
 			for (int f = 1; f <= faceMap.Extent(); f++)
 			{
 				const TopoDS_Face& face = TopoDS::Face(faceMap(f));
@@ -417,7 +451,6 @@ namespace Xbim
 				bool isPlanar = !plane.IsNull();
 				//bool isFaceWithCurve = isCurveFace[f - 1];
 				List<XbimPackedNormal>^ norms;
-				Tess^ tess = gcnew Tess();
 				if (!isPolyhedron)
 				{
 					TopLoc_Location loc;
@@ -505,75 +538,65 @@ namespace Xbim
 					faceIndex++;
 
 				}
-				else //it is planar we can use LibMeshDotNet
+				else //it is planar, triangulate the loops of the face natively
 				{
 					//need to consider whoch side is front annd back
 					gp_Dir faceNormal = faceReversed ? plane->Axis().Direction().Reversed() : plane->Axis().Direction();
 					XbimPackedNormal packedNormal = XbimPackedNormal(faceNormal.X(), faceNormal.Y(), faceNormal.Z());
 					norms = gcnew List<XbimPackedNormal>(1);
-					TopTools_IndexedMapOfShape wireMap;
-					TopExp::MapShapes(face, TopAbs_WIRE, wireMap);
-					if (wireMap.Extent() == 1) //just one loop, it is the outer
+					triangulator.BeginPolygon(faceNormal);
+					for (TopoDS_Iterator wireIt(face); wireIt.More(); wireIt.Next())
 					{
-						TopoDS_Wire outerWire = TopoDS::Wire(wireMap(1));
-						int numberEdges = outerWire.NbChildren();
-						if (numberEdges > 2)
-						{
-							array<ContourVertex>^ outerContour = gcnew array<ContourVertex>(numberEdges);
-							BRepTools_WireExplorer exp(outerWire, face);
-							for (int j = 0; exp.More(); exp.Next())
-							{
-								gp_Pnt p = BRep_Tool::Pnt(exp.CurrentVertex());
-								outerContour[j].Position.X = p.X();
-								outerContour[j].Position.Y = p.Y();
-								outerContour[j].Position.Z = p.Z();
-								j++;
-							}
-							tess->AddContour(outerContour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
-						}
-
+						if (wireIt.Value().ShapeType() != TopAbs_WIRE || wireIt.Value().NbChildren() < 3)
+							continue;
+						triangulator.BeginLoop();
+						//the winding of the loops does not matter, the largest is the outer and triangles are wound about the face normal
+						for (BRepTools_WireExplorer exp(TopoDS::Wire(wireIt.Value()), face); exp.More(); exp.Next())
+							triangulator.AddPoint(BRep_Tool::Pnt(exp.CurrentVertex()));
 					}
-					else
+					int numTriangles = triangulator.Triangulate();
+					if (!triangulator.CoversPolygon())
 					{
-						for (int i = 1; i <= wireMap.Extent(); i++)
+						//the loops cross or touch, LibTess splits them where they meet
+						Tess^ tess = gcnew Tess();
+						for (int l = 0; l < triangulator.NbLoops(); l++)
 						{
-							TopoDS_Wire ccWire = TopoDS::Wire(wireMap(i));
-
-							int numberOfEdges = ccWire.NbChildren();
-							if (numberOfEdges > 2)
+							int start = triangulator.LoopStart(l);
+							int end = triangulator.LoopEnd(l);
+							if (end - start < 3)
+								continue;
+							array<ContourVertex>^ contour = gcnew array<ContourVertex>(end - start);
+							for (int j = start; j < end; j++)
 							{
-								array<ContourVertex>^ contour = gcnew array<ContourVertex>(numberOfEdges);
-								BRepTools_WireExplorer exp(ccWire, face);
-								for (int j = 0; exp.More(); exp.Next())
-								{
-									gp_Pnt p = BRep_Tool::Pnt(exp.CurrentVertex());
-									contour[j].Position.X = p.X();
-									contour[j].Position.Y = p.Y();
-									contour[j].Position.Z = p.Z();
-									j++;
-								}
-								tess->AddContour(contour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
+								const gp_Pnt& p = triangulator.Point(j);
+								contour[j - start].Position.X = p.X();
+								contour[j - start].Position.Y = p.Y();
+								contour[j - start].Position.Z = p.Z();
 							}
+							tess->AddContour(contour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
 						}
+						tess->Tessellate(Xbim::Tessellator::WindingRule::EvenOdd, Xbim::Tessellator::ElementType::Polygons, 3);
+						triangulator.BeginPolygon(faceNormal);
+						array<ContourVertex>^ contourVerts = tess->Vertices;
+						for (int i = 0; i < tess->VertexCount; i++)
+							triangulator.AddPoint(gp_Pnt(contourVerts[i].Position.X, contourVerts[i].Position.Y, contourVerts[i].Position.Z));
+						array<int>^ tessElements = tess->Elements;
+						for (int j = 0; j < tess->ElementCount; j++)
+							triangulator.AddTriangle(tessElements[j * 3], tessElements[j * 3 + 1], tessElements[j * 3 + 2]);
+						numTriangles = tess->ElementCount;
 					}
-					tess->Tessellate(Xbim::Tessellator::WindingRule::EvenOdd, Xbim::Tessellator::ElementType::Polygons, 3);
-					if (tess->ElementCount > 0) //we have some triangles
+					if (numTriangles > 0) //we have some triangles
 					{
-						int numTriangles = tess->ElementCount;
 						triangleCount += numTriangles;
-						array<ContourVertex>^ contourVerts = tess->Vertices;
-						array<int>^ elements = tess->Elements;
-						pointLookup->Add(gcnew List<int>(tess->VertexCount));
-						/*System::Diagnostics::Debug::Assert(Math::Abs(nor[0] - faceNormal.X()) < 1e-3);
-						System::Diagnostics::Debug::Assert(Math::Abs(nor[1] - faceNormal.Y()) < 1e-3);
-						System::Diagnostics::Debug::Assert(Math::Abs(nor[2] - faceNormal.Z()) < 1e-3);*/
+						const std::vector<int>& elements = triangulator.Triangles();
+						pointLookup->Add(gcnew List<int>(triangulator.NbPoints()));
 						norms->Add(packedNormal);
 						normalLookup->Add(norms);
-						for (int i = 0; i < tess->VertexCount; i++) //visit each node for vertices
+						for (int i = 0; i < triangulator.NbPoints(); i++) //visit each node for vertices
 						{
-							Vec3 p = contourVerts[i].Position;
+							const gp_Pnt& p = triangulator.Point(i);
 							int index;
-							XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p.X, p.Y, p.Z, tolerance);
+							XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p.X(), p.Y(), p.Z(), tolerance);
 							if (!pointMap->TryGetValue(pt, index))
 							{
 								index = points->Count;
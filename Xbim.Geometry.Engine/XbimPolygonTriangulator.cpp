@@ -0,0 +1,367 @@
+#include "XbimPolygonTriangulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void XbimPolygonTriangulator::BeginPolygon(const gp_Dir& faceNormal)
+{
+	normal = faceNormal;
+	points.clear();
+	loopStarts.clear();
+	nodes.clear();
+	holes.clear();
+	triangles.clear();
+	coversPolygon = false;
+}
+
+void XbimPolygonTriangulator::BeginLoop()
+{
+	loopStarts.push_back((int)points.size());
+}
+
+void XbimPolygonTriangulator::AddPoint(const gp_Pnt& point)
+{
+	points.push_back(point);
+}
+
+double XbimPolygonTriangulator::Area2(int a, int b, int c) const
+{
+	const Node& na = nodes[a];
+	const Node& nb = nodes[b];
+	const Node& nc = nodes[c];
+	return (nb.X - na.X) * (nc.Y - na.Y) - (nb.Y - na.Y) * (nc.X - na.X);
+}
+
+bool XbimPolygonTriangulator::PointInTriangle(int a, int b, int c, int p) const
+{
+	return Area2(a, b, p) >= -epsilon && Area2(b, c, p) >= -epsilon && Area2(c, a, p) >= -epsilon;
+}
+
+bool XbimPolygonTriangulator::IsReflex(int node) const
+{
+	return Area2(nodes[node].Prev, node, nodes[node].Next) <= epsilon;
+}
+
+bool XbimPolygonTriangulator::IsEar(int ear) const
+{
+	int a = nodes[ear].Prev;
+	int c = nodes[ear].Next;
+	if (Area2(a, ear, c) <= epsilon)
+		return false; //reflex or degenerate
+	//only a reflex vertex can be inside a convex ear, vertices at the corners are bridge duplicates and do not count
+	for (int p = nodes[c].Next; p != a; p = nodes[p].Next)
+	{
+		const Node& np = nodes[p];
+		if ((np.X == nodes[a].X && np.Y == nodes[a].Y) ||
+			(np.X == nodes[ear].X && np.Y == nodes[ear].Y) ||
+			(np.X == nodes[c].X && np.Y == nodes[c].Y))
+			continue;
+		if (IsReflex(p) && PointInTriangle(a, ear, c, p))
+			return false;
+	}
+	return true;
+}
+
+double XbimPolygonTriangulator::SignedArea(int start, int end) const
+{
+	double area = 0;
+	for (int i = start, j = end - 1; i < end; j = i++)
+		area += (nodes[j].X - nodes[i].X) * (nodes[j].Y + nodes[i].Y);
+	return area / 2;
+}
+
+double XbimPolygonTriangulator::RingArea(int start) const
+{
+	double area = 0;
+	int i = start;
+	do
+	{
+		int j = nodes[i].Prev;
+		area += (nodes[j].X - nodes[i].X) * (nodes[j].Y + nodes[i].Y);
+		i = nodes[i].Next;
+	} while (i != start);
+	return area / 2;
+}
+
+//links nodes start..end-1 in to a ring in the requested direction and returns the first node
+int XbimPolygonTriangulator::LinkLoop(int start, int end, bool anticlockwise)
+{
+	bool reverse = (SignedArea(start, end) > 0) != anticlockwise;
+	int count = end - start;
+	for (int i = 0; i < count; i++)
+	{
+		int n = start + i;
+		int prev = start + (i + count - 1) % count;
+		int next = start + (i + 1) % count;
+		nodes[n].Prev = reverse ? next : prev;
+		nodes[n].Next = reverse ? prev : next;
+	}
+	return start;
+}
+
+void XbimPolygonTriangulator::Remove(int node)
+{
+	nodes[nodes[node].Prev].Next = nodes[node].Next;
+	nodes[nodes[node].Next].Prev = nodes[node].Prev;
+}
+
+//removes repeated points and vertices on a straight line, returns a node still in the ring or -1 if it collapses
+int XbimPolygonTriangulator::RemoveDegenerate(int start)
+{
+	int p = start;
+	int end = start;
+	int remaining = 0;
+	for (int q = nodes[start].Next; q != start; q = nodes[q].Next)
+		remaining++;
+	remaining++;
+	bool again;
+	do
+	{
+		if (remaining < 3)
+			return -1;
+		again = false;
+		const Node& np = nodes[p];
+		const Node& nn = nodes[np.Next];
+		if ((np.X == nn.X && np.Y == nn.Y) || std::abs(Area2(np.Prev, p, np.Next)) <= epsilon)
+		{
+			//step back, removing the node can make its neighbour degenerate, and go round again from there
+			int prev = np.Prev;
+			Remove(p);
+			remaining--;
+			p = end = prev;
+			again = true;
+		}
+		else
+			p = np.Next;
+	} while (again || p != end);
+	return remaining < 3 ? -1 : end;
+}
+
+//the hole is joined to the outer ring by a pair of coincident edges, using the point of the outer ring visible
+//from the rightmost point of the hole (Eberly, Triangulation by Ear Clipping)
+int XbimPolygonTriangulator::FindBridge(int hole, int outer) const
+{
+	const Node& h = nodes[hole];
+	double hx = h.X, hy = h.Y;
+	double qx = std::numeric_limits<double>::infinity();
+	int m = -1;
+	int p = outer;
+	do
+	{
+		const Node& np = nodes[p];
+		const Node& nn = nodes[np.Next];
+		//edges going up, on the right of the hole, face it
+		if (np.Y <= hy && hy <= nn.Y && nn.Y != np.Y)
+		{
+			double x = np.X + (hy - np.Y) * (nn.X - np.X) / (nn.Y - np.Y);
+			if (x >= hx && x < qx)
+			{
+				qx = x;
+				if (x == hx)
+					return hy == np.Y ? p : (hy == nn.Y ? np.Next : (np.X > nn.X ? p : np.Next));
+				m = np.X > nn.X ? p : np.Next;
+			}
+		}
+		p = np.Next;
+	} while (p != outer);
+	if (m < 0)
+		return -1;
+	if (qx == nodes[m].X && hy == nodes[m].Y)
+		return m; //the ray hits a vertex
+	//any reflex vertex inside the triangle hole, ray hit, m hides m, take the one closest in angle to the ray
+	double mx = nodes[m].X, my = nodes[m].Y;
+	double tanMin = std::numeric_limits<double>::infinity();
+	int best = m;
+	p = nodes[m].Next;
+	while (p != m)
+	{
+		const Node& np = nodes[p];
+		if (np.X >= hx && np.X <= mx && np.X != hx)
+		{
+			//inside the triangle (hx,hy) (qx,hy) (mx,my), either side of the ray
+			double ax = hx, ay = hy, bx = qx, by = hy, cx = mx, cy = my;
+			double d1 = (bx - ax) * (np.Y - ay) - (by - ay) * (np.X - ax);
+			double d2 = (cx - bx) * (np.Y - by) - (cy - by) * (np.X - bx);
+			double d3 = (ax - cx) * (np.Y - cy) - (ay - cy) * (np.X - cx);
+			bool inside = (d1 >= 0 && d2 >= 0 && d3 >= 0) || (d1 <= 0 && d2 <= 0 && d3 <= 0);
+			if (inside && IsReflex(p))
+			{
+				double tan = std::abs(hy - np.Y) / (np.X - hx);
+				if (tan < tanMin || (tan == tanMin && np.X < nodes[best].X))
+				{
+					tanMin = tan;
+					best = p;
+				}
+			}
+		}
+		p = np.Next;
+	}
+	return best;
+}
+
+//splices the hole in to the outer ring, outerNode and holeNode are duplicated to close the bridge
+int XbimPolygonTriangulator::Bridge(int outerNode, int holeNode)
+{
+	int outerCopy = (int)nodes.size();
+	nodes.push_back(nodes[outerNode]);
+	int holeCopy = (int)nodes.size();
+	nodes.push_back(nodes[holeNode]);
+	int outerNext = nodes[outerNode].Next;
+	int holePrev = nodes[holeNode].Prev;
+
+	nodes[outerNode].Next = holeNode;
+	nodes[holeNode].Prev = outerNode;
+
+	nodes[holePrev].Next = holeCopy;
+	nodes[holeCopy].Prev = holePrev;
+	nodes[holeCopy].Next = outerCopy;
+	nodes[outerCopy].Prev = holeCopy;
+	nodes[outerCopy].Next = outerNext;
+	nodes[outerNext].Prev = outerCopy;
+	return outerNode;
+}
+
+void XbimPolygonTriangulator::ClipEars(int start)
+{
+	int ear = start;
+	int stop = ear;
+	int pass = 0;
+	while (nodes[ear].Prev != nodes[ear].Next)
+	{
+		int prev = nodes[ear].Prev;
+		int next = nodes[ear].Next;
+		if (IsEar(ear) || (pass == 2 && Area2(prev, ear, next) > epsilon))
+		{
+			triangles.push_back(nodes[prev].Index);
+			triangles.push_back(nodes[ear].Index);
+			triangles.push_back(nodes[next].Index);
+			Remove(ear);
+			ear = nodes[next].Next;
+			stop = ear;
+			pass = 0; //clipping can leave new repeated or collinear points, clean up again if it stalls
+			continue;
+		}
+		ear = next;
+		if (ear == stop) //a full turn without an ear
+		{
+			if (pass == 0)
+			{
+				//clean up the ring, collinear points left by bridging or in the input block the ears
+				ear = RemoveDegenerate(ear);
+				if (ear < 0)
+					return;
+				pass = 1;
+			}
+			else if (pass == 1)
+				pass = 2; //the loops intersect, clip any convex corner to cover as much as possible
+			else
+				return;
+			stop = ear;
+		}
+	}
+}
+
+int XbimPolygonTriangulator::Triangulate()
+{
+	triangles.clear();
+	coversPolygon = false;
+	if (points.size() < 3 || loopStarts.empty())
+		return 0;
+	//project on to the plane dropping the largest component of the normal, the axes are chosen so the normal points up
+	double nx = normal.X(), ny = normal.Y(), nz = normal.Z();
+	double ax = std::abs(nx), ay = std::abs(ny), az = std::abs(nz);
+	int u, v;
+	if (az >= ax && az >= ay)
+	{
+		u = nz > 0 ? 0 : 1; v = nz > 0 ? 1 : 0;
+	}
+	else if (ax >= ay)
+	{
+		u = nx > 0 ? 1 : 2; v = nx > 0 ? 2 : 1;
+	}
+	else
+	{
+		u = ny > 0 ? 2 : 0; v = ny > 0 ? 0 : 2;
+	}
+	nodes.resize(points.size());
+	double minX = std::numeric_limits<double>::max(), minY = minX;
+	double maxX = -minX, maxY = -minX;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		Node& n = nodes[i];
+		n.Index = (int)i;
+		n.X = points[i].Coord(u + 1);
+		n.Y = points[i].Coord(v + 1);
+		minX = std::min(minX, n.X); maxX = std::max(maxX, n.X);
+		minY = std::min(minY, n.Y); maxY = std::max(maxY, n.Y);
+	}
+	double size = std::max(maxX - minX, maxY - minY);
+	epsilon = size * size * 1e-14;
+
+	//the largest loop is the outer
+	int loopCount = (int)loopStarts.size();
+	int outerLoop = -1;
+	double outerArea = 0;
+	for (int l = 0; l < loopCount; l++)
+	{
+		int start = loopStarts[l];
+		int end = l + 1 < loopCount ? loopStarts[l + 1] : (int)points.size();
+		if (end - start < 3)
+			continue;
+		double area = std::abs(SignedArea(start, end));
+		if (area > outerArea)
+		{
+			outerArea = area;
+			outerLoop = l;
+		}
+	}
+	if (outerLoop < 0)
+		return 0;
+	int outer = -1;
+	holes.clear();
+	for (int l = 0; l < loopCount; l++)
+	{
+		int start = loopStarts[l];
+		int end = l + 1 < loopCount ? loopStarts[l + 1] : (int)points.size();
+		if (end - start < 3)
+			continue;
+		if (l == outerLoop)
+			outer = LinkLoop(start, end, true);
+		else
+		{
+			//holes are wound clockwise and bridged from their rightmost point
+			LinkLoop(start, end, false);
+			int rightmost = start;
+			for (int i = start + 1; i < end; i++)
+				if (nodes[i].X > nodes[rightmost].X || (nodes[i].X == nodes[rightmost].X && nodes[i].Y < nodes[rightmost].Y))
+					rightmost = i;
+			holes.push_back(rightmost);
+		}
+	}
+	//bridge the holes furthest right first so later bridges cannot cross them
+	std::sort(holes.begin(), holes.end(), [this](int a, int b) { return nodes[a].X > nodes[b].X; });
+	polygonArea = outerArea;
+	for (int hole : holes)
+	{
+		int bridge = FindBridge(hole, outer);
+		if (bridge >= 0) //a hole not inside the outer loop is ignored
+		{
+			polygonArea -= std::abs(RingArea(hole));
+			outer = Bridge(bridge, hole);
+		}
+	}
+	ClipEars(outer);
+	//the triangles must cover the outer loop less its holes, any difference means loops that cross or touch were clipped
+	double covered = 0;
+	for (size_t t = 0; t < triangles.size(); t += 3)
+		covered += Area2(triangles[t], triangles[t + 1], triangles[t + 2]) / 2;
+	coversPolygon = std::abs(covered - polygonArea) <= polygonArea * 1e-6;
+	return (int)triangles.size() / 3;
+}
+
+void XbimPolygonTriangulator::AddTriangle(int a, int b, int c)
+{
+	triangles.push_back(a);
+	triangles.push_back(b);
+	triangles.push_back(c);
+}
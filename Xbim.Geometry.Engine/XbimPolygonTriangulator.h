@@ -0,0 +1,62 @@
+#pragma once
+#include <gp_Pnt.hxx>
+#include <gp_Dir.hxx>
+#include <vector>
+
+//Triangulates planar polygons with holes by ear clipping, holes are bridged in to the outer loop first.
+//The loop with the largest area is the outer, all other loops are holes. Triangles are wound anticlockwise
+//about the normal given to BeginPolygon. Buffers are kept between polygons so one instance should be reused
+//for all the faces of a shape, nothing is allocated once they have grown to the largest face
+class XbimPolygonTriangulator
+{
+private:
+	struct Node
+	{
+		int Index; //index of the point
+		double X;
+		double Y;
+		int Prev;
+		int Next;
+	};
+	std::vector<gp_Pnt> points;
+	std::vector<int> loopStarts;
+	std::vector<Node> nodes;
+	std::vector<int> holes;
+	std::vector<int> triangles;
+	gp_Dir normal;
+	double epsilon;
+	double polygonArea;
+	bool coversPolygon;
+
+	double Area2(int a, int b, int c) const;
+	bool PointInTriangle(int a, int b, int c, int p) const;
+	bool IsEar(int ear) const;
+	bool IsReflex(int node) const;
+	int LinkLoop(int start, int end, bool anticlockwise);
+	double SignedArea(int start, int end) const;
+	double RingArea(int start) const;
+	int FindBridge(int hole, int outer) const;
+	int Bridge(int outerNode, int holeNode);
+	int RemoveDegenerate(int start);
+	void Remove(int node);
+	void ClipEars(int start);
+public:
+	//starts a new polygon, the normal gives the side the triangles face
+	void BeginPolygon(const gp_Dir& faceNormal);
+	void BeginLoop();
+	void AddPoint(const gp_Pnt& point);
+	//triangulates the polygon and returns the number of triangles
+	int Triangulate();
+	int NbPoints() const { return (int)points.size(); }
+	const gp_Pnt& Point(int i) const { return points[i]; }
+	//three point indices per triangle
+	const std::vector<int>& Triangles() const { return triangles; }
+	//false if the area of the triangles is not that of the outer loop less its holes, the loops cross or touch and the
+	//polygon should be tessellated another way
+	bool CoversPolygon() const { return coversPolygon; }
+	int NbLoops() const { return (int)loopStarts.size(); }
+	int LoopStart(int loop) const { return loopStarts[loop]; }
+	int LoopEnd(int loop) const { return loop + 1 < (int)loopStarts.size() ? loopStarts[loop + 1] : (int)points.size(); }
+	//adds a triangle made elsewhere, for points added after BeginPolygon that are not triangulated by Triangulate
+	void AddTriangle(int a, int b, int c);
+};
@@ -0,0 +1,160 @@
+#include "XbimShapeOrientation.h"
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <gp_Pln.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <algorithm>
+#include <cmath>
+
+double XbimShapeOrientation::AmbiguousFraction = 0.01;
+
+//segments a curved edge is divided in to, the sign of the volume does not need more
+static const int CurveSegments = 16;
+//linear deflection, relative to the size of each edge, of the triangulation made for curved faces that have none
+static const double CoarseDeflection = 0.5;
+
+bool XbimShapeOrientation::PlanarVolume(const TopoDS_Shape& face, const gp_XYZ& origin, double& volume)
+{
+	//twice the vector area of the face is the sum of a x b over its oriented edges, holes are traversed the other way and
+	//subtract, the order the edges are visited in does not matter
+	bool exact = true;
+	gp_XYZ area(0, 0, 0);
+	for (TopExp_Explorer edgeExp(face, TopAbs_EDGE); edgeExp.More(); edgeExp.Next())
+	{
+		const TopoDS_Edge& edge = TopoDS::Edge(edgeExp.Current());
+		if (BRep_Tool::Degenerated(edge))
+			continue;
+		BRepAdaptor_Curve curve(edge);
+		if (curve.GetType() == GeomAbs_Line)
+		{
+			TopoDS_Vertex first = TopExp::FirstVertex(edge, Standard_True);
+			TopoDS_Vertex last = TopExp::LastVertex(edge, Standard_True);
+			if (first.IsNull() || last.IsNull())
+				continue;
+			area += (BRep_Tool::Pnt(first).XYZ() - origin).Crossed(BRep_Tool::Pnt(last).XYZ() - origin);
+		}
+		else
+		{
+			exact = false;
+			double start = curve.FirstParameter(), end = curve.LastParameter();
+			if (edge.Orientation() == TopAbs_REVERSED)
+				std::swap(start, end);
+			gp_XYZ previous = curve.Value(start).XYZ() - origin;
+			for (int i = 1; i <= CurveSegments; i++)
+			{
+				gp_XYZ next = curve.Value(start + (end - start) * i / CurveSegments).XYZ() - origin;
+				area += previous.Crossed(next);
+				previous = next;
+			}
+		}
+	}
+	//any point of the plane gives its distance along the area vector
+	BRepAdaptor_Surface surface(TopoDS::Face(face), Standard_False);
+	volume = (surface.Plane().Location().XYZ() - origin).Dot(area);
+	return exact;
+}
+
+bool XbimShapeOrientation::TriangulatedVolume(const TopoDS_Shape& face, const gp_XYZ& origin, double& volume)
+{
+	TopLoc_Location loc;
+	const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(TopoDS::Face(face), loc);
+	if (mesh.IsNull())
+		return false;
+	const gp_Trsf& trsf = loc.Transformation();
+	bool reversed = face.Orientation() == TopAbs_REVERSED;
+	const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+	const Poly_Array1OfTriangle& triangles = mesh->Triangles();
+	volume = 0;
+	for (int i = 1; i <= mesh->NbTriangles(); i++)
+	{
+		int n1, n2, n3;
+		if (reversed)
+			triangles(i).Get(n1, n3, n2);
+		else
+			triangles(i).Get(n1, n2, n3);
+		gp_XYZ a = nodes(n1).Transformed(trsf).XYZ() - origin;
+		gp_XYZ b = nodes(n2).Transformed(trsf).XYZ() - origin;
+		gp_XYZ c = nodes(n3).Transformed(trsf).XYZ() - origin;
+		volume += a.Dot(b.Crossed(c));
+	}
+	return true;
+}
+
+bool XbimShapeOrientation::ClassifyInsideOut(const TopoDS_Shape& shape)
+{
+	BRepClass3d_SolidClassifier class3d(shape);
+	class3d.PerformInfinitePoint(Precision::Confusion());
+	return class3d.State() == TopAbs_IN;
+}
+
+bool XbimShapeOrientation::SignedVolume(const TopoDS_Shape& shape, const gp_XYZ& origin, double& volume, double& magnitude, bool& exact)
+{
+	exact = true;
+	volume = 0;
+	magnitude = 0;
+	for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next())
+	{
+		const TopoDS_Shape& face = faceExp.Current();
+		double faceVolume;
+		BRepAdaptor_Surface surface(TopoDS::Face(face), Standard_False);
+		if (surface.GetType() == GeomAbs_Plane)
+		{
+			if (!PlanarVolume(face, origin, faceVolume))
+				exact = false;
+		}
+		else
+		{
+			exact = false;
+			if (!TriangulatedVolume(face, origin, faceVolume))
+				return false;
+		}
+		volume += faceVolume;
+		magnitude += std::abs(faceVolume);
+	}
+	return true;
+}
+
+bool XbimShapeOrientation::IsInsideOut(const TopoDS_Shape& shape)
+{
+	//the terms are taken about a vertex of the shape so that large coordinates do not swamp them
+	TopExp_Explorer vertexExp(shape, TopAbs_VERTEX);
+	if (!vertexExp.More())
+		return false;
+	gp_XYZ origin = BRep_Tool::Pnt(TopoDS::Vertex(vertexExp.Current())).XYZ();
+
+	bool exact;
+	double volume;
+	double magnitude;
+	if (!SignedVolume(shape, origin, volume, magnitude, exact))
+	{
+		//a curved face has no triangulation, the coarse one is made on a copy of the topology, the faces of the shape may be
+		//shared with other threads and are meshed later at the deflection the caller asks for
+		try
+		{
+			BRepBuilderAPI_Copy copier(shape, Standard_False);
+			TopoDS_Shape copy = copier.Shape();
+			BRepMesh_IncrementalMesh incrementalMesh(copy, CoarseDeflection, Standard_True);
+			if (!SignedVolume(copy, origin, volume, magnitude, exact))
+				return ClassifyInsideOut(shape);
+		}
+		catch (Standard_Failure)
+		{
+			return ClassifyInsideOut(shape);
+		}
+	}
+	if (exact || std::abs(volume) > AmbiguousFraction * magnitude)
+		return volume < 0;
+	return ClassifyInsideOut(shape);
+}
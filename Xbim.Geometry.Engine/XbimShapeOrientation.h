@@ -0,0 +1,26 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include <gp_XYZ.hxx>
+
+//Decides whether a closed shell or solid is inside out from the sign of the volume it encloses. By the divergence theorem the
+//volume is the sum over the faces of a third of the distance of the plane of the face from an origin times its area, so a
+//faceted shape is decided exactly by one pass over its edges. Curved edges are sampled and curved faces summed from their
+//triangulation, a coarse one is made on a copy of the shape if they have none so the shape itself is never meshed. Only
+//when the shape has such approximated faces and the volume is small compared to the sum of the face terms is
+//BRepClass3d_SolidClassifier asked, which casts rays against every face
+class XbimShapeOrientation
+{
+private:
+	//contribution of a planar face to six times the volume, false if any edge had to be sampled
+	static bool PlanarVolume(const TopoDS_Shape& face, const gp_XYZ& origin, double& volume);
+	//contribution of a triangulated face to six times the volume, false if the face has no triangulation
+	static bool TriangulatedVolume(const TopoDS_Shape& face, const gp_XYZ& origin, double& volume);
+	//six times the volume of the shape and the sum of the magnitudes of the face terms, false if a curved face has no triangulation
+	static bool SignedVolume(const TopoDS_Shape& shape, const gp_XYZ& origin, double& volume, double& magnitude, bool& exact);
+	static bool ClassifyInsideOut(const TopoDS_Shape& shape);
+public:
+	//the volume terms of an approximated shape must sum to at least this fraction of their magnitudes to decide without the classifier
+	static double AmbiguousFraction;
+	//true if the faces of the shape point in to the volume they enclose, i.e. the infinite point would be classified IN
+	static bool IsInsideOut(const TopoDS_Shape& shape);
+};
@@ -0,0 +1,251 @@
+#include "XbimShapeValidator.h"
+#include <BRepCheck_Analyzer.hxx>
+#include <BRep_Tool.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <Geom_Curve.hxx>
+#include <Geom_Surface.hxx>
+#include <Geom2d_Curve.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <OSD_Parallel.hxx>
+#include <vector>
+
+XbimShapeValidation XbimShapeValidator::Level = XbimValidationSampled;
+int XbimShapeValidator::MaxSamples = 64;
+
+namespace
+{
+	//runs the analyzer on one sub-shape, used to check the parts of a shape in parallel
+	class XbimAnalyzerFunctor
+	{
+	private:
+		const TopTools_IndexedMapOfShape& parts;
+		std::vector<char>& results;
+		bool geomControls;
+	public:
+		XbimAnalyzerFunctor(const TopTools_IndexedMapOfShape& shapeParts, std::vector<char>& partResults, bool checkGeometry) :
+			parts(shapeParts), results(partResults), geomControls(checkGeometry) {}
+
+		void operator()(int i) const
+		{
+			try
+			{
+				BRepCheck_Analyzer analyser(parts(i + 1), geomControls);
+				results[i] = analyser.IsValid() ? 1 : 0;
+			}
+			catch (const Standard_Failure&)
+			{
+				results[i] = 0;
+			}
+		}
+	};
+}
+
+bool XbimShapeValidator::IsValid(const TopoDS_Shape& shape, bool geomControls)
+{
+	return IsValid(shape, Level, geomControls);
+}
+
+bool XbimShapeValidator::IsValid(const TopoDS_Shape& shape, XbimShapeValidation level, bool geomControls)
+{
+	try
+	{
+		if (level == XbimValidationFull)
+			return CheckFull(shape, geomControls);
+		bool flagged = !CheckTopology(shape);
+		if (!flagged && level == XbimValidationSampled && geomControls)
+			flagged = !CheckGeometrySampled(shape, MaxSamples);
+		if (!flagged) return true;
+		//the cheap checks are conservative, confirm the problem with the full analyzer
+		return CheckFull(shape, geomControls);
+	}
+	catch (const Standard_Failure&)
+	{
+		return false;
+	}
+}
+
+bool XbimShapeValidator::CheckWire(const TopoDS_Wire& wire, bool mustBeClosed)
+{
+	//every vertex of a closed wire is used an even number of times, an open wire has two ends
+	TopTools_IndexedMapOfShape vertices;
+	std::vector<int> usage;
+	for (TopoDS_Iterator it(wire); it.More(); it.Next())
+	{
+		if (it.Value().ShapeType() != TopAbs_EDGE) continue;
+		TopoDS_Vertex v1, v2;
+		TopExp::Vertices(TopoDS::Edge(it.Value()), v1, v2);
+		if (v1.IsNull() || v2.IsNull()) return false;
+		int idx1 = vertices.Add(v1);
+		if (idx1 > (int)usage.size()) usage.push_back(0);
+		usage[idx1 - 1]++;
+		int idx2 = vertices.Add(v2);
+		if (idx2 > (int)usage.size()) usage.push_back(0);
+		usage[idx2 - 1]++;
+	}
+	int ends = 0;
+	for (int count : usage)
+		if (count % 2 != 0) ends++;
+	return mustBeClosed ? ends == 0 : ends <= 2;
+}
+
+bool XbimShapeValidator::CheckFace(const TopoDS_Face& face)
+{
+	for (TopoDS_Iterator it(face); it.More(); it.Next())
+	{
+		if (it.Value().ShapeType() == TopAbs_WIRE && !CheckWire(TopoDS::Wire(it.Value()), true))
+			return false;
+	}
+	return true;
+}
+
+bool XbimShapeValidator::CheckShell(const TopoDS_Shell& shell, bool mustBeClosed)
+{
+	TopTools_IndexedMapOfShape edges;
+	std::vector<int> forward;
+	std::vector<int> reversed;
+	int nbFaces = 0;
+	int nbWires = 0;
+	bool hasInternal = false;
+	for (TopExp_Explorer faceExp(shell, TopAbs_FACE); faceExp.More(); faceExp.Next())
+	{
+		const TopoDS_Face& face = TopoDS::Face(faceExp.Current());
+		if (!CheckFace(face)) return false;
+		nbFaces++;
+		for (TopExp_Explorer wireExp(face, TopAbs_WIRE); wireExp.More(); wireExp.Next()) nbWires++;
+		//the explorer composes the orientations of the shell, face, wire and edge
+		for (TopExp_Explorer edgeExp(face, TopAbs_EDGE); edgeExp.More(); edgeExp.Next())
+		{
+			const TopoDS_Edge& edge = TopoDS::Edge(edgeExp.Current());
+			if (BRep_Tool::Degenerated(edge)) continue;
+			int idx = edges.Add(edge);
+			if (idx > (int)forward.size())
+			{
+				forward.push_back(0);
+				reversed.push_back(0);
+			}
+			switch (edge.Orientation())
+			{
+			case TopAbs_FORWARD:
+				forward[idx - 1]++;
+				break;
+			case TopAbs_REVERSED:
+				reversed[idx - 1]++;
+				break;
+			default:
+				hasInternal = true;
+				break;
+			}
+		}
+	}
+	if (nbFaces == 0) return false;
+	for (size_t i = 0; i < forward.size(); i++)
+	{
+		//an edge used twice in the same sense is either non-manifold or the faces are inconsistently oriented
+		if (forward[i] > 1 || reversed[i] > 1) return false;
+		//a free edge in a shell that should bound a volume
+		if (mustBeClosed && forward[i] != reversed[i]) return false;
+	}
+	if (mustBeClosed && !hasInternal)
+	{
+		//Euler-Poincare V - E + F - R = 2(1 - G) for a connected closed orientable shell, R is the number of inner loops
+		TopTools_IndexedMapOfShape vertices;
+		TopExp::MapShapes(shell, TopAbs_VERTEX, vertices);
+		int chi = vertices.Extent() - edges.Extent() + nbFaces - (nbWires - nbFaces);
+		if (chi > 2 || chi % 2 != 0) return false;
+	}
+	return true;
+}
+
+bool XbimShapeValidator::CheckTopology(const TopoDS_Shape& shape)
+{
+	if (shape.IsNull()) return false;
+	for (TopExp_Explorer solidExp(shape, TopAbs_SOLID); solidExp.More(); solidExp.Next())
+	{
+		for (TopoDS_Iterator it(solidExp.Current()); it.More(); it.Next())
+		{
+			if (it.Value().ShapeType() == TopAbs_SHELL && !CheckShell(TopoDS::Shell(it.Value()), true))
+				return false;
+		}
+	}
+	for (TopExp_Explorer shellExp(shape, TopAbs_SHELL, TopAbs_SOLID); shellExp.More(); shellExp.Next())
+	{
+		const TopoDS_Shell& shell = TopoDS::Shell(shellExp.Current());
+		if (!CheckShell(shell, shell.Closed() == Standard_True)) return false;
+	}
+	for (TopExp_Explorer faceExp(shape, TopAbs_FACE, TopAbs_SHELL); faceExp.More(); faceExp.Next())
+	{
+		if (!CheckFace(TopoDS::Face(faceExp.Current()))) return false;
+	}
+	for (TopExp_Explorer wireExp(shape, TopAbs_WIRE, TopAbs_FACE); wireExp.More(); wireExp.Next())
+	{
+		const TopoDS_Wire& wire = TopoDS::Wire(wireExp.Current());
+		if (!CheckWire(wire, wire.Closed() == Standard_True)) return false;
+	}
+	return true;
+}
+
+bool XbimShapeValidator::CheckGeometrySampled(const TopoDS_Shape& shape, int maxSamples)
+{
+	TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+	TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+	int nbEdges = edgeFaces.Extent();
+	int stride = (maxSamples > 0 && nbEdges > maxSamples) ? nbEdges / maxSamples : 1;
+	for (int i = 1; i <= nbEdges; i += stride)
+	{
+		const TopoDS_Edge& edge = TopoDS::Edge(edgeFaces.FindKey(i));
+		if (BRep_Tool::Degenerated(edge)) continue;
+		Standard_Real first, last;
+		Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
+		if (curve.IsNull()) return false;
+		if (!BRep_Tool::SameParameter(edge) || !BRep_Tool::SameRange(edge)) return false;
+		if (Precision::IsInfinite(first) || Precision::IsInfinite(last)) continue;
+
+		TopoDS_Vertex v1, v2;
+		TopExp::Vertices(TopoDS::Edge(edge.Oriented(TopAbs_FORWARD)), v1, v2);
+		if (!v1.IsNull() && curve->Value(first).Distance(BRep_Tool::Pnt(v1)) > BRep_Tool::Tolerance(v1)) return false;
+		if (!v2.IsNull() && curve->Value(last).Distance(BRep_Tool::Pnt(v2)) > BRep_Tool::Tolerance(v2)) return false;
+
+		double edgeTolerance = BRep_Tool::Tolerance(edge);
+		double mid = 0.5 * (first + last);
+		gp_Pnt midPoint = curve->Value(mid);
+		for (TopTools_ListIteratorOfListOfShape it(edgeFaces.FindFromIndex(i)); it.More(); it.Next())
+		{
+			const TopoDS_Face& face = TopoDS::Face(it.Value());
+			Handle(Geom_Surface) surface = BRep_Tool::Surface(face);
+			if (surface.IsNull()) return false;
+			Standard_Real pFirst, pLast;
+			Handle(Geom2d_Curve) pCurve = BRep_Tool::CurveOnSurface(edge, face, pFirst, pLast);
+			if (pCurve.IsNull()) return false;
+			gp_Pnt2d uv = pCurve->Value(mid);
+			if (surface->Value(uv.X(), uv.Y()).Distance(midPoint) > edgeTolerance) return false;
+		}
+	}
+	return true;
+}
+
+bool XbimShapeValidator::CheckFull(const TopoDS_Shape& shape, bool geomControls)
+{
+	TopTools_IndexedMapOfShape parts;
+	for (TopExp_Explorer exp(shape, TopAbs_SOLID); exp.More(); exp.Next()) parts.Add(exp.Current());
+	for (TopExp_Explorer exp(shape, TopAbs_SHELL, TopAbs_SOLID); exp.More(); exp.Next()) parts.Add(exp.Current());
+	for (TopExp_Explorer exp(shape, TopAbs_FACE, TopAbs_SHELL); exp.More(); exp.Next()) parts.Add(exp.Current());
+	for (TopExp_Explorer exp(shape, TopAbs_WIRE, TopAbs_FACE); exp.More(); exp.Next()) parts.Add(exp.Current());
+	for (TopExp_Explorer exp(shape, TopAbs_EDGE, TopAbs_WIRE); exp.More(); exp.Next()) parts.Add(exp.Current());
+	if (parts.Extent() <= 1)
+		return BRepCheck_Analyzer(shape, geomControls).IsValid() == Standard_True;
+
+	std::vector<char> results(parts.Extent(), 0);
+	OSD_Parallel::For(0, parts.Extent(), XbimAnalyzerFunctor(parts, results, geomControls));
+	for (char valid : results)
+		if (!valid) return false;
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Shell.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Wire.hxx>
+
+//Controls how much work is done to decide if a newly built shape is valid
+enum XbimShapeValidation
+{
+	//only the topological checks are run, the full analyzer confirms anything they flag
+	XbimValidationTopological = 0,
+	//topological checks followed by sampled geometric checks, the full analyzer confirms anything they flag
+	XbimValidationSampled = 1,
+	//the full BRepCheck_Analyzer is always run, this is the slowest and strictest option
+	XbimValidationFull = 2
+};
+
+//Tiered validity checking, cheap topological tests are run first, then sampled geometric tests
+//and only if either of these flag a problem is the full BRepCheck_Analyzer run, in parallel per sub-shape
+class XbimShapeValidator
+{
+private:
+	static bool CheckShell(const TopoDS_Shell& shell, bool mustBeClosed);
+	static bool CheckFace(const TopoDS_Face& face);
+	static bool CheckWire(const TopoDS_Wire& wire, bool mustBeClosed);
+public:
+	//the level used when none is specified, set from the ShapeValidation application setting
+	static XbimShapeValidation Level;
+	//maximum number of edges and faces sampled by the geometric checks
+	static int MaxSamples;
+
+	static bool IsValid(const TopoDS_Shape& shape, bool geomControls = true);
+	static bool IsValid(const TopoDS_Shape& shape, XbimShapeValidation level, bool geomControls = true);
+	//edge usage, orientation consistency and Euler characteristic of closed shells, closure of wires
+	static bool CheckTopology(const TopoDS_Shape& shape);
+	//same parameter, vertex and curve on surface consistency for an evenly spaced sample of the edges
+	static bool CheckGeometrySampled(const TopoDS_Shape& shape, int maxSamples);
+	//runs BRepCheck_Analyzer on each solid, free shell, free face, free wire and free edge in parallel
+	static bool CheckFull(const TopoDS_Shape& shape, bool geomControls);
+};
@@ -25,14 +25,12 @@
 #include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepCheck_Shell.hxx>
 #include <BRepBuilderAPI_MakeSolid.hxx>
-#include <BRepClass3d_SolidClassifier.hxx>
 #include <Precision.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Common.hxx>
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepAlgoAPI_Section.hxx>
 #include <TopTools_IndexedMapOfShape.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <TopTools_HSequenceOfShape.hxx>
 #include <ShapeAnalysis_FreeBounds.hxx>
 #include <BRepAlgo_FaceRestrictor.hxx>
@@ -49,6 +47,9 @@
 #include <GeomLib_IsPlanarSurface.hxx>
 #include <Standard_CString.hxx>
 #include "XbimNativeApi.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimShapeOrientation.h"
+#include "XbimToleranceNormalizer.h"
 using namespace System;
 using namespace Xbim::Common::Exceptions;
 namespace Xbim
@@ -106,8 +107,7 @@ namespace Xbim
 			shapes->Sew(logger);
 			pShell = new TopoDS_Shell();
 			*pShell = (XbimShell^)shapes->MakeShell();
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pShell, openShell->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pShell, openShell->Model->ModelFactors->Precision);
 		}
 
 		void XbimShell::Init(IIfcConnectedFaceSet^ connectedFaceSet, ILogger^ logger)
@@ -116,8 +116,7 @@ namespace Xbim
 			shapes->Sew(logger);
 			pShell = new TopoDS_Shell();
 			*pShell = (XbimShell^)shapes->MakeShell();
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pShell, connectedFaceSet->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pShell, connectedFaceSet->Model->ModelFactors->Precision);
 		}
 
 		void XbimShell::Init(IIfcSurfaceOfLinearExtrusion^ linExt, ILogger^ logger)
@@ -136,8 +135,7 @@ namespace Xbim
 					*pShell = TopoDS::Shell(shellMaker.Shape());
 					if (linExt->Position != nullptr)
 						pShell->Move(XbimConvert::ToLocation(linExt->Position));
-					ShapeFix_ShapeTolerance tolFixer;
-					tolFixer.LimitTolerance(*pShell, linExt->Model->ModelFactors->Precision);
+					XbimToleranceNormalizer::Limit(*pShell, linExt->Model->ModelFactors->Precision);
 				}
 				else
 					XbimGeometryCreator::LogWarning(logger, linExt, "Invalid Surface Extrusion, could not create shell");
@@ -288,10 +286,12 @@ namespace Xbim
 		IXbimGeometryObject^ XbimShell::TransformShallow(XbimMatrix3D matrix3D)
 		{
 			if (!IsValid) return nullptr;
-			gp_Trsf trans = XbimConvert::ToTransform(matrix3D);
-			BRepBuilderAPI_Transform gTran(this, trans, Standard_False);
+			TopoDS_Shape instance;
+			std::string errMsg;
+			if (!XbimNativeApi::InstanceShape(this, XbimConvert::ToGTransform(matrix3D), instance, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
 			GC::KeepAlive(this);
-			return gcnew XbimSolid(TopoDS::Solid(gTran.Shape()));
+			return gcnew XbimShell(TopoDS::Shell(instance));
 		}
 
 		IXbimGeometryObjectSet^ XbimShell::Cut(IXbimSolidSet^ solids, double tolerance, ILogger^ logger)
@@ -338,9 +338,8 @@ namespace Xbim
 			XbimFace^ faceSection = dynamic_cast<XbimFace^>(toSection);
 			if (faceSection == nullptr)  throw gcnew ArgumentException("Only faces created by Xbim.OCC modules are supported", "toSection");
 
-			ShapeFix_ShapeTolerance fixTol;
-			fixTol.SetTolerance(faceSection, tolerance);
-			fixTol.SetTolerance(this, tolerance);
+			XbimToleranceNormalizer::Set(faceSection, tolerance);
+			XbimToleranceNormalizer::Set(this, tolerance);
 			BRepAlgoAPI_Section boolOp(this, faceSection, false);
 			boolOp.ComputePCurveOn2(Standard_True);
 			boolOp.Build();
@@ -387,9 +386,7 @@ namespace Xbim
 		{
 			if (IsValid)
 			{
-				BRepClass3d_SolidClassifier class3d(this);
-				class3d.PerformInfinitePoint(Precision::Confusion());
-				if (class3d.State() == TopAbs_IN)
+				if (XbimShapeOrientation::IsInsideOut(this))
 					this->Reverse();
 			}
 		}
@@ -416,9 +413,9 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
 				GC::KeepAlive(this);
-				return gcnew XbimShell(TopoDS::Shell(tr.Shape()), Tag);
+				return gcnew XbimShell(TopoDS::Shell(transformed), Tag);
 			}
 			else
 			{
@@ -462,9 +459,7 @@ namespace Xbim
 					TopoDS_Solid solid = solidMaker.Solid();
 					try
 					{
-						BRepClass3d_SolidClassifier class3d(solid);
-						class3d.PerformInfinitePoint(Precision::Confusion());
-						if (class3d.State() == TopAbs_IN)
+						if (XbimShapeOrientation::IsInsideOut(solid))
 							solid.Reverse();
 					}
 					catch (Standard_Failure sf)
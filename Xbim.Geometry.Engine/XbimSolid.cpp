@@ -14,6 +14,10 @@
 #include "XbimGeometryCreator.h"
 #include "XbimConvert.h"
 #include "XbimOccWriter.h"
+#include "XbimNativeApi.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimShapeOrientation.h"
+#include "XbimToleranceNormalizer.h"
 
 #include <TopExp.hxx>
 #include <GProp_GProps.hxx>
@@ -45,7 +49,6 @@
 #include <BRepBuilderAPI_MakeSolid.hxx>
 #include <BRepPrimAPI_MakeHalfSpace.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <BRepTools.hxx>
 #include <BRepTools_WireExplorer.hxx>
 #include <Geom_Curve.hxx>
@@ -71,7 +74,6 @@
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <ShapeFix_Solid.hxx>
 #include <ShapeFix_Wireframe.hxx>
-#include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
 #include <Geom_Plane.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
@@ -389,8 +391,7 @@ namespace Xbim
 				XbimShell^ shell = (XbimShell^)comp->MakeShell();
 				pSolid = new TopoDS_Solid();
 				*pSolid = (XbimSolid^)(shell->CreateSolid());
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(*pSolid, bRep->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pSolid, bRep->Model->ModelFactors->Precision);
 			}
 		}
 
@@ -645,9 +646,7 @@ namespace Xbim
 					BRep_Builder bs;
 					bs.MakeSolid(solid);
 					bs.Add(solid, shell);
-					BRepClass3d_SolidClassifier sc(solid);
-					sc.PerformInfinitePoint(Precision::Confusion());
-					if (sc.State() == TopAbs_IN)
+					if (XbimShapeOrientation::IsInsideOut(solid))
 					{
 						bs.MakeSolid(solid);
 						shell.Reverse();
@@ -682,8 +681,7 @@ namespace Xbim
 
 					result.Closed(Standard_True);
 
-					ShapeFix_ShapeTolerance fTol;
-					fTol.LimitTolerance(result, precision);
+					XbimToleranceNormalizer::Limit(result, precision);
 					//BRepTools::Write(result, "c://tmp//result.");
 					return;
 				}
@@ -801,9 +799,7 @@ namespace Xbim
 						BRep_Builder bs;
 						bs.MakeSolid(solid);
 						bs.Add(solid, shell);
-						BRepClass3d_SolidClassifier sc(solid);
-						sc.PerformInfinitePoint(Precision::Confusion());
-						if (sc.State() == TopAbs_IN)
+						if (XbimShapeOrientation::IsInsideOut(solid))
 						{
 							bs.MakeSolid(solid);
 							shell.Reverse();
@@ -815,8 +811,7 @@ namespace Xbim
 						pSolid->Closed(Standard_True);
 						if (repItem->Position != nullptr) //In Ifc4 this is now optional
 							pSolid->Move(XbimConvert::ToLocation(repItem->Position));
-						ShapeFix_ShapeTolerance tolFixer;
-						tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+						XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 						return;
 					}
 					else if (repItem->Angle <= 0)
@@ -880,8 +875,7 @@ namespace Xbim
 						pSolid->Closed(Standard_True);
 						if (repItem->Position != nullptr) //In Ifc4 this is now optional
 							pSolid->Move(XbimConvert::ToLocation(repItem->Position));
-						ShapeFix_ShapeTolerance tolFixer;
-						tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+						XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 						return;
 					}
 					else
@@ -1022,9 +1016,7 @@ namespace Xbim
 					BRep_Builder bs;
 					bs.MakeSolid(solid);
 					bs.Add(solid, shell);
-					BRepClass3d_SolidClassifier sc(solid);
-					sc.PerformInfinitePoint(Precision::Confusion());
-					if (sc.State() == TopAbs_IN)
+					if (XbimShapeOrientation::IsInsideOut(solid))
 					{
 						bs.MakeSolid(solid);
 						shell.Reverse();
@@ -1036,8 +1028,7 @@ namespace Xbim
 					pSolid->Closed(Standard_True);
 					if (repItem->Position != nullptr) //In Ifc4 this is now optional
 						pSolid->Move(XbimConvert::ToLocation(repItem->Position));
-					ShapeFix_ShapeTolerance tolFixer;
-					tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+					XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 					return;
 				}
 				GC::KeepAlive(faceStart);
@@ -1184,9 +1175,7 @@ namespace Xbim
 								bs.Add(shell, lastFace);
 								bs.Add(solid, shell);
 
-								BRepClass3d_SolidClassifier SC(solid);
-								SC.PerformInfinitePoint(Precision::Confusion());
-								if (SC.State() == TopAbs_IN) {
+								if (XbimShapeOrientation::IsInsideOut(solid)) {
 									bs.MakeSolid(solid);
 									shell.Reverse();
 									bs.Add(solid, shell);
@@ -1206,8 +1195,7 @@ namespace Xbim
 					*pSolid = outerShell;
 					pSolid->Closed(Standard_True);
 					GC::KeepAlive(crossSections);
-					ShapeFix_ShapeTolerance tolFixer;
-					tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+					XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 					return;
 				}
 				else
@@ -1264,8 +1252,7 @@ namespace Xbim
 
 						if (repItem->Position != nullptr) //In Ifc4 this is now optional
 							pSolid->Move(XbimConvert::ToLocation(repItem->Position));
-						ShapeFix_ShapeTolerance tolFixer;
-						tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+						XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 						return;
 					}
 				}
@@ -1311,8 +1298,7 @@ namespace Xbim
 					if (repItem->Position != nullptr)
 						*pSolid = TopoDS::Solid(revol.Shape());
 					pSolid->Move(XbimConvert::ToLocation(repItem->Position));
-					ShapeFix_ShapeTolerance tolFixer;
-					tolFixer.LimitTolerance(*pSolid, repItem->Model->ModelFactors->Precision);
+					XbimToleranceNormalizer::Limit(*pSolid, repItem->Model->ModelFactors->Precision);
 				}
 				else
 					XbimGeometryCreator::LogWarning(logger, repItem, "Invalidextrusion, could not create solid");
@@ -1348,8 +1334,7 @@ namespace Xbim
 				pSolid = new TopoDS_Solid();
 				*pSolid = hsMaker.Solid();
 				//half space solids are only used in booleans, set the face tolerance the millimeter precision we require
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(*pSolid, hs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
+				XbimToleranceNormalizer::Limit(*pSolid, hs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
 			}
 		}
 
@@ -1360,8 +1345,7 @@ namespace Xbim
 			BRepPrimAPI_MakeBox box(gp_Pnt(l.X, l.Y, l.Z), rect3D.SizeX, rect3D.SizeY, rect3D.SizeZ);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(box.Shape());
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, tolerance);
+			XbimToleranceNormalizer::Limit(*pSolid, tolerance);
 		}
 
 		void XbimSolid::Init(IIfcBoxedHalfSpace^ bhs, ILogger^ logger)
@@ -1378,8 +1362,7 @@ namespace Xbim
 			if (bhs->AgreementFlag)
 				Translate(XbimVector3D(0, 0, -bhs->Enclosure->ZDim));
 			Move(ifcPlane->Position);
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, bhs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
+			XbimToleranceNormalizer::Limit(*pSolid, bhs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
 		}
 
 		void XbimSolid::Init(IIfcPolygonalBoundedHalfSpace^ pbhs, ILogger^ logger)
@@ -1413,8 +1396,7 @@ namespace Xbim
 				XbimGeometryCreator::LogWarning(logger, pbhs, "Polygonal boundary of half space is not an area. It has been ignored");
 				return;
 			}
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(polyBoundary, pbhs->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(polyBoundary, pbhs->Model->ModelFactors->Precision);
 			// we have to use 1e8 as the max extrusion as the common boolean op times out on values greater than this, probably an extrema issue in booleans
 			TopoDS_Shape substractionBody = BRepPrimAPI_MakePrism(BRepBuilderAPI_MakeFace(polyBoundary), gp_Vec(0, 0, 1e8));
 			//find point inside the material
@@ -1436,7 +1418,7 @@ namespace Xbim
 			}
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(map(1));
-			tolFixer.LimitTolerance(*pSolid, pbhs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
+			XbimToleranceNormalizer::Limit(*pSolid, pbhs->Model->ModelFactors->Precision * XbimGeometryCreator::FuzzyFactor);
 		}
 
 		// params depend on segment type
@@ -1782,8 +1764,7 @@ namespace Xbim
 			BRepPrimAPI_MakeBox boxMaker(gpax2, x, y, z);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(boxMaker.Shape());
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(*pSolid, box->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, box->Model->ModelFactors->Precision);
 		}
 
 
@@ -1811,8 +1792,7 @@ namespace Xbim
 			BRepPrimAPI_MakeSphere sphereMaker(gpax3.Ax2(), IIfcSolid->Radius);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(sphereMaker.Shape());
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 		}
 
 		void XbimSolid::Init(IIfcBlock^ IIfcSolid, ILogger^ /*logger*/)
@@ -1821,8 +1801,7 @@ namespace Xbim
 			BRepPrimAPI_MakeBox boxMaker(gpax3.Ax2(), IIfcSolid->XLength, IIfcSolid->YLength, IIfcSolid->ZLength);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(boxMaker.Shape());
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 		}
 
 		void XbimSolid::Init(IIfcRightCircularCylinder^ IIfcSolid, ILogger^ /*logger*/)
@@ -1831,8 +1810,7 @@ namespace Xbim
 			BRepPrimAPI_MakeCylinder cylinderMaker(gpax3.Ax2(), IIfcSolid->Radius, IIfcSolid->Height);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(cylinderMaker.Shape());
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 		}
 
 		void XbimSolid::Init(IIfcRightCircularCone^ IIfcSolid, ILogger^ /*logger*/)
@@ -1841,8 +1819,7 @@ namespace Xbim
 			BRepPrimAPI_MakeCone coneMaker(gpax3.Ax2(), IIfcSolid->BottomRadius, 0., IIfcSolid->Height);
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(coneMaker.Shape());
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 		}
 
 		void XbimSolid::Init(IIfcRectangularPyramid^ IIfcSolid, ILogger^ /*logger*/)
@@ -1922,8 +1899,7 @@ namespace Xbim
 			pSolid = new TopoDS_Solid();
 			*pSolid = TopoDS::Solid(solidMaker.Shape());
 			Move(IIfcSolid->Position);
-			ShapeFix_ShapeTolerance tolFixer;
-			tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 		}
 
 		void XbimSolid::Init(IIfcTriangulatedFaceSet^ IIfcSolid, ILogger^ logger)
@@ -1941,8 +1917,7 @@ namespace Xbim
 				XbimShell^ shell = (XbimShell^)comp->MakeShell();
 				pSolid = new TopoDS_Solid();
 				*pSolid = (XbimSolid^)(shell->CreateSolid());
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pSolid, IIfcSolid->Model->ModelFactors->Precision);
 			}
 		}
 
@@ -1961,8 +1936,7 @@ namespace Xbim
 				XbimShell^ shell = (XbimShell^)comp->MakeShell();
 				pSolid = new TopoDS_Solid();
 				*pSolid = (XbimSolid^)(shell->CreateSolid());
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(*pSolid, solid->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pSolid, solid->Model->ModelFactors->Precision);
 			}
 		}
 
@@ -1981,8 +1955,7 @@ namespace Xbim
 				XbimShell^ shell = (XbimShell^)comp->MakeShell();
 				pSolid = new TopoDS_Solid();
 				*pSolid = (XbimSolid^)(shell->CreateSolid());
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(*pSolid, solid->Model->ModelFactors->Precision);
+				XbimToleranceNormalizer::Limit(*pSolid, solid->Model->ModelFactors->Precision);
 			}
 		}
 
@@ -2130,10 +2103,12 @@ namespace Xbim
 		IXbimGeometryObject^ XbimSolid::TransformShallow(XbimMatrix3D matrix3D)
 		{
 			if (!IsValid) return nullptr;
-			gp_Trsf trans = XbimConvert::ToTransform(matrix3D);
-			BRepBuilderAPI_Transform gTran(this, trans, Standard_False);
+			TopoDS_Shape instance;
+			std::string errMsg;
+			if (!XbimNativeApi::InstanceShape(this, XbimConvert::ToGTransform(matrix3D), instance, errMsg))
+				throw gcnew XbimGeometryException(gcnew String(errMsg.c_str()));
 			GC::KeepAlive(this);
-			return gcnew XbimSolid(TopoDS::Solid(gTran.Shape()));
+			return gcnew XbimSolid(TopoDS::Solid(instance));
 		}
 
 		IXbimSolidSet^ XbimSolid::Cut(IXbimSolidSet^ toCut, double tolerance, ILogger^ logger)
@@ -2231,9 +2206,8 @@ namespace Xbim
 			XbimFace^ faceSection = dynamic_cast<XbimFace^>(toSection);
 			if (faceSection == nullptr)  throw gcnew ArgumentException("Only IXbimSolids created by Xbim.OCC modules are supported", "toSection");
 
-			ShapeFix_ShapeTolerance fixTol;
-			fixTol.SetTolerance(faceSection, tolerance);
-			fixTol.SetTolerance(this, tolerance);
+			XbimToleranceNormalizer::Set(faceSection, tolerance);
+			XbimToleranceNormalizer::Set(this, tolerance);
 			BRepAlgoAPI_Section boolOp(this, faceSection, false);
 			boolOp.ComputePCurveOn2(Standard_True);
 			boolOp.Build();
@@ -2343,9 +2317,7 @@ namespace Xbim
 		{
 			if (IsValid)
 			{
-				BRepClass3d_SolidClassifier class3d(*pSolid);
-				class3d.PerformInfinitePoint(Precision::Confusion());
-				if (class3d.State() == TopAbs_IN) this->Reverse();
+				if (XbimShapeOrientation::IsInsideOut(*pSolid)) this->Reverse();
 			}
 		}
 
@@ -2407,9 +2379,9 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(*pSolid, trans, Standard_True); //make a copy of underlying shape
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(*pSolid, trans); //keeps the analytic geometry where it can
 				GC::KeepAlive(this);
-				return gcnew XbimSolid(TopoDS::Solid(tr.Shape()), Tag);
+				return gcnew XbimSolid(TopoDS::Solid(transformed), Tag);
 			}
 			else
 			{
@@ -4,13 +4,15 @@
 #include "XbimGeometryCreator.h"
 #include "XbimOccWriter.h"
 #include "XbimProgressMonitor.h"
+#include "XbimShapeValidator.h"
+#include "XbimNativeApi.h"
 #include <TopTools_IndexedMapOfShape.hxx>
 #include <TopExp.hxx>
 #include <BRepTools.hxx>
 #include <BRep_Builder.hxx>
 #include <Standard_NotImplemented.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
-#include <ShapeFix_ShapeTolerance.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepPrimAPI_MakePrism.hxx>
 #include "XbimConvert.h"
 #include "BRepCheck_Analyzer.hxx"
@@ -19,8 +21,14 @@
 #include "BRepBuilderAPI_MakeSolid.hxx"
 #include "BOPAlgo_PaveFiller.hxx"
 #include "BOPAlgo_BOP.hxx"
+#include <BRepTools_ReShape.hxx>
+#include <BRepTools_History.hxx>
+#include <TopTools_MapOfShape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <OSD_OpenFile.hxx>
 #include <algorithm>
+#include <vector>
 
 using namespace std;
 
@@ -429,18 +437,227 @@ namespace Xbim
 
 #pragma managed(push, off)
 
+		//adds the faces that the operation has modified or generated from the faces of source to changedFaces
+		void CollectChangedFaces(BOPAlgo_BOP& aBOP, const TopoDS_Shape& source, TopTools_MapOfShape& changedFaces)
+		{
+			for (TopExp_Explorer exp(source, TopAbs_FACE); exp.More(); exp.Next())
+			{
+				for (TopTools_ListIteratorOfListOfShape it(aBOP.Modified(exp.Current())); it.More(); it.Next())
+					changedFaces.Add(it.Value());
+				for (TopTools_ListIteratorOfListOfShape it(aBOP.Generated(exp.Current())); it.More(); it.Next())
+					changedFaces.Add(it.Value());
+			}
+		}
+
+		//runs ShapeUpgrade_UnifySameDomain on the changed faces of the result and their neighbours only, all other faces are passed through untouched
+		//returns false if the unification cannot be localised and the whole shape should be unified
+		bool UnifyChangedFaces(TopoDS_Shape& result, const TopTools_MapOfShape& changedFaces, double tolerance, double angularTolerance)
+		{
+			TopTools_IndexedMapOfShape resultFaces;
+			TopExp::MapShapes(result, TopAbs_FACE, resultFaces);
+			TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+			TopExp::MapShapesAndAncestors(result, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+
+			//the changed faces that made it into the result, plus the faces that share an edge with them
+			TopTools_MapOfShape region;
+			for (int i = 1; i <= resultFaces.Extent(); i++)
+			{
+				const TopoDS_Shape& face = resultFaces(i);
+				if (!changedFaces.Contains(face)) continue;
+				region.Add(face);
+				for (TopExp_Explorer edgeExp(face, TopAbs_EDGE); edgeExp.More(); edgeExp.Next())
+				{
+					for (TopTools_ListIteratorOfListOfShape it(edgeFaces.FindFromKey(edgeExp.Current())); it.More(); it.Next())
+						region.Add(it.Value());
+				}
+			}
+			if (region.IsEmpty()) return true; //nothing has changed so nothing to unify
+			if (region.Extent() == resultFaces.Extent()) return false;
+
+			BRep_Builder builder;
+			TopoDS_Compound regionFaces;
+			builder.MakeCompound(regionFaces);
+			for (int i = 1; i <= resultFaces.Extent(); i++)
+			{
+				if (region.Contains(resultFaces(i)))
+					builder.Add(regionFaces, resultFaces(i));
+			}
+			//edges the region shares with the untouched faces and their vertices must survive so the untouched faces stay connected
+			//in a closed shell the faces round a vertex are joined by its edges, so a vertex where an untouched face only touches the
+			//region at a corner is also the vertex of one of these edges
+			TopTools_MapOfShape boundary;
+			TopTools_IndexedMapOfShape regionEdges;
+			TopExp::MapShapes(regionFaces, TopAbs_EDGE, regionEdges);
+			for (int i = 1; i <= regionEdges.Extent(); i++)
+			{
+				const TopoDS_Shape& edge = regionEdges(i);
+				for (TopTools_ListIteratorOfListOfShape it(edgeFaces.FindFromKey(edge)); it.More(); it.Next())
+				{
+					if (region.Contains(it.Value())) continue;
+					boundary.Add(edge);
+					for (TopExp_Explorer vertexExp(edge, TopAbs_VERTEX); vertexExp.More(); vertexExp.Next())
+						boundary.Add(vertexExp.Current());
+					break;
+				}
+			}
+
+			ShapeUpgrade_UnifySameDomain unifier(regionFaces);
+			unifier.SetAngularTolerance(angularTolerance);
+			unifier.SetLinearTolerance(tolerance);
+			unifier.KeepShapes(boundary);
+			unifier.Build();
+			const Handle(BRepTools_History)& history = unifier.History();
+			if (history.IsNull()) return false;
+
+			//group the region faces by the face they have been unified into, then substitute them in the result
+			TopTools_IndexedDataMapOfShapeListOfShape unifiedParts;
+			BRepTools_ReShape reShape;
+			bool hasChanges = false;
+			for (TopoDS_Iterator it(regionFaces); it.More(); it.Next())
+			{
+				const TopoDS_Shape& face = it.Value();
+				if (history->IsRemoved(face))
+				{
+					reShape.Remove(face);
+					hasChanges = true;
+					continue;
+				}
+				const TopTools_ListOfShape& modified = history->Modified(face);
+				if (modified.IsEmpty()) continue;
+				hasChanges = true;
+				if (modified.Extent() == 1)
+				{
+					int idx = unifiedParts.FindIndex(modified.First());
+					if (idx == 0) idx = unifiedParts.Add(modified.First(), TopTools_ListOfShape());
+					unifiedParts(idx).Append(face);
+				}
+				else
+				{
+					TopoDS_Compound images;
+					builder.MakeCompound(images);
+					for (TopTools_ListIteratorOfListOfShape mit(modified); mit.More(); mit.Next())
+						builder.Add(images, mit.Value());
+					reShape.Replace(face, images);
+				}
+			}
+			if (!hasChanges) return true;
+			for (int i = 1; i <= unifiedParts.Extent(); i++)
+				reShape.Merge(unifiedParts(i), unifiedParts.FindKey(i));
+			//the unifier may still rebuild a kept edge or vertex, the untouched faces must then use the same image as the unified faces
+			//if a shared one has been removed or split the untouched faces cannot follow and the whole shape is unified instead
+			for (TopTools_MapIteratorOfMapOfShape it(boundary); it.More(); it.Next())
+			{
+				const TopoDS_Shape& shared = it.Key();
+				if (history->IsRemoved(shared)) return false;
+				const TopTools_ListOfShape& modified = history->Modified(shared);
+				if (modified.IsEmpty()) continue;
+				if (modified.Extent() > 1) return false;
+				reShape.Replace(shared, modified.First());
+			}
+			result = reShape.Apply(result);
+			return true;
+		}
+
+		//performs a single Boolean operation with no recovery, the result is set even if the operation reports errors
+		//the faces of the result that are modified or generated from the body or tools are added to changedFaces
+		int RunBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double fuzzyTol, double timeout, TopoDS_Shape& result, TopTools_MapOfShape& changedFaces)
+		{
+			try
+			{
+				BOPAlgo_BOP aBOP;
+				aBOP.AddArgument(body);
+				aBOP.SetTools(tools);
+				aBOP.SetOperation(op);
+				aBOP.SetRunParallel(false);
+				//aBOP.SetCheckInverted(true);
+				aBOP.SetNonDestructive(true);
+				aBOP.SetFuzzyValue(fuzzyTol);
+
+				Handle(XbimProgressMonitor) pi = new XbimProgressMonitor(timeout);
+				aBOP.SetProgressIndicator(pi);
+				aBOP.Perform();
+				if (pi->TimedOut())
+					return BOOLEAN_TIMEDOUT;
+				result = aBOP.Shape();
+				CollectChangedFaces(aBOP, body, changedFaces);
+				for (TopTools_ListIteratorOfListOfShape it(tools); it.More(); it.Next())
+				{
+					CollectChangedFaces(aBOP, it.Value(), changedFaces);
+					//tools that are passed through unchanged, e.g. in a union
+					for (TopExp_Explorer exp(it.Value(), TopAbs_FACE); exp.More(); exp.Next())
+						changedFaces.Add(exp.Current());
+				}
+#ifdef _DEBUG
+
+				/*if (aBOP.HasWarnings())
+				{
+					ofstream os;
+					OSD_OpenStream(os, "c:/tmp/warnings.txt", ios::out);
+					aBOP.DumpWarnings(os);
+					os.flush();
+					os.close();
+				}*/
+#endif // DEBUG
+				return aBOP.HasErrors() ? BOOLEAN_FAIL : BOOLEAN_SUCCESS;
+			}
+			catch (Standard_NotImplemented) //User break most likely called
+			{
+				return BOOLEAN_TIMEDOUT;
+			}
+			catch (...)
+			{
+				return BOOLEAN_FAIL;
+			}
+		}
+
+		//applies tools[begin, end) to the body as one batch, if the batch fails it is halved and each half is applied in turn
+		//until the tools that cannot be applied are isolated, these are added to skipped. k bad tools in n cost O(k log n) operations
+		void BisectBoolean(TopoDS_Shape& body, const std::vector<TopoDS_Shape>& tools, size_t begin, size_t end, BOPAlgo_Operation op, double fuzzyTol,
+			OSD_Timer& timer, double timeout, TopTools_ListOfShape& skipped, TopTools_MapOfShape& changedFaces, bool tryBatch)
+		{
+			double remaining = timeout - timer.ElapsedTime();
+			if (remaining <= 0) //out of time, nothing more can be applied
+			{
+				for (size_t i = begin; i < end; i++) skipped.Append(tools[i]);
+				return;
+			}
+			if (tryBatch)
+			{
+				TopTools_ListOfShape batch;
+				for (size_t i = begin; i < end; i++) batch.Append(tools[i]);
+				TopoDS_Shape batchResult;
+				int status = RunBoolean(body, batch, op, fuzzyTol, remaining, batchResult, changedFaces);
+				if (status == BOOLEAN_SUCCESS)
+				{
+					body = batchResult;
+					return;
+				}
+				if (end - begin == 1) //a single tool, keep the result if it is usable otherwise skip the tool
+				{
+					if (status == BOOLEAN_FAIL && !batchResult.IsNull() && XbimShapeValidator::IsValid(batchResult))
+						body = batchResult;
+					else
+						skipped.Append(tools[begin]);
+					return;
+				}
+			}
+			size_t mid = begin + (end - begin) / 2;
+			BisectBoolean(body, tools, begin, mid, op, fuzzyTol, timer, timeout, skipped, changedFaces, true);
+			BisectBoolean(body, tools, mid, end, op, fuzzyTol, timer, timeout, skipped, changedFaces, true);
+		}
+
 		int DoBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double tolerance, double fuzzyFactor, TopoDS_Shape& result, int timeout)
+		{
+			TopTools_ListOfShape skippedTools;
+			return DoBoolean(body, tools, op, tolerance, fuzzyFactor, result, timeout, skippedTools);
+		}
+
+		int DoBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double tolerance, double fuzzyFactor, TopoDS_Shape& result, int timeout, TopTools_ListOfShape& skippedTools)
 		{
 			
 			int  retVal = BOOLEAN_FAIL;
 			try
 			{
-				ShapeAnalysis_Wire tolFixer;
-
-				
-				TopTools_ListOfShape shapeObjects;
-				shapeObjects.Append(body);
-
 				TopTools_ListOfShape shapeTools;
 
 				Bnd_Box tsBodyBox;
@@ -474,85 +691,49 @@ namespace Xbim
 				}
 				if (argCount == 0)
 				{
-					result = body;
+					//the body may be in use on other threads, the result is meshed by the caller
+					result = BRepBuilderAPI_Copy(body).Shape();
 					return BOOLEAN_SUCCESS;
 				}
 
-
 				//double fuzzyTol = std::max(maxTol - tolerance, 10 * tolerance);//this seems about right				
-				BOPAlgo_BOP aBOP;
-
-
-				aBOP.AddArgument(body);
-				aBOP.SetTools(shapeTools);
-				aBOP.SetOperation(op);
-				aBOP.SetRunParallel(false);
-				//aBOP.SetCheckInverted(true);
-				aBOP.SetNonDestructive(true);
-				aBOP.SetFuzzyValue(fuzzyTol);
-				
-				Handle(XbimProgressMonitor) pi = new XbimProgressMonitor(timeout);
-				aBOP.SetProgressIndicator(pi);
 				TopoDS_Shape aR;
-
-
-				aBOP.Perform();
-				aR = aBOP.Shape();
-
-				if (pi->TimedOut())
-				{
+				TopTools_MapOfShape changedFaces;
+				bool canLocaliseUnify = true;
+				int bopStatus = RunBoolean(body, shapeTools, op, fuzzyTol, timeout, aR, changedFaces);
+				if (bopStatus == BOOLEAN_TIMEDOUT)
 					return BOOLEAN_TIMEDOUT;
 
-				}
-				bool bopErr = aBOP.HasErrors();
-#ifdef _DEBUG
-
-				/*if (aBOP.HasWarnings())
-				{
-					ofstream os;
-					OSD_OpenStream(os, "c:/tmp/warnings.txt", ios::out);
-					aBOP.DumpWarnings(os);
-					os.flush();
-					os.close();
-				}*/
-#endif // DEBUG
-				if (bopErr) // a sign of failure do them individually
+				if (bopStatus == BOOLEAN_FAIL) // a sign of failure, find the tools that are causing it
 				{
-
-					//check if the shape is empty
-
-					if (tools.Size() > 1)//do them one at a time if we are not already doing or have done that
+					if (argCount > 1)//bisect the tools if we are not already down to one
 					{
+						std::vector<TopoDS_Shape> toolArray;
+						toolArray.reserve(argCount);
+						for (TopTools_ListIteratorOfListOfShape itl(shapeTools); itl.More(); itl.Next())
+							toolArray.push_back(itl.Value());
+						//the recovery as a whole is given the same time as the original operation
+						OSD_Timer timer;
+						timer.Start();
 						TopoDS_Shape cutBody = body;
-
-						TopTools_ListIteratorOfListOfShape itl(tools);
-
-						bool noSuccess = true;
-						for (; itl.More(); itl.Next())
-						{
-							TopTools_ListOfShape toCut;
-							toCut.Append(itl.Value());
-							TopoDS_Shape cutResult;
-							int success = DoBoolean(cutBody, toCut, op, tolerance, fuzzyFactor, cutResult, timeout);
-							if (success > 0)
-							{
-								cutBody = cutResult;
-								aR = cutResult;
-								noSuccess = false;
-							}
-							else
-							{
-								retVal = BOOLEAN_PARTIALSUCCESSSINGLECUT;
-							}
-						}
-						if (noSuccess) return BOOLEAN_FAIL;
-						retVal = BOOLEAN_SUCCESSSINGLECUT;
+						BisectBoolean(cutBody, toolArray, 0, toolArray.size(), op, fuzzyTol, timer, timeout, skippedTools, changedFaces, false);
+						timer.Stop();
+						if (skippedTools.Extent() == argCount) return BOOLEAN_FAIL;
+						aR = cutBody;
+						bopStatus = skippedTools.IsEmpty() ? BOOLEAN_SUCCESSSINGLECUT : BOOLEAN_PARTIALSUCCESSSINGLECUT;
 					}
+					else
+						bopStatus = BOOLEAN_SUCCESS; //use what we have, it will be checked and fixed below
 				}
-
+				if (aR.IsNull()) return BOOLEAN_FAIL;
+				//the faces the operation left untouched are shared with the arguments, which other threads may be using, the fixer,
+				//the unifier and the mesher all write to the result
+				TopTools_ListOfShape arguments(shapeTools);
+				arguments.Append(body);
+				aR = XbimNativeApi::CopyShared(aR, arguments, changedFaces);
 
 				//have one go at fixing if it is not right
-				if (BRepCheck_Analyzer(aR, Standard_True).IsValid() == Standard_False)
+				if (!XbimShapeValidator::IsValid(aR))
 				{
 					//try and fix if we can
 					ShapeFix_Shape fixer(aR);
@@ -565,7 +746,8 @@ namespace Xbim
 						if (fixer.Perform(pi2))
 						{
 							result = fixer.Shape();
-							retVal = BOOLEAN_SUCCESS;
+							retVal = bopStatus;
+							canLocaliseUnify = false; //the fixer does not keep the history of the faces
 						}
 						else
 						{
@@ -582,20 +764,23 @@ namespace Xbim
 				else
 				{
 					result = aR;
-					retVal = BOOLEAN_SUCCESS;
+					retVal = bopStatus;
 				}
 				//unify the shape
 
 				
-				ShapeUpgrade_UnifySameDomain unifier(result);
-				//unifier.SetAngularTolerance(0.00174533); //1 tenth of a degree
-				unifier.SetLinearTolerance(tolerance);
-				
 				try
 				{
 					//sometimes unifier crashes
-					unifier.Build();
-					result =unifier.Shape();
+					//only the faces changed by the tools need unifying, fall back to the whole shape if that cannot be worked out
+					if (!canLocaliseUnify || !UnifyChangedFaces(result, changedFaces, tolerance, Precision::Angular()))
+					{
+						ShapeUpgrade_UnifySameDomain unifier(result);
+						//unifier.SetAngularTolerance(0.00174533); //1 tenth of a degree
+						unifier.SetLinearTolerance(tolerance);
+						unifier.Build();
+						result = unifier.Shape();
+					}
 				}
 				catch (...) //any failure
 				{
@@ -619,6 +804,29 @@ namespace Xbim
 
 #pragma managed(pop)
 
+		String^ XbimSolidSet::SkippedToolNames(const TopTools_ListOfShape& skipped, IEnumerable<IXbimSolid^>^ tools)
+		{
+			List<String^>^ names = gcnew List<String^>();
+			for each (IXbimSolid ^ tool in tools)
+			{
+				XbimSolid^ solid = dynamic_cast<XbimSolid^>(tool);
+				if (solid == nullptr || !solid->IsValid) continue;
+				for (TopTools_ListIteratorOfListOfShape it(skipped); it.More(); it.Next())
+				{
+					if (!it.Value().IsSame(solid)) continue;
+					IPersistEntity^ entity = dynamic_cast<IPersistEntity^>(solid->Tag);
+					if (entity != nullptr)
+						names->Add(String::Format("#{0}", entity->EntityLabel));
+					else if (solid->Tag != nullptr)
+						names->Add(String::Format("#{0}", solid->Tag));
+					else
+						names->Add("untagged");
+					break;
+				}
+			}
+			return String::Join(", ", names);
+		}
+
 		IXbimSolidSet^ XbimSolidSet::DoBoolean(IXbimSolidSet^ arguments, BOPAlgo_Operation operation, double tolerance, ILogger^ logger)
 		{
 			if (!IsValid) return this;
@@ -634,10 +842,11 @@ namespace Xbim
 					tools.Append((XbimSolid^)tool);
 				}
 				TopoDS_Shape result;
+				TopTools_ListOfShape skippedTools;
 				int success = BOOLEAN_FAIL;
 				try
 				{
-					success = Xbim::Geometry::DoBoolean((XbimSolid^)solids[i], tools, operation, tolerance, XbimGeometryCreator::FuzzyFactor, result, XbimGeometryCreator::BooleanTimeOut);
+					success = Xbim::Geometry::DoBoolean((XbimSolid^)solids[i], tools, operation, tolerance, XbimGeometryCreator::FuzzyFactor, result, XbimGeometryCreator::BooleanTimeOut, skippedTools);
 				}
 				catch (...)
 				{
@@ -657,7 +866,7 @@ namespace Xbim
 					msg = "Boolean operation has created a shape with invalid BREP Topology. The result may not be correct";
 					break;
 				case BOOLEAN_PARTIALSUCCESSSINGLECUT:
-					msg = "Boolean operation executed as one tool per operation with partial success. The result may not be correct";
+					msg = String::Format("Boolean operation recovered by bisecting the tools, {0} of {1} tools could not be applied and were skipped: {2}. The result may not be correct", skippedTools.Extent(), tools.Extent(), SkippedToolNames(skippedTools, arguments));
 					break;
 				case BOOLEAN_TIMEDOUT:
 					msg = "Boolean operation timed out. No result whas been generated";
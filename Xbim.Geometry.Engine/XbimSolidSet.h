@@ -4,6 +4,7 @@
 #include "XbimGeometryObjectSet.h"
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
+#include <TopTools_MapOfShape.hxx>
 using namespace System;
 using namespace Xbim::Common;
 using namespace System::Collections::Generic;
@@ -13,14 +14,18 @@ namespace Xbim
 	namespace Geometry
 	{
 		const int BOOLEAN_PARTIALSUCCESSBADTOPOLOGY = 4; //we have managed to create a shape but it fails topo analysis
-		const int BOOLEAN_PARTIALSUCCESSSINGLECUT = 3; //had to do each tool separately but one or more ops failed but we have something
-		const int BOOLEAN_SUCCESSSINGLECUT = 2;//had to do each tool separately total sucess		
+		const int BOOLEAN_PARTIALSUCCESSSINGLECUT = 3; //had to bisect the tools and one or more tools could not be applied but we have something
+		const int BOOLEAN_SUCCESSSINGLECUT = 2;//had to bisect the tools, all were applied		
 		const int BOOLEAN_SUCCESS = 1; //first attempt with all  tools worked
 		const int BOOLEAN_FAIL = 0;
 		const int BOOLEAN_TIMEDOUT = -1;
 		
 	
 	    int DoBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double tolerance, double fuzzTolerance, TopoDS_Shape& result, int timeout);
+		//as above, any tools that could not be applied are returned in skippedTools
+		int DoBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double tolerance, double fuzzTolerance, TopoDS_Shape& result, int timeout, TopTools_ListOfShape& skippedTools);
+		//unifies only the changed faces of the shape and their neighbours, returns false if the whole shape should be unified instead
+		bool UnifyChangedFaces(TopoDS_Shape& result, const TopTools_MapOfShape& changedFaces, double tolerance, double angularTolerance);
 
 		private ref class VolumeComparer : IComparer<Tuple<double, XbimSolid^>^>
 		{
@@ -75,6 +80,8 @@ namespace Xbim
 			static property XbimSolidSet^ Empty{XbimSolidSet^ get(){ return empty; }};
 			static XbimSolidSet^ BuildClippingList(IIfcBooleanClippingResult^ solid, List<IIfcBooleanOperand^>^ clipList, ILogger^ logger);
 			static XbimSolidSet^ BuildBooleanResult(IIfcBooleanResult^ solid, IfcBooleanOperator operatorType, XbimSolidSet^ ops, ILogger^ logger);
+			//names the tools that are in skipped by their tags, the entity or label the caller tagged each tool with
+			static String^ SkippedToolNames(const TopTools_ListOfShape& skipped, IEnumerable<IXbimSolid^>^ tools);
 			XbimSolidSet();
 			XbimSolidSet(const TopoDS_Shape& shape);
 			XbimSolidSet(XbimCompound^ shape);
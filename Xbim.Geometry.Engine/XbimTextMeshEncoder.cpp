@@ -0,0 +1,119 @@
+#include "XbimTextMeshEncoder.h"
+#include <cmath>
+#include <cstdio>
+
+XbimTextMeshEncoder::XbimTextMeshEncoder(const std::string& newLine) : newLine(newLine)
+{
+	buffer.reserve(ChunkSize + 256);
+}
+
+void XbimTextMeshEncoder::AppendDouble(double value)
+{
+	//the strings .NET uses for the values printf has its own names for, negative zero is written as 0
+	if (std::isnan(value))
+	{
+		buffer.append("NaN");
+		return;
+	}
+	if (std::isinf(value))
+	{
+		buffer.append(value > 0 ? "Infinity" : "-Infinity");
+		return;
+	}
+	if (value == 0)
+	{
+		buffer.push_back('0');
+		return;
+	}
+	//%G switches to the exponent form at the same points as the .NET G format and also writes at least two exponent digits
+	char text[32];
+	int length = snprintf(text, sizeof(text), "%.15G", value);
+	for (int i = 0; i < length; i++)
+		buffer.push_back(text[i] == ',' ? '.' : text[i]); //in case the C locale has been changed
+}
+
+void XbimTextMeshEncoder::AppendInteger(size_t value)
+{
+	char digits[24];
+	int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	while (count > 0)
+		buffer.push_back(digits[--count]);
+}
+
+void XbimTextMeshEncoder::Header(int version, size_t pointCount, size_t faceCount, size_t triangleCount, size_t normalCount)
+{
+	buffer.append("P ");
+	AppendInteger(version);
+	buffer.push_back(' ');
+	AppendInteger(pointCount);
+	buffer.push_back(' ');
+	AppendInteger(faceCount);
+	buffer.push_back(' ');
+	AppendInteger(triangleCount);
+	buffer.push_back(' ');
+	AppendInteger(normalCount);
+	EndLine();
+}
+
+void XbimTextMeshEncoder::BeginLine(char command)
+{
+	buffer.push_back(command);
+}
+
+void XbimTextMeshEncoder::EndLine()
+{
+	buffer.append(newLine);
+}
+
+void XbimTextMeshEncoder::Triple(double x, double y, double z)
+{
+	buffer.push_back(' ');
+	AppendDouble(x);
+	buffer.push_back(',');
+	AppendDouble(y);
+	buffer.push_back(',');
+	AppendDouble(z);
+}
+
+void XbimTextMeshEncoder::Triangle(size_t a, size_t b, size_t c)
+{
+	buffer.push_back(' ');
+	AppendInteger(a);
+	buffer.push_back(',');
+	AppendInteger(b);
+	buffer.push_back(',');
+	AppendInteger(c);
+}
+
+void XbimTextMeshEncoder::Triangle(size_t a, size_t b, size_t c, size_t normal)
+{
+	buffer.push_back(' ');
+	AppendInteger(a);
+	buffer.push_back('/');
+	AppendInteger(normal);
+	buffer.push_back(',');
+	AppendInteger(b);
+	buffer.push_back(',');
+	AppendInteger(c);
+}
+
+void XbimTextMeshEncoder::Triangle(size_t a, size_t na, size_t b, size_t nb, size_t c, size_t nc)
+{
+	buffer.push_back(' ');
+	AppendInteger(a);
+	buffer.push_back('/');
+	AppendInteger(na);
+	buffer.push_back(',');
+	AppendInteger(b);
+	buffer.push_back('/');
+	AppendInteger(nb);
+	buffer.push_back(',');
+	AppendInteger(c);
+	buffer.push_back('/');
+	AppendInteger(nc);
+}
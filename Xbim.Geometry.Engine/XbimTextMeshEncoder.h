@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+
+//Writes the text polyhedron format ("P", "V", "N" and "T" lines) in to a byte buffer without boxing or managed strings.
+//Numbers are formatted as .NET formats a double in the invariant culture, 15 significant digits with the exponent written
+//as E+XX or E-XX when it is below -4 or above 14, so the output is byte for byte what String::Format wrote.
+//The caller hands the buffer on to the writer whenever IsFull is true and at the end
+class XbimTextMeshEncoder
+{
+private:
+	std::string buffer;
+	std::string newLine;
+	void AppendDouble(double value);
+	void AppendInteger(size_t value);
+public:
+	//size at which the buffer should be written out
+	static const size_t ChunkSize = 0x10000;
+
+	XbimTextMeshEncoder(const std::string& newLine);
+	//P version pointCount faceCount triangleCount normalCount
+	void Header(int version, size_t pointCount, size_t faceCount, size_t triangleCount, size_t normalCount);
+	//starts a V, N or T line
+	void BeginLine(char command);
+	void EndLine();
+	//a vertex or normal, " x,y,z"
+	void Triple(double x, double y, double z);
+	//" a,b,c"
+	void Triangle(size_t a, size_t b, size_t c);
+	//the first triangle of a planar face carries the normal of the face, " a/n,b,c"
+	void Triangle(size_t a, size_t b, size_t c, size_t normal);
+	//every corner of a curved face has its own normal, " a/na,b/nb,c/nc"
+	void Triangle(size_t a, size_t na, size_t b, size_t nb, size_t c, size_t nc);
+
+	bool IsFull() const { return buffer.size() >= ChunkSize; }
+	const char* Data() const { return buffer.data(); }
+	size_t Size() const { return buffer.size(); }
+	void Clear() { buffer.clear(); }
+};
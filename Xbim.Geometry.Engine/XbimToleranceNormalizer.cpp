@@ -0,0 +1,108 @@
+#include "XbimToleranceNormalizer.h"
+#include <BRep_TEdge.hxx>
+#include <BRep_TFace.hxx>
+#include <BRep_TVertex.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Iterator.hxx>
+
+void XbimToleranceNormalizer::Limit(const TopoDS_Shape& shape, double tolerance, TColStd_MapOfTransient& visited)
+{
+	if (!visited.Add(shape.TShape()))
+		return;
+	switch (shape.ShapeType())
+	{
+	case TopAbs_VERTEX:
+	{
+		const Handle(BRep_TVertex)& tVertex = Handle(BRep_TVertex)::DownCast(shape.TShape());
+		if (tVertex->Tolerance() < tolerance) tVertex->Tolerance(tolerance);
+		return;
+	}
+	case TopAbs_EDGE:
+	{
+		const Handle(BRep_TEdge)& tEdge = Handle(BRep_TEdge)::DownCast(shape.TShape());
+		if (tEdge->Tolerance() < tolerance) tEdge->Tolerance(tolerance);
+		for (TopoDS_Iterator it(shape, Standard_False, Standard_False); it.More(); it.Next())
+			Limit(it.Value(), tolerance, visited);
+		return;
+	}
+	case TopAbs_FACE:
+	{
+		const Handle(BRep_TFace)& tFace = Handle(BRep_TFace)::DownCast(shape.TShape());
+		if (tFace->Tolerance() < tolerance) tFace->Tolerance(tolerance);
+		break;
+	}
+	default:
+		break;
+	}
+	for (TopoDS_Iterator it(shape, Standard_False, Standard_False); it.More(); it.Next())
+		Limit(it.Value(), tolerance, visited);
+}
+
+void XbimToleranceNormalizer::Limit(const TopoDS_Shape& shape, double tolerance)
+{
+	if (shape.IsNull() || tolerance < 0)
+		return;
+	TColStd_MapOfTransient visited;
+	Limit(shape, tolerance, visited);
+}
+
+bool XbimToleranceNormalizer::IsLimited(const TopoDS_Shape& shape, double tolerance, TColStd_MapOfTransient& visited)
+{
+	if (!visited.Add(shape.TShape()))
+		return true;
+	switch (shape.ShapeType())
+	{
+	case TopAbs_VERTEX:
+		return Handle(BRep_TVertex)::DownCast(shape.TShape())->Tolerance() >= tolerance;
+	case TopAbs_EDGE:
+		if (Handle(BRep_TEdge)::DownCast(shape.TShape())->Tolerance() < tolerance) return false;
+		break;
+	case TopAbs_FACE:
+		if (Handle(BRep_TFace)::DownCast(shape.TShape())->Tolerance() < tolerance) return false;
+		break;
+	default:
+		break;
+	}
+	for (TopoDS_Iterator it(shape, Standard_False, Standard_False); it.More(); it.Next())
+	{
+		if (!IsLimited(it.Value(), tolerance, visited)) return false;
+	}
+	return true;
+}
+
+bool XbimToleranceNormalizer::IsLimited(const TopoDS_Shape& shape, double tolerance)
+{
+	if (shape.IsNull() || tolerance < 0)
+		return true;
+	TColStd_MapOfTransient visited;
+	return IsLimited(shape, tolerance, visited);
+}
+
+void XbimToleranceNormalizer::Set(const TopoDS_Shape& shape, double tolerance, TopAbs_ShapeEnum type)
+{
+	if (shape.IsNull() || tolerance <= 0)
+		return;
+	bool all = type != TopAbs_VERTEX && type != TopAbs_EDGE && type != TopAbs_FACE && type != TopAbs_WIRE;
+	if (all || type == TopAbs_VERTEX || type == TopAbs_WIRE)
+	{
+		TopTools_IndexedMapOfShape vertices;
+		TopExp::MapShapes(shape, TopAbs_VERTEX, vertices);
+		for (int i = 1; i <= vertices.Extent(); i++)
+			Handle(BRep_TVertex)::DownCast(vertices(i).TShape())->Tolerance(tolerance);
+	}
+	if (all || type == TopAbs_EDGE || type == TopAbs_WIRE)
+	{
+		TopTools_IndexedMapOfShape edges;
+		TopExp::MapShapes(shape, TopAbs_EDGE, edges);
+		for (int i = 1; i <= edges.Extent(); i++)
+			Handle(BRep_TEdge)::DownCast(edges(i).TShape())->Tolerance(tolerance);
+	}
+	if (all || type == TopAbs_FACE)
+	{
+		TopTools_IndexedMapOfShape faces;
+		TopExp::MapShapes(shape, TopAbs_FACE, faces);
+		for (int i = 1; i <= faces.Extent(); i++)
+			Handle(BRep_TFace)::DownCast(faces(i).TShape())->Tolerance(tolerance);
+	}
+}
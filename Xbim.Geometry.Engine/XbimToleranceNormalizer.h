@@ -0,0 +1,24 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TColStd_MapOfTransient.hxx>
+
+//Brings the tolerances of newly built topology up to the precision of the model. ShapeFix_ShapeTolerance walks the shape once
+//for vertices, once for edges and once for faces, meeting shared vertices and edges again through every face that uses them.
+//Here each vertex, edge and face is visited once per call, the shapes visited are recorded for that call only so nothing is
+//kept alive and no record can go stale when a shape is changed or freed between calls
+class XbimToleranceNormalizer
+{
+private:
+	static void Limit(const TopoDS_Shape& shape, double tolerance, TColStd_MapOfTransient& visited);
+	static bool IsLimited(const TopoDS_Shape& shape, double tolerance, TColStd_MapOfTransient& visited);
+public:
+	//raises every vertex, edge and face tolerance of the shape that is below the tolerance to it, as
+	//ShapeFix_ShapeTolerance::LimitTolerance does without an upper bound
+	static void Limit(const TopoDS_Shape& shape, double tolerance);
+	//true if Limit would change nothing, only reads the shape
+	static bool IsLimited(const TopoDS_Shape& shape, double tolerance);
+	//sets the tolerance of the vertices, edges and faces of the shape as ShapeFix_ShapeTolerance::SetTolerance does, TopAbs_WIRE
+	//sets the edges and vertices only
+	static void Set(const TopoDS_Shape& shape, double tolerance, TopAbs_ShapeEnum type = TopAbs_SHAPE);
+};
@@ -1,5 +1,6 @@
 #include "XbimVertex.h"
 #include "XbimConvert.h"
+#include "XbimNonUniformTransform.h"
 #include <BRep_Builder.hxx>
 #include <BRepBuilderAPI_Transform.hxx>
 #include <BRepBuilderAPI_GTransform.hxx>
@@ -107,8 +108,8 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
-				return gcnew XbimVertex(TopoDS::Vertex(tr.Shape()), Tag);
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
+				return gcnew XbimVertex(TopoDS::Vertex(transformed), Tag);
 			}
 			else
 			{
@@ -6,6 +6,8 @@
 #include "XbimEdgeSet.h"
 #include "XbimVertexSet.h"
 #include "XbimCompound.h"
+#include "XbimNonUniformTransform.h"
+#include "XbimToleranceNormalizer.h"
 #include <BRepBuilderAPI_Transform.hxx>
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <TopExp_Explorer.hxx>
@@ -13,7 +15,6 @@
 #include <BRepBndLib.hxx>
 #include <BRepTools_WireExplorer.hxx>
 
-#include <ShapeFix_ShapeTolerance.hxx>
 #include <BRepCheck_Analyzer.hxx>
 #include <ShapeFix_Shape.hxx>
 #include <TopoDS.hxx>
@@ -124,8 +125,7 @@ namespace Xbim
 			polyMaker.Close();
 			pWire = new TopoDS_Wire();
 			*pWire = polyMaker.Wire();
-			ShapeFix_ShapeTolerance fixer;
-			fixer.LimitTolerance(*pWire, tolerance);
+			XbimToleranceNormalizer::Limit(*pWire, tolerance);
 		}
 		XbimWire::XbimWire(double precision) { Init(precision); }
 		XbimWire::XbimWire(IIfcCurve^ profile, ILogger^ logger, XbimConstraints constraints) { Init(profile, logger, constraints); }
@@ -364,8 +364,7 @@ namespace Xbim
 
 				pWire = new TopoDS_Wire();
 				*pWire = wireMaker.Wire();
-				ShapeFix_ShapeTolerance tFixer;
-				tFixer.LimitTolerance(*pWire, precision);
+				XbimToleranceNormalizer::Limit(*pWire, precision);
 
 			}
 		}
@@ -515,15 +514,13 @@ namespace Xbim
 				}
 			}
 
-			ShapeFix_ShapeTolerance tFixer;
-			tFixer.LimitTolerance(*pWire, tolerance);
+			XbimToleranceNormalizer::Limit(*pWire, tolerance);
 
 		}
 
 		void XbimWire::Init(IIfcIndexedPolyCurve^ polyCurve, ILogger^ logger, XbimConstraints /*constraints*/)
 		{
 			double tolerance = polyCurve->Model->ModelFactors->Precision;
-			ShapeFix_ShapeTolerance tFixer;
 
 			IItemSet<IItemSet<Ifc4::MeasureResource::IfcLengthMeasure>^>^ coordList;
 			IIfcCartesianPointList3D^ points3D = dynamic_cast<IIfcCartesianPointList3D^>(polyCurve->Points);
@@ -613,11 +610,11 @@ namespace Xbim
 										XbimGeometryCreator::LogWarning(logger, segment, "Failed to join IfcArcIndex segment. It has been ignored");
 										return;
 									}
-									tFixer.LimitTolerance(edgeMaker.Vertex1(), actualGap + tolerance);
+									XbimToleranceNormalizer::Limit(edgeMaker.Vertex1(), actualGap + tolerance);
 								}
 							}
 
-							tFixer.LimitTolerance(edge, tolerance);
+							XbimToleranceNormalizer::Limit(edge, tolerance);
 							wireMaker.Add(edge);
 							if (!wireMaker.IsDone())
 							{
@@ -651,10 +648,10 @@ namespace Xbim
 											XbimGeometryCreator::LogWarning(logger, segment, "Failed to join IfcArcIndex as polyline segment. It has been ignored");
 											return;
 										}
-										tFixer.LimitTolerance(edgeMaker.Vertex1(), actualGap + tolerance);
+										XbimToleranceNormalizer::Limit(edgeMaker.Vertex1(), actualGap + tolerance);
 									}
 								}
-								tFixer.LimitTolerance(edge, tolerance);
+								XbimToleranceNormalizer::Limit(edge, tolerance);
 								wireMaker.Add(edge);
 								if (!wireMaker.IsDone())
 								{
@@ -726,11 +723,11 @@ namespace Xbim
 										XbimGeometryCreator::LogWarning(logger, segment, "Failed to join IfcLineIndex as polyline segment. It has been ignored");
 										return;
 									}
-									tFixer.LimitTolerance(polyMaker.FirstVertex(), actualGap + tolerance);
+									XbimToleranceNormalizer::Limit(polyMaker.FirstVertex(), actualGap + tolerance);
 								}
 							}
 							const TopoDS_Wire& wire = polyMaker.Wire();
-							tFixer.LimitTolerance(wire, tolerance);
+							XbimToleranceNormalizer::Limit(wire, tolerance);
 							wireMaker.Add(wire);
 							if (!wireMaker.IsDone())
 							{
@@ -806,7 +803,7 @@ namespace Xbim
 				{
 					pWire = new TopoDS_Wire();
 					*pWire = polyMaker.Wire();
-					tFixer.LimitTolerance(*pWire, tolerance);
+					XbimToleranceNormalizer::Limit(*pWire, tolerance);
 				}
 				else
 				{
@@ -838,8 +835,7 @@ namespace Xbim
 				{
 					pWire = new TopoDS_Wire();
 					*pWire = wireMaker.Wire();
-					ShapeFix_ShapeTolerance FTol;
-					FTol.LimitTolerance(*pWire, curve->Model->ModelFactors->Precision);
+					XbimToleranceNormalizer::Limit(*pWire, curve->Model->ModelFactors->Precision);
 				}
 				else
 				{
@@ -852,7 +848,6 @@ namespace Xbim
 		{
 			double tolerance = cCurve->Model->ModelFactors->Precision;
 			//BRepBuilderAPI_MakeWire converter;
-			ShapeFix_ShapeTolerance fTol;
 			double fiveMilli = 5 * cCurve->Model->ModelFactors->OneMilliMeter; //we are going to accept that a gap of 5mm is not a gap
 
 
@@ -908,7 +903,7 @@ namespace Xbim
 								pWire = new TopoDS_Wire();
 								*pWire = resultWire;
 								pWire->Closed(true);
-								fTol.LimitTolerance(*pWire, tolerance);
+								XbimToleranceNormalizer::Limit(*pWire, tolerance);
 								return;
 							}
 							resultWireFirstPoint = BRep_Tool::Pnt(resultWireFirstVertex);
@@ -980,7 +975,7 @@ namespace Xbim
 			}
 			pWire = new TopoDS_Wire();
 			*pWire = resultWire;
-			fTol.LimitTolerance(*pWire, tolerance);
+			XbimToleranceNormalizer::Limit(*pWire, tolerance);
 
 		}
 		//This is going to be added to to the selected vertex and the tolerances will be adjusted. the duplicate points will be removed
@@ -1097,8 +1092,7 @@ namespace Xbim
 				TopoDS_Face theFace = BRepBuilderAPI_MakeFace(thePlane, theWire);
 
 				//limit the tolerances for the vertices and edges
-				ShapeFix_ShapeTolerance tolFixer;
-				tolFixer.LimitTolerance(theWire, tolerance); //set all tolerances
+				XbimToleranceNormalizer::Limit(theWire, tolerance); //set all tolerances
 				//adjust vertex tolerances for bad planar fit if we have anything more than a triangle (which will alway fit a plane)
 
 				if (pointSeq.Length() > 3)
@@ -1560,8 +1554,7 @@ namespace Xbim
 			TopoDS_Wire wire;
 			b.MakeWire(wire);
 			b.Add(wire, edge);
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, circProfile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, circProfile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -1654,9 +1647,8 @@ namespace Xbim
 					TopoDS_Edge e3 = BRepBuilderAPI_MakeEdge(aSeg3);
 					TopoDS_Edge e4 = BRepBuilderAPI_MakeEdge(aSeg4);
 					TopoDS_Wire wire = BRepBuilderAPI_MakeWire(e1, e2, e3, e4);
-					ShapeFix_ShapeTolerance tol;
 					//set the correct precision
-					tol.LimitTolerance(wire, precision);
+					XbimToleranceNormalizer::Limit(wire, precision);
 					//apply the position transformation
 					if (rectProfile->Position != nullptr)
 						wire.Move(XbimConvert::ToLocation(rectProfile->Position));
@@ -1767,8 +1759,7 @@ namespace Xbim
 				t.SetTranslation(v);
 				wire.Move(t);
 			}*/
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -1846,8 +1837,7 @@ namespace Xbim
 				t.SetTranslation(v);
 				wire.Move(t);
 			}*/
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -1992,8 +1982,7 @@ namespace Xbim
 			TopoDS_Wire wire;
 			b.MakeWire(wire);
 			b.Add(wire, edge);
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -2144,8 +2133,7 @@ namespace Xbim
 			}
 			if (profile->Position != nullptr)
 				wire.Move(XbimConvert::ToLocation(profile->Position));
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -2256,8 +2244,7 @@ namespace Xbim
 				t.SetTranslation(v);
 				wire.Move(t);
 			}*/
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -2356,8 +2343,7 @@ namespace Xbim
 				t.SetTranslation(v);
 				wire.Move(t);
 			}*/
-			ShapeFix_ShapeTolerance FTol;
-			FTol.LimitTolerance(wire, profile->Model->ModelFactors->Precision);
+			XbimToleranceNormalizer::Limit(wire, profile->Model->ModelFactors->Precision);
 			pWire = new TopoDS_Wire();
 			*pWire = wire;
 		}
@@ -2453,7 +2439,6 @@ namespace Xbim
 			BRepAdaptor_CompCurve cc(*pWire, Standard_True);
 			GeomAbs_Shape continuity = cc.Continuity();
 			int numIntervals = cc.NbIntervals(continuity);
-			ShapeFix_ShapeTolerance fTol;
 
 			if (numIntervals == 1)
 			{
@@ -2484,7 +2469,7 @@ namespace Xbim
 					BRepBuilderAPI_MakeWire wm;
 					wm.Add(BRepBuilderAPI_MakeEdge(trimmed));
 					TopoDS_Wire trimmedWire = wm.Wire();
-					fTol.LimitTolerance(trimmedWire, this->MaxTolerance);
+					XbimToleranceNormalizer::Limit(trimmedWire, this->MaxTolerance);
 					return gcnew XbimWire(trimmedWire);
 				}
 				else
@@ -2576,7 +2561,7 @@ namespace Xbim
 
 				TopoDS_Wire trimmedWire = wm.Wire();
 
-				fTol.LimitTolerance(trimmedWire, this->MaxTolerance);
+				XbimToleranceNormalizer::Limit(trimmedWire, this->MaxTolerance);
 				return gcnew XbimWire(trimmedWire);
 			}
 		}
@@ -2904,8 +2889,8 @@ namespace Xbim
 			if (nonUniform != nullptr)
 			{
 				gp_GTrsf trans = XbimConvert::ToTransform(nonUniform);
-				BRepBuilderAPI_GTransform tr(this, trans, Standard_True); //make a copy of underlying shape
-				return gcnew XbimWire(TopoDS::Wire(tr.Shape()), Tag);
+				TopoDS_Shape transformed = XbimNonUniformTransform::Transform(this, trans); //keeps the analytic geometry where it can
+				return gcnew XbimWire(TopoDS::Wire(transformed), Tag);
 			}
 			else
 			{
@@ -0,0 +1,144 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+
+namespace XbimRegression
+{
+    /// <summary>
+    /// Compares the results of a run with those stored in a baseline results file, columns are matched by name
+    /// so baselines written before a column was added can still be used
+    /// </summary>
+    public class BaselineComparer
+    {
+        private static readonly string[] TimeColumns =
+        {
+            "Parse Duration (ms)", "Geometry Conversion (ms)", "Total Duration (ms)", "Shape Geometries (ms)",
+            "Mapped Items (ms)", "Features (ms)", "Product Shapes (ms)", "Regions (ms)"
+        };
+        // any increase in these is a regression
+        private static readonly string[] CountColumns = { "Errors", "Boolean Failures", "Boolean Timeouts" };
+
+        private readonly Dictionary<string, Dictionary<string, string>> _baseline;
+        private readonly Params _params;
+
+        public BaselineComparer(Params arguments)
+        {
+            _params = arguments;
+            _baseline = ReadResults(File.ReadAllLines(arguments.BaselineFile));
+        }
+
+        /// <summary>
+        /// Compares the results with the baseline, returns a description of each regression found
+        /// </summary>
+        public List<string> Compare(IEnumerable<ProcessResult> results)
+        {
+            var current = ReadResults(new[] { ProcessResult.CsvHeader }.Concat(results.Select(r => r.ToCsv())));
+            var regressions = new List<string>();
+            foreach (var file in current)
+            {
+                if (!_baseline.TryGetValue(file.Key, out var baseline))
+                {
+                    Console.WriteLine($"{file.Key} is not in the baseline");
+                    continue;
+                }
+                var now = file.Value;
+                if (IsTrue(now, "Failed") && !IsTrue(baseline, "Failed"))
+                {
+                    regressions.Add($"{file.Key}: processing failed");
+                    continue;
+                }
+                foreach (var column in CountColumns)
+                {
+                    if (TryRead(baseline, column, out var before) && TryRead(now, column, out var after) && after > before)
+                        regressions.Add($"{file.Key}: {column} increased from {before} to {after}");
+                }
+                if (TryRead(baseline, "Geometry Nodes", out var nodesBefore) && TryRead(now, "Geometry Nodes", out var nodesAfter) && nodesAfter < nodesBefore)
+                    regressions.Add($"{file.Key}: Geometry Nodes decreased from {nodesBefore} to {nodesAfter}");
+                foreach (var column in TimeColumns)
+                {
+                    if (TryRead(baseline, column, out var before) && TryRead(now, column, out var after) &&
+                        after - before > _params.MinTimeDelta && after > before * (1 + _params.TimeThreshold))
+                        regressions.Add($"{file.Key}: {column} increased from {before} to {after}");
+                }
+                if (TryRead(baseline, "Peak Working Set (MB)", out var memBefore) && TryRead(now, "Peak Working Set (MB)", out var memAfter) &&
+                    memBefore > 0 && memAfter > memBefore * (1 + _params.MemoryThreshold))
+                    regressions.Add($"{file.Key}: Peak Working Set (MB) increased from {memBefore} to {memAfter}");
+            }
+            foreach (var missing in _baseline.Keys.Except(current.Keys))
+            {
+                Console.WriteLine($"{missing} is in the baseline but was not processed");
+            }
+            return regressions;
+        }
+
+        private static bool IsTrue(Dictionary<string, string> row, string column)
+        {
+            return row.TryGetValue(column, out var value) && bool.TryParse(value, out var flag) && flag;
+        }
+
+        private static bool TryRead(Dictionary<string, string> row, string column, out double value)
+        {
+            value = 0;
+            return row.TryGetValue(column, out var text) && double.TryParse(text, NumberStyles.Float, CultureInfo.InvariantCulture, out value);
+        }
+
+        /// <summary>
+        /// Reads the rows of a results file keyed by file name, each row maps the column names to the values
+        /// </summary>
+        private static Dictionary<string, Dictionary<string, string>> ReadResults(IEnumerable<string> lines)
+        {
+            var results = new Dictionary<string, Dictionary<string, string>>(StringComparer.OrdinalIgnoreCase);
+            string[] header = null;
+            foreach (var line in lines)
+            {
+                if (string.IsNullOrWhiteSpace(line))
+                    continue;
+                var fields = SplitCsv(line);
+                if (header == null)
+                {
+                    header = fields.Select(f => f.Trim()).ToArray();
+                    continue;
+                }
+                var row = new Dictionary<string, string>();
+                for (int i = 0; i < header.Length && i < fields.Count; i++)
+                    row[header[i]] = fields[i];
+                if (row.TryGetValue("IFC File", out var name))
+                    results[name] = row;
+            }
+            return results;
+        }
+
+        private static List<string> SplitCsv(string line)
+        {
+            var fields = new List<string>();
+            var field = new StringBuilder();
+            bool quoted = false;
+            for (int i = 0; i < line.Length; i++)
+            {
+                var c = line[i];
+                if (c == '"')
+                {
+                    if (quoted && i + 1 < line.Length && line[i + 1] == '"')
+                    {
+                        field.Append(c);
+                        i++;
+                    }
+                    else
+                        quoted = !quoted;
+                }
+                else if (c == ',' && !quoted)
+                {
+                    fields.Add(field.ToString());
+                    field.Clear();
+                }
+                else
+                    field.Append(c);
+            }
+            fields.Add(field.ToString());
+            return fields;
+        }
+    }
+}
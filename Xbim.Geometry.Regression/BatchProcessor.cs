@@ -5,7 +5,9 @@ using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
 using System.Linq;
+using System.Threading.Tasks;
 using Xbim.Common;
+using Xbim.Common.Geometry;
 using Xbim.Geometry.Engine.Interop;
 using Xbim.Ifc;
 using Xbim.Ifc4.Interfaces;
@@ -32,87 +34,164 @@ namespace XbimRegression
             get { return _params; }
         }
 
-        public void Run()
+        /// <summary>
+        /// Processes the files and writes the results, returns 1 if a baseline was given and the run has regressed, otherwise 0
+        /// </summary>
+        public int Run()
         {
             FileInfo f = new FileInfo(Params.ResultsFile);
             Console.WriteLine($"Reporting to \"{f.FullName}\"");
 
-            using var writer = new StreamWriter(Params.ResultsFile);
-            writer.WriteLine(ProcessResult.CsvHeader);
-            // ParallelOptions opts = new ParallelOptions() { MaxDegreeOfParallelism = 12 };
-
-            // Parallel.ForEach<FileInfo>(toProcess, opts, file =>
-            foreach (var file in Params.FilesToProcess)
+            var results = new List<ProcessResult>();
+            using (var writer = new StreamWriter(Params.ResultsFile))
             {
-                //set up a  log file for this file run                 
-                var logFile = Path.ChangeExtension(file.FullName, "log");
-                ProcessResult result;
-                using (var loggerFactory = new LoggerFactory())
+                writer.WriteLine(ProcessResult.CsvHeader);
+                var opts = new ParallelOptions() { MaxDegreeOfParallelism = Math.Max(1, Params.MaxConcurrentFiles) };
+                Parallel.ForEach(Params.FilesToProcess, opts, file =>
                 {
-                    XbimLogging.LoggerFactory = loggerFactory;
-                    loggerFactory.AddConsole(LogLevel.Error);
-                    loggerFactory.AddProvider(new NReco.Logging.File.FileLoggerProvider(logFile, false)
+                    var result = ProcessFileWithLog(file);
+                    if (result == null)
+                        return;
+                    lock (writer)
                     {
-                        FormatLogEntry = (msg) =>
-                        {
-                            var sb = new System.Text.StringBuilder();
-                            StringWriter sw = new StringWriter(sb);
-                            var jsonWriter = new Newtonsoft.Json.JsonTextWriter(sw);
-                            jsonWriter.WriteStartArray();
-                            jsonWriter.WriteValue(DateTime.Now.ToString("o"));
-                            jsonWriter.WriteValue(msg.LogLevel.ToString());
-                            jsonWriter.WriteValue(msg.EventId.Id);
-                            jsonWriter.WriteValue(msg.Message);
-                            jsonWriter.WriteValue(msg.Exception?.ToString());
-                            jsonWriter.WriteEndArray();
-                            return sb.ToString();
-                        }
-                    });
-                    var logger = loggerFactory.CreateLogger<BatchProcessor>();
-                    Console.WriteLine($"Processing {file}");
-                    result = ProcessFile(file.FullName, writer, logger);
-                }
-                if (result == null)
+                        results.Add(result);
+                        writer.WriteLine(result.ToCsv());
+                        writer.Flush();
+                    }
+                });
+            }
+
+            var exitCode = 0;
+            if (Params.BaselineFile != null)
+            {
+                var regressions = new BaselineComparer(Params).Compare(results);
+                foreach (var regression in regressions)
                 {
-                    continue;
+                    Console.WriteLine($"Regression: {regression}");
                 }
+                Console.WriteLine($"{regressions.Count} regressions found against baseline \"{Params.BaselineFile}\"");
+                if (regressions.Any())
+                    exitCode = 1;
+            }
+
+            if (!Params.NoWait)
+            {
+                Console.WriteLine("Finished. Press Enter to continue...");
+                Console.ReadLine();
+            }
+            return exitCode;
+        }
+
+        private ProcessResult ProcessFileWithLog(FileInfo file)
+        {
+            // the logger factory is shared by the whole process so it can only be set when files are processed one at a time
+            var sequential = Params.MaxConcurrentFiles <= 1;
+            //set up a  log file for this file run                 
+            var logFile = Path.ChangeExtension(file.FullName, "log");
+            ProcessResult result;
+            using (var loggerFactory = new LoggerFactory())
+            {
+                if (sequential)
+                    XbimLogging.LoggerFactory = loggerFactory;
+                loggerFactory.AddConsole(LogLevel.Error);
+                loggerFactory.AddProvider(new NReco.Logging.File.FileLoggerProvider(logFile, false)
+                {
+                    FormatLogEntry = (msg) =>
+                    {
+                        var sb = new System.Text.StringBuilder();
+                        StringWriter sw = new StringWriter(sb);
+                        var jsonWriter = new Newtonsoft.Json.JsonTextWriter(sw);
+                        jsonWriter.WriteStartArray();
+                        jsonWriter.WriteValue(DateTime.Now.ToString("o"));
+                        jsonWriter.WriteValue(msg.LogLevel.ToString());
+                        jsonWriter.WriteValue(msg.EventId.Id);
+                        jsonWriter.WriteValue(msg.Message);
+                        jsonWriter.WriteValue(msg.Exception?.ToString());
+                        jsonWriter.WriteEndArray();
+                        return sb.ToString();
+                    }
+                });
+                var logger = loggerFactory.CreateLogger<BatchProcessor>();
+                Console.WriteLine($"Processing {file}");
+                result = ProcessFile(file.FullName, logger, sequential);
+            }
+            if (result == null)
+            {
+                return null;
+            }
 
+            if (sequential)
                 XbimLogging.LoggerFactory = null; // uses a default loggerFactory
 
-                var txt = File.ReadAllText(logFile);
-                if (string.IsNullOrEmpty(txt))
+            var txt = File.ReadAllText(logFile);
+            if (string.IsNullOrEmpty(txt))
+            {
+                File.Delete(logFile);
+                result.Errors = 0;
+                result.Warnings = 0;
+                result.Information = 0;
+            }
+            else
+            {
+                CountLogEntries(txt, result);
+            }
+            if (result != null && !result.Failed)
+            {
+                Console.WriteLine($"Processed {file} : {result.Errors} Errors, {result.Warnings} Warnings, {result.Information} Informational in {result.TotalTime}ms. {result.Entities} IFC Elements & {result.GeometryEntries} Geometry Nodes.");
+            }
+            else
+            {
+                Console.WriteLine("Processing failed for {0} after {1}ms.", file, result.TotalTime);
+            }
+            result.FileName = file.Name;
+            return result;
+        }
+
+        /// <summary>
+        /// Counts the log entries by level and the Boolean operations reported as failed or timed out
+        /// </summary>
+        private static void CountLogEntries(string log, ProcessResult result)
+        {
+            result.Errors = 0;
+            result.Warnings = 0;
+            result.Information = 0;
+            result.BooleanFailures = 0;
+            result.BooleanTimeouts = 0;
+            foreach (var line in log.Split(new[] { '\r', '\n' }, StringSplitOptions.RemoveEmptyEntries))
+            {
+                JArray entry;
+                try
                 {
-                    File.Delete(logFile);
-                    result.Errors = 0;
-                    result.Warnings = 0;
-                    result.Information = 0;
+                    entry = JArray.Parse(line);
                 }
-                else
+                catch (Newtonsoft.Json.JsonReaderException)
                 {
-
-                    var tokens = txt.Split(new char[] { ',' }, StringSplitOptions.RemoveEmptyEntries);
-                    result.Errors = tokens.Count(t => t == "\"Error\"");
-                    result.Warnings = tokens.Count(t => t == "\"Warning\"");
-                    result.Information = Math.Max(0, tokens.Count(t => t == "\"Information\"") - 2); //we always get 2
+                    continue;
                 }
-                if (result != null && !result.Failed)
+                var level = entry.Count > 1 ? (string)entry[1] : null;
+                var message = entry.Count > 3 ? (string)entry[3] ?? "" : "";
+                switch (level)
                 {
-                    Console.WriteLine($"Processed {file} : {result.Errors} Errors, {result.Warnings} Warnings, {result.Information} Informational in {result.TotalTime}ms. {result.Entities} IFC Elements & {result.GeometryEntries} Geometry Nodes.");
+                    case "Error":
+                        result.Errors++;
+                        break;
+                    case "Warning":
+                        result.Warnings++;
+                        break;
+                    case "Information":
+                        result.Information++;
+                        break;
+                    default:
+                        continue;
                 }
+                if (level == "Information" || message.IndexOf("boolean", StringComparison.OrdinalIgnoreCase) < 0)
+                    continue;
+                if (message.IndexOf("timed out", StringComparison.OrdinalIgnoreCase) >= 0)
+                    result.BooleanTimeouts++;
                 else
-                {
-                    Console.WriteLine("Processing failed for {0} after {1}ms.", file, result.TotalTime);
-                }
-                result.FileName = file.Name;
-                writer.WriteLine(result.ToCsv());
-                writer.Flush();
+                    result.BooleanFailures++;
             }
-
-            writer.Close();
-
-            Console.WriteLine("Finished. Press Enter to continue...");
-
-            Console.ReadLine();
+            result.Information = Math.Max(0, result.Information - 2); //we always get 2
         }
 
         string lastState = "";
@@ -151,21 +230,24 @@ namespace XbimRegression
             stateIsComplete = false;
         }
 
-        private ProcessResult ProcessFile(string ifcFile, StreamWriter writer, ILogger<BatchProcessor> logger)
+        private ProcessResult ProcessFile(string ifcFile, ILogger<BatchProcessor> logger, bool sequential)
         {
             RemoveFiles(ifcFile);
             // using (var eventTrace = LoggerFactory.CreateEventTrace())
             {
                 var result = new ProcessResult() { Errors = -1 };
                 var watch = new Stopwatch();
+                using var workingSet = new WorkingSetMonitor();
                 try
                 {
                     ReportProgressDelegate progress = null;
-                    if (_params.ReportProgress)
+                    // the console progress is not per file so it is only shown when files are processed one at a time
+                    if (_params.ReportProgress && sequential)
                     {
                         InitProgress();
                         progress = progressReport;
                     }
+                    var phases = new PhaseTimer(progress);
                     watch.Start();
                     using (var model = ParseModelFile(ifcFile, Params.Caching, logger, progress))
                     {
@@ -179,7 +261,7 @@ namespace XbimRegression
                         // context.CustomMeshingBehaviour = CustomMeshingBehaviour;
                         if (_params.WriteBreps == null)
                         {
-                            context.CreateContext(progress);
+                            context.CreateContext(phases.Report);
                             //}
                             var geomTime = watch.ElapsedMilliseconds - parseTime;
                             //XbimSceneBuilder sb = new XbimSceneBuilder();
@@ -203,6 +285,12 @@ namespace XbimRegression
                                         string.Format("{0}, {1}", header.FileDescription.Description.FirstOrDefault(),
                                             header.FileDescription.ImplementationLevel),
                                     GeometryEntries = geomReader.ShapeInstances.Count(),
+                                    ShapeGeometriesDuration = phases.Duration("WriteShapeGeometries"),
+                                    MappedItemsDuration = phases.Duration("WriteMappedItems"),
+                                    FeaturesDuration = phases.Duration("WriteFeatureElements"),
+                                    ProductShapesDuration = phases.Duration("WriteProductShapes"),
+                                    RegionsDuration = phases.Duration("WriteRegionsToDb"),
+                                    FeatureElements = phases.FeatureElements,
                                     IfcLength = ReadFileLength(ifcFile),
                                     XbimLength = ReadFileLength(xbimFilename),
                                     SceneLength = 0,
@@ -215,6 +303,7 @@ namespace XbimRegression
                                                 .OfType<IIfcManifoldSolidBrep>().Count(),
                                     Application = ohs == null ? "Unknown" : ohs.OwningApplication?.ApplicationFullName.ToString()
                                 };
+                                CountTriangles(geomReader, result);
                             }
                         }
 
@@ -319,6 +408,7 @@ namespace XbimRegression
                     result.Failed = true;
                     result.GeometryDuration = watch.ElapsedMilliseconds;
                 }
+                result.PeakWorkingSet = workingSet.Peak;
 
                 return result;
             }
@@ -326,6 +416,25 @@ namespace XbimRegression
 
 
 
+        /// <summary>
+        /// Reads the triangle count from the header of each binary shape geometry
+        /// </summary>
+        private static void CountTriangles(IGeometryStoreReader geomReader, ProcessResult result)
+        {
+            foreach (var geometry in geomReader.ShapeGeometries)
+            {
+                if ((XbimGeometryType)geometry.Format != XbimGeometryType.PolyhedronBinary)
+                    continue;
+                var data = ((IXbimShapeGeometryData)geometry).ShapeData;
+                // header is the format version byte, the vertex count and the triangle count
+                if (data == null || data.Length < 9)
+                    continue;
+                long triangles = BitConverter.ToUInt32(data, 5);
+                result.Triangles += triangles;
+                result.InstancedTriangles += triangles * Math.Max(1, geometry.ReferenceCount);
+            }
+        }
+
         private Xbim3DModelContext.MeshingBehaviourResult CustomMeshingBehaviour(int elementId, int typeId, ref double linearDeflection, ref double angularDeflection)
         {
             if (typeId == 571) // = reinforcingbar
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Globalization;
 using System.IO;
 using System.Linq;
 
@@ -19,6 +20,7 @@ namespace XbimRegression
         public bool ReportProgress = false;
         public List<int> WriteBreps = null;
         public bool GeometryV1;
+        public bool NoWait = false;
 
         public Params(string[] args)
         {
@@ -104,6 +106,24 @@ namespace XbimRegression
                             case "/geometryv1":
                                 GeometryV1 = true;
                                 break;
+                            case "/parallel":
+                                paramType = CompoundParameter.Parallel;
+                                break;
+                            case "/baseline":
+                                paramType = CompoundParameter.Baseline;
+                                break;
+                            case "/timethreshold":
+                                paramType = CompoundParameter.TimeThreshold;
+                                break;
+                            case "/memorythreshold":
+                                paramType = CompoundParameter.MemoryThreshold;
+                                break;
+                            case "/mintimedelta":
+                                paramType = CompoundParameter.MinTimeDelta;
+                                break;
+                            case "/nowait":
+                                NoWait = true;
+                                break;
                             default:
                                 Console.WriteLine("Skipping un-expected argument '{0}'", arg);
                                 break;
@@ -125,6 +145,50 @@ namespace XbimRegression
                         }
                         paramType = CompoundParameter.None;
                         break;
+                    case CompoundParameter.Parallel:
+                        int files;
+                        if (int.TryParse(arg, out files) && files > 0)
+                        {
+                            MaxConcurrentFiles = files;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.Baseline:
+                        if (File.Exists(arg))
+                        {
+                            BaselineFile = arg;
+                        }
+                        else
+                        {
+                            Console.WriteLine("Baseline file {0} not found", arg);
+                            return;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.TimeThreshold:
+                        double timeThreshold;
+                        if (double.TryParse(arg, NumberStyles.Float, CultureInfo.InvariantCulture, out timeThreshold))
+                        {
+                            TimeThreshold = timeThreshold / 100;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.MemoryThreshold:
+                        double memoryThreshold;
+                        if (double.TryParse(arg, NumberStyles.Float, CultureInfo.InvariantCulture, out memoryThreshold))
+                        {
+                            MemoryThreshold = memoryThreshold / 100;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.MinTimeDelta:
+                        int minTimeDelta;
+                        if (int.TryParse(arg, out minTimeDelta))
+                        {
+                            MinTimeDelta = minTimeDelta;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
                     case CompoundParameter.Breps:
                         int brepv;
                         if (int.TryParse(arg, out brepv))
@@ -145,6 +209,7 @@ namespace XbimRegression
         private static void WriteSyntax()
         {
             Console.WriteLine("Syntax: XbimRegression <modelfolder> [/timeout <seconds>] [/maxthreads <number>] [/singlethread] /writebreps [labels]");
+            Console.WriteLine("        [/parallel <files>] [/baseline <results.csv>] [/timethreshold <percent>] [/memorythreshold <percent>] [/mintimedelta <ms>] [/nowait]");
         }
 
         /// <summary>
@@ -157,6 +222,31 @@ namespace XbimRegression
         /// </summary>
         public int Timeout { get; set; }
 
+        /// <summary>
+        /// Number of files processed at the same time
+        /// </summary>
+        public int MaxConcurrentFiles { get; set; } = 1;
+
+        /// <summary>
+        /// Results file of an earlier run to compare this run with, null if there is no comparison
+        /// </summary>
+        public string BaselineFile { get; set; }
+
+        /// <summary>
+        /// Fraction a duration may grow by before it is reported as a regression
+        /// </summary>
+        public double TimeThreshold { get; set; } = 0.25;
+
+        /// <summary>
+        /// Fraction the peak working set may grow by before it is reported as a regression
+        /// </summary>
+        public double MemoryThreshold { get; set; } = 0.25;
+
+        /// <summary>
+        /// Durations that grow by less than this, in milli-seconds, are treated as noise
+        /// </summary>
+        public int MinTimeDelta { get; set; } = 1000;
+
         /// <summary>
         /// Flag indicating if the parameters are valid
         /// </summary>
@@ -170,7 +260,12 @@ namespace XbimRegression
             Timeout,
             MaxThreads,
             CachingOn,
-            Breps
+            Breps,
+            Parallel,
+            Baseline,
+            TimeThreshold,
+            MemoryThreshold,
+            MinTimeDelta
         };
     }
 }
@@ -0,0 +1,127 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading;
+using Xbim.Common;
+
+namespace XbimRegression
+{
+    /// <summary>
+    /// Times the phases of a context creation from the progress messages raised by Xbim3DModelContext.CreateContext
+    /// </summary>
+    /// <remarks>
+    /// Each phase reports -1 when it starts and 101 when it ends, the phase name is the first word of the message
+    /// </remarks>
+    public class PhaseTimer
+    {
+        private readonly ReportProgressDelegate _inner;
+        private readonly Stopwatch _watch = Stopwatch.StartNew();
+        private readonly Dictionary<string, long> _started = new Dictionary<string, long>();
+        private readonly Dictionary<string, long> _durations = new Dictionary<string, long>();
+
+        /// <param name="inner">optional delegate that all progress messages are forwarded to</param>
+        public PhaseTimer(ReportProgressDelegate inner = null)
+        {
+            _inner = inner;
+        }
+
+        /// <summary>
+        /// Number of opening and projection elements reported by the feature phase, -1 if it did not run
+        /// </summary>
+        public int FeatureElements { get; private set; } = -1;
+
+        public void Report(int percentProgress, object userState)
+        {
+            var state = userState?.ToString() ?? "";
+            var phase = PhaseName(state);
+            if (percentProgress == -1)
+            {
+                _started[phase] = _watch.ElapsedMilliseconds;
+                if (phase == "WriteFeatureElements")
+                    FeatureElements = ReadCount(state);
+            }
+            else if (percentProgress > 100 && _started.TryGetValue(phase, out var start))
+            {
+                _durations.TryGetValue(phase, out var total);
+                _durations[phase] = total + _watch.ElapsedMilliseconds - start;
+                _started.Remove(phase);
+            }
+            _inner?.Invoke(percentProgress, userState);
+        }
+
+        /// <summary>
+        /// The time spent in the phase in milliseconds, 0 if it did not run
+        /// </summary>
+        public long Duration(string phase)
+        {
+            return _durations.TryGetValue(phase, out var duration) ? duration : 0;
+        }
+
+        private static string PhaseName(string state)
+        {
+            var end = state.IndexOfAny(new[] { ' ', ',', '(' });
+            return end < 0 ? state : state.Substring(0, end);
+        }
+
+        private static int ReadCount(string state)
+        {
+            var open = state.IndexOf('(');
+            if (open < 0)
+                return -1;
+            var end = state.IndexOf(' ', open);
+            if (end < 0)
+                return -1;
+            return int.TryParse(state.Substring(open + 1, end - open - 1), out var count) ? count : -1;
+        }
+    }
+
+    /// <summary>
+    /// Samples the working set of the process while a file is processed and records the peak
+    /// </summary>
+    /// <remarks>
+    /// The working set is that of the whole process, when files are processed concurrently it includes the other files in progress
+    /// </remarks>
+    public class WorkingSetMonitor : IDisposable
+    {
+        private readonly Timer _timer;
+        private long _peak;
+
+        public WorkingSetMonitor(int intervalMs = 250)
+        {
+            Sample(null);
+            _timer = new Timer(Sample, null, intervalMs, intervalMs);
+        }
+
+        /// <summary>
+        /// Peak working set in bytes seen since the monitor was created
+        /// </summary>
+        public long Peak
+        {
+            get
+            {
+                Sample(null);
+                return Interlocked.Read(ref _peak);
+            }
+        }
+
+        private void Sample(object state)
+        {
+            long current;
+            using (var process = Process.GetCurrentProcess())
+                current = process.WorkingSet64;
+            long peak;
+            do
+            {
+                peak = Interlocked.Read(ref _peak);
+                if (current <= peak)
+                    return;
+            }
+            while (Interlocked.CompareExchange(ref _peak, current, peak) != peak);
+        }
+
+        public void Dispose()
+        {
+            _timer.Dispose();
+        }
+    }
+}
@@ -36,13 +36,45 @@ namespace XbimRegression
         public long BReps { get; set; }
         public String Application { get; set; }
         public long BooleanGeometries { get; set; }
+        public long ShapeGeometriesDuration { get; set; }
+        public long MappedItemsDuration { get; set; }
+        public long FeaturesDuration { get; set; }
+        public long ProductShapesDuration { get; set; }
+        public long RegionsDuration { get; set; }
+        /// <summary>
+        /// Peak working set of the process in bytes while the file was processed
+        /// </summary>
+        public long PeakWorkingSet { get; set; }
+        /// <summary>
+        /// Elements with openings or projections, each needs one or more Boolean operations
+        /// </summary>
+        public int FeatureElements { get; set; }
+        /// <summary>
+        /// Warnings and errors logged about Boolean operations that failed or were only partially applied
+        /// </summary>
+        public int BooleanFailures { get; set; }
+        public int BooleanTimeouts { get; set; }
+        /// <summary>
+        /// Triangles in the distinct shape geometries
+        /// </summary>
+        public long Triangles { get; set; }
+        /// <summary>
+        /// Triangles in the model once every shape geometry is counted for each of its instances
+        /// </summary>
+        public long InstancedTriangles { get; set; }
+
+        // new columns are added to the end so that older result files can still be used as a baseline
         public const String CsvHeader = @"IFC File, Errors, Warnings, Information, Parse Duration (ms), Geometry Conversion (ms), Total Duration (ms), IFC Size,  IFC Entities, Geometry Nodes, " +
            
-            "FILE_SCHEMA, FILE_NAME, FILE_DESCRIPTION, Application, Products, Solid Models, Maps, Booleans, BReps";
+            "FILE_SCHEMA, FILE_NAME, FILE_DESCRIPTION, Application, Products, Solid Models, Maps, Booleans, BReps, " +
+            "Failed, Shape Geometries (ms), Mapped Items (ms), Features (ms), Product Shapes (ms), Regions (ms), Peak Working Set (MB), " +
+            "Feature Elements, Boolean Failures, Boolean Timeouts, Triangles, Instanced Triangles";
 
         public String ToCsv()
         {
-            return String.Format($"\"{FileName}\",{Errors},{Warnings},{Information},{ParseDuration},{GeometryDuration},{TotalTime},{IfcLength},{Entities},{GeometryEntries},\"{IfcSchema}\",\"{IfcName}\",\"{IfcDescription}\",\"{Application}\",{IfcProductEntries},{IfcSolidGeometries},{IfcMappedGeometries},{BooleanGeometries},{BReps}");
+            return String.Format($"\"{FileName}\",{Errors},{Warnings},{Information},{ParseDuration},{GeometryDuration},{TotalTime},{IfcLength},{Entities},{GeometryEntries},\"{IfcSchema}\",\"{IfcName}\",\"{IfcDescription}\",\"{Application}\",{IfcProductEntries},{IfcSolidGeometries},{IfcMappedGeometries},{BooleanGeometries},{BReps}," +
+                $"{Failed},{ShapeGeometriesDuration},{MappedItemsDuration},{FeaturesDuration},{ProductShapesDuration},{RegionsDuration},{PeakWorkingSet / (1024 * 1024)}," +
+                $"{FeatureElements},{BooleanFailures},{BooleanTimeouts},{Triangles},{InstancedTriangles}");
         }
 
         public long TotalTime 
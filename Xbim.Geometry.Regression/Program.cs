@@ -4,17 +4,17 @@ namespace XbimRegression
 {
     class Program
     {
-        private static void Main(string[] args)
+        private static int Main(string[] args)
         {
             // ContextTesting is a class that has been temporarily created to test multiple files
             // ContextTesting.Run();
-            // return;
+            // return 0;
             IfcStore.ModelProviderFactory.UseHeuristicModelProvider();
             var arguments = new Params(args);
             if (!arguments.IsValid)
-                return;
+                return 2;
             var processor = new BatchProcessor(arguments);
-            processor.Run();
+            return processor.Run();
         }
     }
 }
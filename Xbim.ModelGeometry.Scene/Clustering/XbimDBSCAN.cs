@@ -10,36 +10,239 @@ namespace Xbim.ModelGeometry.Scene.Clustering
     /// http://en.wikipedia.org/wiki/DBSCAN
     /// Except the Noise portion has not been implemented.
     /// </summary>
+    /// <remarks>
+    /// Clusters are merged until no two cluster bounds are within the threshold distance of each other.
+    /// Candidate pairs are found by bucketing the bounds in a grid and merged with a union-find, each pass is near linear
+    /// and passes are repeated on the merged bounds until nothing changes
+    /// </remarks>
     public static class XbimDbscan
     {
+        //bounds that would cover more grid cells than this are tested against every other cluster instead
+        private const int MaxCellsPerBound = 64;
+
         public static List<XbimBBoxClusterElement> GetClusters(IEnumerable<XbimBBoxClusterElement> itemsToCluster, double eps)
+        {
+            return GetClusters(itemsToCluster, eps, 0);
+        }
+
+        /// <summary>
+        /// Clusters the items, any cluster larger than maxSize along an axis is then split in to smaller clusters
+        /// </summary>
+        /// <param name="itemsToCluster">The items to cluster, the first item of each cluster has the others added to it</param>
+        /// <param name="eps">the threshold distance</param>
+        /// <param name="maxSize">the largest size of a cluster along any axis, 0 or less if clusters are not to be split</param>
+        public static List<XbimBBoxClusterElement> GetClusters(IEnumerable<XbimBBoxClusterElement> itemsToCluster, double eps, double maxSize)
         {
             if (itemsToCluster == null) 
                 return null;
-            var clusters = itemsToCluster.ToList();
-            // eps *= eps; // square eps
+            var items = itemsToCluster.ToList();
+            // each group holds the indices of the items in it, in ascending order
+            var groups = items.Select((item, i) => new List<int> { i }).ToList();
+            var bounds = items.Select(item => item.Bound).ToList();
 
-            var lastCount = 0;
-            while (clusters.Count != lastCount)
+            while (groups.Count > 1)
             {
-                lastCount = clusters.Count;
-                for (var i = 0; i < clusters.Count; i++)
+                var sets = new UnionFind(groups.Count);
+                if (!MergeNeighbours(bounds, eps, sets))
+                    break;
+                var rootToGroup = new Dictionary<int, int>();
+                var mergedGroups = new List<List<int>>();
+                var mergedBounds = new List<XbimRect3D>();
+                for (var i = 0; i < groups.Count; i++)
                 {
-                    var baseItem = clusters[i];
-                    // efficiency fix: because clusters.removeat cost is O(count-index) then we start from the end of the list
-                    for (var j = clusters.Count - 1; j > i; j--)
+                    var root = sets.Find(i);
+                    if (rootToGroup.TryGetValue(root, out var g))
                     {
-                        if (ValidDistance(baseItem.Bound, clusters[j].Bound, eps))
-                        {
-                            baseItem.Add(clusters[j]);
-                            clusters.RemoveAt(j);
-                        }                         
+                        mergedGroups[g].AddRange(groups[i]);
+                        var bound = mergedBounds[g];
+                        bound.Union(bounds[i]);
+                        mergedBounds[g] = bound;
+                    }
+                    else
+                    {
+                        rootToGroup.Add(root, mergedGroups.Count);
+                        mergedGroups.Add(new List<int>(groups[i]));
+                        mergedBounds.Add(bounds[i]);
                     }
                 }
+                groups = mergedGroups;
+                bounds = mergedBounds;
+            }
+
+            if (maxSize > 0)
+            {
+                var splitGroups = new List<List<int>>(groups.Count);
+                foreach (var group in groups)
+                    Split(group, items, maxSize, splitGroups);
+                groups = splitGroups;
+            }
+
+            var clusters = new List<XbimBBoxClusterElement>(groups.Count);
+            foreach (var group in groups)
+            {
+                group.Sort();
+                var cluster = items[group[0]];
+                for (var i = 1; i < group.Count; i++)
+                    cluster.Add(items[group[i]]);
+                clusters.Add(cluster);
             }
             return clusters;
         }
 
+        /// <summary>
+        /// Unions every pair of bounds that are within the threshold distance, returns true if anything was merged
+        /// </summary>
+        private static bool MergeNeighbours(List<XbimRect3D> bounds, double eps, UnionFind sets)
+        {
+            // two bounds are within eps on every axis if they overlap once both are grown by half of eps,
+            // so bounds only need to be compared with the others in the grid cells their grown bound covers
+            var half = eps / 2;
+            var sizes = bounds.Where(IsFinite).Select(b => Math.Max(b.SizeX, Math.Max(b.SizeY, b.SizeZ))).OrderBy(s => s).ToList();
+            var cellSize = Math.Max(eps, sizes.Count > 0 ? sizes[sizes.Count / 2] : eps);
+            if (!(cellSize > 0))
+                cellSize = 1;
+            var cells = new Dictionary<(long, long, long), List<int>>();
+            var large = new List<int>();
+            for (var i = 0; i < bounds.Count; i++)
+            {
+                var b = bounds[i];
+                if (!IsFinite(b))
+                {
+                    large.Add(i);
+                    continue;
+                }
+                var x0 = (long)Math.Floor((b.X - half) / cellSize);
+                var y0 = (long)Math.Floor((b.Y - half) / cellSize);
+                var z0 = (long)Math.Floor((b.Z - half) / cellSize);
+                var x1 = (long)Math.Floor((b.X + b.SizeX + half) / cellSize);
+                var y1 = (long)Math.Floor((b.Y + b.SizeY + half) / cellSize);
+                var z1 = (long)Math.Floor((b.Z + b.SizeZ + half) / cellSize);
+                if ((x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > MaxCellsPerBound)
+                {
+                    large.Add(i);
+                    continue;
+                }
+                for (var x = x0; x <= x1; x++)
+                    for (var y = y0; y <= y1; y++)
+                        for (var z = z0; z <= z1; z++)
+                        {
+                            var key = (x, y, z);
+                            if (!cells.TryGetValue(key, out var cell))
+                            {
+                                cell = new List<int>();
+                                cells.Add(key, cell);
+                            }
+                            cell.Add(i);
+                        }
+            }
+
+            var merged = false;
+            foreach (var cell in cells.Values)
+            {
+                for (var i = 1; i < cell.Count; i++)
+                {
+                    for (var j = 0; j < i; j++)
+                    {
+                        if (sets.Find(cell[i]) != sets.Find(cell[j]) && ValidDistance(bounds[cell[i]], bounds[cell[j]], eps))
+                            merged |= sets.Union(cell[i], cell[j]);
+                    }
+                }
+            }
+            foreach (var i in large)
+            {
+                for (var j = 0; j < bounds.Count; j++)
+                {
+                    if (i != j && sets.Find(i) != sets.Find(j) && ValidDistance(bounds[i], bounds[j], eps))
+                        merged |= sets.Union(i, j);
+                }
+            }
+            return merged;
+        }
+
+        /// <summary>
+        /// Splits the group at the median of the item centres along its longest axis until each part fits within maxSize
+        /// </summary>
+        private static void Split(List<int> group, List<XbimBBoxClusterElement> items, double maxSize, List<List<int>> result)
+        {
+            var bound = items[group[0]].Bound;
+            for (var i = 1; i < group.Count; i++)
+                bound.Union(items[group[i]].Bound);
+            var largest = Math.Max(bound.SizeX, Math.Max(bound.SizeY, bound.SizeZ));
+            if (group.Count == 1 || !(largest > maxSize))
+            {
+                result.Add(group);
+                return;
+            }
+            Func<XbimRect3D, double> centre;
+            if (largest == bound.SizeX)
+                centre = b => b.X + b.SizeX / 2;
+            else if (largest == bound.SizeY)
+                centre = b => b.Y + b.SizeY / 2;
+            else
+                centre = b => b.Z + b.SizeZ / 2;
+            var sorted = group.OrderBy(i => centre(items[i].Bound)).ToList();
+            var half = sorted.Count / 2;
+            Split(sorted.GetRange(0, half), items, maxSize, result);
+            Split(sorted.GetRange(half, sorted.Count - half), items, maxSize, result);
+        }
+
+        private static bool IsFinite(XbimRect3D b)
+        {
+            return !double.IsInfinity(b.X) && !double.IsNaN(b.X) && !double.IsInfinity(b.SizeX) && !double.IsNaN(b.SizeX) &&
+                   !double.IsInfinity(b.Y) && !double.IsNaN(b.Y) && !double.IsInfinity(b.SizeY) && !double.IsNaN(b.SizeY) &&
+                   !double.IsInfinity(b.Z) && !double.IsNaN(b.Z) && !double.IsInfinity(b.SizeZ) && !double.IsNaN(b.SizeZ);
+        }
+
+        /// <summary>
+        /// Disjoint sets with path halving and union by size
+        /// </summary>
+        private class UnionFind
+        {
+            private readonly int[] _parent;
+            private readonly int[] _size;
+
+            public UnionFind(int count)
+            {
+                _parent = new int[count];
+                _size = new int[count];
+                for (var i = 0; i < count; i++)
+                {
+                    _parent[i] = i;
+                    _size[i] = 1;
+                }
+            }
+
+            public int Find(int i)
+            {
+                while (_parent[i] != i)
+                {
+                    _parent[i] = _parent[_parent[i]];
+                    i = _parent[i];
+                }
+                return i;
+            }
+
+            /// <summary>
+            /// Returns true if the two were in different sets
+            /// </summary>
+            public bool Union(int a, int b)
+            {
+                a = Find(a);
+                b = Find(b);
+                if (a == b)
+                    return false;
+                if (_size[a] < _size[b])
+                {
+                    var t = a;
+                    a = b;
+                    b = t;
+                }
+                _parent[b] = a;
+                _size[a] += _size[b];
+                return true;
+            }
+        }
+
         /// <summary>
         /// Looks at the maximum distance (between all axis) between two boxes and compares it with a specified threshold.
         /// </summary>
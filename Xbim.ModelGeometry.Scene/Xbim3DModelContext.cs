@@ -44,33 +44,57 @@ namespace Xbim.ModelGeometry.Scene
             private readonly int _styleId;
             private readonly int _productLabel;
             private readonly int _productType;
+            private readonly IList<XbimShapeInstance> _productShapes;
+            private readonly IList<XbimShapeInstance> _cutShapes;
+            private readonly IList<XbimShapeInstance> _projectShapes;
             private IXbimGeometryObjectSet _productGeometries;
             private IXbimSolidSet _cutGeometries;
             private IXbimSolidSet _projectGeometries;
 
-            public XbimProductBooleanInfo(XbimCreateContextHelper contextHelper, XbimGeometryEngine engine, IModel model, ConcurrentDictionary<int, bool> shapeIdsUsedMoreThanOnce, IList<XbimShapeInstance> productShapes, IList<XbimShapeInstance> cutToolIds, IList<XbimShapeInstance> projectToolIds, int context, int styleId)
+            public XbimProductBooleanInfo(XbimCreateContextHelper contextHelper, IList<XbimShapeInstance> productShapes, IList<XbimShapeInstance> cutToolIds, IList<XbimShapeInstance> projectToolIds, int context, int styleId)
             {
                 _contextId = context;
                 _styleId = styleId;
+                _productShapes = productShapes;
+                _cutShapes = cutToolIds;
+                _projectShapes = projectToolIds;
 
                 // all the productShapes belong to the same product, take the first to identify it.
                 XbimShapeInstance shape = productShapes.FirstOrDefault();
                 _productLabel = shape != null ? shape.IfcProductLabel : 0;
                 _productType = shape != null ? shape.IfcTypeId : 0;
-                AddGeometries(contextHelper, engine, model, shapeIdsUsedMoreThanOnce, productShapes, cutToolIds, projectToolIds);
+
+                // the operand cache keeps each geometry until every operation that needs it has released it
+                foreach (var operand in Operands)
+                {
+                    int key;
+                    if (contextHelper.TryGetCacheKey(operand, out key))
+                        contextHelper.OperandCache.AddConsumer(key);
+                }
+            }
+
+            private IEnumerable<XbimShapeInstance> Operands
+            {
+                get { return _productShapes.Concat(_cutShapes).Concat(_projectShapes); }
             }
 
-            private void AddGeometries(XbimCreateContextHelper contextHelper, XbimGeometryEngine engine, IModel model, ConcurrentDictionary<int, bool> shapeIdsUsedMoreThanOnce, IList<XbimShapeInstance> productShapes, IList<XbimShapeInstance> cutToolIds, IList<XbimShapeInstance> projectToolIds)
+            /// <summary>
+            /// Number of cutting and projecting shapes, the operations with the most are started first
+            /// </summary>
+            public int ToolCount
             {
-                // todo: memory: I suppose that the memory footprint grows during meshing because all the shapes are retained in the XbimBooleanDefinition fields
-                // this should be investigated and moved.
+                get { return _cutShapes.Count + _projectShapes.Count; }
+            }
 
-                bool placebo;
+            /// <summary>
+            /// Takes the geometries of the operands from the cache, called just before the Boolean operations
+            /// </summary>
+            public void AddGeometries(XbimCreateContextHelper contextHelper, XbimGeometryEngine engine, IModel model)
+            {
                 _productGeometries = engine.CreateGeometryObjectSet();
-                foreach (var argument in productShapes)
+                foreach (var argument in _productShapes)
                 {
-                    // makes copy if used more than once
-                    var geom = contextHelper.GetGeometryFromCache(argument, shapeIdsUsedMoreThanOnce.TryGetValue(argument.ShapeGeometryLabel, out placebo));
+                    var geom = contextHelper.GetGeometryFromCache(argument);
                     if (geom != null)
                         _productGeometries.Add(geom);
                     else
@@ -81,13 +105,11 @@ namespace Xbim.ModelGeometry.Scene
 
                 //now build the openings
                 _cutGeometries = engine.CreateSolidSet();
-                foreach (var openingShape in cutToolIds)
+                foreach (var openingShape in _cutShapes)
                 {
-                    // makes copy if used more than once
-                    bool makeCopy = shapeIdsUsedMoreThanOnce.TryGetValue(openingShape.ShapeGeometryLabel, out placebo);
-                    var openingGeom = contextHelper.GetGeometryFromCache(openingShape, makeCopy);
+                    var openingGeom = contextHelper.GetGeometryFromCache(openingShape);
                     if (openingGeom != null)
-                        _cutGeometries.Add(openingGeom);
+                        AddTool(_cutGeometries, openingGeom, openingShape.IfcProductLabel);
                     else
                         LogWarning(model.Instances[openingShape.IfcProductLabel],
                        "Some 3D geometric form definition is missing");
@@ -95,17 +117,47 @@ namespace Xbim.ModelGeometry.Scene
 
                 //now all the projections
                 _projectGeometries = engine.CreateSolidSet();
-                foreach (var projectionShape in projectToolIds)
+                foreach (var projectionShape in _projectShapes)
                 {
-                    var projGeom = contextHelper.GetGeometryFromCache(projectionShape, shapeIdsUsedMoreThanOnce.TryGetValue(projectionShape.ShapeGeometryLabel, out placebo));
+                    var projGeom = contextHelper.GetGeometryFromCache(projectionShape);
                     if (projGeom != null)
-                        _projectGeometries.Add(projGeom);
+                        AddTool(_projectGeometries, projGeom, projectionShape.IfcProductLabel);
                     else
                         LogWarning(model.Instances[projectionShape.IfcProductLabel],
                        "Some 3D geometric form definition is missing");
                 }
             }
 
+            /// <summary>
+            /// Tags the solids of a tool with the label of its product, a Boolean operation that has to skip the tool names it by the tag
+            /// </summary>
+            private static void AddTool(IXbimSolidSet tools, IXbimGeometryObject toolGeom, int productLabel)
+            {
+                var before = tools.Count;
+                tools.Add(toolGeom);
+                foreach (var solid in tools.Skip(before))
+                    solid.Tag = productLabel;
+            }
+
+            /// <summary>
+            /// Disposes the geometries of the operands and releases them from the cache, called once the operation has finished or failed
+            /// </summary>
+            public void Release(XbimCreateContextHelper contextHelper)
+            {
+                if (_productGeometries != null) _productGeometries.Dispose();
+                if (_cutGeometries != null) _cutGeometries.Dispose();
+                if (_projectGeometries != null) _projectGeometries.Dispose();
+                _productGeometries = null;
+                _cutGeometries = null;
+                _projectGeometries = null;
+                foreach (var operand in Operands)
+                {
+                    int key;
+                    if (contextHelper.TryGetCacheKey(operand, out key))
+                        contextHelper.OperandCache.Release(key);
+                }
+            }
+
 
             public int ContextId
             {
@@ -194,7 +246,7 @@ namespace Xbim.ModelGeometry.Scene
             private HashSet<int> VoidedProductIds { get; set; }
             internal HashSet<int> VoidedShapeIds { get; set; }
             internal HashSet<int> ProductShapeIds { get; private set; }
-            internal ConcurrentDictionary<int, IXbimGeometryObject> CachedGeometries { get; private set; }
+            internal XbimBooleanOperandCache OperandCache { get; set; }
             internal int Total { get; private set; }
             internal int PercentageParsed { get; set; }
             internal int Tally { get; set; }
@@ -214,27 +266,34 @@ namespace Xbim.ModelGeometry.Scene
 
             public MeshingBehaviourSetter customMeshBehaviour { get; internal set; }
 
-            internal IXbimGeometryObject GetGeometryFromCache(XbimShapeInstance shapeInstance, bool makeCopy)
+            /// <summary>
+            /// Places an instance of the cached geometry of the shape. Rigid placements only set the location of the instance so it
+            /// shares the geometry of the cached shape, only a scaling transform makes a copy. An instance must not be meshed, it
+            /// would write the triangulation to faces other threads may be reading or meshing
+            /// </summary>
+            internal IXbimGeometryObject GetGeometryFromCache(XbimShapeInstance shapeInstance)
             {
-
                 int ifcShapeId;
+                if (!TryGetCacheKey(shapeInstance, out ifcShapeId))
+                    return null;
+                return OperandCache.Use(ifcShapeId, obj => obj.TransformShallow(shapeInstance.Transformation));
+            }
+
+            /// <summary>
+            /// Finds the IFC label of the shape of the instance, the key of its geometry in the operand cache
+            /// </summary>
+            internal bool TryGetCacheKey(XbimShapeInstance shapeInstance, out int ifcShapeId)
+            {
                 if (GeometryShapeLookup.TryGetValue(shapeInstance.ShapeGeometryLabel, out ifcShapeId))
+                    return true;
+                //it might be a map
+                GeometryReference geomRef;
+                if (ShapeLookup.TryGetValue(shapeInstance.InstanceLabel, out geomRef))
                 {
-                    IXbimGeometryObject obj;
-                    if (CachedGeometries.TryGetValue(ifcShapeId, out obj))
-                        return makeCopy ? obj.Transform(shapeInstance.Transformation) : obj.TransformShallow(shapeInstance.Transformation);
-                } //it might be a map
-                else
-                {
-                    GeometryReference geomRef;
-                    if (ShapeLookup.TryGetValue(shapeInstance.InstanceLabel, out geomRef))
-                    {
-                        IXbimGeometryObject obj;
-                        if (CachedGeometries.TryGetValue(geomRef.GeometryId, out obj))
-                            return makeCopy ? obj.Transform(shapeInstance.Transformation) : obj.TransformShallow(shapeInstance.Transformation);
-                    }
+                    ifcShapeId = geomRef.GeometryId;
+                    return true;
                 }
-                return null;
+                return false;
             }
 
             internal bool Initialise(bool adjustWcs)
@@ -252,7 +311,6 @@ namespace Xbim.ModelGeometry.Scene
                     ParallelOptions = new ParallelOptions();
                    // ParallelOptions.MaxDegreeOfParallelism = 16;
 
-                    CachedGeometries = new ConcurrentDictionary<int, IXbimGeometryObject>();
                     foreach (var voidedShapeId in OpeningsAndProjections.Select(op => op.Key.EntityLabel))
                         VoidedProductIds.Add(voidedShapeId);
                     GetProductShapeIds();
@@ -465,14 +523,8 @@ namespace Xbim.ModelGeometry.Scene
             {
                 if (_disposed) return;
                 _disposed = true;
-                if (CachedGeometries != null)
-                {
-                    foreach (var cachedGeom in CachedGeometries)
-                    {
-                        if (cachedGeom.Value != null)
-                            cachedGeom.Value.Dispose();
-                    }
-                }
+                if (OperandCache != null)
+                    OperandCache.Dispose();
                 GC.SuppressFinalize(this);
             }
         }
@@ -697,6 +749,8 @@ namespace Xbim.ModelGeometry.Scene
                 return false;
             }
 
+            //each run builds from the model as it is now, anything the engine cached in an earlier run may be stale if it has been edited
+            Engine.ClearModelCaches(_model);
             using (var geometryTransaction = geometryStore.BeginInit())
             {
                 if (geometryTransaction == null)
@@ -716,6 +770,7 @@ namespace Xbim.ModelGeometry.Scene
                     {
                         contextHelper.ParallelOptions.MaxDegreeOfParallelism = MaxThreads;
                     }
+                    contextHelper.OperandCache = new XbimBooleanOperandCache(Model, Engine, BooleanOperandMemoryLimit);
 
                     WriteShapeGeometries(contextHelper, progDelegate, geometryTransaction, geomStorageType);
                     PrepareMapGeometryReferences(contextHelper, progDelegate);
@@ -747,6 +802,7 @@ namespace Xbim.ModelGeometry.Scene
                 }
                 geometryTransaction.Commit();
             }
+            Engine.ClearModelCaches(_model);
             _logger.LogInformation("Finished creation of model scene");
             return true;
         }
@@ -788,9 +844,6 @@ namespace Xbim.ModelGeometry.Scene
             var featureCount = contextHelper.OpeningsAndProjections.Count;
             if (progDelegate != null) progDelegate(-1, "WriteFeatureElements (" + contextHelper.OpeningsAndProjections.Count + " elements)");
 
-            var shapeIdsUsedMoreThanOnce = new ConcurrentDictionary<int, bool>();
-            var allShapeIds = new ConcurrentDictionary<int, bool>();
-
             var openingAndProjectionOps = new ConcurrentBag<XbimProductBooleanInfo>(); // prepares the information to perform the openings and projections
             //srl this was a workaround to resolve some isues with OCC booleans that are now fixed in 7.3
             // var precision = Math.Max(_model.ModelFactors.OneMilliMeter / 50, _model.ModelFactors.Precision); //set the precision to 100th mm but never less than precision
@@ -811,8 +864,6 @@ namespace Xbim.ModelGeometry.Scene
                 var productShapes = new List<XbimShapeInstance>();
                 foreach (var elemShape in elementShapes)
                 {
-                    if (!allShapeIds.TryAdd(elemShape.ShapeGeometryLabel, true))
-                        shapeIdsUsedMoreThanOnce.TryAdd(elemShape.ShapeGeometryLabel, true);
                     productShapes.Add(elemShape);
                     context = elemShape.RepresentationContext;
                     if (elemShape.StyleLabel > 0)
@@ -835,8 +886,6 @@ namespace Xbim.ModelGeometry.Scene
                         var featureShapes = WriteProductShape(contextHelper, feature, false, txn);
                         foreach (var featureShape in featureShapes)
                         {
-                            if (!allShapeIds.TryAdd(featureShape.ShapeGeometryLabel, true))
-                                shapeIdsUsedMoreThanOnce.TryAdd(featureShape.ShapeGeometryLabel, true);
                             if (isCut)
                                 cutTools.Add(featureShape);
                             else
@@ -845,19 +894,22 @@ namespace Xbim.ModelGeometry.Scene
                         processed.TryAdd(feature.EntityLabel, 0);
 
                     }
-                    var boolOp = new XbimProductBooleanInfo(contextHelper, Engine, Model, shapeIdsUsedMoreThanOnce, productShapes, cutTools, projectTools, context, styleId);
+                    var boolOp = new XbimProductBooleanInfo(contextHelper, productShapes, cutTools, projectTools, context, styleId);
                     openingAndProjectionOps.Add(boolOp);
                 }
             });
+            // every pending operation has been counted, shapes that none of them use are let go now
+            contextHelper.OperandCache.ReleaseUnconsumed();
 
             // process all the openings and projections starting with the most operations first
             //contextHelper.ParallelOptions.MaxDegreeOfParallelism = 1;
-            Parallel.ForEach(openingAndProjectionOps.OrderByDescending(b => b.CutGeometries.Count + b.ProjectGeometries.Count), contextHelper.ParallelOptions, openingAndProjectionOp =>
+            Parallel.ForEach(openingAndProjectionOps.OrderByDescending(b => b.ToolCount), contextHelper.ParallelOptions, openingAndProjectionOp =>
             {
                 Interlocked.Increment(ref localTally);
                 var elementLabel = 0;
                 try
                 {
+                    openingAndProjectionOp.AddGeometries(contextHelper, Engine, Model);
                     if (progDelegate != null)
                     {
                         var newPercentage = Convert.ToInt32((double)localTally / featureCount * 100.0);
@@ -889,14 +941,18 @@ namespace Xbim.ModelGeometry.Scene
 
                     // Get all the parts of this element into a set of solid geometries
                     var elementGeom = openingAndProjectionOp.ProductGeometries;
+                    var isBooleanResult = false;
                     // make the finished shape
                     if (behaviour.HasFlag(MeshingBehaviourResult.PerformAdditions) && openingAndProjectionOp.ProjectGeometries.Any())
                     {
-                        var nextGeom = elementGeom.Union(openingAndProjectionOp.ProjectGeometries, precision);
+                        var nextGeom = elementGeom.Union(openingAndProjectionOp.ProjectGeometries, precision, _logger);
                         if (nextGeom.IsValid)
                         {
                             if (nextGeom.First != null && nextGeom.First.IsValid)
+                            {
                                 elementGeom = nextGeom;
+                                isBooleanResult = true;
+                            }
                             else
                                 LogWarning(_model.Instances[elementLabel], "Projections are an empty shape");
                         }
@@ -911,11 +967,14 @@ namespace Xbim.ModelGeometry.Scene
                         try
                         {
                             //nextGeom = CutWithTimeOut(elementGeom, openingAndProjectionOp.CutGeometries, precision, BooleanTimeOutMilliSeconds);
-                            nextGeom = elementGeom.Cut(openingAndProjectionOp.CutGeometries, precision);
+                            nextGeom = elementGeom.Cut(openingAndProjectionOp.CutGeometries, precision, _logger);
                             if (nextGeom.IsValid)
                             {
                                 if (nextGeom.First != null && nextGeom.First.IsValid)
+                                {
                                     elementGeom = nextGeom;
+                                    isBooleanResult = true;
+                                }
                                 else
                                     LogWarning(_model.Instances[elementLabel],
                                         "Cutting openings has resulted in an empty shape");
@@ -933,9 +992,24 @@ namespace Xbim.ModelGeometry.Scene
 
                     }
 
+                    List<byte[]> meshes;
+                    //the product geometries share their faces with the cached shapes other threads are using and meshing writes to the
+                    //faces, so they are meshed as a copy. A Boolean result has already had what it shares with its operands copied
+                    using (var copy = isBooleanResult ? null : (IXbimGeometryObjectSet)elementGeom.Transform(XbimMatrix3D.Identity))
+                    {
+                        var meshedGeom = copy ?? elementGeom;
+                        meshes = meshedGeom.Select(geom => WriteTriangulation(geom, geomType, mf.Precision, thisDeflectionDistance, thisDeflectionAngle)).ToList();
+                        var budgetFactor = geomType == XbimGeometryType.PolyhedronBinary ? TriangleBudgetFactor(meshes.Sum(m => TriangleCount(m))) : 1;
+                        if (budgetFactor > 1)
+                        {
+                            CoarsenForBudget(budgetFactor, ref thisDeflectionDistance, ref thisDeflectionAngle);
+                            meshes = meshedGeom.Select(geom => WriteTriangulation(geom, geomType, mf.Precision, thisDeflectionDistance, thisDeflectionAngle)).ToList();
+                        }
+                    }
+
                     // now add to the DB     
                     //
-                    foreach (var geom in elementGeom)
+                    foreach (var shapeData in meshes)
                     {
                         XbimShapeGeometry shapeGeometry = new XbimShapeGeometry
                         {
@@ -945,25 +1019,7 @@ namespace Xbim.ModelGeometry.Scene
                             Format = geomType,
                             BoundingBox = elementGeom.BoundingBox
                         };
-                        var memStream = new MemoryStream(0x4000);
-
-                        if (geomType == XbimGeometryType.PolyhedronBinary)
-                        {
-                            using (var bw = new BinaryWriter(memStream))
-                            {
-                                Engine.WriteTriangulation(bw, geom, mf.Precision,
-                                    thisDeflectionDistance, thisDeflectionAngle);
-                            }
-                        }
-                        else
-                        {
-                            using (var tw = new StreamWriter(memStream))
-                            {
-                                Engine.WriteTriangulation(tw, geom, mf.Precision,
-                                    thisDeflectionDistance, thisDeflectionAngle);
-                            }
-                        }
-                        ((IXbimShapeGeometryData)shapeGeometry).ShapeData = memStream.ToArray();
+                        ((IXbimShapeGeometryData)shapeGeometry).ShapeData = shapeData;
                         if (shapeGeometry.ShapeData.Length > 0)
                         {
                             var shapeInstance = new XbimShapeInstance
@@ -989,6 +1045,10 @@ namespace Xbim.ModelGeometry.Scene
                     LogWarning(_model.Instances[elementLabel],
                         "Contains openings but  its basic geometry can not be built, {0}", e.Message);
                 }
+                finally
+                {
+                    openingAndProjectionOp.Release(contextHelper);
+                }
                 //if (progDelegate != null) progDelegate(101, "FeatureElement, (#" + element.EntityLabel + " ended)");
             });
             contextHelper.PercentageParsed = localPercentageParsed;
@@ -999,6 +1059,59 @@ namespace Xbim.ModelGeometry.Scene
             return new HashSet<int>(processed.Keys);
         }
 
+        /// <summary>
+        /// Largest angular deflection a mesh over the triangle budget is coarsened to
+        /// </summary>
+        private const double MaxBudgetAngle = Math.PI / 2;
+
+        private byte[] WriteTriangulation(IXbimGeometryObject geom, XbimGeometryType geomType, double precision, double deflection, double angle)
+        {
+            var memStream = new MemoryStream(0x4000);
+            if (geomType == XbimGeometryType.PolyhedronBinary)
+            {
+                using (var bw = new BinaryWriter(memStream))
+                {
+                    Engine.WriteTriangulation(bw, geom, precision, deflection, angle);
+                }
+            }
+            else
+            {
+                using (var tw = new StreamWriter(memStream))
+                {
+                    Engine.WriteTriangulation(tw, geom, precision, deflection, angle);
+                }
+            }
+            return memStream.ToArray();
+        }
+
+        /// <summary>
+        /// Number of triangles in PolyhedronBinary shape data, read from its header
+        /// </summary>
+        private static int TriangleCount(byte[] shapeData)
+        {
+            return shapeData != null && shapeData.Length >= 9 ? BitConverter.ToInt32(shapeData, 5) : 0;
+        }
+
+        /// <summary>
+        /// How many times over the triangle budget a mesh is, 1 if it is within it or there is no budget
+        /// </summary>
+        private double TriangleBudgetFactor(int triangleCount)
+        {
+            if (MaxTrianglesPerProduct <= 0 || triangleCount <= MaxTrianglesPerProduct)
+                return 1;
+            return (double)triangleCount / MaxTrianglesPerProduct;
+        }
+
+        /// <summary>
+        /// Coarsens the deflections of a mesh that is over the budget by the factor, the triangles along a curve go with
+        /// the inverse of the angle and of the square root of the linear deflection
+        /// </summary>
+        private static void CoarsenForBudget(double factor, ref double deflection, ref double angle)
+        {
+            deflection *= factor * factor;
+            angle = Math.Min(angle * factor, MaxBudgetAngle);
+        }
+
         private XbimMatrix3D ApplyShapeDisplacement(GeometryReference shape, XbimMatrix3D transformation)
         {
             if (!shape.LocalShapeDisplacement.HasValue)
@@ -1292,6 +1405,47 @@ namespace Xbim.ModelGeometry.Scene
         /// </summary>
         public int MaxThreads { get; set; }
 
+        /// <summary>
+        /// If true, swept disk solids that are not Boolean operands are meshed directly without building a solid. Default is true
+        /// The direct mesher only writes PolyhedronBinary, other storage types always build the solid
+        /// </summary>
+        public bool MeshSweptDisksDirectly { get; set; } = true;
+
+        /// <summary>
+        /// The largest size of a region along any axis in metres, larger regions are split by the median of their elements. 0 or less does not split regions
+        /// </summary>
+        public double MaxRegionSize { get; set; }
+
+        /// <summary>
+        /// Folder of a persistent cache of the B-reps of feature element and voided product shapes, these are read from the cache
+        /// on later runs instead of being built again. No cache is used if null or empty
+        /// </summary>
+        public string BrepCacheFolder { get; set; }
+
+        /// <summary>
+        /// Estimated memory in bytes the geometries waiting for Boolean operations may take before the least recently used are
+        /// written to a temporary folder and read back when needed. 0 or less keeps them all in memory
+        /// </summary>
+        public long BooleanOperandMemoryLimit { get; set; }
+
+        /// <summary>
+        /// Maximum number of triangles in the mesh of a product, a product or shape over it is meshed once more with the deflections
+        /// coarsened in proportion. Only PolyhedronBinary meshes are counted, 0 or less sets no limit. The engine adapts the
+        /// deflections to the size and curvature of each shape when the AdaptiveMeshing application setting is true
+        /// </summary>
+        public int MaxTrianglesPerProduct { get; set; }
+
+        /// <summary>
+        /// Meshes of tessellated face sets, and of face sets too large to build as a solid, are decimated with an error of up to
+        /// this multiple of the model precision. 0 or less, the default, leaves them as they are
+        /// </summary>
+        public double MeshDecimationPrecisionFactor { get; set; }
+
+        /// <summary>
+        /// Face set meshes with fewer triangles than this are not decimated. Default is 100000
+        /// </summary>
+        public int MeshDecimationMinTriangles { get; set; } = 100000;
+
         private void WriteShapeGeometries(XbimCreateContextHelper contextHelper, ReportProgressDelegate progDelegate, IGeometryStoreInitialiser geometryStore, XbimGeometryType geomStorageType)
         {
             var localPercentageParsed = contextHelper.PercentageParsed;
@@ -1306,6 +1460,13 @@ namespace Xbim.ModelGeometry.Scene
             var precision = Model.ModelFactors.Precision;
             var deflection = Model.ModelFactors.DeflectionTolerance;
             var deflectionAngle = Model.ModelFactors.DeflectionAngle;
+            var sweptDiskMesher = MeshSweptDisksDirectly && geomStorageType == XbimGeometryType.PolyhedronBinary
+                ? new XbimSweptDiskSolidMesher(Model, deflection, deflectionAngle)
+                : null;
+            var brepCache = string.IsNullOrEmpty(BrepCacheFolder) ? null : new XbimBrepCache(Model, Engine, BrepCacheFolder);
+            var decimator = MeshDecimationPrecisionFactor > 0
+                ? new XbimMeshDecimator(precision * MeshDecimationPrecisionFactor) { MinTriangleCount = MeshDecimationMinTriangles }
+                : null;
             //if we have any grids turn them in to geometry
             foreach (var grid in Model.Instances.OfType<IIfcGrid>())
             {
@@ -1332,141 +1493,291 @@ namespace Xbim.ModelGeometry.Scene
             // var geomCache = new ConcurrentDictionary<int, IXbimGeometryObject>();
             // Model.Tag = geomCache;
             ConcurrentDictionary<int, byte> processed = new ConcurrentDictionary<int, byte>();
-            try
-            {
-
-             //   int c = 0;
-             //contextHelper.ParallelOptions.MaxDegreeOfParallelism = 1;
-                Parallel.ForEach(contextHelper.ProductShapeIds, contextHelper.ParallelOptions, (shapeId) =>
+            // the work is a pipeline, shapes are built in parallel, meshed in parallel and written to the store by one writer,
+            // the bounded queues between the stages hold back the builders when meshing or the store fall behind
+            var capacity = Math.Max(4, 4 * (contextHelper.ParallelOptions.MaxDegreeOfParallelism > 0 ? contextHelper.ParallelOptions.MaxDegreeOfParallelism : Environment.ProcessorCount));
+            var failures = new ConcurrentQueue<Exception>();
+            using (var cancellation = new CancellationTokenSource())
+            using (var built = new BlockingCollection<ShapeGeometryWork>(capacity))
+            using (var meshed = new BlockingCollection<ShapeGeometryWork>(capacity))
+            {
+                Action<Exception> fail = e =>
+                {
+                    //stages stopped by the failure of another report cancellation, only the cause is kept
+                    if (!(e is OperationCanceledException))
+                        failures.Enqueue(e);
+                    cancellation.Cancel();
+                };
+                var parallelOptions = new ParallelOptions
+                {
+                    MaxDegreeOfParallelism = contextHelper.ParallelOptions.MaxDegreeOfParallelism,
+                    CancellationToken = cancellation.Token
+                };
+                var meshing = Task.Factory.StartNew(() =>
                 {
-                  //  Console.WriteLine($"{c} - {shapeId}");
-                   // Interlocked.Increment(ref c);
-                    if (processed.TryGetValue(shapeId, out byte b)) return; //skip it
-                    processed.TryAdd(shapeId, 0); //we are only going to try once
-                    Interlocked.Increment(ref localTally);
-                    IIfcGeometricRepresentationItem shape;
                     try
                     {
-                        shape = (IIfcGeometricRepresentationItem)Model.Instances[shapeId];
-                    }
-                    catch (Exception ex)
-                    {
-                        var errmsg = string.Format("Error getting IIfcGeometricRepresentationItem for EntityLabel #{0}. Geometry Ignored.", shapeId);
-                        LogError(errmsg, ex);
-                        return;
+                        Parallel.ForEach(Partitioner.Create(built.GetConsumingEnumerable(cancellation.Token), EnumerablePartitionerOptions.NoBuffering), parallelOptions, work =>
+                        {
+                            MeshShapeGeometry(contextHelper, work, precision, deflection, deflectionAngle, geomStorageType);
+                            if (decimator != null && work.IsFaceSetMesh)
+                                DecimateShapeGeometry(decimator, work);
+                            meshed.Add(work, cancellation.Token);
+                        });
                     }
-                    if (shape == null)
+                    catch (OperationCanceledException) { }
+                    catch (AggregateException e) { foreach (var item in e.InnerExceptions) fail(item); }
+                    catch (Exception e) { fail(e); }
+                    finally { meshed.CompleteAdding(); }
+                }, TaskCreationOptions.LongRunning);
+                var storing = Task.Factory.StartNew(() =>
+                {
+                    try
                     {
-                        var errmsg = string.Format("IIfcGeometricRepresentationItem for EntityLabel #{0} not found. Geometry Ignored.", shapeId);
-                        LogError(errmsg);
-                        return;
+                        StoreShapeGeometries(contextHelper, meshed, geometryStore, cancellation.Token);
                     }
-                    var isFeatureElementShape = contextHelper.FeatureElementShapeIds.Contains(shapeId);
-                    var isVoidedProductShape = contextHelper.VoidedShapeIds.Contains(shapeId);
+                    catch (OperationCanceledException) { }
+                    catch (Exception e) { fail(e); }
+                }, TaskCreationOptions.LongRunning);
 
-
-                    // Console.WriteLine(shape.GetType().Name);
-                    XbimShapeGeometry shapeGeom = null;
-                    IXbimGeometryObject geomModel = null;
-                    if (!isFeatureElementShape && !isVoidedProductShape && xbimTessellator.CanMesh(shape)) // if we can mesh the shape directly just do it
-                    {
-                        shapeGeom = xbimTessellator.Mesh(shape);
-                    }
-                    else //we need to create a geometry object
+                try
+                {
+                    Parallel.ForEach(contextHelper.ProductShapeIds, parallelOptions, (shapeId) =>
                     {
-                        try
+                        if (processed.TryGetValue(shapeId, out byte b)) return; //skip it
+                        processed.TryAdd(shapeId, 0); //we are only going to try once
+                        Interlocked.Increment(ref localTally);
+                        var work = BuildShapeGeometry(contextHelper, shapeId, xbimTessellator, sweptDiskMesher, brepCache);
+                        if (work != null)
                         {
-                            geomModel = Engine.Create(shape, _logger);
-                        }
-                        catch (XbimGeometryFaceSetTooLargeException fse)
-                        {
-                            int faceSetEntityLabel = (int)fse.Data["LargeFaceSetLabel"];
-                            string faceSetEntityType = (string)fse.Data["LargeFaceSetType"];
-                            _logger.LogWarning("Large Face Set #{0} {1} detected and handled as Mesh", faceSetEntityLabel, faceSetEntityType);
-
-                            //just mesh the big shape as we have no idea what we shoudl have               
-                            shapeGeom = xbimTessellator.Mesh((IIfcRepresentationItem)Model.Instances[faceSetEntityLabel]);
+                            try
+                            {
+                                built.Add(work, cancellation.Token);
+                            }
+                            catch (OperationCanceledException)
+                            {
+                                DisposeGeometryModel(work);
+                                throw;
+                            }
                         }
-                        if (geomModel != null && geomModel.IsValid)
+                        if (progDelegate != null)
                         {
-
-                            shapeGeom = Engine.CreateShapeGeometry(geomModel, precision, deflection, deflectionAngle, geomStorageType, _logger);
-                            if (isFeatureElementShape)
+                            var newPercentage = Convert.ToInt32((double)localTally / contextHelper.Total * 100.0);
+                            if (newPercentage > localPercentageParsed)
                             {
-                                var geomSet = geomModel as IXbimGeometryObjectSet;
-                                if (geomSet != null)
-                                {
-                                    var solidSet = Engine.CreateSolidSet();
-                                    solidSet.Add(geomSet);
-                                    contextHelper.CachedGeometries.TryAdd(shapeId, solidSet);
-                                }
-                                //we need for boolean operations later, add the polyhedron if the face is planar
-                                else contextHelper.CachedGeometries.TryAdd(shapeId, geomModel);
+                                Interlocked.Exchange(ref localPercentageParsed, newPercentage);
+                                progDelegate(localPercentageParsed, "Creating Geometry");
                             }
-                            else if (isVoidedProductShape)
-                                contextHelper.CachedGeometries.TryAdd(shapeId, geomModel);
                         }
-                    }
+                    });
+                }
+                catch (OperationCanceledException) { }
+                catch (AggregateException e) { foreach (var item in e.InnerExceptions) fail(item); }
+                finally
+                {
+                    built.CompleteAdding();
+                    Task.WaitAll(meshing, storing);
+                    //work left in the queues when the stages were cancelled still holds the geometry built for it
+                    while (built.TryTake(out var left))
+                        DisposeGeometryModel(left);
+                    while (meshed.TryTake(out var left))
+                        DisposeGeometryModel(left);
+                }
+            }
+            if (!failures.IsEmpty)
+            {
+                foreach (var item in failures)
+                {
+                    LogError("Processing failure", item);
+                }
+                throw new XbimException("Processing halted due to model error", new AggregateException(failures));
+            }
+            contextHelper.PercentageParsed = localPercentageParsed;
+            contextHelper.Tally = localTally;
+            Debug.Assert(contextHelper.ProductShapeIds.Count == processed.Count);
+            if (progDelegate != null) progDelegate(101, "WriteShapeGeometries, (" + localTally + " written)");
+        }
 
-                    if (shapeGeom == null || shapeGeom.ShapeData == null || shapeGeom.ShapeData.Length == 0)
-                        LogInfo(_model.Instances[shapeId], "Is an empty shape");
-                    else
-                    {
-                        shapeGeom.IfcShapeLabel = shapeId;
-                        var reference = new GeometryReference
-                        {
-                            BoundingBox = shapeGeom.BoundingBox,
-                            GeometryId = geometryStore.AddShapeGeometry(shapeGeom),
-                            // if shape had large coordinates these might be reduced. This represents the
-                            // local displacement of the shape. It needs to be applied to shape (and bounding box) placement in the product.
-                            // This is often the case for already triangulated geometry from infrastructure tools like Bentley.
-                            // Large coordinates stored as floats loose numerical precision which is visible as distorted
-                            // geometry when visualised.
-                            LocalShapeDisplacement = shapeGeom.LocalShapeDisplacement
-                        };
-                        GetStyleId(contextHelper, shapeGeom.IfcShapeLabel, out int styleLabel);
-                        reference.StyleLabel = styleLabel;
-                        contextHelper.ShapeLookup.TryAdd(shapeGeom.IfcShapeLabel, reference);
-                        if (contextHelper.CachedGeometries.ContainsKey(shapeGeom.IfcShapeLabel))
-                        {
-                            //keep a record of the IFC label and database record mapping
-                            contextHelper.GeometryShapeLookup.TryAdd(shapeGeom.ShapeLabel, shapeGeom.IfcShapeLabel);
-                        }
+        /// <summary>
+        /// A shape as it passes through the stages of WriteShapeGeometries
+        /// </summary>
+        private class ShapeGeometryWork
+        {
+            public int ShapeId;
+            public IIfcGeometricRepresentationItem Shape;
+            public bool IsFeatureElementShape;
+            public bool IsVoidedProductShape;
+            public IXbimGeometryObject GeometryModel;
+            public XbimShapeGeometry ShapeGeometry;
+            // the shape geometry is the tessellated mesh of a face set, it may be decimated
+            public bool IsFaceSetMesh;
+        }
 
-                        //   shapeGeometries.Add(shapeGeom);
-                    }
-                    if (geomModel != null && geomModel.IsValid && !isFeatureElementShape && !isVoidedProductShape)
+        private static void DisposeGeometryModel(ShapeGeometryWork work)
+        {
+            work.GeometryModel?.Dispose();
+            work.GeometryModel = null;
+        }
+
+        /// <summary>
+        /// First stage, meshes the shape directly if it can, otherwise builds its geometry. Returns null if the shape is not found
+        /// </summary>
+        private ShapeGeometryWork BuildShapeGeometry(XbimCreateContextHelper contextHelper, int shapeId, XbimTessellator xbimTessellator, XbimSweptDiskSolidMesher sweptDiskMesher, XbimBrepCache brepCache)
+        {
+            IIfcGeometricRepresentationItem shape;
+            try
+            {
+                shape = (IIfcGeometricRepresentationItem)Model.Instances[shapeId];
+            }
+            catch (Exception ex)
+            {
+                var errmsg = string.Format("Error getting IIfcGeometricRepresentationItem for EntityLabel #{0}. Geometry Ignored.", shapeId);
+                LogError(errmsg, ex);
+                return null;
+            }
+            if (shape == null)
+            {
+                var errmsg = string.Format("IIfcGeometricRepresentationItem for EntityLabel #{0} not found. Geometry Ignored.", shapeId);
+                LogError(errmsg);
+                return null;
+            }
+            var work = new ShapeGeometryWork
+            {
+                ShapeId = shapeId,
+                Shape = shape,
+                IsFeatureElementShape = contextHelper.FeatureElementShapeIds.Contains(shapeId),
+                IsVoidedProductShape = contextHelper.VoidedShapeIds.Contains(shapeId)
+            };
+            var isFeatureElementShape = work.IsFeatureElementShape;
+            var isVoidedProductShape = work.IsVoidedProductShape;
+
+            if (!isFeatureElementShape && !isVoidedProductShape && xbimTessellator.CanMesh(shape)) // if we can mesh the shape directly just do it
+            {
+                work.ShapeGeometry = xbimTessellator.Mesh(shape);
+                work.IsFaceSetMesh = shape is IIfcTessellatedFaceSet;
+            }
+            else if (!isFeatureElementShape && !isVoidedProductShape && sweptDiskMesher != null && sweptDiskMesher.TryMesh(shape, out work.ShapeGeometry))
+            {
+                // swept disks that are never cut are meshed without building a solid
+            }
+            else //we need to create a geometry object
+            {
+                var useBrepCache = brepCache != null && (isFeatureElementShape || isVoidedProductShape);
+                try
+                {
+                    if (!useBrepCache || !brepCache.TryRead(shape, out work.GeometryModel))
                     {
-                        geomModel.Dispose();
+                        work.GeometryModel = Engine.Create(shape, _logger);
+                        if (useBrepCache && work.GeometryModel != null && work.GeometryModel.IsValid)
+                            brepCache.Write(shape, work.GeometryModel);
                     }
-                    if (progDelegate != null)
+                }
+                catch (XbimGeometryFaceSetTooLargeException fse)
+                {
+                    int faceSetEntityLabel = (int)fse.Data["LargeFaceSetLabel"];
+                    string faceSetEntityType = (string)fse.Data["LargeFaceSetType"];
+                    _logger.LogWarning("Large Face Set #{0} {1} detected and handled as Mesh", faceSetEntityLabel, faceSetEntityType);
+
+                    //just mesh the big shape as we have no idea what we shoudl have               
+                    work.ShapeGeometry = xbimTessellator.Mesh((IIfcRepresentationItem)Model.Instances[faceSetEntityLabel]);
+                    work.IsFaceSetMesh = true;
+                }
+            }
+            return work;
+        }
+
+        /// <summary>
+        /// Decimates the mesh of a face set, runs in the parallel meshing stage so shapes are decimated concurrently
+        /// </summary>
+        private void DecimateShapeGeometry(XbimMeshDecimator decimator, ShapeGeometryWork work)
+        {
+            var before = TriangleCount(((IXbimShapeGeometryData)work.ShapeGeometry)?.ShapeData);
+            try
+            {
+                if (decimator.TryDecimate(work.ShapeGeometry))
+                    LogInfo(work.Shape, "Face set #{0} decimated from {1} to {2} triangles", work.ShapeId, before, TriangleCount(((IXbimShapeGeometryData)work.ShapeGeometry).ShapeData));
+            }
+            catch (Exception e)
+            {
+                LogWarning(work.Shape, "Face set #{0} could not be decimated and is kept as it is: {1}", work.ShapeId, e.Message);
+            }
+        }
+
+        /// <summary>
+        /// Second stage, meshes any geometry that was built and keeps the geometry of feature elements and voided products for the Boolean operations
+        /// </summary>
+        private void MeshShapeGeometry(XbimCreateContextHelper contextHelper, ShapeGeometryWork work, double precision, double deflection, double deflectionAngle, XbimGeometryType geomStorageType)
+        {
+            var geomModel = work.GeometryModel;
+            if (geomModel != null && geomModel.IsValid)
+            {
+                work.ShapeGeometry = Engine.CreateShapeGeometry(geomModel, precision, deflection, deflectionAngle, geomStorageType, _logger);
+                var budgetFactor = geomStorageType == XbimGeometryType.PolyhedronBinary ? TriangleBudgetFactor(TriangleCount(((IXbimShapeGeometryData)work.ShapeGeometry)?.ShapeData)) : 1;
+                if (budgetFactor > 1)
+                {
+                    //a shape cannot take more than the budget of the products that use it
+                    var budgetDeflection = deflection;
+                    var budgetAngle = deflectionAngle;
+                    CoarsenForBudget(budgetFactor, ref budgetDeflection, ref budgetAngle);
+                    work.ShapeGeometry = Engine.CreateShapeGeometry(geomModel, precision, budgetDeflection, budgetAngle, geomStorageType, _logger);
+                }
+                if (work.IsFeatureElementShape)
+                {
+                    var geomSet = geomModel as IXbimGeometryObjectSet;
+                    if (geomSet != null)
                     {
-                        var newPercentage = Convert.ToInt32((double)localTally / contextHelper.Total * 100.0);
-                        if (newPercentage > localPercentageParsed)
-                        {
-                            Interlocked.Exchange(ref localPercentageParsed, newPercentage);
-                            progDelegate(localPercentageParsed, "Creating Geometry");
-                        }
+                        var solidSet = Engine.CreateSolidSet();
+                        solidSet.Add(geomSet);
+                        contextHelper.OperandCache.TryAdd(work.ShapeId, solidSet, XbimBooleanOperandCache.EstimateSize(work.ShapeGeometry));
                     }
-                    
-                  //  Interlocked.Decrement(ref c);
-                  //  Console.WriteLine($"->{c} - {shapeId}");
+                    //we need for boolean operations later, add the polyhedron if the face is planar
+                    else contextHelper.OperandCache.TryAdd(work.ShapeId, geomModel, XbimBooleanOperandCache.EstimateSize(work.ShapeGeometry));
                 }
-            );
-
+                else if (work.IsVoidedProductShape)
+                    contextHelper.OperandCache.TryAdd(work.ShapeId, geomModel, XbimBooleanOperandCache.EstimateSize(work.ShapeGeometry));
+                else
+                    geomModel.Dispose();
             }
-            catch (AggregateException e)
+            work.GeometryModel = null;
+            var shapeGeom = work.ShapeGeometry;
+            if (shapeGeom == null || shapeGeom.ShapeData == null || shapeGeom.ShapeData.Length == 0)
+                return;
+            shapeGeom.IfcShapeLabel = work.ShapeId;
+        }
+
+        /// <summary>
+        /// Last stage, the only one that writes to the store, adding each shape geometry as it is meshed
+        /// </summary>
+        private void StoreShapeGeometries(XbimCreateContextHelper contextHelper, BlockingCollection<ShapeGeometryWork> meshed, IGeometryStoreInitialiser geometryStore, CancellationToken cancellationToken)
+        {
+            foreach (var work in meshed.GetConsumingEnumerable(cancellationToken))
             {
-                foreach (var item in e.InnerExceptions)
+                var shapeGeom = work.ShapeGeometry;
+                if (shapeGeom == null || shapeGeom.ShapeData == null || shapeGeom.ShapeData.Length == 0)
                 {
-                    LogError("Processing failure", item);
+                    LogInfo(work.Shape, "Is an empty shape");
+                    continue;
+                }
+                var reference = new GeometryReference
+                {
+                    BoundingBox = shapeGeom.BoundingBox,
+                    GeometryId = geometryStore.AddShapeGeometry(shapeGeom),
+                    // if shape had large coordinates these might be reduced. This represents the
+                    // local displacement of the shape. It needs to be applied to shape (and bounding box) placement in the product.
+                    // This is often the case for already triangulated geometry from infrastructure tools like Bentley.
+                    // Large coordinates stored as floats loose numerical precision which is visible as distorted
+                    // geometry when visualised.
+                    LocalShapeDisplacement = shapeGeom.LocalShapeDisplacement
+                };
+                GetStyleId(contextHelper, shapeGeom.IfcShapeLabel, out int styleLabel);
+                reference.StyleLabel = styleLabel;
+                contextHelper.ShapeLookup.TryAdd(shapeGeom.IfcShapeLabel, reference);
+                if (contextHelper.OperandCache.Contains(shapeGeom.IfcShapeLabel))
+                {
+                    //keep a record of the IFC label and database record mapping
+                    contextHelper.GeometryShapeLookup.TryAdd(shapeGeom.ShapeLabel, shapeGeom.IfcShapeLabel);
                 }
-                throw new XbimException("Processing halted due to model error", e);
             }
-            contextHelper.PercentageParsed = localPercentageParsed;
-            contextHelper.Tally = localTally;
-            Debug.Assert(contextHelper.ProductShapeIds.Count == processed.Count);
-            if (progDelegate != null) progDelegate(101, "WriteShapeGeometries, (" + localTally + " written)");
         }
 
         private IXbimGeometryObject CallWithTimeout(IIfcGeometricRepresentationItem shape, ILogger logger, int booleanTimeOutMilliSeconds)
@@ -1540,9 +1851,9 @@ namespace Xbim.ModelGeometry.Scene
 
             var regions = new XbimRegionCollection();
             // the XbimDBSCAN method adopted for clustering produces clusters of contiguous elements.
-            // if the maximum size is a problem they could then be split using other algorithms that divide spaces equally
+            // if the maximum size is a problem they are split at the median of their elements until they fit MaxRegionSize
             //
-            var v = XbimDbscan.GetClusters(elementsToCluster, 5 * metre); // .OrderByDescending(x => x.GeometryIds.Count);
+            var v = XbimDbscan.GetClusters(elementsToCluster, 5 * metre, MaxRegionSize * metre); // .OrderByDescending(x => x.GeometryIds.Count);
             var i = 1;
             regions.AddRange(v.Select(item => new XbimRegion("Region " + i++, item.Bound, item.GeometryIds.Count, WorldCoordinateSystem)));
             regions.ContextLabel = context.EntityLabel;
@@ -1762,6 +2073,17 @@ namespace Xbim.ModelGeometry.Scene
             return mg;
         }
 
+        /// <summary>
+        /// Returns a view over the stored mesh of the shape geometry, the mesh is decoded from the stored bytes as it is read
+        /// </summary>
+        /// <returns>A view over the ShapeData buffer of the shape geometry, nothing is copied. Throws an ArgumentException if the geometry is not PolyhedronBinary</returns>
+        public XbimShapeMeshView ShapeGeometryMeshView(XbimShapeGeometry shapeGeometry)
+        {
+            if (shapeGeometry.Format != XbimGeometryType.PolyhedronBinary)
+                throw new ArgumentException("Only PolyhedronBinary shape geometries can be viewed", nameof(shapeGeometry));
+            return new XbimShapeMeshView(((IXbimShapeGeometryData)shapeGeometry).ShapeData);
+        }
+
         /// <summary>
         /// Returns a triangulated mesh geometry fopr the specified shape instance, all transformations are applied
         /// </summary>
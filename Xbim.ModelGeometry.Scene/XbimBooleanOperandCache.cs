@@ -0,0 +1,366 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Geometry.Engine.Interop;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Holds the geometries of feature element and voided product shapes from when they are built until the Boolean operations
+    /// that use them have finished. Each entry counts the operations that still need it and is disposed as soon as the last of
+    /// them releases it. When a memory limit is set and the estimated size of the entries in memory goes over it, the least
+    /// recently used entries are written to binary B-rep files in a temporary folder and read back the next time they are used.
+    /// All methods are thread safe.
+    /// </summary>
+    internal class XbimBooleanOperandCache : IDisposable
+    {
+        /// <summary>
+        /// A B-rep takes several times the memory of its mesh, the mesh is used to estimate the size as it is already at hand
+        /// </summary>
+        private const int BrepBytesPerMeshByte = 4;
+
+        private class Entry
+        {
+            public int Key;
+            public IXbimGeometryObject Geometry;
+            public bool IsSolidSet;
+            public long Size;
+            public int Consumers;
+            public string SpillPath;
+            public bool CannotSpill;
+            // position in the recently used list, null when the entry is not in memory
+            public LinkedListNode<Entry> Node;
+        }
+
+        private readonly XbimGeometryEngine _engine;
+        private readonly double _precision;
+        private readonly long _memoryLimit;
+        private readonly Dictionary<int, Entry> _entries = new Dictionary<int, Entry>();
+        // entries in memory, least recently used first
+        private readonly LinkedList<Entry> _recentlyUsed = new LinkedList<Entry>();
+        private readonly object _lock = new object();
+        private long _size;
+        private int _spillCount;
+        private string _spillFolder;
+        private bool _disposed;
+
+        /// <summary>
+        /// Creates the cache, a memory limit in bytes of 0 or less keeps all entries in memory. Spilled entries are read back
+        /// with the precision of the model
+        /// </summary>
+        public XbimBooleanOperandCache(IModel model, XbimGeometryEngine engine, long memoryLimit)
+        {
+            _engine = engine;
+            _precision = model.ModelFactors.Precision;
+            _memoryLimit = memoryLimit;
+        }
+
+        /// <summary>
+        /// Estimated size of the geometry in memory from the size of its mesh
+        /// </summary>
+        public static long EstimateSize(XbimShapeGeometry shapeGeometry)
+        {
+            var meshSize = ((IXbimShapeGeometryData)shapeGeometry)?.ShapeData?.Length ?? 0;
+            return (long)meshSize * BrepBytesPerMeshByte;
+        }
+
+        /// <summary>
+        /// Number of entries written to disk since the cache was created
+        /// </summary>
+        public int SpillCount => _spillCount;
+
+        /// <summary>
+        /// Adds the geometry of the shape, returns false if the shape is already held. Its tolerances are limited to the precision
+        /// here, while no other thread can use it, the Boolean operations would otherwise copy every instance to limit them
+        /// </summary>
+        public bool TryAdd(int key, IXbimGeometryObject geometry, long size)
+        {
+            _engine.LimitTolerance(geometry, _precision);
+            lock (_lock)
+            {
+                if (_entries.ContainsKey(key))
+                    return false;
+                var entry = new Entry
+                {
+                    Key = key,
+                    Geometry = geometry,
+                    IsSolidSet = geometry is IXbimSolidSet,
+                    Size = size
+                };
+                entry.Node = _recentlyUsed.AddLast(entry);
+                _entries.Add(key, entry);
+                _size += size;
+            }
+            Spill();
+            return true;
+        }
+
+        public bool Contains(int key)
+        {
+            lock (_lock)
+                return _entries.ContainsKey(key);
+        }
+
+        /// <summary>
+        /// Records one more pending operation that needs the shape, each must be matched by a call to Release
+        /// </summary>
+        public void AddConsumer(int key)
+        {
+            lock (_lock)
+            {
+                if (_entries.TryGetValue(key, out var entry))
+                    entry.Consumers++;
+            }
+        }
+
+        /// <summary>
+        /// Disposes the entries that no pending operation needs, called once all consumers have been added
+        /// </summary>
+        public void ReleaseUnconsumed()
+        {
+            List<Entry> unconsumed;
+            lock (_lock)
+            {
+                unconsumed = _entries.Values.Where(e => e.Consumers == 0).ToList();
+                foreach (var entry in unconsumed)
+                    _entries.Remove(entry.Key);
+            }
+            foreach (var entry in unconsumed)
+                Evict(entry);
+        }
+
+        /// <summary>
+        /// Calls use with the geometry of the shape, reading it back from disk if it has been spilled, and returns its result.
+        /// The geometry is only valid for the duration of the call. Returns the default if the shape is not held
+        /// </summary>
+        public T Use<T>(int key, Func<IXbimGeometryObject, T> use)
+        {
+            Entry entry;
+            lock (_lock)
+            {
+                if (!_entries.TryGetValue(key, out entry))
+                    return default(T);
+            }
+            T result;
+            lock (entry)
+            {
+                if (entry.Geometry == null && !Load(entry))
+                    return default(T);
+                result = use(entry.Geometry);
+                lock (_lock)
+                {
+                    if (entry.Node != null)
+                    {
+                        _recentlyUsed.Remove(entry.Node);
+                        _recentlyUsed.AddLast(entry.Node);
+                    }
+                }
+            }
+            Spill();
+            return result;
+        }
+
+        /// <summary>
+        /// Records that a pending operation no longer needs the shape, the entry is disposed when none are left
+        /// </summary>
+        public void Release(int key)
+        {
+            Entry entry;
+            lock (_lock)
+            {
+                if (!_entries.TryGetValue(key, out entry) || --entry.Consumers > 0)
+                    return;
+                _entries.Remove(key);
+            }
+            Evict(entry);
+        }
+
+        /// <summary>
+        /// Reads a spilled entry back in to memory, the caller holds the lock of the entry
+        /// </summary>
+        private bool Load(Entry entry)
+        {
+            if (entry.SpillPath == null)
+                return false; //released
+            IXbimGeometryObject geometry;
+            try
+            {
+                geometry = _engine.ReadBrep(entry.SpillPath, _precision);
+            }
+            catch (Exception e)
+            {
+                Xbim3DModelContext.LogError(string.Format("Spilled Boolean operand #{0} could not be read", entry.Key), e);
+                return false;
+            }
+            if (geometry == null)
+                return false;
+            //sets are written as a compound, operands that were solid sets are made so again
+            if (entry.IsSolidSet && !(geometry is IXbimSolidSet))
+            {
+                var solidSet = _engine.CreateSolidSet();
+                solidSet.Add(geometry);
+                geometry = solidSet;
+            }
+            TryDelete(entry.SpillPath);
+            entry.SpillPath = null;
+            entry.Geometry = geometry;
+            lock (_lock)
+            {
+                entry.Node = _recentlyUsed.AddLast(entry);
+                _size += entry.Size;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Writes the least recently used entries to disk until the estimated size is within the limit,
+        /// entries that are in use by another thread are skipped
+        /// </summary>
+        private void Spill()
+        {
+            if (_memoryLimit <= 0)
+                return;
+            while (true)
+            {
+                Entry victim = null;
+                lock (_lock)
+                {
+                    if (_size <= _memoryLimit || _disposed)
+                        return;
+                    for (var node = _recentlyUsed.First; node != null; node = node.Next)
+                    {
+                        if (!node.Value.CannotSpill && Monitor.TryEnter(node.Value))
+                        {
+                            victim = node.Value;
+                            break;
+                        }
+                    }
+                    if (victim == null)
+                        return;
+                    _recentlyUsed.Remove(victim.Node);
+                    victim.Node = null;
+                    _size -= victim.Size;
+                }
+                try
+                {
+                    SpillEntry(victim);
+                }
+                finally
+                {
+                    Monitor.Exit(victim);
+                }
+            }
+        }
+
+        private void SpillEntry(Entry entry)
+        {
+            var path = Path.Combine(SpillFolder(), entry.Key + ".brep");
+            try
+            {
+                _engine.WriteBrep(path, entry.Geometry);
+                entry.Geometry.Dispose();
+                entry.Geometry = null;
+                entry.SpillPath = path;
+                Interlocked.Increment(ref _spillCount);
+            }
+            catch (Exception e)
+            {
+                //keep it in memory and do not try again
+                Xbim3DModelContext.LogWarning(entry.Geometry, "Boolean operand #{0} could not be spilled to disk: {1}", entry.Key, e.Message);
+                TryDelete(path);
+                entry.CannotSpill = true;
+                lock (_lock)
+                {
+                    entry.Node = _recentlyUsed.AddLast(entry);
+                    _size += entry.Size;
+                }
+            }
+        }
+
+        private string SpillFolder()
+        {
+            lock (_lock)
+            {
+                if (_spillFolder == null)
+                {
+                    var folder = Path.Combine(Path.GetTempPath(), "XbimOperands" + Guid.NewGuid().ToString("N"));
+                    Directory.CreateDirectory(folder);
+                    _spillFolder = folder;
+                }
+                return _spillFolder;
+            }
+        }
+
+        private void Evict(Entry entry)
+        {
+            lock (entry)
+            {
+                lock (_lock)
+                {
+                    if (entry.Node != null)
+                    {
+                        _recentlyUsed.Remove(entry.Node);
+                        entry.Node = null;
+                        _size -= entry.Size;
+                    }
+                }
+                if (entry.Geometry != null)
+                {
+                    entry.Geometry.Dispose();
+                    entry.Geometry = null;
+                }
+                if (entry.SpillPath != null)
+                {
+                    TryDelete(entry.SpillPath);
+                    entry.SpillPath = null;
+                }
+            }
+        }
+
+        private static void TryDelete(string path)
+        {
+            try
+            {
+                File.Delete(path);
+            }
+            catch (IOException)
+            {
+            }
+            catch (UnauthorizedAccessException)
+            {
+            }
+        }
+
+        public void Dispose()
+        {
+            List<Entry> remaining;
+            lock (_lock)
+            {
+                if (_disposed) return;
+                _disposed = true;
+                remaining = _entries.Values.ToList();
+                _entries.Clear();
+            }
+            foreach (var entry in remaining)
+                Evict(entry);
+            if (_spillFolder != null)
+            {
+                try
+                {
+                    Directory.Delete(_spillFolder, true);
+                }
+                catch (IOException)
+                {
+                }
+                catch (UnauthorizedAccessException)
+                {
+                }
+            }
+            GC.SuppressFinalize(this);
+        }
+    }
+}
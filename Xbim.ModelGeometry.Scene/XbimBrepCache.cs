@@ -0,0 +1,213 @@
+﻿using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Security.Cryptography;
+using System.Text;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Geometry.Engine.Interop;
+using Xbim.Ifc4.Interfaces;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Persistent cache of the B-reps built for representation items, stored in the binary brep format of the engine so a
+    /// later run over the same model can read a shape instead of building it again. Each file is named by a fingerprint of
+    /// the representation item, the engine version and the model precision. The fingerprint is made from the values of the
+    /// item and everything it references, but not from entity labels, so it is stable when a model is exported again.
+    /// Solid sets are written as a compound, their files have a separate extension so they are read back as solid sets.
+    /// Files are read through a memory mapped view by the engine. All methods are thread safe.
+    /// </summary>
+    public class XbimBrepCache
+    {
+        private const string Extension = ".brep";
+        private const string SolidSetExtension = ".solids.brep";
+
+        private readonly XbimGeometryEngine _engine;
+        private readonly string _folder;
+        private readonly string _salt;
+        private readonly double _precision;
+
+        public XbimBrepCache(IModel model, XbimGeometryEngine engine, string folder)
+        {
+            _engine = engine;
+            _folder = folder;
+            _precision = model.ModelFactors.Precision;
+            Directory.CreateDirectory(folder);
+            _salt = string.Format(CultureInfo.InvariantCulture, "{0}|{1:R}",
+                engine.GetType().Assembly.GetName().Version, model.ModelFactors.Precision);
+        }
+
+        public string Folder => _folder;
+
+        /// <summary>
+        /// Reads the B-rep of the item if it is in the cache, a file that cannot be read is deleted and treated as missing
+        /// </summary>
+        public bool TryRead(IIfcGeometricRepresentationItem item, out IXbimGeometryObject geometry)
+        {
+            geometry = null;
+            var fingerprint = Fingerprint(item);
+            var path = Path.Combine(_folder, fingerprint + SolidSetExtension);
+            var isSolidSet = File.Exists(path);
+            if (!isSolidSet)
+            {
+                path = Path.Combine(_folder, fingerprint + Extension);
+                if (!File.Exists(path))
+                    return false;
+            }
+            try
+            {
+                geometry = _engine.ReadBrep(path, _precision);
+            }
+            catch (Exception e)
+            {
+                Xbim3DModelContext.LogWarning(item, "Cached brep {0} could not be read and is rebuilt: {1}", path, e.Message);
+                TryDelete(path);
+                return false;
+            }
+            //a solid set comes back as a compound, it is made a solid set again so the Boolean stage sees what it would have built
+            if (isSolidSet && geometry != null && !(geometry is IXbimSolidSet))
+            {
+                var solidSet = _engine.CreateSolidSet();
+                solidSet.Add(geometry);
+                geometry = solidSet;
+            }
+            return geometry != null && geometry.IsValid;
+        }
+
+        /// <summary>
+        /// Adds the B-rep of the item to the cache, the file is written under a temporary name and then moved
+        /// so a reader never sees a partly written file
+        /// </summary>
+        public void Write(IIfcGeometricRepresentationItem item, IXbimGeometryObject geometry)
+        {
+            var path = PathOf(item, geometry is IXbimSolidSet);
+            if (File.Exists(path))
+                return;
+            var tempPath = path + "." + Guid.NewGuid().ToString("N") + ".tmp";
+            try
+            {
+                _engine.WriteBrep(tempPath, geometry);
+                File.Move(tempPath, path);
+            }
+            catch (Exception e)
+            {
+                //another thread or process may have written the same shape first
+                TryDelete(tempPath);
+                if (!File.Exists(path))
+                    Xbim3DModelContext.LogWarning(item, "Brep could not be written to the cache: {0}", e.Message);
+            }
+        }
+
+        /// <summary>
+        /// Full path of the cache file of the item, isSolidSet gives the file of an item whose geometry is a solid set
+        /// </summary>
+        public string PathOf(IPersistEntity item, bool isSolidSet = false)
+        {
+            return Path.Combine(_folder, Fingerprint(item) + (isSolidSet ? SolidSetExtension : Extension));
+        }
+
+        /// <summary>
+        /// Hex SHA-256 of the explicit attribute values of the entity and of every entity it references, with the engine version
+        /// and model precision. Entities referenced more than once are written once and then referred to by the order they were first met
+        /// </summary>
+        public string Fingerprint(IPersistEntity item)
+        {
+            using (var ms = new MemoryStream())
+            using (var bw = new BinaryWriter(ms, Encoding.UTF8))
+            {
+                bw.Write(_salt);
+                WriteEntity(bw, item, new Dictionary<int, int>());
+                bw.Flush();
+                byte[] hash;
+                using (var sha = SHA256.Create())
+                    hash = sha.ComputeHash(ms.GetBuffer(), 0, (int)ms.Length);
+                var sb = new StringBuilder(hash.Length * 2);
+                foreach (var b in hash)
+                    sb.Append(b.ToString("x2"));
+                return sb.ToString();
+            }
+        }
+
+        private static void WriteEntity(BinaryWriter bw, IPersistEntity entity, Dictionary<int, int> visited)
+        {
+            if (visited.TryGetValue(entity.EntityLabel, out var order))
+            {
+                bw.Write('@');
+                bw.Write(order);
+                return;
+            }
+            visited.Add(entity.EntityLabel, visited.Count);
+            bw.Write('#');
+            bw.Write(entity.ExpressType.ExpressName);
+            foreach (var property in entity.ExpressType.Properties.OrderBy(p => p.Key))
+                WriteValue(bw, property.Value.PropertyInfo.GetValue(entity, null), visited);
+        }
+
+        private static void WriteValue(BinaryWriter bw, object value, Dictionary<int, int> visited)
+        {
+            switch (value)
+            {
+                case null:
+                    bw.Write('$');
+                    break;
+                case IPersistEntity entity:
+                    WriteEntity(bw, entity, visited);
+                    break;
+                case IExpressValueType expressValue:
+                    bw.Write('v');
+                    bw.Write(expressValue.GetType().Name);
+                    WriteValue(bw, expressValue.Value, visited);
+                    break;
+                case string text:
+                    bw.Write('s');
+                    bw.Write(text);
+                    break;
+                case double real:
+                    bw.Write('d');
+                    bw.Write(real);
+                    break;
+                case long integer:
+                    bw.Write('l');
+                    bw.Write(integer);
+                    break;
+                case int integer:
+                    bw.Write('i');
+                    bw.Write(integer);
+                    break;
+                case bool boolean:
+                    bw.Write('b');
+                    bw.Write(boolean);
+                    break;
+                case IEnumerable items:
+                    bw.Write('(');
+                    foreach (var item in items)
+                        WriteValue(bw, item, visited);
+                    bw.Write(')');
+                    break;
+                default:
+                    //enumerations, logicals and anything else with a stable text form
+                    bw.Write('e');
+                    bw.Write(Convert.ToString(value, CultureInfo.InvariantCulture));
+                    break;
+            }
+        }
+
+        private static void TryDelete(string path)
+        {
+            try
+            {
+                File.Delete(path);
+            }
+            catch (IOException)
+            {
+            }
+            catch (UnauthorizedAccessException)
+            {
+            }
+        }
+    }
+}
@@ -0,0 +1,616 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.Extensions.Logging;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    public enum XbimClashType
+    {
+        /// <summary>
+        /// The meshes penetrate each other or one is inside the other
+        /// </summary>
+        Hard,
+        /// <summary>
+        /// The meshes are closer than the required clearance
+        /// </summary>
+        Clearance
+    }
+
+    public class XbimClash
+    {
+        public XbimShapeInstance A { get; internal set; }
+        public XbimShapeInstance B { get; internal set; }
+        public XbimClashType Type { get; internal set; }
+        /// <summary>
+        /// Minimum distance between the meshes for a clearance clash, 0 for a hard clash
+        /// </summary>
+        public double Distance { get; internal set; }
+        /// <summary>
+        /// A point on A where the clash was found
+        /// </summary>
+        public XbimPoint3D Location { get; internal set; }
+        /// <summary>
+        /// Volume of the intersection of the solids of a hard clash, only set when the clash has been refined
+        /// </summary>
+        public double? Volume { get; internal set; }
+    }
+
+    /// <summary>
+    /// Finds clashes between the shape instances of a geometry store. The broad phase queries an XbimSceneIndex with the
+    /// instance bounds grown by the clearance, the narrow phase tests the triangles of each candidate pair in the region
+    /// where their bounds overlap, and hard clashes can optionally be refined with a Boolean intersection of the solids.
+    /// Pairs are tested in parallel and the clashes are returned as they are found.
+    /// </summary>
+    public class XbimClashDetector
+    {
+        private readonly IModel _model;
+        private readonly ILogger _logger;
+
+        public XbimClashDetector(IModel model, ILogger logger = null)
+        {
+            _model = model;
+            _logger = logger;
+        }
+
+        /// <summary>
+        /// Meshes closer than this are reported as clearance clashes, 0 only reports hard clashes
+        /// </summary>
+        public double Clearance { get; set; }
+
+        /// <summary>
+        /// Triangles that only touch within this distance are not a hard clash, defaults to the model precision
+        /// </summary>
+        public double Tolerance { get; set; } = -1;
+
+        /// <summary>
+        /// Maximum number of threads to use, any value less then 1 is not used
+        /// </summary>
+        public int MaxThreads { get; set; }
+
+        /// <summary>
+        /// If set hard clashes are refined by intersecting the solids it returns for each instance, these must be in world coordinates.
+        /// Clashes whose intersection has no volume are dropped
+        /// </summary>
+        public Func<XbimShapeInstance, IXbimSolidSet> SolidProvider { get; set; }
+
+        /// <summary>
+        /// Finds the clashes between every pair of instances, instances of the same product are not tested against each other
+        /// </summary>
+        public IEnumerable<XbimClash> Detect(IEnumerable<XbimShapeInstance> instances)
+        {
+            return Detect(instances, null);
+        }
+
+        /// <summary>
+        /// Finds the clashes between the instances of set A and set B, if set B is null set A is tested against itself
+        /// </summary>
+        public IEnumerable<XbimClash> Detect(IEnumerable<XbimShapeInstance> setA, IEnumerable<XbimShapeInstance> setB)
+        {
+            var listA = setA.Where(IsMeshed).ToList();
+            var listB = setB?.Where(IsMeshed).ToList();
+            var results = new BlockingCollection<XbimClash>(1024);
+            var cancellation = new CancellationTokenSource();
+            var producer = Task.Run(() =>
+            {
+                try
+                {
+                    Run(listA, listB, clash => results.Add(clash, cancellation.Token), cancellation.Token);
+                }
+                finally
+                {
+                    results.CompleteAdding();
+                }
+            });
+            try
+            {
+                foreach (var clash in results.GetConsumingEnumerable())
+                    yield return clash;
+                producer.Wait();
+            }
+            finally
+            {
+                //the caller may stop enumerating before all pairs are tested, the producer stops at its next result
+                cancellation.Cancel();
+                try
+                {
+                    producer.Wait();
+                }
+                catch (AggregateException)
+                {
+                    //already surfaced by the wait above or no longer wanted
+                }
+                cancellation.Dispose();
+                results.Dispose();
+            }
+        }
+
+        private static bool IsMeshed(XbimShapeInstance instance)
+        {
+            return (byte)instance.RepresentationType == (byte)XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded && !instance.BoundingBox.IsEmpty;
+        }
+
+        private void Run(List<XbimShapeInstance> setA, List<XbimShapeInstance> setB, Action<XbimClash> found, CancellationToken cancellation)
+        {
+            var tolerance = Tolerance >= 0 ? Tolerance : _model.ModelFactors.Precision;
+            var meshes = LoadMeshes(setB == null ? setA : setA.Concat(setB));
+            var index = new XbimSceneIndex(setB ?? setA, MaxThreads);
+            var parallelOptions = new ParallelOptions { CancellationToken = cancellation };
+            if (MaxThreads > 0)
+                parallelOptions.MaxDegreeOfParallelism = MaxThreads;
+            try
+            {
+                Parallel.ForEach(setA, parallelOptions, a =>
+                {
+                    var boundsA = a.BoundingBox.Transform(a.Transformation);
+                    var query = new XbimRect3D(boundsA.X - Clearance, boundsA.Y - Clearance, boundsA.Z - Clearance,
+                        boundsA.SizeX + 2 * Clearance, boundsA.SizeY + 2 * Clearance, boundsA.SizeZ + 2 * Clearance);
+                    foreach (var b in index.Overlapping(query))
+                    {
+                        if (b.IfcProductLabel == a.IfcProductLabel)
+                            continue;
+                        //each pair only once when a set is tested against itself
+                        if (setB == null && b.InstanceLabel <= a.InstanceLabel)
+                            continue;
+                        var clash = TestPair(meshes, a, b, tolerance);
+                        if (clash != null && (clash.Type != XbimClashType.Hard || Refine(clash, tolerance)))
+                            found(clash);
+                    }
+                });
+            }
+            catch (OperationCanceledException)
+            {
+                //the results are no longer wanted
+            }
+            catch (AggregateException) when (cancellation.IsCancellationRequested)
+            {
+                //a body was cancelled while adding a result
+            }
+        }
+
+        private Dictionary<int, XbimShapeMeshView> LoadMeshes(IEnumerable<XbimShapeInstance> instances)
+        {
+            //each call to Detect has its own meshes so concurrent calls do not see each other's
+            var meshes = new Dictionary<int, XbimShapeMeshView>();
+            using (var reader = _model.GeometryStore.BeginRead())
+            {
+                foreach (var label in instances.Select(i => i.ShapeGeometryLabel).Distinct())
+                {
+                    var geometry = reader.ShapeGeometry(label);
+                    var shapeData = ((IXbimShapeGeometryData)geometry)?.ShapeData;
+                    if (shapeData == null || shapeData.Length == 0 || geometry.Format != XbimGeometryType.PolyhedronBinary)
+                        continue;
+                    var mesh = new XbimShapeMeshView(shapeData);
+                    if (mesh.VertexCount > 0)
+                        meshes[label] = mesh;
+                }
+            }
+            return meshes;
+        }
+
+        private bool Refine(XbimClash clash, double tolerance)
+        {
+            if (SolidProvider == null)
+                return true;
+            try
+            {
+                var solidsA = SolidProvider(clash.A);
+                var solidsB = SolidProvider(clash.B);
+                if (solidsA == null || solidsB == null || !solidsA.Any() || !solidsB.Any())
+                    return true; //nothing to refine with, keep the mesh result
+                var intersection = solidsA.Intersection(solidsB, tolerance, _logger);
+                clash.Volume = intersection.Volume;
+                return intersection.Volume > tolerance * tolerance * tolerance;
+            }
+            catch (Exception e)
+            {
+                _logger?.LogWarning("GeomScene: #{entityLabel} failed to refine clash with #{otherLabel} [{message}]",
+                    clash.A.IfcProductLabel, clash.B.IfcProductLabel, e.Message);
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// Triangles of a mesh in world coordinates, with the bounds of each triangle
+        /// </summary>
+        private class WorldTriangles
+        {
+            public double[] Points; //9 per triangle
+            public double[] Bounds; //minX, minY, minZ, maxX, maxY, maxZ per triangle
+            public int Count;
+        }
+
+        private XbimClash TestPair(Dictionary<int, XbimShapeMeshView> meshes, XbimShapeInstance a, XbimShapeInstance b, double tolerance)
+        {
+            if (!meshes.TryGetValue(a.ShapeGeometryLabel, out var meshA) || !meshes.TryGetValue(b.ShapeGeometryLabel, out var meshB))
+                return null;
+            var boundsA = a.BoundingBox.Transform(a.Transformation);
+            var boundsB = b.BoundingBox.Transform(b.Transformation);
+            //only triangles in the region where the grown bounds overlap can clash
+            var region = new[]
+            {
+                Math.Max(boundsA.X, boundsB.X) - Clearance,
+                Math.Max(boundsA.Y, boundsB.Y) - Clearance,
+                Math.Max(boundsA.Z, boundsB.Z) - Clearance,
+                Math.Min(boundsA.X + boundsA.SizeX, boundsB.X + boundsB.SizeX) + Clearance,
+                Math.Min(boundsA.Y + boundsA.SizeY, boundsB.Y + boundsB.SizeY) + Clearance,
+                Math.Min(boundsA.Z + boundsA.SizeZ, boundsB.Z + boundsB.SizeZ) + Clearance
+            };
+            var trianglesA = GetTriangles(meshA, a.Transformation, region);
+            var trianglesB = GetTriangles(meshB, b.Transformation, region);
+
+            var minDistance = double.PositiveInfinity;
+            var location = default(XbimPoint3D);
+            if (trianglesA.Count > 0 && trianglesB.Count > 0)
+            {
+                //sweep along X, triangles of B sorted by their minimum X
+                var order = Enumerable.Range(0, trianglesB.Count).OrderBy(t => trianglesB.Bounds[t * 6]).ToArray();
+                var minXs = order.Select(t => trianglesB.Bounds[t * 6]).ToArray();
+                var maxWidth = 0.0;
+                for (var t = 0; t < trianglesB.Count; t++)
+                    maxWidth = Math.Max(maxWidth, trianglesB.Bounds[t * 6 + 3] - trianglesB.Bounds[t * 6]);
+                for (var ta = 0; ta < trianglesA.Count; ta++)
+                {
+                    var ba = ta * 6;
+                    var start = Array.BinarySearch(minXs, trianglesA.Bounds[ba] - Clearance - maxWidth);
+                    if (start < 0)
+                        start = ~start;
+                    for (var o = start; o < order.Length && minXs[o] <= trianglesA.Bounds[ba + 3] + Clearance; o++)
+                    {
+                        var tb = order[o];
+                        if (!BoundsOverlap(trianglesA.Bounds, ba, trianglesB.Bounds, tb * 6, Clearance))
+                            continue;
+                        if (TrianglesIntersect(trianglesA.Points, ta * 9, trianglesB.Points, tb * 9, tolerance))
+                            return new XbimClash { A = a, B = b, Type = XbimClashType.Hard, Location = Centroid(trianglesA.Points, ta * 9) };
+                        if (Clearance > 0)
+                        {
+                            var d = TriangleDistance(trianglesA.Points, ta * 9, trianglesB.Points, tb * 9);
+                            if (d < minDistance)
+                            {
+                                minDistance = d;
+                                location = Centroid(trianglesA.Points, ta * 9);
+                            }
+                        }
+                    }
+                }
+            }
+            //no crossing triangles, one may still be entirely inside the other
+            if (Contains(boundsB, boundsA) && IsInside(meshB, b.Transformation, meshA.Vertex(0), a.Transformation))
+                return new XbimClash { A = a, B = b, Type = XbimClashType.Hard, Location = a.Transformation.Transform(meshA.Vertex(0)) };
+            if (Contains(boundsA, boundsB) && IsInside(meshA, a.Transformation, meshB.Vertex(0), b.Transformation))
+                return new XbimClash { A = a, B = b, Type = XbimClashType.Hard, Location = b.Transformation.Transform(meshB.Vertex(0)) };
+            if (minDistance < Clearance)
+                return new XbimClash { A = a, B = b, Type = XbimClashType.Clearance, Distance = minDistance, Location = location };
+            return null;
+        }
+
+        private static WorldTriangles GetTriangles(XbimShapeMeshView mesh, XbimMatrix3D transform, double[] region)
+        {
+            var vertices = new float[mesh.VertexCount * 3];
+            mesh.CopyVertices(transform, vertices, 0);
+            var indices = new int[mesh.TriangleCount * 3];
+            var indexCount = mesh.CopyTriangleIndices(indices, 0);
+            var result = new WorldTriangles { Points = new double[indexCount * 3], Bounds = new double[indexCount * 2] };
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var p = result.Count * 9;
+                var b = result.Count * 6;
+                for (var k = 0; k < 3; k++)
+                    for (var axis = 0; axis < 3; axis++)
+                        result.Points[p + k * 3 + axis] = vertices[indices[i + k] * 3 + axis];
+                for (var axis = 0; axis < 3; axis++)
+                {
+                    var v0 = result.Points[p + axis];
+                    var v1 = result.Points[p + 3 + axis];
+                    var v2 = result.Points[p + 6 + axis];
+                    result.Bounds[b + axis] = Math.Min(v0, Math.Min(v1, v2));
+                    result.Bounds[b + 3 + axis] = Math.Max(v0, Math.Max(v1, v2));
+                }
+                if (BoundsOverlap(result.Bounds, b, region, 0, 0))
+                    result.Count++;
+            }
+            return result;
+        }
+
+        private static bool BoundsOverlap(double[] a, int ia, double[] b, int ib, double grow)
+        {
+            for (var axis = 0; axis < 3; axis++)
+            {
+                if (a[ia + axis] > b[ib + 3 + axis] + grow || b[ib + axis] > a[ia + 3 + axis] + grow)
+                    return false;
+            }
+            return true;
+        }
+
+        private static bool Contains(XbimRect3D outer, XbimRect3D inner)
+        {
+            return inner.X >= outer.X && inner.Y >= outer.Y && inner.Z >= outer.Z &&
+                   inner.X + inner.SizeX <= outer.X + outer.SizeX &&
+                   inner.Y + inner.SizeY <= outer.Y + outer.SizeY &&
+                   inner.Z + inner.SizeZ <= outer.Z + outer.SizeZ;
+        }
+
+        /// <summary>
+        /// Counts the crossings of a ray from the point with the closed mesh
+        /// </summary>
+        private static bool IsInside(XbimShapeMeshView mesh, XbimMatrix3D transform, XbimPoint3D localPoint, XbimMatrix3D pointTransform)
+        {
+            var point = pointTransform.Transform(localPoint);
+            var vertices = new float[mesh.VertexCount * 3];
+            mesh.CopyVertices(transform, vertices, 0);
+            var indices = new int[mesh.TriangleCount * 3];
+            var indexCount = mesh.CopyTriangleIndices(indices, 0);
+            //an arbitrary direction makes a ray through an edge or vertex unlikely
+            double dx = 0.5773, dy = 0.5779, dz = 0.5767;
+            var crossings = 0;
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var i0 = indices[i] * 3;
+                var i1 = indices[i + 1] * 3;
+                var i2 = indices[i + 2] * 3;
+                double e1x = vertices[i1] - vertices[i0], e1y = vertices[i1 + 1] - vertices[i0 + 1], e1z = vertices[i1 + 2] - vertices[i0 + 2];
+                double e2x = vertices[i2] - vertices[i0], e2y = vertices[i2 + 1] - vertices[i0 + 1], e2z = vertices[i2 + 2] - vertices[i0 + 2];
+                double px = dy * e2z - dz * e2y, py = dz * e2x - dx * e2z, pz = dx * e2y - dy * e2x;
+                var det = e1x * px + e1y * py + e1z * pz;
+                if (Math.Abs(det) < 1e-12)
+                    continue;
+                var inv = 1 / det;
+                double tx = point.X - vertices[i0], ty = point.Y - vertices[i0 + 1], tz = point.Z - vertices[i0 + 2];
+                var u = (tx * px + ty * py + tz * pz) * inv;
+                if (u < 0 || u > 1)
+                    continue;
+                double qx = ty * e1z - tz * e1y, qy = tz * e1x - tx * e1z, qz = tx * e1y - ty * e1x;
+                var v = (dx * qx + dy * qy + dz * qz) * inv;
+                if (v < 0 || u + v > 1)
+                    continue;
+                if ((e2x * qx + e2y * qy + e2z * qz) * inv > 0)
+                    crossings++;
+            }
+            return crossings % 2 == 1;
+        }
+
+        private static XbimPoint3D Centroid(double[] p, int i)
+        {
+            return new XbimPoint3D((p[i] + p[i + 3] + p[i + 6]) / 3, (p[i + 1] + p[i + 4] + p[i + 7]) / 3, (p[i + 2] + p[i + 5] + p[i + 8]) / 3);
+        }
+
+        #region Triangle tests
+
+        private static void Sub(double[] p, int i, int j, double[] r)
+        {
+            r[0] = p[j] - p[i];
+            r[1] = p[j + 1] - p[i + 1];
+            r[2] = p[j + 2] - p[i + 2];
+        }
+
+        private static double[] Cross(double[] a, double[] b)
+        {
+            return new[] { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        }
+
+        private static double Dot(double[] n, double[] p, int i)
+        {
+            return n[0] * p[i] + n[1] * p[i + 1] + n[2] * p[i + 2];
+        }
+
+        /// <summary>
+        /// Signed distances of the corners of triangle q from the plane of triangle p, scaled by the length of the plane normal.
+        /// Distances within the tolerance are snapped to zero, returns false unless the corners lie on both sides of the plane
+        /// </summary>
+        private static bool Straddles(double[] p, int ip, double[] q, int iq, double tolerance, double[] distances, out double[] normal)
+        {
+            var e1 = new double[3];
+            var e2 = new double[3];
+            Sub(p, ip, ip + 3, e1);
+            Sub(p, ip, ip + 6, e2);
+            normal = Cross(e1, e2);
+            var length = Math.Sqrt(Dot(normal, normal, 0));
+            if (length == 0)
+                return false;
+            var d = -Dot(normal, p, ip);
+            var snap = tolerance * length;
+            var negative = false;
+            var positive = false;
+            for (var k = 0; k < 3; k++)
+            {
+                var dist = Dot(normal, q, iq + k * 3) + d;
+                if (Math.Abs(dist) < snap)
+                    dist = 0;
+                distances[k] = dist;
+                negative |= dist < 0;
+                positive |= dist > 0;
+            }
+            return negative && positive;
+        }
+
+        /// <summary>
+        /// Moller's interval overlap test, triangles that only touch or are coplanar are not counted as intersecting
+        /// </summary>
+        private static bool TrianglesIntersect(double[] p, int ip, double[] q, int iq, double tolerance)
+        {
+            var dq = new double[3];
+            var dp = new double[3];
+            if (!Straddles(p, ip, q, iq, tolerance, dq, out var n1))
+                return false;
+            if (!Straddles(q, iq, p, ip, tolerance, dp, out var n2))
+                return false;
+            var direction = Cross(n1, n2);
+            //project on to the largest axis of the intersection line
+            var axis = 0;
+            if (Math.Abs(direction[1]) > Math.Abs(direction[axis])) axis = 1;
+            if (Math.Abs(direction[2]) > Math.Abs(direction[axis])) axis = 2;
+            if (direction[axis] == 0)
+                return false;
+            var pp = new[] { p[ip + axis], p[ip + 3 + axis], p[ip + 6 + axis] };
+            var qq = new[] { q[iq + axis], q[iq + 3 + axis], q[iq + 6 + axis] };
+            Interval(pp, dp, out var a0, out var a1);
+            Interval(qq, dq, out var b0, out var b1);
+            return !(a1 <= b0 || b1 <= a0);
+        }
+
+        /// <summary>
+        /// Interval where a triangle crosses the plane of the other, given the projections and plane distances of its corners
+        /// </summary>
+        private static void Interval(double[] v, double[] d, out double t0, out double t1)
+        {
+            //find the corner alone on its side of the plane
+            int lone;
+            if (d[0] * d[1] > 0) lone = 2;
+            else if (d[0] * d[2] > 0) lone = 1;
+            else if (d[1] * d[2] > 0 || d[0] != 0) lone = 0;
+            else if (d[1] != 0) lone = 1;
+            else lone = 2;
+            var o1 = (lone + 1) % 3;
+            var o2 = (lone + 2) % 3;
+            t0 = d[lone] == d[o1] ? v[lone] : v[lone] + (v[o1] - v[lone]) * d[lone] / (d[lone] - d[o1]);
+            t1 = d[lone] == d[o2] ? v[lone] : v[lone] + (v[o2] - v[lone]) * d[lone] / (d[lone] - d[o2]);
+            if (t0 > t1)
+            {
+                var t = t0;
+                t0 = t1;
+                t1 = t;
+            }
+        }
+
+        /// <summary>
+        /// Distance between two triangles that do not intersect, the least of the corner to triangle and edge to edge distances
+        /// </summary>
+        private static double TriangleDistance(double[] p, int ip, double[] q, int iq)
+        {
+            var best = double.PositiveInfinity;
+            for (var k = 0; k < 3; k++)
+            {
+                best = Math.Min(best, PointTriangleDistance(p, ip + k * 3, q, iq));
+                best = Math.Min(best, PointTriangleDistance(q, iq + k * 3, p, ip));
+            }
+            for (var i = 0; i < 3; i++)
+            {
+                for (var j = 0; j < 3; j++)
+                    best = Math.Min(best, SegmentDistance(p, ip + i * 3, ip + (i + 1) % 3 * 3, q, iq + j * 3, iq + (j + 1) % 3 * 3));
+            }
+            return best;
+        }
+
+        /// <summary>
+        /// Closest point on a triangle by Voronoi regions (Ericson, Real-Time Collision Detection 5.1.5)
+        /// </summary>
+        private static double PointTriangleDistance(double[] pt, int ipt, double[] t, int it)
+        {
+            double px = pt[ipt], py = pt[ipt + 1], pz = pt[ipt + 2];
+            double ax = t[it], ay = t[it + 1], az = t[it + 2];
+            double bx = t[it + 3], by = t[it + 4], bz = t[it + 5];
+            double cx = t[it + 6], cy = t[it + 7], cz = t[it + 8];
+            double abx = bx - ax, aby = by - ay, abz = bz - az;
+            double acx = cx - ax, acy = cy - ay, acz = cz - az;
+            double apx = px - ax, apy = py - ay, apz = pz - az;
+            var d1 = abx * apx + aby * apy + abz * apz;
+            var d2 = acx * apx + acy * apy + acz * apz;
+            double rx, ry, rz;
+            if (d1 <= 0 && d2 <= 0)
+                return Length(px - ax, py - ay, pz - az);
+            double bpx = px - bx, bpy = py - by, bpz = pz - bz;
+            var d3 = abx * bpx + aby * bpy + abz * bpz;
+            var d4 = acx * bpx + acy * bpy + acz * bpz;
+            if (d3 >= 0 && d4 <= d3)
+                return Length(px - bx, py - by, pz - bz);
+            var vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+            {
+                var v = d1 / (d1 - d3);
+                rx = ax + v * abx; ry = ay + v * aby; rz = az + v * abz;
+                return Length(px - rx, py - ry, pz - rz);
+            }
+            double cpx = px - cx, cpy = py - cy, cpz = pz - cz;
+            var d5 = abx * cpx + aby * cpy + abz * cpz;
+            var d6 = acx * cpx + acy * cpy + acz * cpz;
+            if (d6 >= 0 && d5 <= d6)
+                return Length(px - cx, py - cy, pz - cz);
+            var vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+            {
+                var w = d2 / (d2 - d6);
+                rx = ax + w * acx; ry = ay + w * acy; rz = az + w * acz;
+                return Length(px - rx, py - ry, pz - rz);
+            }
+            var va = d3 * d6 - d5 * d4;
+            if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+            {
+                var w = (d4 - d3) / (d4 - d3 + (d5 - d6));
+                rx = bx + w * (cx - bx); ry = by + w * (cy - by); rz = bz + w * (cz - bz);
+                return Length(px - rx, py - ry, pz - rz);
+            }
+            var denom = va + vb + vc;
+            if (denom == 0)
+                return Length(px - ax, py - ay, pz - az); //degenerate triangle
+            var vv = vb / denom;
+            var ww = vc / denom;
+            rx = ax + abx * vv + acx * ww; ry = ay + aby * vv + acy * ww; rz = az + abz * vv + acz * ww;
+            return Length(px - rx, py - ry, pz - rz);
+        }
+
+        /// <summary>
+        /// Distance between two segments (Ericson, Real-Time Collision Detection 5.1.9)
+        /// </summary>
+        private static double SegmentDistance(double[] p, int p1, int q1, double[] t, int p2, int q2)
+        {
+            double d1x = p[q1] - p[p1], d1y = p[q1 + 1] - p[p1 + 1], d1z = p[q1 + 2] - p[p1 + 2];
+            double d2x = t[q2] - t[p2], d2y = t[q2 + 1] - t[p2 + 1], d2z = t[q2 + 2] - t[p2 + 2];
+            double rx = p[p1] - t[p2], ry = p[p1 + 1] - t[p2 + 1], rz = p[p1 + 2] - t[p2 + 2];
+            var a = d1x * d1x + d1y * d1y + d1z * d1z;
+            var e = d2x * d2x + d2y * d2y + d2z * d2z;
+            var f = d2x * rx + d2y * ry + d2z * rz;
+            double s, u;
+            if (a <= double.Epsilon && e <= double.Epsilon)
+                return Length(rx, ry, rz);
+            if (a <= double.Epsilon)
+            {
+                s = 0;
+                u = Clamp(f / e);
+            }
+            else
+            {
+                var c = d1x * rx + d1y * ry + d1z * rz;
+                if (e <= double.Epsilon)
+                {
+                    u = 0;
+                    s = Clamp(-c / a);
+                }
+                else
+                {
+                    var b = d1x * d2x + d1y * d2y + d1z * d2z;
+                    var denom = a * e - b * b;
+                    s = denom != 0 ? Clamp((b * f - c * e) / denom) : 0;
+                    u = (b * s + f) / e;
+                    if (u < 0)
+                    {
+                        u = 0;
+                        s = Clamp(-c / a);
+                    }
+                    else if (u > 1)
+                    {
+                        u = 1;
+                        s = Clamp((b - c) / a);
+                    }
+                }
+            }
+            return Length(rx + d1x * s - d2x * u, ry + d1y * s - d2y * u, rz + d1z * s - d2z * u);
+        }
+
+        private static double Clamp(double v)
+        {
+            return v < 0 ? 0 : v > 1 ? 1 : v;
+        }
+
+        private static double Length(double x, double y, double z)
+        {
+            return Math.Sqrt(x * x + y * y + z * z);
+        }
+
+        #endregion
+    }
+}
@@ -0,0 +1,149 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Exports the geometry store with each shape geometry written once, followed by a packed table of the transforms
+    /// of every instance of it, in the manner of glTF EXT_mesh_gpu_instancing. Records are written to the stream as
+    /// they are read from the store, only the instance tables are held in memory.
+    ///
+    /// Stream layout, little endian:
+    /// Version                          // byte
+    /// Records...
+    ///     RecordType                   // byte, 1 geometry, 2 instance batch, 0 end of stream
+    ///   Geometry:
+    ///     ShapeGeometryLabel           // int
+    ///     Format                       // byte, XbimGeometryType
+    ///     Length                       // int
+    ///     ShapeData                    // byte * Length
+    ///   Instance batch, always after the geometry it uses:
+    ///     ShapeGeometryLabel           // int
+    ///     StyleLabel                   // int
+    ///     InstanceCount                // int
+    ///     [IfcProductLabel             // int
+    ///      InstanceLabel               // int
+    ///      M11 M12 M13 M21 M22 M23 M31 M32 M33 // 9 * float, rotation and scale
+    ///      OffsetX OffsetY OffsetZ]    // 3 * double, kept as double for georeferenced models
+    ///     ...
+    /// </summary>
+    public class XbimInstancedMeshExporter
+    {
+        public const byte Version = 1;
+        public const byte EndRecord = 0;
+        public const byte GeometryRecord = 1;
+        public const byte InstanceBatchRecord = 2;
+
+        private readonly IModel _model;
+
+        public XbimInstancedMeshExporter(IModel model)
+        {
+            _model = model;
+        }
+
+        /// <summary>
+        /// Only instances in these representation contexts are exported, all contexts if null or empty
+        /// </summary>
+        public ISet<int> ContextLabels { get; set; }
+
+        /// <summary>
+        /// The representation type exported, default is the final shape of products with openings and projections applied
+        /// </summary>
+        public XbimGeometryRepresentationType RepresentationType { get; set; } = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded;
+
+        /// <summary>
+        /// Number of geometries written by the last export
+        /// </summary>
+        public int GeometryCount { get; private set; }
+
+        /// <summary>
+        /// Number of instances written by the last export
+        /// </summary>
+        public int InstanceCount { get; private set; }
+
+        /// <summary>
+        /// Writes the geometry store to the output, the output is left open
+        /// </summary>
+        public void Export(Stream output)
+        {
+            GeometryCount = 0;
+            InstanceCount = 0;
+            using (var reader = _model.GeometryStore.BeginRead())
+            using (var bw = new BinaryWriter(output, Encoding.UTF8, true))
+            {
+                // geometry label -> style label -> instances, the geometry itself is read when it is written
+                var batches = new SortedDictionary<int, SortedDictionary<int, List<XbimShapeInstance>>>();
+                foreach (var shapeInstance in reader.ShapeInstances)
+                {
+                    if ((byte)shapeInstance.RepresentationType != (byte)RepresentationType)
+                        continue;
+                    if (ContextLabels != null && ContextLabels.Count > 0 && !ContextLabels.Contains(shapeInstance.RepresentationContext))
+                        continue;
+                    if (!batches.TryGetValue(shapeInstance.ShapeGeometryLabel, out var styles))
+                    {
+                        styles = new SortedDictionary<int, List<XbimShapeInstance>>();
+                        batches.Add(shapeInstance.ShapeGeometryLabel, styles);
+                    }
+                    if (!styles.TryGetValue(shapeInstance.StyleLabel, out var instances))
+                    {
+                        instances = new List<XbimShapeInstance>();
+                        styles.Add(shapeInstance.StyleLabel, instances);
+                    }
+                    instances.Add(shapeInstance);
+                }
+
+                bw.Write(Version);
+                foreach (var batch in batches)
+                {
+                    var geometry = reader.ShapeGeometry(batch.Key);
+                    // the bytes as stored, the ShapeData property of the geometry is a string decoded from them
+                    var shapeData = ((IXbimShapeGeometryData)geometry)?.ShapeData;
+                    if (shapeData == null || shapeData.Length == 0)
+                        continue;
+                    bw.Write(GeometryRecord);
+                    bw.Write(batch.Key);
+                    bw.Write((byte)geometry.Format);
+                    bw.Write(shapeData.Length);
+                    bw.Write(shapeData);
+                    GeometryCount++;
+
+                    foreach (var style in batch.Value)
+                    {
+                        bw.Write(InstanceBatchRecord);
+                        bw.Write(batch.Key);
+                        bw.Write(style.Key);
+                        bw.Write(style.Value.Count);
+                        foreach (var instance in style.Value)
+                            WriteInstance(bw, instance);
+                        InstanceCount += style.Value.Count;
+                    }
+                }
+                bw.Write(EndRecord);
+                bw.Flush();
+            }
+        }
+
+        private static void WriteInstance(BinaryWriter bw, XbimShapeInstance instance)
+        {
+            var m = instance.Transformation;
+            bw.Write(instance.IfcProductLabel);
+            bw.Write(instance.InstanceLabel);
+            bw.Write((float)m.M11);
+            bw.Write((float)m.M12);
+            bw.Write((float)m.M13);
+            bw.Write((float)m.M21);
+            bw.Write((float)m.M22);
+            bw.Write((float)m.M23);
+            bw.Write((float)m.M31);
+            bw.Write((float)m.M32);
+            bw.Write((float)m.M33);
+            bw.Write(m.OffsetX);
+            bw.Write(m.OffsetY);
+            bw.Write(m.OffsetZ);
+        }
+    }
+}
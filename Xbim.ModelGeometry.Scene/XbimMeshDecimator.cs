@@ -0,0 +1,688 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Simplifies PolyhedronBinary meshes by collapsing edges in the order of their quadric error (Garland and Heckbert),
+    /// until the next collapse would move the surface by more than the maximum error. Edges on the boundary of the mesh, between
+    /// faces of the shape and at creases sharper than the crease angle are held by constraint planes so the outline and the sharp
+    /// features survive. Collapses that would fold a triangle over or make the mesh non manifold are skipped.
+    /// Planar faces keep their normal, the normals of curved faces are recalculated. Instances hold no state while
+    /// decimating and can be used from several threads at once
+    /// </summary>
+    public class XbimMeshDecimator
+    {
+        //constraint planes count this many times more than the planes of the triangles, boundaries move by about 1/30 of the error
+        private const double ConstraintWeight = 1000;
+
+        /// <summary>
+        /// Sum of the squared distances to a set of planes as the symmetric 4x4 matrix of their coefficients
+        /// </summary>
+        private struct Quadric
+        {
+            public double XX, XY, XZ, XW, YY, YZ, YW, ZZ, ZW, WW;
+
+            public Quadric(double a, double b, double c, double d, double weight)
+            {
+                XX = weight * a * a; XY = weight * a * b; XZ = weight * a * c; XW = weight * a * d;
+                YY = weight * b * b; YZ = weight * b * c; YW = weight * b * d;
+                ZZ = weight * c * c; ZW = weight * c * d;
+                WW = weight * d * d;
+            }
+
+            public void Add(ref Quadric q)
+            {
+                XX += q.XX; XY += q.XY; XZ += q.XZ; XW += q.XW;
+                YY += q.YY; YZ += q.YZ; YW += q.YW;
+                ZZ += q.ZZ; ZW += q.ZW;
+                WW += q.WW;
+            }
+
+            public double Evaluate(double x, double y, double z)
+            {
+                return XX * x * x + 2 * XY * x * y + 2 * XZ * x * z + 2 * XW * x +
+                       YY * y * y + 2 * YZ * y * z + 2 * YW * y +
+                       ZZ * z * z + 2 * ZW * z + WW;
+            }
+
+            /// <summary>
+            /// The point of least error, false if the planes do not fix a single point
+            /// </summary>
+            public bool TryMinimum(out double x, out double y, out double z)
+            {
+                var c11 = YY * ZZ - YZ * YZ;
+                var c12 = XZ * YZ - XY * ZZ;
+                var c13 = XY * YZ - XZ * YY;
+                var det = XX * c11 + XY * c12 + XZ * c13;
+                var scale = Math.Abs(XX) + Math.Abs(YY) + Math.Abs(ZZ);
+                if (Math.Abs(det) <= 1e-9 * scale * scale * scale)
+                {
+                    x = y = z = 0;
+                    return false;
+                }
+                var c22 = XX * ZZ - XZ * XZ;
+                var c23 = XY * XZ - XX * YZ;
+                var c33 = XX * YY - XY * XY;
+                x = -(c11 * XW + c12 * YW + c13 * ZW) / det;
+                y = -(c12 * XW + c22 * YW + c23 * ZW) / det;
+                z = -(c13 * XW + c23 * YW + c33 * ZW) / det;
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// The first two triangles on an edge and the number of triangles on it
+        /// </summary>
+        private struct EdgeUse
+        {
+            public int First;
+            public int Second;
+            public int Count;
+        }
+
+        /// <summary>
+        /// A candidate edge collapse, the point the vertices move to is found again when it is taken to keep the heap small
+        /// </summary>
+        private struct Collapse
+        {
+            public double Cost;
+            public int Keep;
+            public int Remove;
+            public int KeepVersion;
+            public int RemoveVersion;
+        }
+
+        /// <summary>
+        /// Binary min heap of candidate collapses, entries whose vertices have changed since they were added are skipped when taken
+        /// </summary>
+        private class CollapseHeap
+        {
+            private readonly List<Collapse> _items = new List<Collapse>();
+
+            public int Count => _items.Count;
+
+            public void Push(Collapse item)
+            {
+                _items.Add(item);
+                var i = _items.Count - 1;
+                while (i > 0)
+                {
+                    var parent = (i - 1) / 2;
+                    if (_items[parent].Cost <= item.Cost)
+                        break;
+                    _items[i] = _items[parent];
+                    i = parent;
+                }
+                _items[i] = item;
+            }
+
+            public Collapse Pop()
+            {
+                var top = _items[0];
+                var last = _items[_items.Count - 1];
+                _items.RemoveAt(_items.Count - 1);
+                if (_items.Count == 0)
+                    return top;
+                var i = 0;
+                while (true)
+                {
+                    var child = 2 * i + 1;
+                    if (child >= _items.Count)
+                        break;
+                    if (child + 1 < _items.Count && _items[child + 1].Cost < _items[child].Cost)
+                        child++;
+                    if (last.Cost <= _items[child].Cost)
+                        break;
+                    _items[i] = _items[child];
+                    i = child;
+                }
+                _items[i] = last;
+                return top;
+            }
+        }
+
+        /// <summary>
+        /// Creates a decimator that moves the surface by no more than maxError, in the units of the mesh
+        /// </summary>
+        public XbimMeshDecimator(double maxError)
+        {
+            MaxError = maxError;
+        }
+
+        public double MaxError { get; }
+
+        /// <summary>
+        /// Edges whose triangles meet at more than this angle, in radians, are kept as creases, default is 30 degrees
+        /// </summary>
+        public double CreaseAngle { get; set; } = Math.PI / 6;
+
+        /// <summary>
+        /// Meshes with fewer triangles than this are left as they are
+        /// </summary>
+        public int MinTriangleCount { get; set; }
+
+        /// <summary>
+        /// Decimates the mesh of the shape geometry in place if it is in the PolyhedronBinary format, returns true if any triangles were removed
+        /// </summary>
+        public bool TryDecimate(XbimShapeGeometry shapeGeometry)
+        {
+            var shapeData = ((IXbimShapeGeometryData)shapeGeometry)?.ShapeData;
+            if (shapeData == null || shapeData.Length == 0 || shapeGeometry.Format != XbimGeometryType.PolyhedronBinary)
+                return false;
+            var decimated = Decimate(shapeData, out var bounds);
+            if (decimated == null)
+                return false;
+            ((IXbimShapeGeometryData)shapeGeometry).ShapeData = decimated;
+            shapeGeometry.BoundingBox = bounds;
+            return true;
+        }
+
+        /// <summary>
+        /// Returns the decimated PolyhedronBinary shape data, or null if no triangles were removed
+        /// </summary>
+        public byte[] Decimate(byte[] shapeData)
+        {
+            return Decimate(shapeData, out _);
+        }
+
+        private byte[] Decimate(byte[] shapeData, out XbimRect3D bounds)
+        {
+            bounds = XbimRect3D.Empty;
+            var mesh = new XbimShapeMeshView(shapeData);
+            if (mesh.TriangleCount == 0 || mesh.TriangleCount < MinTriangleCount || MaxError <= 0)
+                return null;
+
+            //positions are taken about the first vertex so the quadrics do not lose precision far from the origin
+            var vertexCount = mesh.VertexCount;
+            var origin = mesh.Vertex(0);
+            var positions = new double[vertexCount * 3];
+            for (var i = 0; i < vertexCount; i++)
+            {
+                var p = mesh.Vertex(i);
+                positions[i * 3] = p.X - origin.X;
+                positions[i * 3 + 1] = p.Y - origin.Y;
+                positions[i * 3 + 2] = p.Z - origin.Z;
+            }
+            var triangles = new int[mesh.TriangleCount * 3];
+            var triangleCount = mesh.CopyTriangleIndices(triangles, 0) / 3;
+            var triangleFaces = new int[triangleCount];
+            for (int f = 0, t = 0; f < mesh.FaceCount; f++)
+            {
+                for (var i = 0; i < mesh.FaceTriangleCount(f); i++)
+                    triangleFaces[t++] = f;
+            }
+
+            var state = new DecimationState(positions, triangles, triangleFaces, vertexCount);
+            state.AddQuadrics(Math.Cos(CreaseAngle));
+            var removed = state.Collapse(MaxError * MaxError);
+            if (removed == 0)
+                return null;
+            return state.Write(mesh, origin, out bounds);
+        }
+
+        /// <summary>
+        /// The working mesh of one call to Decimate
+        /// </summary>
+        private class DecimationState
+        {
+            private readonly double[] _positions;
+            private readonly int[] _triangles;
+            private readonly int[] _triangleFaces;
+            private readonly bool[] _deletedTriangles;
+            private readonly bool[] _removedVertices;
+            private readonly bool[] _fixed;
+            private readonly Dictionary<long, EdgeUse> _edges;
+            private readonly int[] _versions;
+            private readonly List<int>[] _vertexTriangles;
+            private readonly Quadric[] _quadrics;
+            //scratch marks for the neighbour test, a vertex is marked if its entry equals the current stamp
+            private readonly int[] _marks;
+            private int _stamp;
+
+            public DecimationState(double[] positions, int[] triangles, int[] triangleFaces, int vertexCount)
+            {
+                _positions = positions;
+                _triangles = triangles;
+                _triangleFaces = triangleFaces;
+                _deletedTriangles = new bool[triangleFaces.Length];
+                _removedVertices = new bool[vertexCount];
+                _fixed = new bool[vertexCount];
+                _versions = new int[vertexCount];
+                _quadrics = new Quadric[vertexCount];
+                _marks = new int[vertexCount];
+                _vertexTriangles = new List<int>[vertexCount];
+                for (var v = 0; v < vertexCount; v++)
+                    _vertexTriangles[v] = new List<int>(6);
+                _edges = new Dictionary<long, EdgeUse>(triangleFaces.Length * 2);
+                for (var t = 0; t < triangleFaces.Length; t++)
+                {
+                    for (var c = 0; c < 3; c++)
+                    {
+                        _vertexTriangles[triangles[t * 3 + c]].Add(t);
+                        var key = EdgeKey(triangles[t * 3 + c], triangles[t * 3 + (c + 1) % 3]);
+                        _edges.TryGetValue(key, out var use);
+                        if (use.Count == 0)
+                            use.First = t;
+                        else if (use.Count == 1)
+                            use.Second = t;
+                        use.Count++;
+                        _edges[key] = use;
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Sums the planes of the triangles at each vertex and adds constraint planes along boundary, face and crease edges
+            /// </summary>
+            public void AddQuadrics(double creaseCosine)
+            {
+                var triangleCount = _triangleFaces.Length;
+                var normals = new double[triangleCount * 3];
+                for (var t = 0; t < triangleCount; t++)
+                {
+                    if (!TriangleNormal(t, out var nx, out var ny, out var nz))
+                        continue;
+                    normals[t * 3] = nx;
+                    normals[t * 3 + 1] = ny;
+                    normals[t * 3 + 2] = nz;
+                    var a = _triangles[t * 3] * 3;
+                    var plane = new Quadric(nx, ny, nz, -(nx * _positions[a] + ny * _positions[a + 1] + nz * _positions[a + 2]), 1);
+                    for (var c = 0; c < 3; c++)
+                        _quadrics[_triangles[t * 3 + c]].Add(ref plane);
+                }
+
+                foreach (var edge in _edges)
+                {
+                    var u = (int)(edge.Key >> 32);
+                    var v = (int)(edge.Key & 0xFFFFFFFF);
+                    var use = edge.Value;
+                    if (use.Count == 1)
+                        AddConstraint(u, v, use.First, normals);
+                    else if (use.Count > 2)
+                        _fixed[u] = _fixed[v] = true; //non manifold, left as it is
+                    else
+                    {
+                        var first = use.First * 3;
+                        var second = use.Second * 3;
+                        var cos = normals[first] * normals[second] + normals[first + 1] * normals[second + 1] + normals[first + 2] * normals[second + 2];
+                        if (_triangleFaces[use.First] != _triangleFaces[use.Second] || cos < creaseCosine)
+                        {
+                            AddConstraint(u, v, use.First, normals);
+                            AddConstraint(u, v, use.Second, normals);
+                        }
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Adds the plane through the edge at right angles to the triangle to both ends of the edge
+            /// </summary>
+            private void AddConstraint(int u, int v, int triangle, double[] normals)
+            {
+                double nx = normals[triangle * 3], ny = normals[triangle * 3 + 1], nz = normals[triangle * 3 + 2];
+                if (nx == 0 && ny == 0 && nz == 0)
+                    return;
+                double ex = _positions[v * 3] - _positions[u * 3];
+                double ey = _positions[v * 3 + 1] - _positions[u * 3 + 1];
+                double ez = _positions[v * 3 + 2] - _positions[u * 3 + 2];
+                double cx = ey * nz - ez * ny, cy = ez * nx - ex * nz, cz = ex * ny - ey * nx;
+                var length = Math.Sqrt(cx * cx + cy * cy + cz * cz);
+                if (length == 0)
+                    return;
+                cx /= length;
+                cy /= length;
+                cz /= length;
+                var constraint = new Quadric(cx, cy, cz, -(cx * _positions[u * 3] + cy * _positions[u * 3 + 1] + cz * _positions[u * 3 + 2]), ConstraintWeight);
+                _quadrics[u].Add(ref constraint);
+                _quadrics[v].Add(ref constraint);
+            }
+
+            /// <summary>
+            /// Collapses edges cheapest first until the cheapest costs more than maxCost, returns the number of triangles removed
+            /// </summary>
+            public int Collapse(double maxCost)
+            {
+                var heap = new CollapseHeap();
+                foreach (var key in _edges.Keys)
+                    PushCollapse(heap, (int)(key >> 32), (int)(key & 0xFFFFFFFF), maxCost);
+                var removed = 0;
+                while (heap.Count > 0)
+                {
+                    var collapse = heap.Pop();
+                    if (collapse.Cost > maxCost)
+                        break;
+                    if (_removedVertices[collapse.Keep] || _removedVertices[collapse.Remove] ||
+                        _versions[collapse.Keep] != collapse.KeepVersion || _versions[collapse.Remove] != collapse.RemoveVersion)
+                        continue; //stale
+                    Cost(collapse.Keep, collapse.Remove, out var x, out var y, out var z);
+                    if (!CanCollapse(collapse.Keep, collapse.Remove, x, y, z))
+                        continue;
+                    removed += Apply(collapse.Keep, collapse.Remove, x, y, z);
+                    foreach (var neighbour in Neighbours(collapse.Keep))
+                        PushCollapse(heap, collapse.Keep, neighbour, maxCost);
+                }
+                return removed;
+            }
+
+            private void PushCollapse(CollapseHeap heap, int keep, int remove, double maxCost)
+            {
+                if (_fixed[keep] || _fixed[remove])
+                    return;
+                var cost = Cost(keep, remove, out _, out _, out _);
+                if (cost > maxCost)
+                    return;
+                heap.Push(new Collapse
+                {
+                    Cost = cost,
+                    Keep = keep,
+                    Remove = remove,
+                    KeepVersion = _versions[keep],
+                    RemoveVersion = _versions[remove]
+                });
+            }
+
+            /// <summary>
+            /// The error of collapsing the edge and the point the vertices move to
+            /// </summary>
+            private double Cost(int keep, int remove, out double x, out double y, out double z)
+            {
+                var q = _quadrics[keep];
+                q.Add(ref _quadrics[remove]);
+                double cost;
+                if (q.TryMinimum(out x, out y, out z))
+                    cost = q.Evaluate(x, y, z);
+                else
+                {
+                    //the better of the two ends and the middle
+                    double kx = _positions[keep * 3], ky = _positions[keep * 3 + 1], kz = _positions[keep * 3 + 2];
+                    double rx = _positions[remove * 3], ry = _positions[remove * 3 + 1], rz = _positions[remove * 3 + 2];
+                    x = kx; y = ky; z = kz;
+                    cost = q.Evaluate(x, y, z);
+                    var removeCost = q.Evaluate(rx, ry, rz);
+                    if (removeCost < cost)
+                    {
+                        cost = removeCost;
+                        x = rx; y = ry; z = rz;
+                    }
+                    double mx = (kx + rx) / 2, my = (ky + ry) / 2, mz = (kz + rz) / 2;
+                    var middleCost = q.Evaluate(mx, my, mz);
+                    if (middleCost < cost)
+                    {
+                        cost = middleCost;
+                        x = mx; y = my; z = mz;
+                    }
+                }
+                return Math.Max(cost, 0); //round off
+            }
+
+            /// <summary>
+            /// False if the collapse would make the mesh non manifold or turn a triangle over
+            /// </summary>
+            private bool CanCollapse(int keep, int remove, double x, double y, double z)
+            {
+                //the link condition, the only vertices next to both ends are the apexes of the triangles on the edge
+                _stamp++;
+                foreach (var t in _vertexTriangles[keep])
+                {
+                    if (_deletedTriangles[t]) continue;
+                    for (var c = 0; c < 3; c++)
+                        _marks[_triangles[t * 3 + c]] = _stamp;
+                }
+                var shared = 0;
+                var common = 0;
+                _stamp++;
+                foreach (var t in _vertexTriangles[remove])
+                {
+                    if (_deletedTriangles[t]) continue;
+                    if (HasVertex(t, keep))
+                        shared++;
+                    for (var c = 0; c < 3; c++)
+                    {
+                        var w = _triangles[t * 3 + c];
+                        if (w == remove || w == keep) continue;
+                        if (_marks[w] == _stamp - 1)
+                        {
+                            common++;
+                            _marks[w] = _stamp; //count each vertex once
+                        }
+                    }
+                }
+                if (common != shared || shared == 0)
+                    return false;
+                return !Flips(keep, remove, x, y, z) && !Flips(remove, keep, x, y, z);
+            }
+
+            /// <summary>
+            /// True if moving the vertex to the point turns over any of its triangles that do not also use other
+            /// </summary>
+            private bool Flips(int vertex, int other, double x, double y, double z)
+            {
+                foreach (var t in _vertexTriangles[vertex])
+                {
+                    if (_deletedTriangles[t] || HasVertex(t, other))
+                        continue;
+                    if (!TriangleNormal(t, out var ox, out var oy, out var oz))
+                        continue;
+                    var corner = _triangles[t * 3] == vertex ? 0 : _triangles[t * 3 + 1] == vertex ? 1 : 2;
+                    var a = _triangles[t * 3 + (corner + 1) % 3] * 3;
+                    var b = _triangles[t * 3 + (corner + 2) % 3] * 3;
+                    double ux = _positions[a] - x, uy = _positions[a + 1] - y, uz = _positions[a + 2] - z;
+                    double vx = _positions[b] - x, vy = _positions[b + 1] - y, vz = _positions[b + 2] - z;
+                    double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+                    var length = Math.Sqrt(nx * nx + ny * ny + nz * nz);
+                    //a new sliver or a normal that turns by more than about 80 degrees
+                    if (length == 0 || (nx * ox + ny * oy + nz * oz) / length < 0.2)
+                        return true;
+                }
+                return false;
+            }
+
+            private int Apply(int keep, int remove, double x, double y, double z)
+            {
+                var removed = 0;
+                foreach (var t in _vertexTriangles[remove])
+                {
+                    if (_deletedTriangles[t]) continue;
+                    if (HasVertex(t, keep))
+                    {
+                        _deletedTriangles[t] = true;
+                        removed++;
+                        continue;
+                    }
+                    for (var c = 0; c < 3; c++)
+                    {
+                        if (_triangles[t * 3 + c] == remove)
+                            _triangles[t * 3 + c] = keep;
+                    }
+                    _vertexTriangles[keep].Add(t);
+                }
+                _vertexTriangles[keep].RemoveAll(t => _deletedTriangles[t]);
+                _vertexTriangles[remove] = null;
+                _removedVertices[remove] = true;
+                _quadrics[keep].Add(ref _quadrics[remove]);
+                _positions[keep * 3] = x;
+                _positions[keep * 3 + 1] = y;
+                _positions[keep * 3 + 2] = z;
+                _versions[keep]++;
+                return removed;
+            }
+
+            private IEnumerable<int> Neighbours(int vertex)
+            {
+                _stamp++;
+                _marks[vertex] = _stamp;
+                var neighbours = new List<int>();
+                foreach (var t in _vertexTriangles[vertex])
+                {
+                    if (_deletedTriangles[t]) continue;
+                    for (var c = 0; c < 3; c++)
+                    {
+                        var w = _triangles[t * 3 + c];
+                        if (_marks[w] == _stamp) continue;
+                        _marks[w] = _stamp;
+                        neighbours.Add(w);
+                    }
+                }
+                return neighbours;
+            }
+
+            private bool HasVertex(int triangle, int vertex)
+            {
+                return _triangles[triangle * 3] == vertex || _triangles[triangle * 3 + 1] == vertex || _triangles[triangle * 3 + 2] == vertex;
+            }
+
+            private bool TriangleNormal(int triangle, out double nx, out double ny, out double nz)
+            {
+                var a = _triangles[triangle * 3] * 3;
+                var b = _triangles[triangle * 3 + 1] * 3;
+                var c = _triangles[triangle * 3 + 2] * 3;
+                double ux = _positions[b] - _positions[a], uy = _positions[b + 1] - _positions[a + 1], uz = _positions[b + 2] - _positions[a + 2];
+                double vx = _positions[c] - _positions[a], vy = _positions[c + 1] - _positions[a + 1], vz = _positions[c + 2] - _positions[a + 2];
+                nx = uy * vz - uz * vy;
+                ny = uz * vx - ux * vz;
+                nz = ux * vy - uy * vx;
+                var length = Math.Sqrt(nx * nx + ny * ny + nz * nz);
+                if (length == 0)
+                    return false;
+                nx /= length;
+                ny /= length;
+                nz /= length;
+                return true;
+            }
+
+            private static long EdgeKey(int u, int v)
+            {
+                return u < v ? ((long)u << 32) | (uint)v : ((long)v << 32) | (uint)u;
+            }
+
+            /// <summary>
+            /// Writes the remaining triangles face by face in the PolyhedronBinary format, unused vertices are dropped
+            /// </summary>
+            public byte[] Write(XbimShapeMeshView original, XbimPoint3D origin, out XbimRect3D bounds)
+            {
+                var remap = new int[_removedVertices.Length];
+                for (var v = 0; v < remap.Length; v++)
+                    remap[v] = -1;
+                var faceTriangles = new List<int>[original.FaceCount];
+                var vertexCount = 0;
+                for (var t = 0; t < _triangleFaces.Length; t++)
+                {
+                    if (_deletedTriangles[t]) continue;
+                    var face = _triangleFaces[t];
+                    (faceTriangles[face] ?? (faceTriangles[face] = new List<int>())).Add(t);
+                    for (var c = 0; c < 3; c++)
+                    {
+                        var v = _triangles[t * 3 + c];
+                        if (remap[v] < 0)
+                            remap[v] = vertexCount++;
+                    }
+                }
+                var vertices = new int[vertexCount];
+                for (var v = 0; v < remap.Length; v++)
+                {
+                    if (remap[v] >= 0)
+                        vertices[remap[v]] = v;
+                }
+
+                double minX = double.MaxValue, minY = double.MaxValue, minZ = double.MaxValue;
+                double maxX = double.MinValue, maxY = double.MinValue, maxZ = double.MinValue;
+                var triangleCount = 0;
+                var faceCount = 0;
+                foreach (var list in faceTriangles)
+                {
+                    if (list == null) continue;
+                    triangleCount += list.Count;
+                    faceCount++;
+                }
+
+                var memStream = new MemoryStream(0x4000);
+                using (var bw = new BinaryWriter(memStream))
+                {
+                    bw.Write(original.Version);
+                    bw.Write(vertexCount);
+                    bw.Write(triangleCount);
+                    foreach (var v in vertices)
+                    {
+                        double x = _positions[v * 3] + origin.X, y = _positions[v * 3 + 1] + origin.Y, z = _positions[v * 3 + 2] + origin.Z;
+                        bw.Write((float)x);
+                        bw.Write((float)y);
+                        bw.Write((float)z);
+                        minX = Math.Min(minX, x); minY = Math.Min(minY, y); minZ = Math.Min(minZ, z);
+                        maxX = Math.Max(maxX, x); maxY = Math.Max(maxY, y); maxZ = Math.Max(maxZ, z);
+                    }
+                    bw.Write(faceCount);
+                    var normalSums = new double[_removedVertices.Length * 3];
+                    for (var f = 0; f < faceTriangles.Length; f++)
+                    {
+                        var list = faceTriangles[f];
+                        if (list == null) continue;
+                        if (original.IsPlanar(f))
+                        {
+                            bw.Write(list.Count);
+                            original.Normal(f, 0, 0).Write(bw);
+                            foreach (var t in list)
+                            {
+                                for (var c = 0; c < 3; c++)
+                                    WriteIndex(bw, remap[_triangles[t * 3 + c]], vertexCount);
+                            }
+                            continue;
+                        }
+                        //smooth normals within the face, weighted by the area of the triangles
+                        foreach (var t in list)
+                        {
+                            var a = _triangles[t * 3] * 3;
+                            var b = _triangles[t * 3 + 1] * 3;
+                            var c = _triangles[t * 3 + 2] * 3;
+                            double ux = _positions[b] - _positions[a], uy = _positions[b + 1] - _positions[a + 1], uz = _positions[b + 2] - _positions[a + 2];
+                            double vx = _positions[c] - _positions[a], vy = _positions[c + 1] - _positions[a + 1], vz = _positions[c + 2] - _positions[a + 2];
+                            double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+                            for (var k = 0; k < 3; k++)
+                            {
+                                var v = _triangles[t * 3 + k] * 3;
+                                normalSums[v] += nx;
+                                normalSums[v + 1] += ny;
+                                normalSums[v + 2] += nz;
+                            }
+                        }
+                        bw.Write(-list.Count); //negative count as every index has a normal
+                        foreach (var t in list)
+                        {
+                            for (var c = 0; c < 3; c++)
+                            {
+                                var v = _triangles[t * 3 + c];
+                                WriteIndex(bw, remap[v], vertexCount);
+                                var normal = new XbimVector3D(normalSums[v * 3], normalSums[v * 3 + 1], normalSums[v * 3 + 2]).Normalized();
+                                new XbimPackedNormal(normal.X, normal.Y, normal.Z).Write(bw);
+                            }
+                        }
+                        foreach (var t in list)
+                        {
+                            for (var c = 0; c < 3; c++)
+                            {
+                                var v = _triangles[t * 3 + c] * 3;
+                                normalSums[v] = normalSums[v + 1] = normalSums[v + 2] = 0;
+                            }
+                        }
+                    }
+                }
+                bounds = vertexCount > 0
+                    ? new XbimRect3D(minX, minY, minZ, maxX - minX, maxY - minY, maxZ - minZ)
+                    : XbimRect3D.Empty;
+                return memStream.ToArray();
+            }
+
+            private static void WriteIndex(BinaryWriter bw, int index, int maxInt)
+            {
+                if (maxInt <= 0xFF)
+                    bw.Write((byte)index);
+                else if (maxInt <= 0xFFFF)
+                    bw.Write((ushort)index);
+                else
+                    bw.Write(index);
+            }
+        }
+    }
+}
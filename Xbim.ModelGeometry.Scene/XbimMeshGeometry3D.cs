@@ -75,158 +75,305 @@ namespace Xbim.ModelGeometry.Scene
         /// <param name="data"></param>
         /// <param name="trans">An optional transformation</param>
         /// <returns></returns>
+        /// <remarks>The data is scanned in place, no strings are created for lines, tokens or numbers in the format the engine writes</remarks>
         public bool Read(String data, XbimMatrix3D? trans = null)
         {
             var version = 2; //we are at at least verson 2 now
             var q = new XbimQuaternion();
             if (trans.HasValue)
                 q = trans.Value.GetRotationQuaternion();
-            using (var sr = new StringReader(data))
-            {
-
-                var vertexList = new List<XbimPoint3D>(); //holds the actual positions of the vertices in this data set in the mesh
-                var normalList = new List<XbimVector3D>(); //holds the actual normals of the vertices in this data set in the mesh
-                String line;
-                // Read and display lines from the data until the end of
-                // the data is reached.
 
-                while ((line = sr.ReadLine()) != null)
+            var vertexList = new List<XbimPoint3D>(); //holds the actual positions of the vertices in this data set in the mesh
+            var normalList = new List<XbimVector3D>(); //holds the actual normals of the vertices in this data set in the mesh
+            var writtenVertices = new Dictionary<int, int>();
+            var lineStart = 0;
+            // Read the lines from the data until the end of the data is reached, a line ends at \r, \n or \r\n
+            while (lineStart < data.Length)
+            {
+                var lineEnd = lineStart;
+                while (lineEnd < data.Length && data[lineEnd] != '\r' && data[lineEnd] != '\n') lineEnd++;
+                var next = lineEnd + 1;
+                if (lineEnd < data.Length && data[lineEnd] == '\r' && next < data.Length && data[next] == '\n') next++;
+
+                int commandStart, commandEnd;
+                var pos = lineStart;
+                //we need a command and some data
+                if (NextToken(data, ref pos, lineEnd, ' ', out commandStart, out commandEnd) && HasToken(data, pos, lineEnd))
                 {
-
-                    var tokens = line.Split(new[] { ' ' }, StringSplitOptions.RemoveEmptyEntries);
-                    if (tokens.Length > 1) //we need a command and some data
+                    var command = commandEnd - commandStart == 1
+                        ? char.ToUpper(data[commandStart])
+                        : CommandOf(data.Substring(commandStart, commandEnd - commandStart));
+                    int tokenStart, tokenEnd;
+                    switch (command)
                     {
-                        var command = tokens[0].Trim().ToUpper();
-                        switch (command)
-                        {
-                            case "P":
-                                version = Int32.Parse(tokens[1]);
-                                var pointCount = 512;
-                                //var faceCount = 128;
-                                //var triangleCount = 256;
-                                var normalCount = 512;
-                                if (tokens.Length > 1) pointCount = Int32.Parse(tokens[2]);
-                               // if (tokens.Length > 2) faceCount = Int32.Parse(tokens[3]);
-                               // if (tokens.Length > 3) triangleCount = Int32.Parse(tokens[4]);
-                                //version 2 of the string format uses packed normals
-                                if (version < 2 && tokens.Length > 4) normalCount = Int32.Parse(tokens[5]);
-                                vertexList = new List<XbimPoint3D>(pointCount);
-                                normalList = new List<XbimVector3D>(normalCount);
-                                break;
-                            case "V": //process vertices
-                                for (var i = 1; i < tokens.Length; i++)
+                        case 'P':
+                            var tokens = new List<string>(6) { "P" };
+                            while (NextToken(data, ref pos, lineEnd, ' ', out tokenStart, out tokenEnd))
+                                tokens.Add(data.Substring(tokenStart, tokenEnd - tokenStart));
+                            version = Int32.Parse(tokens[1]);
+                            var pointCount = 512;
+                            var normalCount = 512;
+                            if (tokens.Count > 1) pointCount = Int32.Parse(tokens[2]);
+                            //version 2 of the string format uses packed normals
+                            if (version < 2 && tokens.Count > 4) normalCount = Int32.Parse(tokens[5]);
+                            vertexList = new List<XbimPoint3D>(pointCount);
+                            normalList = new List<XbimVector3D>(normalCount);
+                            break;
+                        case 'V': //process vertices
+                            while (NextToken(data, ref pos, lineEnd, ' ', out tokenStart, out tokenEnd))
+                            {
+                                double x, y, z;
+                                ParseTriple(data, tokenStart, tokenEnd, out x, out y, out z);
+                                var p = new XbimPoint3D(x, y, z);
+                                if (trans.HasValue)
+                                    p = trans.Value.Transform(p);
+                                vertexList.Add(p);
+                            }
+                            break;
+                        case 'N': //processes normals
+                            while (NextToken(data, ref pos, lineEnd, ' ', out tokenStart, out tokenEnd))
+                            {
+                                double x, y, z;
+                                ParseTriple(data, tokenStart, tokenEnd, out x, out y, out z);
+                                normalList.Add(new XbimVector3D(x, y, z));
+                            }
+                            break;
+                        case 'T': //process triangulated meshes
+                            var currentNormal = XbimVector3D.Zero;
+                            //each time we start a new mesh face we have to duplicate the vertices to ensure that we get correct shading of planar and non planar faces
+                            writtenVertices.Clear();
+
+                            while (NextToken(data, ref pos, lineEnd, ' ', out tokenStart, out tokenEnd))
+                            {
+                                if (CountTokens(data, tokenStart, tokenEnd, ',') != 3) throw new Exception("Invalid triangle definition");
+                                var cornerPos = tokenStart;
+                                int cornerStart, cornerEnd;
+                                while (NextToken(data, ref cornerPos, tokenEnd, ',', out cornerStart, out cornerEnd))
                                 {
-                                    var xyz = tokens[i].Split(',');
-                                    var p = new XbimPoint3D(Convert.ToDouble(xyz[0], CultureInfo.InvariantCulture),
-                                                                      Convert.ToDouble(xyz[1], CultureInfo.InvariantCulture),
-                                                                      Convert.ToDouble(xyz[2], CultureInfo.InvariantCulture));
-                                    if (trans.HasValue)
-                                        p = trans.Value.Transform(p);
-                                    vertexList.Add(p);
-                                }
-                                break;
-                            case "N": //processes normals
-                                for (var i = 1; i < tokens.Length; i++)
-                                {
-                                    var xyz = tokens[i].Split(',');
-                                    var v = new XbimVector3D(Convert.ToDouble(xyz[0], CultureInfo.InvariantCulture),
-                                                                       Convert.ToDouble(xyz[1], CultureInfo.InvariantCulture),
-                                                                       Convert.ToDouble(xyz[2], CultureInfo.InvariantCulture));
-                                    normalList.Add(v);
-                                }
-                                break;
-                            case "T": //process triangulated meshes
-                                var currentNormal = XbimVector3D.Zero;
-                                //each time we start a new mesh face we have to duplicate the vertices to ensure that we get correct shading of planar and non planar faces
-                                var writtenVertices = new Dictionary<int, int>();
-
-                                for (var i = 1; i < tokens.Length; i++)
-                                {
-                                    var triangleIndices = tokens[i].Split(new[] { ',' }, StringSplitOptions.RemoveEmptyEntries);
-                                    if (triangleIndices.Length != 3) throw new Exception("Invalid triangle definition");
-                                    for (var t = 0; t < 3; t++)
+                                    var partPos = cornerStart;
+                                    int indexStart, indexEnd, normalStart, normalEnd;
+                                    NextToken(data, ref partPos, cornerEnd, '/', out indexStart, out indexEnd);
+                                    if (NextToken(data, ref partPos, cornerEnd, '/', out normalStart, out normalEnd)) //we have a normal defined
                                     {
-                                        var indexNormalPair = triangleIndices[t].Split(new[] { '/' }, StringSplitOptions.RemoveEmptyEntries);
-
-                                        if (indexNormalPair.Length > 1) //we have a normal defined
+                                        if (version < 2)
+                                            currentNormal = ParseNormal(data, normalStart, normalEnd, normalList);
+                                        else
+                                            currentNormal = new XbimPackedNormal(ParseUShort(data, normalStart, normalEnd)).Normal;
+                                        if (trans.HasValue)
                                         {
-                                            var normalStr = indexNormalPair[1].Trim();
-                                            if (version < 2)
-                                            {
-                                                switch (normalStr)
-                                                {
-                                                    case "F": //Front
-                                                        currentNormal = new XbimVector3D(0, -1, 0);
-                                                        break;
-                                                    case "B": //Back
-                                                        currentNormal = new XbimVector3D(0, 1, 0);
-                                                        break;
-                                                    case "L": //Left
-                                                        currentNormal = new XbimVector3D(-1, 0, 0);
-                                                        break;
-                                                    case "R": //Right
-                                                        currentNormal = new XbimVector3D(1, 0, 0);
-                                                        break;
-                                                    case "U": //Up
-                                                        currentNormal = new XbimVector3D(0, 0, 1);
-                                                        break;
-                                                    case "D": //Down
-                                                        currentNormal = new XbimVector3D(0, 0, -1);
-                                                        break;
-                                                    default: //it is an index number
-                                                        var normalIndex = int.Parse(indexNormalPair[1]);
-                                                        currentNormal = normalList[normalIndex];
-                                                        break;
-                                                }
-                                            }
-                                            else
-                                            {
-                                                var normalIndex = ushort.Parse(indexNormalPair[1]);  
-                                                var packedNormal = new XbimPackedNormal(normalIndex);
-                                                currentNormal = packedNormal.Normal;
-                                            }
-                                            if (trans.HasValue)
-                                            {
-                                                XbimVector3D v;
-                                                XbimQuaternion.Transform(ref currentNormal, ref q, out v);
-                                                currentNormal = v;
-
-                                            }
+                                            XbimVector3D v;
+                                            XbimQuaternion.Transform(ref currentNormal, ref q, out v);
+                                            currentNormal = v;
                                         }
+                                    }
 
-                                        //now add the index
-                                        var index = int.Parse(indexNormalPair[0]);
+                                    //now add the index
+                                    var index = ParseInt(data, indexStart, indexEnd);
 
-                                        int alreadyWrittenAt; 
-                                        if (!writtenVertices.TryGetValue(index, out alreadyWrittenAt)) //if we haven't  written it in this mesh pass, add it again unless it is the first one which we know has been written
-                                        {
-                                            //all vertices will be unique and have only one normal
-                                            writtenVertices.Add(index, PositionCount);
-                                            TriangleIndices.Add(PositionCount);
-                                            Positions.Add(vertexList[index]);
-                                            Normals.Add(currentNormal); 
-                                        }
-                                        else //just add the index reference
-                                        {
-                                            TriangleIndices.Add(alreadyWrittenAt);
-                                        }
+                                    int alreadyWrittenAt;
+                                    if (!writtenVertices.TryGetValue(index, out alreadyWrittenAt)) //if we haven't  written it in this mesh pass, add it again unless it is the first one which we know has been written
+                                    {
+                                        //all vertices will be unique and have only one normal
+                                        writtenVertices.Add(index, PositionCount);
+                                        TriangleIndices.Add(PositionCount);
+                                        Positions.Add(vertexList[index]);
+                                        Normals.Add(currentNormal);
+                                    }
+                                    else //just add the index reference
+                                    {
+                                        TriangleIndices.Add(alreadyWrittenAt);
                                     }
                                 }
-
-                                break;
-                            case "F":
-                                break;
-                            default:
-                                throw new Exception("Invalid Geometry Command");
-
-                        }
+                            }
+                            break;
+                        case 'F':
+                            break;
+                        default:
+                            throw new Exception("Invalid Geometry Command");
                     }
                 }
+                lineStart = next;
             }
             return true;
         }
 
-       
+        #region text format scanning
+
+        /// <summary>
+        /// Finds the next non empty run of characters between separators in data[pos..end), pos is moved past it
+        /// </summary>
+        private static bool NextToken(string data, ref int pos, int end, char separator, out int tokenStart, out int tokenEnd)
+        {
+            while (pos < end && data[pos] == separator) pos++;
+            tokenStart = pos;
+            while (pos < end && data[pos] != separator) pos++;
+            tokenEnd = pos;
+            return tokenEnd > tokenStart;
+        }
+
+        private static bool HasToken(string data, int pos, int end)
+        {
+            int tokenStart, tokenEnd;
+            return NextToken(data, ref pos, end, ' ', out tokenStart, out tokenEnd);
+        }
+
+        private static int CountTokens(string data, int start, int end, char separator)
+        {
+            var count = 0;
+            int tokenStart, tokenEnd;
+            while (NextToken(data, ref start, end, separator, out tokenStart, out tokenEnd)) count++;
+            return count;
+        }
+
+        /// <summary>
+        /// Commands padded with other white space than blanks, anything longer than one letter is not a command
+        /// </summary>
+        private static char CommandOf(string token)
+        {
+            var command = token.Trim().ToUpper();
+            return command.Length == 1 ? command[0] : '\0';
+        }
+
+        /// <summary>
+        /// x,y,z, components after the third are ignored as they always were
+        /// </summary>
+        private static void ParseTriple(string data, int start, int end, out double x, out double y, out double z)
+        {
+            var xEnd = data.IndexOf(',', start, end - start);
+            var yEnd = xEnd < 0 ? -1 : data.IndexOf(',', xEnd + 1, end - xEnd - 1);
+            if (yEnd < 0) throw new Exception("Invalid point definition");
+            var zEnd = data.IndexOf(',', yEnd + 1, end - yEnd - 1);
+            if (zEnd < 0) zEnd = end;
+            x = ParseDouble(data, start, xEnd);
+            y = ParseDouble(data, xEnd + 1, yEnd);
+            z = ParseDouble(data, yEnd + 1, zEnd);
+        }
+
+        private static XbimVector3D ParseNormal(string data, int start, int end, List<XbimVector3D> normalList)
+        {
+            var trimmedStart = start;
+            var trimmedEnd = end;
+            while (trimmedStart < trimmedEnd && char.IsWhiteSpace(data[trimmedStart])) trimmedStart++;
+            while (trimmedEnd > trimmedStart && char.IsWhiteSpace(data[trimmedEnd - 1])) trimmedEnd--;
+            if (trimmedEnd - trimmedStart == 1)
+            {
+                switch (data[trimmedStart])
+                {
+                    case 'F': //Front
+                        return new XbimVector3D(0, -1, 0);
+                    case 'B': //Back
+                        return new XbimVector3D(0, 1, 0);
+                    case 'L': //Left
+                        return new XbimVector3D(-1, 0, 0);
+                    case 'R': //Right
+                        return new XbimVector3D(1, 0, 0);
+                    case 'U': //Up
+                        return new XbimVector3D(0, 0, 1);
+                    case 'D': //Down
+                        return new XbimVector3D(0, 0, -1);
+                }
+            }
+            //it is an index number
+            return normalList[ParseInt(data, start, end)];
+        }
+
+        /// <summary>
+        /// Unsigned decimal integers of up to 9 digits are read in place, anything else is left to int.Parse
+        /// </summary>
+        private static int ParseInt(string data, int start, int end)
+        {
+            if (end > start && end - start <= 9)
+            {
+                var value = 0;
+                var i = start;
+                for (; i < end; i++)
+                {
+                    var digit = data[i] - '0';
+                    if (digit < 0 || digit > 9) break;
+                    value = value * 10 + digit;
+                }
+                if (i == end) return value;
+            }
+            return int.Parse(data.Substring(start, end - start));
+        }
+
+        private static ushort ParseUShort(string data, int start, int end)
+        {
+            var value = ParseInt(data, start, end);
+            if (value < 0 || value > ushort.MaxValue)
+                return ushort.Parse(data.Substring(start, end - start)); //throws the same overflow as before
+            return (ushort)value;
+        }
+
+        private static readonly double[] PowersOf10 =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        /// <summary>
+        /// Reads a number in the invariant culture. A number with at most 15 significant digits and a decimal exponent of at most 22
+        /// is an exact integer scaled by an exact power of ten, a single multiplication or division rounds it correctly, which covers
+        /// everything the engine writes. Anything else is left to Convert.ToDouble
+        /// </summary>
+        private static double ParseDouble(string data, int start, int end)
+        {
+            var i = start;
+            var negative = false;
+            if (i < end && (data[i] == '-' || data[i] == '+'))
+            {
+                negative = data[i] == '-';
+                i++;
+            }
+            long mantissa = 0;
+            var digits = 0;
+            var scale = 0;
+            var anyDigits = false;
+            for (; i < end && data[i] >= '0' && data[i] <= '9'; i++)
+            {
+                anyDigits = true;
+                if (mantissa == 0 && data[i] == '0') continue; //leading zeros are not significant
+                mantissa = mantissa * 10 + (data[i] - '0');
+                digits++;
+            }
+            if (i < end && data[i] == '.')
+            {
+                for (i++; i < end && data[i] >= '0' && data[i] <= '9'; i++)
+                {
+                    anyDigits = true;
+                    scale--;
+                    if (mantissa == 0 && data[i] == '0') continue;
+                    mantissa = mantissa * 10 + (data[i] - '0');
+                    digits++;
+                }
+            }
+            if (anyDigits && digits <= 15 && i < end && (data[i] == 'E' || data[i] == 'e'))
+            {
+                i++;
+                var negativeExponent = false;
+                if (i < end && (data[i] == '-' || data[i] == '+'))
+                {
+                    negativeExponent = data[i] == '-';
+                    i++;
+                }
+                var exponent = 0;
+                var exponentStart = i;
+                for (; i < end && data[i] >= '0' && data[i] <= '9' && exponent < 1000; i++)
+                    exponent = exponent * 10 + (data[i] - '0');
+                if (i == exponentStart) anyDigits = false;
+                scale += negativeExponent ? -exponent : exponent;
+            }
+            if (anyDigits && digits <= 15 && i == end && scale >= -22 && scale <= 22)
+            {
+                double value = mantissa;
+                if (scale > 0) value *= PowersOf10[scale];
+                else if (scale < 0) value /= PowersOf10[-scale];
+                return negative && mantissa != 0 ? -value : value; //-0 reads as 0 as it did
+            }
+            return Convert.ToDouble(data.Substring(start, end - start), CultureInfo.InvariantCulture);
+        }
+
+        #endregion
 
         #region standard calls
 
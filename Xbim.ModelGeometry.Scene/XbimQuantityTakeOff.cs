@@ -0,0 +1,269 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    public class XbimQuantities
+    {
+        public int ProductLabel { get; internal set; }
+        public double Volume { get; internal set; }
+        public double SurfaceArea { get; internal set; }
+        /// <summary>
+        /// Area of the shape projected on to the XY plane, taken as half the projected area of all triangles so
+        /// for shapes that overhang themselves it is the projected area of the upward facing triangles
+        /// </summary>
+        public double FootprintArea { get; internal set; }
+        /// <summary>
+        /// Centre of volume in world coordinates
+        /// </summary>
+        public XbimPoint3D Centroid { get; internal set; }
+        /// <summary>
+        /// True if any part of the quantities came from the mesh of a curved shape rather than its B-rep
+        /// </summary>
+        public bool IsApproximate { get; internal set; }
+    }
+
+    /// <summary>
+    /// Calculates the volume, surface area, footprint area and centroid of products from the meshes in the geometry store.
+    /// The exact closed mesh formulas are used for shapes whose faces are all planar, curved shapes use the B-rep from the
+    /// CurvedSolidProvider when one is given. Quantities are cached by shape geometry label so a geometry that is mapped
+    /// to many instances is only integrated once, and the instances are processed in parallel.
+    /// </summary>
+    public class XbimQuantityTakeOff
+    {
+        private class GeometryQuantities
+        {
+            public XbimShapeMeshView Mesh;
+            public double Volume;
+            public double SurfaceArea;
+            public XbimPoint3D Centroid;
+            public bool IsApproximate;
+        }
+
+        private readonly IModel _model;
+        private readonly ConcurrentDictionary<int, Lazy<GeometryQuantities>> _cache = new ConcurrentDictionary<int, Lazy<GeometryQuantities>>();
+        private readonly Dictionary<int, XbimShapeGeometry> _geometries = new Dictionary<int, XbimShapeGeometry>();
+
+        public XbimQuantityTakeOff(IModel model)
+        {
+            _model = model;
+        }
+
+        /// <summary>
+        /// Maximum number of threads to use, any value less then 1 is not used
+        /// </summary>
+        public int MaxThreads { get; set; }
+
+        /// <summary>
+        /// If set it is called once for each shape geometry with curved faces, to return its solids in the coordinates of the geometry,
+        /// their volume and area are then integrated from the B-rep
+        /// </summary>
+        public Func<XbimShapeGeometry, IXbimSolidSet> CurvedSolidProvider { get; set; }
+
+        /// <summary>
+        /// Calculates the quantities of every product with a shape in the geometry store, keyed by product label
+        /// </summary>
+        public Dictionary<int, XbimQuantities> Calculate()
+        {
+            List<XbimShapeInstance> instances;
+            using (var reader = _model.GeometryStore.BeginRead())
+            {
+                instances = reader.ShapeInstances
+                    .Where(si => (byte)si.RepresentationType == (byte)XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded)
+                    .ToList();
+            }
+            return Calculate(instances);
+        }
+
+        /// <summary>
+        /// Calculates the quantities of the products of the instances, keyed by product label
+        /// </summary>
+        public Dictionary<int, XbimQuantities> Calculate(IList<XbimShapeInstance> instances)
+        {
+            using (var reader = _model.GeometryStore.BeginRead())
+            {
+                foreach (var label in instances.Select(i => i.ShapeGeometryLabel).Distinct())
+                {
+                    if (_geometries.ContainsKey(label))
+                        continue;
+                    var geometry = reader.ShapeGeometry(label);
+                    var shapeData = ((IXbimShapeGeometryData)geometry)?.ShapeData;
+                    if (shapeData != null && shapeData.Length > 0 && geometry.Format == XbimGeometryType.PolyhedronBinary)
+                        _geometries.Add(label, geometry);
+                }
+            }
+
+            var parallelOptions = new ParallelOptions();
+            if (MaxThreads > 0)
+                parallelOptions.MaxDegreeOfParallelism = MaxThreads;
+            var perInstance = new XbimQuantities[instances.Count];
+            Parallel.For(0, instances.Count, parallelOptions, i => perInstance[i] = Calculate(instances[i]));
+
+            var results = new Dictionary<int, XbimQuantities>();
+            foreach (var quantities in perInstance)
+            {
+                if (quantities == null)
+                    continue;
+                if (!results.TryGetValue(quantities.ProductLabel, out var total))
+                {
+                    results.Add(quantities.ProductLabel, quantities);
+                    continue;
+                }
+                var volume = total.Volume + quantities.Volume;
+                if (volume > 0)
+                {
+                    var a = total.Centroid;
+                    var b = quantities.Centroid;
+                    total.Centroid = new XbimPoint3D(
+                        (a.X * total.Volume + b.X * quantities.Volume) / volume,
+                        (a.Y * total.Volume + b.Y * quantities.Volume) / volume,
+                        (a.Z * total.Volume + b.Z * quantities.Volume) / volume);
+                }
+                total.Volume = volume;
+                total.SurfaceArea += quantities.SurfaceArea;
+                total.FootprintArea += quantities.FootprintArea;
+                total.IsApproximate |= quantities.IsApproximate;
+            }
+            return results;
+        }
+
+        private XbimQuantities Calculate(XbimShapeInstance instance)
+        {
+            if (!_geometries.TryGetValue(instance.ShapeGeometryLabel, out var geometry))
+                return null;
+            var local = _cache.GetOrAdd(instance.ShapeGeometryLabel, label => new Lazy<GeometryQuantities>(() => Integrate(geometry))).Value;
+            if (local.Mesh.TriangleCount == 0)
+                return null;
+
+            var m = instance.Transformation;
+            var vertices = new float[local.Mesh.VertexCount * 3];
+            local.Mesh.CopyVertices(m, vertices, 0);
+            var indices = new int[local.Mesh.TriangleCount * 3];
+            var indexCount = local.Mesh.CopyTriangleIndices(indices, 0);
+            var projected = 0.0;
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var a = indices[i] * 3;
+                var b = indices[i + 1] * 3;
+                var c = indices[i + 2] * 3;
+                projected += Math.Abs((vertices[b] - vertices[a]) * (vertices[c + 1] - vertices[a + 1]) -
+                                      (vertices[b + 1] - vertices[a + 1]) * (vertices[c] - vertices[a]));
+            }
+
+            //volume scales by the determinant, area only by the square of a uniform scale
+            var det = m.M11 * (m.M22 * m.M33 - m.M23 * m.M32) - m.M12 * (m.M21 * m.M33 - m.M23 * m.M31) + m.M13 * (m.M21 * m.M32 - m.M22 * m.M31);
+            var area = IsUniformScale(m, out var scaleSquared)
+                ? local.SurfaceArea * scaleSquared
+                : MeshArea(vertices, indices, indexCount);
+            return new XbimQuantities
+            {
+                ProductLabel = instance.IfcProductLabel,
+                Volume = local.Volume * Math.Abs(det),
+                SurfaceArea = area,
+                FootprintArea = projected / 4, //half of each triangle, half of all triangles
+                Centroid = m.Transform(local.Centroid),
+                IsApproximate = local.IsApproximate
+            };
+        }
+
+        private GeometryQuantities Integrate(XbimShapeGeometry geometry)
+        {
+            var mesh = new XbimShapeMeshView(((IXbimShapeGeometryData)geometry).ShapeData);
+            var result = new GeometryQuantities { Mesh = mesh };
+            var vertices = new float[mesh.VertexCount * 3];
+            mesh.CopyVertices(vertices, 0);
+            var indices = new int[mesh.TriangleCount * 3];
+            var indexCount = mesh.CopyTriangleIndices(indices, 0);
+
+            //divergence theorem, each triangle forms a signed tetrahedron with the origin, taken about the first vertex to limit round off
+            double ox = 0, oy = 0, oz = 0;
+            if (mesh.VertexCount > 0)
+            {
+                ox = vertices[0];
+                oy = vertices[1];
+                oz = vertices[2];
+            }
+            double volume = 0, cx = 0, cy = 0, cz = 0;
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var a = indices[i] * 3;
+                var b = indices[i + 1] * 3;
+                var c = indices[i + 2] * 3;
+                double ax = vertices[a] - ox, ay = vertices[a + 1] - oy, az = vertices[a + 2] - oz;
+                double bx = vertices[b] - ox, by = vertices[b + 1] - oy, bz = vertices[b + 2] - oz;
+                double qx = vertices[c] - ox, qy = vertices[c + 1] - oy, qz = vertices[c + 2] - oz;
+                var v = (ax * (by * qz - bz * qy) - ay * (bx * qz - bz * qx) + az * (bx * qy - by * qx)) / 6;
+                volume += v;
+                cx += v * (ax + bx + qx) / 4;
+                cy += v * (ay + by + qy) / 4;
+                cz += v * (az + bz + qz) / 4;
+            }
+            result.Volume = Math.Abs(volume);
+            result.Centroid = volume != 0
+                ? new XbimPoint3D(ox + cx / volume, oy + cy / volume, oz + cz / volume)
+                : new XbimPoint3D(ox, oy, oz);
+            result.SurfaceArea = MeshArea(vertices, indices, indexCount);
+
+            var polyhedral = true;
+            for (var f = 0; f < mesh.FaceCount && polyhedral; f++)
+                polyhedral = mesh.IsPlanar(f);
+            if (polyhedral)
+                return result;
+            result.IsApproximate = true;
+            if (CurvedSolidProvider == null)
+                return result;
+            try
+            {
+                var solids = CurvedSolidProvider(geometry);
+                if (solids != null && solids.Any())
+                {
+                    result.Volume = solids.Volume;
+                    result.SurfaceArea = solids.Sum(s => s.SurfaceArea);
+                    result.IsApproximate = false;
+                }
+            }
+            catch (Exception e)
+            {
+                Xbim3DModelContext.LogWarning(geometry, "Failed to integrate curved shape geometry #{0}, mesh quantities are used: {1}", geometry.ShapeLabel, e.Message);
+            }
+            return result;
+        }
+
+        private static double MeshArea(float[] vertices, int[] indices, int indexCount)
+        {
+            var area = 0.0;
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var a = indices[i] * 3;
+                var b = indices[i + 1] * 3;
+                var c = indices[i + 2] * 3;
+                double ux = vertices[b] - vertices[a], uy = vertices[b + 1] - vertices[a + 1], uz = vertices[b + 2] - vertices[a + 2];
+                double vx = vertices[c] - vertices[a], vy = vertices[c + 1] - vertices[a + 1], vz = vertices[c + 2] - vertices[a + 2];
+                double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+                area += Math.Sqrt(nx * nx + ny * ny + nz * nz) / 2;
+            }
+            return area;
+        }
+
+        /// <summary>
+        /// True if the rows of the linear part of the transform are orthogonal and of equal length
+        /// </summary>
+        private static bool IsUniformScale(XbimMatrix3D m, out double scaleSquared)
+        {
+            var l1 = m.M11 * m.M11 + m.M12 * m.M12 + m.M13 * m.M13;
+            var l2 = m.M21 * m.M21 + m.M22 * m.M22 + m.M23 * m.M23;
+            var l3 = m.M31 * m.M31 + m.M32 * m.M32 + m.M33 * m.M33;
+            scaleSquared = l1;
+            var eps = 1e-9 * Math.Max(l1, Math.Max(l2, l3));
+            return Math.Abs(l1 - l2) <= eps && Math.Abs(l1 - l3) <= eps &&
+                   Math.Abs(m.M11 * m.M21 + m.M12 * m.M22 + m.M13 * m.M23) <= eps &&
+                   Math.Abs(m.M11 * m.M31 + m.M12 * m.M32 + m.M13 * m.M33) <= eps &&
+                   Math.Abs(m.M21 * m.M31 + m.M22 * m.M32 + m.M23 * m.M33) <= eps;
+        }
+    }
+}
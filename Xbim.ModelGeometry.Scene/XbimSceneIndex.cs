@@ -0,0 +1,477 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// A read only spatial index over the world bounding boxes of shape instances, for visibility culling and picking.
+    /// The index is a linear bounding volume hierarchy built in bulk: the box centres are sorted by their Morton code
+    /// and every internal node is derived from the sorted codes independently (Karras 2012), so the nodes and then their
+    /// bounds are built in parallel. Nodes are held in flat arrays and queries walk them with a small explicit stack.
+    /// </summary>
+    /// <remarks>
+    /// Unlike XbimOctree the index cannot be added to, it should be rebuilt when the instances change.
+    /// </remarks>
+    public class XbimSceneIndex
+    {
+        internal struct NodeBox
+        {
+            public double MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+
+            public NodeBox(XbimRect3D rect)
+            {
+                MinX = rect.X;
+                MinY = rect.Y;
+                MinZ = rect.Z;
+                MaxX = rect.X + rect.SizeX;
+                MaxY = rect.Y + rect.SizeY;
+                MaxZ = rect.Z + rect.SizeZ;
+            }
+
+            public void Union(ref NodeBox a, ref NodeBox b)
+            {
+                MinX = Math.Min(a.MinX, b.MinX);
+                MinY = Math.Min(a.MinY, b.MinY);
+                MinZ = Math.Min(a.MinZ, b.MinZ);
+                MaxX = Math.Max(a.MaxX, b.MaxX);
+                MaxY = Math.Max(a.MaxY, b.MaxY);
+                MaxZ = Math.Max(a.MaxZ, b.MaxZ);
+            }
+
+            public bool Overlaps(ref NodeBox other)
+            {
+                return MinX <= other.MaxX && MaxX >= other.MinX &&
+                       MinY <= other.MaxY && MaxY >= other.MinY &&
+                       MinZ <= other.MaxZ && MaxZ >= other.MinZ;
+            }
+        }
+
+        /// <summary>
+        /// An internal node, a child index of 0 or more is another internal node, a negative one is the complement of a leaf index
+        /// </summary>
+        private struct Node
+        {
+            public NodeBox Box;
+            public int Left;
+            public int Right;
+        }
+
+        /// <summary>
+        /// A convex volume bounded by planes, a point is inside when A*x + B*y + C*z + D >= 0 for every plane
+        /// </summary>
+        public class Frustum
+        {
+            // A, B, C, D for each plane
+            private readonly double[] _planes;
+
+            public Frustum(IEnumerable<Tuple<XbimVector3D, double>> planes)
+            {
+                var list = new List<double>();
+                foreach (var plane in planes)
+                {
+                    list.Add(plane.Item1.X);
+                    list.Add(plane.Item1.Y);
+                    list.Add(plane.Item1.Z);
+                    list.Add(plane.Item2);
+                }
+                _planes = list.ToArray();
+            }
+
+            private Frustum(double[] planes)
+            {
+                _planes = planes;
+            }
+
+            /// <summary>
+            /// Extracts the six clipping planes from a combined view and projection matrix, points are row vectors multiplied
+            /// on the left as elsewhere in Xbim. The near plane is taken at a clip depth of -w, so for projections that clip
+            /// depth to 0..w the culling is slightly conservative.
+            /// </summary>
+            public static Frustum FromViewProjection(XbimMatrix3D m)
+            {
+                var c1 = new[] { m.M11, m.M21, m.M31, m.OffsetX };
+                var c2 = new[] { m.M12, m.M22, m.M32, m.OffsetY };
+                var c3 = new[] { m.M13, m.M23, m.M33, m.OffsetZ };
+                var c4 = new[] { m.M14, m.M24, m.M34, m.M44 };
+                var planes = new double[24];
+                for (var i = 0; i < 4; i++)
+                {
+                    planes[i] = c4[i] + c1[i]; //left
+                    planes[4 + i] = c4[i] - c1[i]; //right
+                    planes[8 + i] = c4[i] + c2[i]; //bottom
+                    planes[12 + i] = c4[i] - c2[i]; //top
+                    planes[16 + i] = c4[i] + c3[i]; //near
+                    planes[20 + i] = c4[i] - c3[i]; //far
+                }
+                return new Frustum(planes);
+            }
+
+            internal bool Excludes(ref NodeBox box)
+            {
+                for (var i = 0; i < _planes.Length; i += 4)
+                {
+                    var a = _planes[i];
+                    var b = _planes[i + 1];
+                    var c = _planes[i + 2];
+                    //the corner furthest along the plane normal
+                    var x = a >= 0 ? box.MaxX : box.MinX;
+                    var y = b >= 0 ? box.MaxY : box.MinY;
+                    var z = c >= 0 ? box.MaxZ : box.MinZ;
+                    if (a * x + b * y + c * z + _planes[i + 3] < 0)
+                        return true;
+                }
+                return false;
+            }
+        }
+
+        /// <summary>
+        /// A shape instance whose bounding box is hit by a ray, Distance is where the ray enters the box in multiples of the ray direction
+        /// </summary>
+        public struct Hit
+        {
+            public XbimShapeInstance Instance;
+            public double Distance;
+        }
+
+        //number of bits used for each axis of the Morton codes
+        private const int MortonBits = 10;
+
+        private readonly XbimShapeInstance[] _instances;
+        private readonly NodeBox[] _leafBoxes;
+        private readonly Node[] _nodes;
+        private readonly int _root;
+
+        /// <summary>
+        /// Builds the index from the world bounding boxes of the instances, instances with empty bounds are ignored
+        /// </summary>
+        /// <param name="shapeInstances">The instances to index</param>
+        /// <param name="maxThreads">Maximum number of threads to use, any value less then 1 is not used</param>
+        public XbimSceneIndex(IEnumerable<XbimShapeInstance> shapeInstances, int maxThreads = 0)
+        {
+            var parallelOptions = new ParallelOptions();
+            if (maxThreads > 0)
+                parallelOptions.MaxDegreeOfParallelism = maxThreads;
+
+            var instances = shapeInstances.Where(si => !si.BoundingBox.IsEmpty).ToArray();
+            var count = instances.Length;
+            var boxes = new NodeBox[count];
+            Parallel.For(0, count, parallelOptions, i =>
+            {
+                boxes[i] = new NodeBox(instances[i].BoundingBox.Transform(instances[i].Transformation));
+            });
+
+            _instances = new XbimShapeInstance[count];
+            _leafBoxes = new NodeBox[count];
+            _nodes = new Node[Math.Max(count - 1, 0)];
+            if (count == 0)
+                return;
+
+            //quantise the box centres within the scene bounds, the instance index in the low bits makes each key unique
+            var scene = boxes[0];
+            for (var i = 1; i < count; i++)
+                scene.Union(ref scene, ref boxes[i]);
+            var scale = (1 << MortonBits) - 1;
+            var sizeX = Math.Max(scene.MaxX - scene.MinX, double.Epsilon);
+            var sizeY = Math.Max(scene.MaxY - scene.MinY, double.Epsilon);
+            var sizeZ = Math.Max(scene.MaxZ - scene.MinZ, double.Epsilon);
+            var keys = new ulong[count];
+            Parallel.For(0, count, parallelOptions, i =>
+            {
+                var x = Quantise(((boxes[i].MinX + boxes[i].MaxX) / 2 - scene.MinX) / sizeX, scale);
+                var y = Quantise(((boxes[i].MinY + boxes[i].MaxY) / 2 - scene.MinY) / sizeY, scale);
+                var z = Quantise(((boxes[i].MinZ + boxes[i].MaxZ) / 2 - scene.MinZ) / sizeZ, scale);
+                keys[i] = ((ulong)((ExpandBits(x) << 2) | (ExpandBits(y) << 1) | ExpandBits(z)) << 32) | (uint)i;
+            });
+            Array.Sort(keys);
+
+            Parallel.For(0, count, parallelOptions, i =>
+            {
+                var source = (int)(keys[i] & 0xFFFFFFFF);
+                _instances[i] = instances[source];
+                _leafBoxes[i] = boxes[source];
+            });
+
+            if (count == 1)
+            {
+                _root = ~0;
+                return;
+            }
+            _root = 0;
+            var internalParents = new int[count - 1];
+            var leafParents = new int[count];
+            internalParents[0] = -1;
+            Parallel.For(0, count - 1, parallelOptions, i => BuildNode(keys, i, internalParents, leafParents));
+
+            //bounds are filled from the leaves up, the second child to arrive at a node computes its bounds
+            var arrivals = new int[count - 1];
+            Parallel.For(0, count, parallelOptions, i =>
+            {
+                var node = leafParents[i];
+                while (node >= 0 && Interlocked.Increment(ref arrivals[node]) == 2)
+                {
+                    _nodes[node].Box.Union(ref ChildBox(_nodes[node].Left), ref ChildBox(_nodes[node].Right));
+                    node = internalParents[node];
+                }
+            });
+        }
+
+        /// <summary>
+        /// The indexed instances, in the order of their Morton codes
+        /// </summary>
+        public IReadOnlyList<XbimShapeInstance> Instances => _instances;
+
+        public int Count => _instances.Length;
+
+        private ref NodeBox ChildBox(int child)
+        {
+            if (child < 0)
+                return ref _leafBoxes[~child];
+            return ref _nodes[child].Box;
+        }
+
+        /// <summary>
+        /// Finds the range of sorted keys covered by internal node i and where that range splits
+        /// </summary>
+        private void BuildNode(ulong[] keys, int i, int[] internalParents, int[] leafParents)
+        {
+            var d = Delta(keys, i, i + 1) > Delta(keys, i, i - 1) ? 1 : -1;
+            var minDelta = Delta(keys, i, i - d);
+            var lMax = 2;
+            while (Delta(keys, i, i + lMax * d) > minDelta)
+                lMax *= 2;
+            var l = 0;
+            for (var t = lMax / 2; t >= 1; t /= 2)
+            {
+                if (Delta(keys, i, i + (l + t) * d) > minDelta)
+                    l += t;
+            }
+            var j = i + l * d;
+            var nodeDelta = Delta(keys, i, j);
+            var s = 0;
+            var step = l;
+            do
+            {
+                step = (step + 1) >> 1;
+                if (Delta(keys, i, i + (s + step) * d) > nodeDelta)
+                    s += step;
+            } while (step > 1);
+            var split = i + s * d + Math.Min(d, 0);
+
+            if (Math.Min(i, j) == split)
+            {
+                _nodes[i].Left = ~split;
+                leafParents[split] = i;
+            }
+            else
+            {
+                _nodes[i].Left = split;
+                internalParents[split] = i;
+            }
+            if (Math.Max(i, j) == split + 1)
+            {
+                _nodes[i].Right = ~(split + 1);
+                leafParents[split + 1] = i;
+            }
+            else
+            {
+                _nodes[i].Right = split + 1;
+                internalParents[split + 1] = i;
+            }
+        }
+
+        /// <summary>
+        /// Length of the common prefix of two sorted keys, -1 if j is out of range
+        /// </summary>
+        private static int Delta(ulong[] keys, int i, int j)
+        {
+            if (j < 0 || j >= keys.Length)
+                return -1;
+            return LeadingZeros(keys[i] ^ keys[j]);
+        }
+
+        private static int LeadingZeros(ulong x)
+        {
+            if (x == 0)
+                return 64;
+            var n = 0;
+            if ((x & 0xFFFFFFFF00000000UL) == 0) { n += 32; x <<= 32; }
+            if ((x & 0xFFFF000000000000UL) == 0) { n += 16; x <<= 16; }
+            if ((x & 0xFF00000000000000UL) == 0) { n += 8; x <<= 8; }
+            if ((x & 0xF000000000000000UL) == 0) { n += 4; x <<= 4; }
+            if ((x & 0xC000000000000000UL) == 0) { n += 2; x <<= 2; }
+            if ((x & 0x8000000000000000UL) == 0) { n += 1; }
+            return n;
+        }
+
+        private static uint Quantise(double unit, int scale)
+        {
+            if (!(unit > 0))
+                return 0;
+            return (uint)Math.Min(unit * scale, scale);
+        }
+
+        /// <summary>
+        /// Spreads the low 10 bits of v so there are two zero bits between each
+        /// </summary>
+        private static uint ExpandBits(uint v)
+        {
+            v = (v * 0x00010001u) & 0xFF0000FFu;
+            v = (v * 0x00000101u) & 0x0F00F00Fu;
+            v = (v * 0x00000011u) & 0xC30C30C3u;
+            v = (v * 0x00000005u) & 0x49249249u;
+            return v;
+        }
+
+        /// <summary>
+        /// Visits every leaf whose box passes the node test, the test is applied to internal nodes and leaves alike
+        /// </summary>
+        private void Traverse(Func<NodeBox, bool> accept, Action<int> leaf)
+        {
+            if (_instances.Length == 0)
+                return;
+            var stack = new int[64];
+            var top = 0;
+            stack[top++] = _root;
+            while (top > 0)
+            {
+                var node = stack[--top];
+                if (!accept(ChildBox(node)))
+                    continue;
+                if (node < 0)
+                {
+                    leaf(~node);
+                    continue;
+                }
+                if (top + 2 > stack.Length)
+                    Array.Resize(ref stack, stack.Length * 2);
+                stack[top++] = _nodes[node].Right;
+                stack[top++] = _nodes[node].Left;
+            }
+        }
+
+        /// <summary>
+        /// Returns the instances whose world bounding box overlaps the box
+        /// </summary>
+        public List<XbimShapeInstance> Overlapping(XbimRect3D box)
+        {
+            var results = new List<XbimShapeInstance>();
+            if (box.IsEmpty)
+                return results;
+            var query = new NodeBox(box);
+            Traverse(b => b.Overlaps(ref query), i => results.Add(_instances[i]));
+            return results;
+        }
+
+        /// <summary>
+        /// Runs a batch of box queries in parallel, the results are in the order of the boxes
+        /// </summary>
+        public List<XbimShapeInstance>[] Overlapping(IList<XbimRect3D> boxes)
+        {
+            var results = new List<XbimShapeInstance>[boxes.Count];
+            Parallel.For(0, boxes.Count, i => results[i] = Overlapping(boxes[i]));
+            return results;
+        }
+
+        /// <summary>
+        /// Returns the instances whose world bounding box is at least partly inside the frustum
+        /// </summary>
+        public List<XbimShapeInstance> Visible(Frustum frustum)
+        {
+            var results = new List<XbimShapeInstance>();
+            Traverse(b => !frustum.Excludes(ref b), i => results.Add(_instances[i]));
+            return results;
+        }
+
+        /// <summary>
+        /// Culls against a batch of frusta in parallel, the results are in the order of the frusta
+        /// </summary>
+        public List<XbimShapeInstance>[] Visible(IList<Frustum> frusta)
+        {
+            var results = new List<XbimShapeInstance>[frusta.Count];
+            Parallel.For(0, frusta.Count, i => results[i] = Visible(frusta[i]));
+            return results;
+        }
+
+        /// <summary>
+        /// Returns every instance whose world bounding box is hit by the ray, nearest first
+        /// </summary>
+        public List<Hit> Pick(XbimPoint3D origin, XbimVector3D direction)
+        {
+            var hits = new List<Hit>();
+            var inverse = new[] { 1 / direction.X, 1 / direction.Y, 1 / direction.Z };
+            Traverse(b => RayDistance(ref b, origin, inverse) >= 0, i => hits.Add(new Hit
+            {
+                Instance = _instances[i],
+                Distance = RayDistance(ref _leafBoxes[i], origin, inverse)
+            }));
+            hits.Sort((a, b) => a.Distance.CompareTo(b.Distance));
+            return hits;
+        }
+
+        /// <summary>
+        /// Picks a batch of rays in parallel, returning the nearest hit of each ray or null if it hits nothing
+        /// </summary>
+        public Hit?[] Pick(IList<XbimPoint3D> origins, IList<XbimVector3D> directions)
+        {
+            if (origins.Count != directions.Count)
+                throw new ArgumentException("There must be one direction for each origin", nameof(directions));
+            var results = new Hit?[origins.Count];
+            Parallel.For(0, origins.Count, r =>
+            {
+                var origin = origins[r];
+                var direction = directions[r];
+                var inverse = new[] { 1 / direction.X, 1 / direction.Y, 1 / direction.Z };
+                var nearest = double.PositiveInfinity;
+                var nearestLeaf = -1;
+                //nodes entered beyond the nearest hit so far cannot contain a nearer one
+                Traverse(b =>
+                {
+                    var t = RayDistance(ref b, origin, inverse);
+                    return t >= 0 && t < nearest;
+                }, i =>
+                {
+                    nearest = RayDistance(ref _leafBoxes[i], origin, inverse);
+                    nearestLeaf = i;
+                });
+                if (nearestLeaf >= 0)
+                    results[r] = new Hit { Instance = _instances[nearestLeaf], Distance = nearest };
+            });
+            return results;
+        }
+
+        /// <summary>
+        /// Slab test, returns the ray parameter where the ray enters the box, 0 if it starts inside and -1 if it misses
+        /// </summary>
+        private static double RayDistance(ref NodeBox box, XbimPoint3D origin, double[] inverse)
+        {
+            var tMin = 0.0;
+            var tMax = double.PositiveInfinity;
+            if (!Slab(box.MinX, box.MaxX, origin.X, inverse[0], ref tMin, ref tMax) ||
+                !Slab(box.MinY, box.MaxY, origin.Y, inverse[1], ref tMin, ref tMax) ||
+                !Slab(box.MinZ, box.MaxZ, origin.Z, inverse[2], ref tMin, ref tMax))
+                return -1;
+            return tMin;
+        }
+
+        private static bool Slab(double min, double max, double origin, double inverse, ref double tMin, ref double tMax)
+        {
+            if (double.IsInfinity(inverse))
+                return origin >= min && origin <= max; //parallel to the slab
+            var t1 = (min - origin) * inverse;
+            var t2 = (max - origin) * inverse;
+            if (t1 > t2)
+            {
+                var t = t1;
+                t1 = t2;
+                t2 = t;
+            }
+            tMin = Math.Max(tMin, t1);
+            tMax = Math.Min(tMax, t2);
+            return tMin <= tMax;
+        }
+    }
+}
@@ -0,0 +1,244 @@
+﻿using System;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// A read only view over a PolyhedronBinary shape geometry held in a byte buffer, values are decoded from the buffer
+    /// as they are asked for and nothing is copied in to lists. The bulk copy methods write straight in to buffers owned by the caller,
+    /// e.g. vertex and index buffers of a graphics API.
+    ///
+    /// Layout of the buffer:
+    /// Version                  // byte
+    /// VertexCount              // int
+    /// TriangleCount            // int
+    /// [X, Y, Z]                // 3 * float * VertexCount
+    /// FaceCount                // int
+    /// [TriangleCountInFace     // int, positive if the face is planar
+    ///  Normal                  // packed normal, planar faces only
+    ///  [Index                  // byte, ushort or int f(VertexCount)
+    ///   Normal]                // packed normal after each index, curved faces only
+    ///  ...]
+    /// </summary>
+    public struct XbimShapeMeshView
+    {
+        private const int PackedNormalSize = 2;
+
+        private readonly byte[] _data;
+        private readonly int _verticesOffset;
+        private readonly int _indexSize;
+        // offset of the first index of each face, its triangle count is stored immediately before (and before the planar normal)
+        private readonly int[] _faceOffsets;
+        private readonly int[] _faceTriangleCounts;
+
+        public XbimShapeMeshView(byte[] data) : this(new ArraySegment<byte>(data))
+        {
+        }
+
+        /// <summary>
+        /// Creates a view over the shape data, only the face headers are read, to find where each face starts
+        /// </summary>
+        public XbimShapeMeshView(ArraySegment<byte> data)
+        {
+            _data = data.Array;
+            var pos = data.Offset;
+            Version = _data[pos];
+            VertexCount = BitConverter.ToInt32(_data, pos + 1);
+            TriangleCount = BitConverter.ToInt32(_data, pos + 5);
+            _verticesOffset = pos + 9;
+            _indexSize = VertexCount <= 0xFF ? sizeof(byte) : VertexCount <= 0xFFFF ? sizeof(ushort) : sizeof(int);
+            pos = _verticesOffset + VertexCount * 3 * sizeof(float);
+            var faceCount = BitConverter.ToInt32(_data, pos);
+            pos += sizeof(int);
+            _faceOffsets = new int[faceCount];
+            _faceTriangleCounts = new int[faceCount];
+            for (var f = 0; f < faceCount; f++)
+            {
+                var triangles = BitConverter.ToInt32(_data, pos);
+                pos += sizeof(int);
+                _faceTriangleCounts[f] = triangles;
+                if (triangles > 0)
+                {
+                    pos += PackedNormalSize;
+                    _faceOffsets[f] = pos;
+                    pos += triangles * 3 * _indexSize;
+                }
+                else
+                {
+                    _faceOffsets[f] = pos;
+                    pos += -triangles * 3 * (_indexSize + PackedNormalSize);
+                }
+            }
+            if (pos > data.Offset + data.Count)
+                throw new ArgumentException("The shape data is shorter than its header describes", nameof(data));
+        }
+
+        public byte Version { get; }
+
+        public int VertexCount { get; }
+
+        public int TriangleCount { get; }
+
+        public int FaceCount => _faceOffsets.Length;
+
+        public XbimPoint3D Vertex(int index)
+        {
+            var pos = _verticesOffset + index * 3 * sizeof(float);
+            return new XbimPoint3D(
+                BitConverter.ToSingle(_data, pos),
+                BitConverter.ToSingle(_data, pos + sizeof(float)),
+                BitConverter.ToSingle(_data, pos + 2 * sizeof(float)));
+        }
+
+        /// <summary>
+        /// Number of triangles in the face
+        /// </summary>
+        public int FaceTriangleCount(int face)
+        {
+            return Math.Abs(_faceTriangleCounts[face]);
+        }
+
+        /// <summary>
+        /// True if the face is planar and has one normal, otherwise each index has its own normal
+        /// </summary>
+        public bool IsPlanar(int face)
+        {
+            return _faceTriangleCounts[face] > 0;
+        }
+
+        /// <summary>
+        /// Vertex index of a corner of a triangle of the face, corner is 0, 1 or 2
+        /// </summary>
+        public int Index(int face, int triangle, int corner)
+        {
+            return ReadIndex(_faceOffsets[face] + (triangle * 3 + corner) * CornerSize(face));
+        }
+
+        /// <summary>
+        /// Normal at a corner of a triangle of the face, this is the face normal for planar faces
+        /// </summary>
+        public XbimPackedNormal Normal(int face, int triangle, int corner)
+        {
+            var pos = IsPlanar(face)
+                ? _faceOffsets[face] - PackedNormalSize
+                : _faceOffsets[face] + (triangle * 3 + corner) * CornerSize(face) + _indexSize;
+            return new XbimPackedNormal(_data[pos], _data[pos + 1]);
+        }
+
+        /// <summary>
+        /// Copies the vertices as X, Y, Z floats, 3 * VertexCount floats are written
+        /// </summary>
+        public void CopyVertices(float[] destination, int destinationIndex)
+        {
+            Buffer.BlockCopy(_data, _verticesOffset, destination, destinationIndex * sizeof(float), VertexCount * 3 * sizeof(float));
+        }
+
+        /// <summary>
+        /// Copies the vertices transformed by the instance transform, 3 * VertexCount floats are written.
+        /// The vertices are copied in one block and then transformed in place, the arithmetic is in double so large
+        /// georeferenced offsets do not lose precision before the final conversion to float
+        /// </summary>
+        public void CopyVertices(XbimMatrix3D transform, float[] destination, int destinationIndex)
+        {
+            CopyVertices(destination, destinationIndex);
+            if (transform.IsIdentity)
+                return;
+            double m11 = transform.M11, m12 = transform.M12, m13 = transform.M13;
+            double m21 = transform.M21, m22 = transform.M22, m23 = transform.M23;
+            double m31 = transform.M31, m32 = transform.M32, m33 = transform.M33;
+            double ox = transform.OffsetX, oy = transform.OffsetY, oz = transform.OffsetZ;
+            var end = destinationIndex + VertexCount * 3;
+            for (var i = destinationIndex; i < end; i += 3)
+            {
+                double x = destination[i];
+                double y = destination[i + 1];
+                double z = destination[i + 2];
+                destination[i] = (float)(x * m11 + y * m21 + z * m31 + ox);
+                destination[i + 1] = (float)(x * m12 + y * m22 + z * m32 + oy);
+                destination[i + 2] = (float)(x * m13 + y * m23 + z * m33 + oz);
+            }
+        }
+
+        /// <summary>
+        /// Copies the vertex indices of every triangle, face by face, adding baseVertex to each.
+        /// Returns the number of indices written, 3 * TriangleCount
+        /// </summary>
+        public int CopyTriangleIndices(int[] destination, int destinationIndex, int baseVertex = 0)
+        {
+            var written = destinationIndex;
+            for (var f = 0; f < _faceOffsets.Length; f++)
+            {
+                var cornerSize = CornerSize(f);
+                var pos = _faceOffsets[f];
+                var corners = FaceTriangleCount(f) * 3;
+                switch (cornerSize)
+                {
+                    case sizeof(byte):
+                        for (var c = 0; c < corners; c++)
+                            destination[written++] = _data[pos + c] + baseVertex;
+                        break;
+                    default:
+                        for (var c = 0; c < corners; c++, pos += cornerSize)
+                            destination[written++] = ReadIndex(pos) + baseVertex;
+                        break;
+                }
+            }
+            return written - destinationIndex;
+        }
+
+        /// <summary>
+        /// Copies the normal of each triangle corner as X, Y, Z floats, in the same order as CopyTriangleIndices,
+        /// rotated by the rotation of the transform if given. Returns the number of floats written, 9 * TriangleCount
+        /// </summary>
+        public int CopyCornerNormals(float[] destination, int destinationIndex, XbimMatrix3D? transform = null)
+        {
+            var rotation = new XbimQuaternion();
+            var rotate = false;
+            if (transform.HasValue && !transform.Value.IsIdentity)
+            {
+                rotation = transform.Value.GetRotationQuaternion();
+                rotate = !rotation.IsIdentity();
+            }
+            var written = destinationIndex;
+            for (var f = 0; f < _faceOffsets.Length; f++)
+            {
+                var triangles = FaceTriangleCount(f);
+                for (var t = 0; t < triangles; t++)
+                {
+                    for (var c = 0; c < 3; c++)
+                    {
+                        // planar faces repeat the same normal, it is decoded once per corner to keep the loop simple
+                        var normal = Normal(f, t, c).Normal;
+                        if (rotate)
+                        {
+                            var baseVal = normal;
+                            XbimQuaternion.Transform(ref baseVal, ref rotation, out normal);
+                        }
+                        destination[written++] = (float)normal.X;
+                        destination[written++] = (float)normal.Y;
+                        destination[written++] = (float)normal.Z;
+                    }
+                }
+            }
+            return written - destinationIndex;
+        }
+
+        private int CornerSize(int face)
+        {
+            return IsPlanar(face) ? _indexSize : _indexSize + PackedNormalSize;
+        }
+
+        private int ReadIndex(int pos)
+        {
+            switch (_indexSize)
+            {
+                case sizeof(byte):
+                    return _data[pos];
+                case sizeof(ushort):
+                    return BitConverter.ToUInt16(_data, pos);
+                default:
+                    return BitConverter.ToInt32(_data, pos);
+            }
+        }
+    }
+}
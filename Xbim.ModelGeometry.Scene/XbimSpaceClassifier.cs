@@ -0,0 +1,282 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Classifies batches of points, boxes or elements against the meshes of a set of volumes, typically spaces.
+    /// Candidate volumes come from an XbimSceneIndex over their bounds, each candidate is tested with the generalised
+    /// winding number of its mesh, which tolerates small gaps and a fully inverted mesh. For a closed mesh the winding number is
+    /// exactly 0 or 1 however close the point is, so points within BoundaryDistance of the mesh, where the chordal mesh and a
+    /// curved boundary may disagree, are passed to the BoundaryClassifier. Points whose winding number is ambiguous because
+    /// the mesh has gaps go to the BoundaryClassifier or to a vote of ray crossings. Queries run in parallel.
+    /// </summary>
+    public class XbimSpaceClassifier
+    {
+        private const double FourPi = 4 * Math.PI;
+
+        private readonly XbimSceneIndex _index;
+        // world triangles of each volume, 9 doubles per triangle, keyed by instance label
+        private readonly Dictionary<int, double[]> _triangles = new Dictionary<int, double[]>();
+
+        /// <summary>
+        /// Loads the meshes of the volumes from the geometry store of the model
+        /// </summary>
+        public XbimSpaceClassifier(IModel model, IEnumerable<XbimShapeInstance> volumes, int maxThreads = 0)
+        {
+            var loaded = new List<XbimShapeInstance>();
+            using (var reader = model.GeometryStore.BeginRead())
+            {
+                foreach (var volume in volumes)
+                {
+                    var geometry = reader.ShapeGeometry(volume.ShapeGeometryLabel);
+                    var shapeData = ((IXbimShapeGeometryData)geometry)?.ShapeData;
+                    if (shapeData == null || shapeData.Length == 0 || geometry.Format != XbimGeometryType.PolyhedronBinary)
+                        continue;
+                    var mesh = new XbimShapeMeshView(shapeData);
+                    if (mesh.TriangleCount == 0)
+                        continue;
+                    _triangles[volume.InstanceLabel] = WorldTriangles(mesh, volume.Transformation);
+                    loaded.Add(volume);
+                }
+            }
+            MaxThreads = maxThreads;
+            BoundaryDistance = model.ModelFactors.DeflectionTolerance;
+            _index = new XbimSceneIndex(loaded, maxThreads);
+        }
+
+        /// <summary>
+        /// Maximum number of threads to use, any value less then 1 is not used
+        /// </summary>
+        public int MaxThreads { get; set; }
+
+        /// <summary>
+        /// Winding numbers further than this from both 0 and 1 are ambiguous, which only happens where the mesh has gaps, default is 0.25
+        /// </summary>
+        public double AmbiguityBand { get; set; } = 0.25;
+
+        /// <summary>
+        /// Points closer than this to the mesh of a volume are near its boundary and are passed to the BoundaryClassifier,
+        /// default is the deflection tolerance of the model, the furthest the mesh may be from a curved boundary
+        /// </summary>
+        public double BoundaryDistance { get; set; }
+
+        /// <summary>
+        /// Optional exact classifier called for points near the boundary of a volume, e.g. one using the B-rep of the space.
+        /// Returns true if the point is inside, when not set the majority of three ray crossing tests decides
+        /// </summary>
+        public Func<XbimShapeInstance, XbimPoint3D, bool> BoundaryClassifier { get; set; }
+
+        /// <summary>
+        /// Returns the volumes that contain each point
+        /// </summary>
+        public List<XbimShapeInstance>[] Classify(IList<XbimPoint3D> points)
+        {
+            var results = new List<XbimShapeInstance>[points.Count];
+            Parallel.For(0, points.Count, ParallelOptions(), i => results[i] = Classify(points[i]));
+            return results;
+        }
+
+        /// <summary>
+        /// Returns the volumes that contain the centre of each box
+        /// </summary>
+        public List<XbimShapeInstance>[] Classify(IList<XbimRect3D> boxes)
+        {
+            return Classify(boxes.Select(b => b.Centroid()).ToList());
+        }
+
+        /// <summary>
+        /// Returns the volumes that contain the centre of the world bounds of each element
+        /// </summary>
+        public List<XbimShapeInstance>[] Classify(IList<XbimShapeInstance> elements)
+        {
+            return Classify(elements.Select(e => e.BoundingBox.Transform(e.Transformation).Centroid()).ToList());
+        }
+
+        /// <summary>
+        /// Returns the volumes that contain the point
+        /// </summary>
+        public List<XbimShapeInstance> Classify(XbimPoint3D point)
+        {
+            var results = new List<XbimShapeInstance>();
+            foreach (var volume in _index.Overlapping(new XbimRect3D(point.X, point.Y, point.Z, 0, 0, 0)))
+            {
+                if (Contains(volume, point))
+                    results.Add(volume);
+            }
+            return results;
+        }
+
+        private ParallelOptions ParallelOptions()
+        {
+            var options = new ParallelOptions();
+            if (MaxThreads > 0)
+                options.MaxDegreeOfParallelism = MaxThreads;
+            return options;
+        }
+
+        private bool Contains(XbimShapeInstance volume, XbimPoint3D point)
+        {
+            var triangles = _triangles[volume.InstanceLabel];
+            //an inverted mesh gives -1 inside
+            var winding = Math.Abs(WindingNumber(triangles, point));
+            var ambiguous = winding <= 1 - AmbiguityBand && winding >= AmbiguityBand;
+            if (BoundaryClassifier != null && (ambiguous || IsNear(triangles, point, BoundaryDistance)))
+                return BoundaryClassifier(volume, point);
+            if (!ambiguous)
+                return winding > 0.5;
+            var votes = 0;
+            if (RayCrossings(triangles, point, 0.5773, 0.5779, 0.5767) % 2 == 1) votes++;
+            if (RayCrossings(triangles, point, -0.6123, 0.3531, 0.7071) % 2 == 1) votes++;
+            if (RayCrossings(triangles, point, 0.2673, -0.8018, -0.5345) % 2 == 1) votes++;
+            return votes >= 2;
+        }
+
+        private static double[] WorldTriangles(XbimShapeMeshView mesh, XbimMatrix3D transform)
+        {
+            var vertices = new float[mesh.VertexCount * 3];
+            mesh.CopyVertices(transform, vertices, 0);
+            var indices = new int[mesh.TriangleCount * 3];
+            var indexCount = mesh.CopyTriangleIndices(indices, 0);
+            var points = new double[indexCount * 3];
+            for (var i = 0; i < indexCount; i++)
+            {
+                points[i * 3] = vertices[indices[i] * 3];
+                points[i * 3 + 1] = vertices[indices[i] * 3 + 1];
+                points[i * 3 + 2] = vertices[indices[i] * 3 + 2];
+            }
+            return points;
+        }
+
+        /// <summary>
+        /// Sum of the solid angles the triangles subtend at the point divided by 4 pi (Van Oosterom and Strackee)
+        /// </summary>
+        private static double WindingNumber(double[] t, XbimPoint3D p)
+        {
+            var total = 0.0;
+            for (var i = 0; i < t.Length; i += 9)
+            {
+                double ax = t[i] - p.X, ay = t[i + 1] - p.Y, az = t[i + 2] - p.Z;
+                double bx = t[i + 3] - p.X, by = t[i + 4] - p.Y, bz = t[i + 5] - p.Z;
+                double cx = t[i + 6] - p.X, cy = t[i + 7] - p.Y, cz = t[i + 8] - p.Z;
+                var la = Math.Sqrt(ax * ax + ay * ay + az * az);
+                var lb = Math.Sqrt(bx * bx + by * by + bz * bz);
+                var lc = Math.Sqrt(cx * cx + cy * cy + cz * cz);
+                var det = ax * (by * cz - bz * cy) - ay * (bx * cz - bz * cx) + az * (bx * cy - by * cx);
+                var div = la * lb * lc + (ax * bx + ay * by + az * bz) * lc + (ax * cx + ay * cy + az * cz) * lb + (bx * cx + by * cy + bz * cz) * la;
+                total += 2 * Math.Atan2(det, div);
+            }
+            return total / FourPi;
+        }
+
+        /// <summary>
+        /// True if any triangle is within the distance of the point
+        /// </summary>
+        private static bool IsNear(double[] t, XbimPoint3D p, double distance)
+        {
+            if (distance <= 0)
+                return false;
+            var distanceSquared = distance * distance;
+            for (var i = 0; i < t.Length; i += 9)
+            {
+                //most triangles are rejected by their bounds
+                if (p.X < Math.Min(t[i], Math.Min(t[i + 3], t[i + 6])) - distance || p.X > Math.Max(t[i], Math.Max(t[i + 3], t[i + 6])) + distance ||
+                    p.Y < Math.Min(t[i + 1], Math.Min(t[i + 4], t[i + 7])) - distance || p.Y > Math.Max(t[i + 1], Math.Max(t[i + 4], t[i + 7])) + distance ||
+                    p.Z < Math.Min(t[i + 2], Math.Min(t[i + 5], t[i + 8])) - distance || p.Z > Math.Max(t[i + 2], Math.Max(t[i + 5], t[i + 8])) + distance)
+                    continue;
+                if (DistanceSquared(t, i, p) <= distanceSquared)
+                    return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// Squared distance from the point to the closest point of the triangle starting at i (Ericson, Real-Time Collision Detection 5.1.5)
+        /// </summary>
+        private static double DistanceSquared(double[] t, int i, XbimPoint3D p)
+        {
+            double abx = t[i + 3] - t[i], aby = t[i + 4] - t[i + 1], abz = t[i + 5] - t[i + 2];
+            double acx = t[i + 6] - t[i], acy = t[i + 7] - t[i + 1], acz = t[i + 8] - t[i + 2];
+            double apx = p.X - t[i], apy = p.Y - t[i + 1], apz = p.Z - t[i + 2];
+            var d1 = abx * apx + aby * apy + abz * apz;
+            var d2 = acx * apx + acy * apy + acz * apz;
+            double u, v; //closest point is a + u ab + v ac
+            if (d1 <= 0 && d2 <= 0)
+            {
+                u = 0; v = 0;
+            }
+            else
+            {
+                double bpx = p.X - t[i + 3], bpy = p.Y - t[i + 4], bpz = p.Z - t[i + 5];
+                var d3 = abx * bpx + aby * bpy + abz * bpz;
+                var d4 = acx * bpx + acy * bpy + acz * bpz;
+                double cpx = p.X - t[i + 6], cpy = p.Y - t[i + 7], cpz = p.Z - t[i + 8];
+                var d5 = abx * cpx + aby * cpy + abz * cpz;
+                var d6 = acx * cpx + acy * cpy + acz * cpz;
+                var va = d3 * d6 - d5 * d4;
+                var vb = d5 * d2 - d1 * d6;
+                var vc = d1 * d4 - d3 * d2;
+                if (d3 >= 0 && d4 <= d3)
+                {
+                    u = 1; v = 0;
+                }
+                else if (d6 >= 0 && d5 <= d6)
+                {
+                    u = 0; v = 1;
+                }
+                else if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                {
+                    u = d1 / (d1 - d3); v = 0;
+                }
+                else if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                {
+                    u = 0; v = d2 / (d2 - d6);
+                }
+                else if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+                {
+                    v = (d4 - d3) / ((d4 - d3) + (d5 - d6)); u = 1 - v;
+                }
+                else
+                {
+                    var denom = 1 / (va + vb + vc);
+                    u = vb * denom; v = vc * denom;
+                }
+            }
+            double dx = apx - u * abx - v * acx, dy = apy - u * aby - v * acy, dz = apz - u * abz - v * acz;
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        /// <summary>
+        /// Number of triangles a ray from the point crosses (Moller and Trumbore)
+        /// </summary>
+        private static int RayCrossings(double[] t, XbimPoint3D p, double dx, double dy, double dz)
+        {
+            var crossings = 0;
+            for (var i = 0; i < t.Length; i += 9)
+            {
+                double e1x = t[i + 3] - t[i], e1y = t[i + 4] - t[i + 1], e1z = t[i + 5] - t[i + 2];
+                double e2x = t[i + 6] - t[i], e2y = t[i + 7] - t[i + 1], e2z = t[i + 8] - t[i + 2];
+                double px = dy * e2z - dz * e2y, py = dz * e2x - dx * e2z, pz = dx * e2y - dy * e2x;
+                var det = e1x * px + e1y * py + e1z * pz;
+                if (Math.Abs(det) < 1e-12)
+                    continue;
+                var inv = 1 / det;
+                double sx = p.X - t[i], sy = p.Y - t[i + 1], sz = p.Z - t[i + 2];
+                var u = (sx * px + sy * py + sz * pz) * inv;
+                if (u < 0 || u > 1)
+                    continue;
+                double qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+                var v = (dx * qx + dy * qy + dz * qz) * inv;
+                if (v < 0 || u + v > 1)
+                    continue;
+                if ((e2x * qx + e2y * qy + e2z * qz) * inv > 0)
+                    crossings++;
+            }
+            return crossings;
+        }
+    }
+}
@@ -0,0 +1,887 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.GeometryResource;
+using Xbim.Ifc4.Interfaces;
+using Xbim.Ifc4.MeasureResource;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Meshes an IfcSweptDiskSolid directly to the PolyhedronBinary format without building a solid.
+    /// Rings of points are generated along the directrix, corners are mitred at half angle and filleted if the solid is polygonal with a fillet radius.
+    /// Only use this for swept disks that are not Boolean operands, the result is a mesh and cannot be cut
+    /// </summary>
+    public class XbimSweptDiskSolidMesher
+    {
+        private readonly IModel _model;
+        private readonly double _precision;
+        private readonly double _deflection;
+        private readonly double _deflectionAngle;
+        //joins sharper than this are treated as a corner and mitred, anything less is smooth
+        private const double SmoothJoinAngle = 0.0349066; //2 degrees
+        //turns tighter than this cannot be mitred sensibly, these are left to the geometry engine
+        private const double MinMitreCosine = -0.95;
+
+        public XbimSweptDiskSolidMesher(IModel model, double deflection, double deflectionAngle)
+        {
+            _model = model;
+            _precision = model.ModelFactors.Precision;
+            _deflection = deflection;
+            _deflectionAngle = deflectionAngle > 0 ? deflectionAngle : 0.5;
+        }
+
+        /// <summary>
+        /// Returns true if the directrix and trimming parameters of the shape are supported
+        /// </summary>
+        public bool CanMesh(IIfcGeometricRepresentationItem shape)
+        {
+            if (!(shape is IIfcSweptDiskSolid sweptDisk) || (double)sweptDisk.Radius <= 0)
+                return false;
+            if (sweptDisk.InnerRadius.HasValue && (double)sweptDisk.InnerRadius.Value >= (double)sweptDisk.Radius)
+                return false;
+            //the engine trims polylines and indexed poly curves by length, other trims are left to the engine
+            if ((sweptDisk.StartParam.HasValue || sweptDisk.EndParam.HasValue) &&
+                !(sweptDisk.Directrix is IIfcPolyline) && !(sweptDisk.Directrix is IIfcIndexedPolyCurve))
+                return false;
+            return IsSupported(sweptDisk.Directrix);
+        }
+
+        /// <summary>
+        /// Meshes the shape if it is a supported swept disk, returns false if the shape should be built by the geometry engine
+        /// </summary>
+        public bool TryMesh(IIfcGeometricRepresentationItem shape, out XbimShapeGeometry shapeGeometry)
+        {
+            shapeGeometry = null;
+            if (!CanMesh(shape))
+                return false;
+            try
+            {
+                shapeGeometry = Mesh((IIfcSweptDiskSolid)shape);
+            }
+            catch (Exception)
+            {
+                //anything unexpected in the definition is left to the engine to report
+                shapeGeometry = null;
+            }
+            return shapeGeometry != null;
+        }
+
+        private static bool IsSupported(IIfcCurve curve)
+        {
+            switch (curve)
+            {
+                case IIfcPolyline _:
+                case IIfcIndexedPolyCurve _:
+                case IIfcBSplineCurveWithKnots _:
+                    return true;
+                case IIfcTrimmedCurve trimmed:
+                    return trimmed.BasisCurve is IIfcCircle || trimmed.BasisCurve is IIfcLine;
+                case IIfcCompositeCurve composite:
+                    return composite.Segments.Any() && composite.Segments.All(s => IsSupported(s.ParentCurve));
+                default:
+                    return false;
+            }
+        }
+
+        /// <summary>
+        /// Returns the mesh of the swept disk or null if the directrix cannot be meshed directly
+        /// </summary>
+        public XbimShapeGeometry Mesh(IIfcSweptDiskSolid sweptDisk)
+        {
+            var directrix = new List<XbimPoint3D>();
+            var smooth = new List<bool>();
+            if (!AddCurve(sweptDisk.Directrix, directrix, smooth))
+                return null;
+            if (sweptDisk.StartParam.HasValue || sweptDisk.EndParam.HasValue)
+            {
+                if (!TrimByLength(sweptDisk, directrix, smooth))
+                    return null;
+            }
+            RemoveDuplicatePoints(directrix, smooth);
+            if (directrix.Count < 2)
+                return null;
+            if (sweptDisk is IIfcSweptDiskSolidPolygonal polygonal && polygonal.FilletRadius.HasValue)
+                Fillet(directrix, smooth, polygonal.FilletRadius.Value);
+
+            double radius = sweptDisk.Radius;
+            double innerRadius = sweptDisk.InnerRadius.HasValue ? (double)sweptDisk.InnerRadius.Value : 0;
+            var segmentCount = RingSegmentCount(radius);
+
+            var outer = BuildRings(directrix, radius, segmentCount);
+            if (outer == null)
+                return null;
+            List<XbimPoint3D[]> inner = null;
+            if (innerRadius > _precision)
+            {
+                inner = BuildRings(directrix, innerRadius, segmentCount);
+                if (inner == null)
+                    return null;
+            }
+            var bounds = XbimRect3D.Empty;
+            foreach (var ring in outer)
+                foreach (var p in ring)
+                    bounds.Union(p);
+
+            var shapeGeometry = new XbimShapeGeometry
+            {
+                LOD = XbimLOD.LOD_Unspecified,
+                Format = XbimGeometryType.PolyhedronBinary,
+                BoundingBox = bounds
+            };
+            using (var memStream = new MemoryStream(0x4000))
+            {
+                using (var bw = new BinaryWriter(memStream))
+                {
+                    WriteTriangulation(bw, directrix, smooth, outer, inner);
+                }
+                ((IXbimShapeGeometryData)shapeGeometry).ShapeData = memStream.ToArray();
+            }
+            return shapeGeometry;
+        }
+
+        /// <summary>
+        /// Number of points in each ring, enough to keep the chord within the deflection and the angle between facets within the deflection angle
+        /// </summary>
+        private int RingSegmentCount(double radius)
+        {
+            var step = _deflectionAngle;
+            if (_deflection > 0 && _deflection < radius)
+                step = Math.Min(step, 2 * Math.Acos(1 - _deflection / radius));
+            return Math.Max(3, (int)Math.Ceiling(2 * Math.PI / step));
+        }
+
+        #region Directrix
+
+        /// <summary>
+        /// Appends the points of the curve to the directrix, smooth is false at points where the direction changes sharply
+        /// </summary>
+        private bool AddCurve(IIfcCurve curve, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var curvePoints = new List<XbimPoint3D>();
+            var curveSmooth = new List<bool>();
+            switch (curve)
+            {
+                case IIfcPolyline polyline:
+                    foreach (var p in polyline.Points)
+                    {
+                        curvePoints.Add(ToPoint(p));
+                        curveSmooth.Add(false);
+                    }
+                    break;
+                case IIfcIndexedPolyCurve polyCurve:
+                    if (!SampleIndexedPolyCurve(polyCurve, curvePoints, curveSmooth))
+                        return false;
+                    break;
+                case IIfcTrimmedCurve trimmed:
+                    if (!SampleTrimmedCurve(trimmed, curvePoints, curveSmooth))
+                        return false;
+                    break;
+                case IIfcCompositeCurve composite:
+                    foreach (var segment in composite.Segments)
+                    {
+                        var segmentPoints = new List<XbimPoint3D>();
+                        var segmentSmooth = new List<bool>();
+                        if (!AddCurve(segment.ParentCurve, segmentPoints, segmentSmooth))
+                            return false;
+                        if (!segment.SameSense)
+                        {
+                            segmentPoints.Reverse();
+                            segmentSmooth.Reverse();
+                        }
+                        if (!Join(curvePoints, curveSmooth, segmentPoints, segmentSmooth))
+                            return false;
+                    }
+                    break;
+                case IIfcBSplineCurveWithKnots bspline:
+                    if (!SampleBSpline(bspline, curvePoints, curveSmooth))
+                        return false;
+                    break;
+                default:
+                    return false;
+            }
+            return Join(points, smooth, curvePoints, curveSmooth);
+        }
+
+        /// <summary>
+        /// Appends the next part of the directrix, the parts must meet within 5mm
+        /// </summary>
+        private bool Join(List<XbimPoint3D> points, List<bool> smooth, List<XbimPoint3D> next, List<bool> nextSmooth)
+        {
+            if (next.Count == 0)
+                return true;
+            if (points.Count == 0)
+            {
+                points.AddRange(next);
+                smooth.AddRange(nextSmooth);
+                return true;
+            }
+            var gap = (next[0] - points[points.Count - 1]).Length;
+            if (gap > 5 * _model.ModelFactors.OneMilliMeter)
+                return false;
+            var start = gap <= _precision ? 1 : 0;
+            //a join is smooth if the two parts are tangent continuous
+            if (points.Count > 1 && next.Count > start + 1)
+            {
+                var before = points[points.Count - 1] - points[points.Count - 2];
+                var after = next[start + 1] - next[start];
+                smooth[smooth.Count - 1] = Angle(before, after) < SmoothJoinAngle;
+            }
+            for (int i = start; i < next.Count; i++)
+            {
+                points.Add(next[i]);
+                smooth.Add(nextSmooth[i]);
+            }
+            return true;
+        }
+
+        private bool SampleIndexedPolyCurve(IIfcIndexedPolyCurve polyCurve, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var coordinates = new List<XbimPoint3D>();
+            if (polyCurve.Points is IIfcCartesianPointList3D points3D)
+            {
+                foreach (var coord in points3D.CoordList)
+                {
+                    var c = coord.Select(v => (double)v).ToArray();
+                    coordinates.Add(new XbimPoint3D(c[0], c[1], c[2]));
+                }
+            }
+            else if (polyCurve.Points is IIfcCartesianPointList2D points2D)
+            {
+                foreach (var coord in points2D.CoordList)
+                {
+                    var c = coord.Select(v => (double)v).ToArray();
+                    coordinates.Add(new XbimPoint3D(c[0], c[1], 0));
+                }
+            }
+            else
+                return false;
+
+            if (!polyCurve.Segments.Any())
+            {
+                //"In the case that the list of Segments is not provided, all points in the IfcCartesianPointList are connected by straight line segments"
+                points.AddRange(coordinates);
+                smooth.AddRange(coordinates.Select(c => false));
+                return true;
+            }
+            foreach (var segment in polyCurve.Segments)
+            {
+                var segmentPoints = new List<XbimPoint3D>();
+                var segmentSmooth = new List<bool>();
+                if (segment is IfcArcIndex arcIndex)
+                {
+                    var indices = ((List<IfcPositiveInteger>)arcIndex.Value).Select(i => (int)(long)i - 1).ToList();
+                    if (indices.Count != 3 || indices.Any(i => i < 0 || i >= coordinates.Count))
+                        return false;
+                    if (!SampleArc(coordinates[indices[0]], coordinates[indices[1]], coordinates[indices[2]], segmentPoints, segmentSmooth))
+                    {
+                        //the three points are in a line, treat it as a polyline segment
+                        segmentPoints.Add(coordinates[indices[0]]);
+                        segmentPoints.Add(coordinates[indices[2]]);
+                        segmentSmooth.Add(false);
+                        segmentSmooth.Add(false);
+                    }
+                }
+                else if (segment is IfcLineIndex lineIndex)
+                {
+                    foreach (var i in ((List<IfcPositiveInteger>)lineIndex.Value).Select(i => (int)(long)i - 1))
+                    {
+                        if (i < 0 || i >= coordinates.Count)
+                            return false;
+                        segmentPoints.Add(coordinates[i]);
+                        segmentSmooth.Add(false);
+                    }
+                }
+                else
+                    return false;
+                if (!Join(points, smooth, segmentPoints, segmentSmooth))
+                    return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Samples the arc through the three points, returns false if the points are colinear
+        /// </summary>
+        private bool SampleArc(XbimPoint3D start, XbimPoint3D mid, XbimPoint3D end, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var a = start - mid;
+            var b = end - mid;
+            var axis = a.CrossProduct(b);
+            var axisLengthSq = axis.DotProduct(axis);
+            if (axisLengthSq < _precision * _precision * _precision * _precision)
+                return false;
+            //circumcentre of the three points
+            var centre = mid + (b * a.DotProduct(a) - a * b.DotProduct(b)).CrossProduct(axis) * (1 / (2 * axisLengthSq));
+            var xAxis = (start - centre).Normalized();
+            var zAxis = (mid - start).CrossProduct(end - mid).Normalized();
+            var yAxis = zAxis.CrossProduct(xAxis);
+            var radius = (start - centre).Length;
+            var endVector = end - centre;
+            var sweep = Math.Atan2(endVector.DotProduct(yAxis), endVector.DotProduct(xAxis));
+            if (sweep <= 0)
+                sweep += 2 * Math.PI;
+            SampleCircle(centre, xAxis, yAxis, radius, 0, sweep, points, smooth);
+            return true;
+        }
+
+        /// <summary>
+        /// Samples a circular arc from the start angle through the sweep angle, a negative sweep runs clockwise
+        /// </summary>
+        private void SampleCircle(XbimPoint3D centre, XbimVector3D xAxis, XbimVector3D yAxis, double radius, double startAngle, double sweep,
+            List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var step = _deflectionAngle;
+            if (_deflection > 0 && _deflection < radius)
+                step = Math.Min(step, 2 * Math.Acos(1 - _deflection / radius));
+            var count = Math.Max(1, (int)Math.Ceiling(Math.Abs(sweep) / step));
+            for (int i = 0; i <= count; i++)
+            {
+                var angle = startAngle + sweep * i / count;
+                points.Add(centre + xAxis * (radius * Math.Cos(angle)) + yAxis * (radius * Math.Sin(angle)));
+                smooth.Add(i > 0 && i < count);
+            }
+        }
+
+        /// <summary>
+        /// Samples a trimmed circle or line, the trims are interpreted in the same way as the geometry engine does
+        /// </summary>
+        private bool SampleTrimmedCurve(IIfcTrimmedCurve trimmed, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var preferCartesian = trimmed.MasterRepresentation == IfcTrimmingPreference.CARTESIAN;
+            XbimPoint3D? p1 = null, p2 = null;
+            double? u1 = null, u2 = null;
+            ReadTrim(trimmed.Trim1, ref p1, ref u1);
+            ReadTrim(trimmed.Trim2, ref p2, ref u2);
+
+            if (trimmed.BasisCurve is IIfcLine line)
+            {
+                var origin = ToPoint(line.Pnt);
+                var direction = ToVector(line.Dir.Orientation).Normalized();
+                double magnitude = line.Dir.Magnitude;
+                var start = (preferCartesian || !u1.HasValue) && p1.HasValue ? p1.Value : u1.HasValue ? origin + direction * (u1.Value * magnitude) : (XbimPoint3D?)null;
+                var end = (preferCartesian || !u2.HasValue) && p2.HasValue ? p2.Value : u2.HasValue ? origin + direction * (u2.Value * magnitude) : (XbimPoint3D?)null;
+                if (!start.HasValue || !end.HasValue || (end.Value - start.Value).Length < _precision)
+                    return false;
+                points.Add(start.Value);
+                points.Add(end.Value);
+                smooth.Add(false);
+                smooth.Add(false);
+                return true;
+            }
+            if (trimmed.BasisCurve is IIfcCircle circle)
+            {
+                double radius = circle.Radius;
+                if (!ReadPlacement(circle.Position, out var centre, out var xAxis, out var yAxis))
+                    return false;
+                var angleFactor = _model.ModelFactors.AngleToRadiansConversionFactor;
+                double AngleOf(XbimPoint3D p)
+                {
+                    var v = p - centre;
+                    var a = Math.Atan2(v.DotProduct(yAxis), v.DotProduct(xAxis));
+                    return a < 0 ? a + 2 * Math.PI : a;
+                }
+                double? start = (preferCartesian || !u1.HasValue) && p1.HasValue ? AngleOf(p1.Value) : u1 * angleFactor;
+                double? end = (preferCartesian || !u2.HasValue) && p2.HasValue ? AngleOf(p2.Value) : u2 * angleFactor;
+                if (!start.HasValue || !end.HasValue || Math.Abs(start.Value - end.Value) < 1e-7)
+                    return false;
+                //the end parameter is zero, make it 360 to ensure correct direction
+                if (Math.Abs(end.Value) < 1e-7)
+                    end = 2 * Math.PI;
+                //go anticlockwise from trim 1 to trim 2 if the senses agree, otherwise clockwise
+                var sweep = end.Value - start.Value;
+                if (trimmed.SenseAgreement)
+                {
+                    while (sweep <= 0) sweep += 2 * Math.PI;
+                }
+                else
+                {
+                    while (sweep >= 0) sweep -= 2 * Math.PI;
+                }
+                SampleCircle(centre, xAxis, yAxis, radius, start.Value, sweep, points, smooth);
+                return true;
+            }
+            return false;
+        }
+
+        private static void ReadTrim(IEnumerable<IIfcTrimmingSelect> trims, ref XbimPoint3D? point, ref double? parameter)
+        {
+            foreach (var trim in trims)
+            {
+                if (trim is IIfcCartesianPoint cp)
+                    point = ToPoint(cp);
+                else if (trim is IfcParameterValue value)
+                    parameter = (double)value;
+            }
+        }
+
+        private static bool ReadPlacement(IIfcAxis2Placement placement, out XbimPoint3D origin, out XbimVector3D xAxis, out XbimVector3D yAxis)
+        {
+            var zAxis = new XbimVector3D(0, 0, 1);
+            xAxis = new XbimVector3D(1, 0, 0);
+            if (placement is IIfcAxis2Placement3D placement3D)
+            {
+                origin = ToPoint(placement3D.Location);
+                if (placement3D.Axis != null)
+                    zAxis = ToVector(placement3D.Axis).Normalized();
+                if (placement3D.RefDirection != null)
+                    xAxis = ToVector(placement3D.RefDirection);
+            }
+            else if (placement is IIfcAxis2Placement2D placement2D)
+            {
+                origin = ToPoint(placement2D.Location);
+                if (placement2D.RefDirection != null)
+                    xAxis = ToVector(placement2D.RefDirection);
+            }
+            else
+            {
+                origin = new XbimPoint3D(0, 0, 0);
+                yAxis = new XbimVector3D(0, 1, 0);
+                return false;
+            }
+            //make the x axis perpendicular to the z axis
+            xAxis = (xAxis - zAxis * xAxis.DotProduct(zAxis));
+            if (xAxis.Length < 1e-9)
+            {
+                yAxis = new XbimVector3D(0, 1, 0);
+                return false;
+            }
+            xAxis = xAxis.Normalized();
+            yAxis = zAxis.CrossProduct(xAxis);
+            return true;
+        }
+
+        /// <summary>
+        /// Samples the b-spline by evaluating each knot span at a number of points set by the degree
+        /// </summary>
+        private bool SampleBSpline(IIfcBSplineCurveWithKnots bspline, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var degree = (int)(long)bspline.Degree;
+            var poles = bspline.ControlPointsList.Select(ToPoint).ToArray();
+            var weights = bspline is IIfcRationalBSplineCurveWithKnots rational
+                ? rational.WeightsData.Select(w => (double)w).ToArray()
+                : poles.Select(p => 1.0).ToArray();
+            var knots = new List<double>();
+            var distinctKnots = bspline.Knots.Select(k => (double)k).ToArray();
+            var multiplicities = bspline.KnotMultiplicities.Select(m => (int)(long)m).ToArray();
+            if (degree < 1 || weights.Length != poles.Length || distinctKnots.Length != multiplicities.Length)
+                return false;
+            for (int i = 0; i < distinctKnots.Length; i++)
+                for (int j = 0; j < multiplicities[i]; j++)
+                    knots.Add(distinctKnots[i]);
+            if (knots.Count != poles.Length + degree + 1)
+                return false;
+
+            var samplesPerSpan = Math.Max(4, degree * 4);
+            for (int span = degree; span < poles.Length; span++)
+            {
+                var u0 = knots[span];
+                var u1 = knots[span + 1];
+                if (u1 - u0 <= 0)
+                    continue;
+                for (int i = points.Count == 0 ? 0 : 1; i <= samplesPerSpan; i++)
+                {
+                    points.Add(DeBoor(span, u0 + (u1 - u0) * i / samplesPerSpan, degree, knots, poles, weights));
+                    smooth.Add(true);
+                }
+            }
+            if (points.Count < 2)
+                return false;
+            smooth[0] = false;
+            smooth[smooth.Count - 1] = false;
+            return true;
+        }
+
+        private static XbimPoint3D DeBoor(int span, double u, int degree, List<double> knots, XbimPoint3D[] poles, double[] weights)
+        {
+            //homogeneous control points of the span
+            var d = new double[degree + 1, 4];
+            for (int j = 0; j <= degree; j++)
+            {
+                var pole = poles[span - degree + j];
+                var w = weights[span - degree + j];
+                d[j, 0] = pole.X * w;
+                d[j, 1] = pole.Y * w;
+                d[j, 2] = pole.Z * w;
+                d[j, 3] = w;
+            }
+            for (int r = 1; r <= degree; r++)
+            {
+                for (int j = degree; j >= r; j--)
+                {
+                    var left = knots[span - degree + j];
+                    var right = knots[span + 1 + j - r];
+                    var alpha = right - left > 0 ? (u - left) / (right - left) : 0;
+                    for (int k = 0; k < 4; k++)
+                        d[j, k] = (1 - alpha) * d[j - 1, k] + alpha * d[j, k];
+                }
+            }
+            return new XbimPoint3D(d[degree, 0] / d[degree, 3], d[degree, 1] / d[degree, 3], d[degree, 2] / d[degree, 3]);
+        }
+
+        /// <summary>
+        /// Trims the directrix by length, this is how the geometry engine interprets the parameters of polylines and indexed poly curves
+        /// </summary>
+        private bool TrimByLength(IIfcSweptDiskSolid sweptDisk, List<XbimPoint3D> points, List<bool> smooth)
+        {
+            var total = 0.0;
+            for (int i = 1; i < points.Count; i++)
+                total += (points[i] - points[i - 1]).Length;
+            double start = sweptDisk.StartParam.HasValue ? (double)sweptDisk.StartParam.Value : 0;
+            double end = sweptDisk.EndParam.HasValue ? (double)sweptDisk.EndParam.Value : total;
+            if (sweptDisk.Directrix is IIfcPolyline && start == 0 && end == 1 &&
+                _model.ModelFactors.ApplyWorkAround("#PolylineTrimLengthOneForEntireLine"))
+                end = total; //consider work around for incorrectly set trims
+            start = Math.Max(0, start);
+            end = Math.Min(total, end);
+            if (end - start < _precision)
+                return false;
+            if (start <= _precision && total - end <= _precision)
+                return true;
+
+            var trimmed = new List<XbimPoint3D>();
+            var trimmedSmooth = new List<bool>();
+            var length = 0.0;
+            for (int i = 1; i < points.Count; i++)
+            {
+                var segment = points[i] - points[i - 1];
+                var segmentLength = segment.Length;
+                var next = length + segmentLength;
+                if (next > start && length < end && segmentLength > 0)
+                {
+                    if (trimmed.Count == 0)
+                    {
+                        trimmed.Add(points[i - 1] + segment * ((start - length) / segmentLength));
+                        trimmedSmooth.Add(false);
+                    }
+                    if (next >= end)
+                    {
+                        trimmed.Add(points[i - 1] + segment * ((end - length) / segmentLength));
+                        trimmedSmooth.Add(false);
+                        break;
+                    }
+                    trimmed.Add(points[i]);
+                    trimmedSmooth.Add(smooth[i]);
+                }
+                length = next;
+            }
+            points.Clear();
+            points.AddRange(trimmed);
+            smooth.Clear();
+            smooth.AddRange(trimmedSmooth);
+            return points.Count > 1;
+        }
+
+        private void RemoveDuplicatePoints(List<XbimPoint3D> points, List<bool> smooth)
+        {
+            for (int i = points.Count - 1; i > 0; i--)
+            {
+                if ((points[i] - points[i - 1]).Length <= _precision)
+                {
+                    //keep the end point
+                    var keep = i == points.Count - 1 ? i : i - 1;
+                    smooth[keep] = smooth[i] && smooth[i - 1];
+                    var remove = keep == i ? i - 1 : i;
+                    points.RemoveAt(remove);
+                    smooth.RemoveAt(remove);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Replaces every corner with an arc of the fillet radius, if any corner is too tight for the radius the directrix is left with mitred corners
+        /// </summary>
+        private void Fillet(List<XbimPoint3D> points, List<bool> smooth, double filletRadius)
+        {
+            if (filletRadius <= _precision || points.Count < 3)
+                return;
+            var trims = new double[points.Count];
+            for (int i = 1; i < points.Count - 1; i++)
+            {
+                if (smooth[i])
+                    continue;
+                var turn = Angle(points[i] - points[i - 1], points[i + 1] - points[i]);
+                if (turn < SmoothJoinAngle)
+                    continue;
+                if (turn > Math.PI - SmoothJoinAngle)
+                    return;
+                trims[i] = filletRadius * Math.Tan(turn / 2);
+            }
+            //each segment must be long enough for the fillets at both of its ends
+            for (int i = 1; i < points.Count; i++)
+            {
+                if (trims[i - 1] + trims[i] > (points[i] - points[i - 1]).Length + _precision)
+                    return;
+            }
+            var filleted = new List<XbimPoint3D> { points[0] };
+            var filletedSmooth = new List<bool> { smooth[0] };
+            for (int i = 1; i < points.Count - 1; i++)
+            {
+                if (trims[i] <= 0)
+                {
+                    filleted.Add(points[i]);
+                    filletedSmooth.Add(smooth[i]);
+                    continue;
+                }
+                var dirIn = (points[i] - points[i - 1]).Normalized();
+                var dirOut = (points[i + 1] - points[i]).Normalized();
+                var arcStart = points[i] + dirIn * -trims[i];
+                var arcEnd = points[i] + dirOut * trims[i];
+                var turn = Angle(dirIn, dirOut);
+                var inward = (dirOut - dirIn).Normalized();
+                var centre = points[i] + inward * (filletRadius / Math.Cos(turn / 2));
+                var xAxis = (arcStart - centre).Normalized();
+                var yAxis = dirIn;
+                var arcPoints = new List<XbimPoint3D>();
+                var arcSmooth = new List<bool>();
+                SampleCircle(centre, xAxis, yAxis, filletRadius, 0, turn, arcPoints, arcSmooth);
+                arcPoints[arcPoints.Count - 1] = arcEnd;
+                //the arc is tangent to the segments at both ends
+                for (int j = 0; j < arcPoints.Count; j++)
+                {
+                    if ((arcPoints[j] - filleted[filleted.Count - 1]).Length <= _precision)
+                        continue;
+                    filleted.Add(arcPoints[j]);
+                    filletedSmooth.Add(true);
+                }
+            }
+            filleted.Add(points[points.Count - 1]);
+            filletedSmooth.Add(smooth[points.Count - 1]);
+            points.Clear();
+            points.AddRange(filleted);
+            smooth.Clear();
+            smooth.AddRange(filletedSmooth);
+        }
+
+        #endregion
+
+        #region Rings
+
+        /// <summary>
+        /// Builds a ring of points at each point of the directrix. The first ring is a circle perpendicular to the directrix,
+        /// each following ring is the previous ring moved along the segment and projected on to the mitre plane at the next point.
+        /// This keeps every segment an exact cylinder of the radius and the rings do not twist.
+        /// Returns null if a turn is too tight to mitre
+        /// </summary>
+        private List<XbimPoint3D[]> BuildRings(List<XbimPoint3D> directrix, double radius, int segmentCount)
+        {
+            var rings = new List<XbimPoint3D[]>(directrix.Count);
+            var tangent = (directrix[1] - directrix[0]).Normalized();
+            //any vector not parallel to the tangent will do to start the frame
+            var reference = Math.Abs(tangent.Z) < 0.9 ? new XbimVector3D(0, 0, 1) : new XbimVector3D(1, 0, 0);
+            var xAxis = reference.CrossProduct(tangent).Normalized();
+            var yAxis = tangent.CrossProduct(xAxis);
+            var first = new XbimPoint3D[segmentCount];
+            for (int k = 0; k < segmentCount; k++)
+            {
+                var angle = 2 * Math.PI * k / segmentCount;
+                first[k] = directrix[0] + xAxis * (radius * Math.Cos(angle)) + yAxis * (radius * Math.Sin(angle));
+            }
+            rings.Add(first);
+            for (int j = 1; j < directrix.Count; j++)
+            {
+                var dirIn = (directrix[j] - directrix[j - 1]).Normalized();
+                XbimVector3D planeNormal;
+                if (j == directrix.Count - 1)
+                    planeNormal = dirIn;
+                else
+                {
+                    var dirOut = (directrix[j + 1] - directrix[j]).Normalized();
+                    if (dirIn.DotProduct(dirOut) < MinMitreCosine)
+                        return null;
+                    planeNormal = (dirIn + dirOut).Normalized();
+                }
+                var previous = rings[j - 1];
+                var ring = new XbimPoint3D[segmentCount];
+                var along = dirIn.DotProduct(planeNormal);
+                for (int k = 0; k < segmentCount; k++)
+                {
+                    var s = (directrix[j] - previous[k]).DotProduct(planeNormal) / along;
+                    ring[k] = previous[k] + dirIn * s;
+                }
+                rings.Add(ring);
+            }
+            return rings;
+        }
+
+        /// <summary>
+        /// The normal of the tube of the segment at a point on a ring, perpendicular to the segment direction
+        /// </summary>
+        private static XbimVector3D SegmentNormal(XbimPoint3D ringPoint, XbimPoint3D centre, XbimVector3D segmentDirection)
+        {
+            var radial = ringPoint - centre;
+            return (radial - segmentDirection * radial.DotProduct(segmentDirection)).Normalized();
+        }
+
+        #endregion
+
+        #region Output
+
+        private void WriteTriangulation(BinaryWriter bw, List<XbimPoint3D> directrix, List<bool> smooth, List<XbimPoint3D[]> outer, List<XbimPoint3D[]> inner)
+        {
+            var ringCount = outer.Count;
+            var segmentCount = outer[0].Length;
+            var tubeCount = inner == null ? 1 : 2;
+            var sideTriangles = (ringCount - 1) * segmentCount * 2;
+            var capTriangles = inner == null ? segmentCount - 2 : segmentCount * 2;
+            var numVertices = ringCount * segmentCount * tubeCount;
+            var triangleCount = sideTriangles * tubeCount + capTriangles * 2;
+
+            // Write out header
+            bw.Write((byte)1); //stream format version
+            bw.Write((uint)numVertices);
+            bw.Write((uint)triangleCount);
+            foreach (var tube in inner == null ? new[] { outer } : new[] { outer, inner })
+            {
+                foreach (var ring in tube)
+                {
+                    foreach (var p in ring)
+                    {
+                        bw.Write((float)p.X);
+                        bw.Write((float)p.Y);
+                        bw.Write((float)p.Z);
+                    }
+                }
+            }
+
+            //the sides of the tubes have a normal for every index, the caps are planar
+            bw.Write(tubeCount + 2);
+            WriteSide(bw, directrix, smooth, outer, 0, false, numVertices);
+            if (inner != null)
+                WriteSide(bw, directrix, smooth, inner, ringCount * segmentCount, true, numVertices);
+            var startNormal = (directrix[0] - directrix[1]).Normalized();
+            var endNormal = (directrix[directrix.Count - 1] - directrix[directrix.Count - 2]).Normalized();
+            WriteCap(bw, 0, inner == null ? -1 : ringCount * segmentCount, segmentCount, startNormal, true, numVertices);
+            WriteCap(bw, (ringCount - 1) * segmentCount, inner == null ? -1 : (2 * ringCount - 1) * segmentCount, segmentCount, endNormal, false, numVertices);
+            bw.Flush();
+        }
+
+        private static void WriteSide(BinaryWriter bw, List<XbimPoint3D> directrix, List<bool> smooth, List<XbimPoint3D[]> rings, int offset, bool reversed, int numVertices)
+        {
+            var segmentCount = rings[0].Length;
+            bw.Write(-(rings.Count - 1) * segmentCount * 2); //use negative count to indicate that every index has a normal
+            for (int j = 0; j < rings.Count - 1; j++)
+            {
+                var direction = (directrix[j + 1] - directrix[j]).Normalized();
+                var previousDirection = j > 0 ? (directrix[j] - directrix[j - 1]).Normalized() : direction;
+                var nextDirection = j + 2 < directrix.Count ? (directrix[j + 2] - directrix[j + 1]).Normalized() : direction;
+                for (int k = 0; k < segmentCount; k++)
+                {
+                    var k1 = (k + 1) % segmentCount;
+                    var a = offset + j * segmentCount + k;
+                    var b = offset + j * segmentCount + k1;
+                    var c = offset + (j + 1) * segmentCount + k1;
+                    var d = offset + (j + 1) * segmentCount + k;
+                    var na = Normal(rings[j][k], directrix[j], direction, previousDirection, smooth[j], reversed);
+                    var nb = Normal(rings[j][k1], directrix[j], direction, previousDirection, smooth[j], reversed);
+                    var nc = Normal(rings[j + 1][k1], directrix[j + 1], direction, nextDirection, smooth[j + 1], reversed);
+                    var nd = Normal(rings[j + 1][k], directrix[j + 1], direction, nextDirection, smooth[j + 1], reversed);
+                    if (reversed)
+                    {
+                        WriteCorner(bw, a, na, numVertices);
+                        WriteCorner(bw, d, nd, numVertices);
+                        WriteCorner(bw, b, nb, numVertices);
+                        WriteCorner(bw, b, nb, numVertices);
+                        WriteCorner(bw, d, nd, numVertices);
+                        WriteCorner(bw, c, nc, numVertices);
+                    }
+                    else
+                    {
+                        WriteCorner(bw, a, na, numVertices);
+                        WriteCorner(bw, b, nb, numVertices);
+                        WriteCorner(bw, d, nd, numVertices);
+                        WriteCorner(bw, b, nb, numVertices);
+                        WriteCorner(bw, c, nc, numVertices);
+                        WriteCorner(bw, d, nd, numVertices);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Normal at a ring point for the segment, at smooth points it is blended with the normal of the neighbouring segment
+        /// </summary>
+        private static XbimPackedNormal Normal(XbimPoint3D ringPoint, XbimPoint3D centre, XbimVector3D direction, XbimVector3D neighbourDirection, bool isSmooth, bool reversed)
+        {
+            var normal = SegmentNormal(ringPoint, centre, direction);
+            if (isSmooth)
+                normal = (normal + SegmentNormal(ringPoint, centre, neighbourDirection)).Normalized();
+            if (reversed)
+                normal = normal * -1;
+            return new XbimPackedNormal(normal.X, normal.Y, normal.Z);
+        }
+
+        /// <summary>
+        /// Writes a planar end cap, a fan over the ring if there is no inner ring, otherwise an annulus between the rings
+        /// </summary>
+        private static void WriteCap(BinaryWriter bw, int outerOffset, int innerOffset, int segmentCount, XbimVector3D normal, bool isStart, int numVertices)
+        {
+            var triangles = new List<int>();
+            if (innerOffset < 0)
+            {
+                for (int k = 1; k < segmentCount - 1; k++)
+                {
+                    triangles.Add(outerOffset);
+                    triangles.Add(outerOffset + (isStart ? k + 1 : k));
+                    triangles.Add(outerOffset + (isStart ? k : k + 1));
+                }
+            }
+            else
+            {
+                for (int k = 0; k < segmentCount; k++)
+                {
+                    var k1 = (k + 1) % segmentCount;
+                    var o0 = outerOffset + k;
+                    var o1 = outerOffset + k1;
+                    var i0 = innerOffset + k;
+                    var i1 = innerOffset + k1;
+                    if (isStart)
+                        triangles.AddRange(new[] { o0, i0, o1, o1, i0, i1 });
+                    else
+                        triangles.AddRange(new[] { o0, o1, i0, o1, i1, i0 });
+                }
+            }
+            bw.Write(triangles.Count / 3);
+            new XbimPackedNormal(normal.X, normal.Y, normal.Z).Write(bw); //write the normal for the face
+            foreach (var index in triangles)
+                WriteIndex(bw, index, numVertices);
+        }
+
+        private static void WriteCorner(BinaryWriter bw, int index, XbimPackedNormal normal, int numVertices)
+        {
+            WriteIndex(bw, index, numVertices);
+            normal.Write(bw);
+        }
+
+        private static void WriteIndex(BinaryWriter bw, int index, int maxInt)
+        {
+            if (maxInt <= 0xFF)
+                bw.Write((byte)index);
+            else if (maxInt <= 0xFFFF)
+                bw.Write((ushort)index);
+            else
+                bw.Write(index);
+        }
+
+        #endregion
+
+        private static double Angle(XbimVector3D a, XbimVector3D b)
+        {
+            var cos = a.Normalized().DotProduct(b.Normalized());
+            return Math.Acos(Math.Max(-1, Math.Min(1, cos)));
+        }
+
+        private static XbimPoint3D ToPoint(IIfcCartesianPoint p)
+        {
+            return new XbimPoint3D(p.X, p.Y, double.IsNaN(p.Z) ? 0 : p.Z);
+        }
+
+        private static XbimVector3D ToVector(IIfcDirection d)
+        {
+            return new XbimVector3D(d.X, d.Y, double.IsNaN(d.Z) ? 0 : d.Z);
+        }
+    }
+}
@@ -79,6 +79,8 @@ Example for a 1x1x1 box:
 		[...more triangles follow...]
 */
 
+using System;
+using System.Collections.Generic;
 using System.Linq;
 using System.IO;
 using Xbim.Common.Geometry;
@@ -121,11 +123,21 @@ namespace Xbim.ModelGeometry.Scene
 		}
 
 		MemoryStream _dataStream;
+		// streams appended by MergeStream that have not been merged in to _dataStream yet
+		List<XbimTriangulatedModelStream> _pending;
 
 		public MemoryStream DataStream
 		{
-			get { return _dataStream; }
-			set { _dataStream = value; }
+			get
+			{
+				MergePending();
+				return _dataStream;
+			}
+			set
+			{
+				_pending = null;
+				_dataStream = value;
+			}
 		}
 
 		public XbimTriangulatedModelStream(byte []  data)
@@ -140,6 +152,7 @@ namespace Xbim.ModelGeometry.Scene
 		//
 		public void Write(BinaryWriter bw)
 		{
+			MergePending();
 			if (_dataStream != null)
 			{
 				// Debug.WriteLine(string.Format("Writing stream at: {0} len {1}.", bw.BaseStream.Position, _dataStream.Length));
@@ -152,7 +165,8 @@ namespace Xbim.ModelGeometry.Scene
 		}
 
 		// this function seems only to be called in meshing XbimGeometryModelCollection
-		// 
+		// the merge is deferred until the data is next read, so appending any number of streams copies each of them once
+		// the data of the other stream is read at that point and should not be changed until then
 		public void MergeStream(XbimTriangulatedModelStream other)
 		{
 			if (other.IsEmpty)
@@ -163,99 +177,256 @@ namespace Xbim.ModelGeometry.Scene
 				_dataStream = other.DataStream;
 				return;
 			}
+			if (_pending == null)
+				_pending = new List<XbimTriangulatedModelStream>();
+			_pending.Add(new XbimTriangulatedModelStream(true) { _dataStream = other.DataStream });
+		}
 
-			BinaryReader[] r = new BinaryReader[] {
-				new BinaryReader(this.DataStream), 
-				new BinaryReader(other.DataStream)
-			};
+		/// <summary>
+		/// Merges the streams appended by MergeStream in to this one in a single pass
+		/// </summary>
+		private void MergePending()
+		{
+			if (_pending == null)
+				return;
+			var streams = new List<XbimTriangulatedModelStream>(_pending.Count + 1) { new XbimTriangulatedModelStream(true) { _dataStream = _dataStream } };
+			streams.AddRange(_pending);
+			_pending = null;
+			var merged = Merge(streams);
+			_dataStream.Dispose();
+			_dataStream = merged._dataStream;
+		}
+
+		/// <summary>
+		/// Merges any number of streams in to a new stream, the output is allocated once at its final size
+		/// </summary>
+		/// <param name="streams">the streams to merge, empty or null streams are skipped</param>
+		/// <param name="transforms">optional transform for each stream, null or an identity matrix leaves the stream unchanged</param>
+		public static XbimTriangulatedModelStream Merge(IList<XbimTriangulatedModelStream> streams, IList<XbimMatrix3D?> transforms = null)
+		{
+			var counts = ReadCounts(streams);
+			var buffer = new byte[MergedLength(counts)];
+			Merge(counts, transforms, buffer, 0);
+			return new XbimTriangulatedModelStream(true) { DataStream = new MemoryStream(buffer, 0, buffer.Length, true, true) };
+		}
 
-			MemoryStream result = new MemoryStream(0x4000);
-			BinaryWriter w = new BinaryWriter(result);
+		/// <summary>
+		/// The number of bytes Merge writes for the streams
+		/// </summary>
+		public static int MergedLength(IList<XbimTriangulatedModelStream> streams)
+		{
+			return MergedLength(ReadCounts(streams));
+		}
 
-			r[0].BaseStream.Seek(0, SeekOrigin.Begin);
-			r[1].BaseStream.Seek(0, SeekOrigin.Begin);
+		/// <summary>
+		/// Merges any number of streams directly in to the buffer, indices are remapped in a single pass over each stream
+		/// </summary>
+		/// <param name="streams">the streams to merge, empty or null streams are skipped</param>
+		/// <param name="transforms">optional transform for each stream, null or an identity matrix leaves the stream unchanged</param>
+		/// <param name="buffer">the buffer to write to, it must have at least MergedLength bytes after offset</param>
+		/// <param name="offset">where to start writing in the buffer</param>
+		/// <returns>the number of bytes written</returns>
+		public static int Merge(IList<XbimTriangulatedModelStream> streams, IList<XbimMatrix3D?> transforms, byte[] buffer, int offset)
+		{
+			return Merge(ReadCounts(streams), transforms, buffer, offset);
+		}
 
-			int[] CountUniquePositions = new int[2] { r[0].ReadInt32(), r[1].ReadInt32() };
-			int[] CountUniqueNormals = new int[2] { r[0].ReadInt32(), r[1].ReadInt32() };
-			int[] CountUniquePositionNormals = new int[2] { r[0].ReadInt32(), r[1].ReadInt32() };
-			int[] CountAllTriangles = new int[2] { r[0].ReadInt32(), r[1].ReadInt32() };
-			int[] CountPolygons = new int[2] { r[0].ReadInt32(), r[1].ReadInt32() };
+		private static int Merge(List<StreamCounts> counts, IList<XbimMatrix3D?> transforms, byte[] buffer, int offset)
+		{
+			if (transforms != null && transforms.Count != counts.Count)
+				throw new ArgumentException("There must be one transform for each stream", nameof(transforms));
+			var length = MergedLength(counts);
+			if (buffer.Length - offset < length)
+				throw new ArgumentException("The buffer is too small for the merged streams", nameof(buffer));
+			if (length == 0)
+				return 0;
+
+			var parts = new List<StreamCounts>();
+			var partTransforms = new List<XbimMatrix3D?>();
+			for (int i = 0; i < counts.Count; i++)
+			{
+				if (counts[i] == null)
+					continue;
+				parts.Add(counts[i]);
+				var transform = transforms?[i];
+				partTransforms.Add(transform.HasValue && !transform.Value.IsIdentity ? transform : null);
+			}
+			uint sumPositions = 0, sumNormals = 0, sumUniques = 0, sumTriangles = 0, sumPolygons = 0;
+			foreach (var part in parts)
+			{
+				sumPositions += part.Positions;
+				sumNormals += part.Normals;
+				sumUniques += part.Uniques;
+				sumTriangles += part.Triangles;
+				sumPolygons += part.Polygons;
+			}
 
-			w.Write((uint)CountUniquePositions.Sum());
-			w.Write((uint)CountUniqueNormals.Sum());
-			w.Write((uint)CountUniquePositionNormals.Sum());
-			w.Write((uint)CountAllTriangles.Sum());
-			w.Write((uint)CountPolygons.Sum());
+			var w = new BinaryWriter(new MemoryStream(buffer, offset, length, true));
+			w.Write(sumPositions);
+			w.Write(sumNormals);
+			w.Write(sumUniques);
+			w.Write(sumTriangles);
+			w.Write(sumPolygons);
 
+			// each reader moves through the sections of its stream in the same order as they are written
+			var r = parts.Select(part => new BinaryReader(new MemoryStream(part.Data.Array, part.Data.Offset + HeaderSize, part.Data.Count - HeaderSize, false))).ToArray();
 
 			// copies point coordinates
-			for (int i = 0; i < 2; i++)
+			for (int i = 0; i < parts.Count; i++)
 			{
-				w.Write(r[i].ReadBytes(sizeof(float) * 3 * CountUniquePositions[i]));
+				if (partTransforms[i] == null)
+				{
+					w.Write(r[i].ReadBytes(sizeof(float) * 3 * (int)parts[i].Positions));
+					continue;
+				}
+				var transform = partTransforms[i].Value;
+				for (uint p = 0; p < parts[i].Positions; p++)
+				{
+					var pt = transform.Transform(new XbimPoint3D(r[i].ReadSingle(), r[i].ReadSingle(), r[i].ReadSingle()));
+					w.Write((float)pt.X);
+					w.Write((float)pt.Y);
+					w.Write((float)pt.Z);
+				}
 			}
 			// copies normal vectors
-			for (int i = 0; i < 2; i++)
+			for (int i = 0; i < parts.Count; i++)
 			{
-				w.Write(r[i].ReadBytes(sizeof(float) * 3 * CountUniqueNormals[i]));
+				if (partTransforms[i] == null)
+				{
+					w.Write(r[i].ReadBytes(sizeof(float) * 3 * (int)parts[i].Normals));
+					continue;
+				}
+				var transform = partTransforms[i].Value;
+				for (uint n = 0; n < parts[i].Normals; n++)
+				{
+					var v = transform.Transform(new XbimVector3D(r[i].ReadSingle(), r[i].ReadSingle(), r[i].ReadSingle())).Normalized();
+					w.Write((float)v.X);
+					w.Write((float)v.Y);
+					w.Write((float)v.Z);
+				}
 			}
 
-			// indices to points need to be copied in consideration of remapping 
-			uint offset = 0;
-			uint sumout = (uint)CountUniquePositions.Sum();
-			for (int i = 0; i < 2; i++)
+			// indices to points and then to normals are offset by the counts of the streams before them
+			uint offsetIndex = 0;
+			for (int i = 0; i < parts.Count; i++)
 			{
-				IndexConverter c1 = new IndexConverter((uint)CountUniquePositions[i], r[i], sumout , w);
-				c1.Offset = offset;
-				for (int iIndex = 0; iIndex < CountUniquePositionNormals[i]; iIndex++) // loop each position-normal
-				{
+				IndexConverter c1 = new IndexConverter(parts[i].Positions, r[i], sumPositions, w);
+				c1.Offset = offsetIndex;
+				for (uint iIndex = 0; iIndex < parts[i].Uniques; iIndex++)
 					c1.ConvertIndex();
-				}
-				offset += (uint)CountUniquePositions[i];
+				offsetIndex += parts[i].Positions;
 			}
-
-			// indices to normals need to be copied in consideration of remapping 
-			offset = 0;
-			sumout = (uint)CountUniqueNormals.Sum();
-			for (int i = 0; i < 2; i++)
+			offsetIndex = 0;
+			for (int i = 0; i < parts.Count; i++)
 			{
-				IndexConverter c1 = new IndexConverter((uint)CountUniqueNormals[i], r[i], sumout, w);
-				c1.Offset = offset;
-				for (int iIndex = 0; iIndex < CountUniquePositionNormals[i]; iIndex++) // loop each position-normal
-				{
+				IndexConverter c1 = new IndexConverter(parts[i].Normals, r[i], sumNormals, w);
+				c1.Offset = offsetIndex;
+				for (uint iIndex = 0; iIndex < parts[i].Uniques; iIndex++)
 					c1.ConvertIndex();
-				}
-				offset += (uint)CountUniqueNormals[i];
+				offsetIndex += parts[i].Normals;
 			}
 
 			// now loop polygons
-			offset = 0;
-			sumout = (uint)CountUniquePositionNormals.Sum();
-			for (int i = 0; i < 2; i++)
+			offsetIndex = 0;
+			for (int i = 0; i < parts.Count; i++)
 			{
-				for (int iPoly = 0; iPoly < CountPolygons[i]; iPoly++)
+				IndexConverter c1 = new IndexConverter(parts[i].Uniques, r[i], sumUniques, w);
+				c1.Offset = offsetIndex;
+				for (uint iPoly = 0; iPoly < parts[i].Polygons; iPoly++)
 				{
-					// copy polygon type straight accross
+					// copy polygon type and point count straight accross
 					w.Write(r[i].ReadByte());
-					// copy point count straight accross but keeping value
 					int iCountPoints = r[i].ReadInt32();
 					w.Write(iCountPoints);
-
-					IndexConverter c1 = new IndexConverter((uint)CountUniquePositionNormals[i], r[i], sumout, w);
-					c1.Offset = offset;
 					for (int iPolyPoint = 0; iPolyPoint < iCountPoints; iPolyPoint++)
-					{
 						c1.ConvertIndex();
-					}
 				}
-				offset += (uint)CountUniquePositionNormals[i];
+				offsetIndex += parts[i].Uniques;
 			}
 			w.Flush();
-			// w.Close();
-			_dataStream.Dispose();           
-			_dataStream = result;
+			return length;
+		}
+
+		private const int HeaderSize = 5 * sizeof(int);
+
+		/// <summary>
+		/// The header of a stream and the number of polygon indices it holds
+		/// </summary>
+		private class StreamCounts
+		{
+			public ArraySegment<byte> Data;
+			public uint Positions;
+			public uint Normals;
+			public uint Uniques;
+			public uint Triangles;
+			public uint Polygons;
+			public long PolygonIndices;
+		}
+
+		/// <summary>
+		/// Reads the headers of the streams and walks their polygon headers, null for an empty stream
+		/// </summary>
+		private static List<StreamCounts> ReadCounts(IList<XbimTriangulatedModelStream> streams)
+		{
+			var result = new List<StreamCounts>(streams.Count);
+			foreach (var stream in streams)
+			{
+				if (stream == null || stream.IsEmpty)
+				{
+					result.Add(null);
+					continue;
+				}
+				stream.MergePending();
+				if (!stream._dataStream.TryGetBuffer(out ArraySegment<byte> data))
+					data = new ArraySegment<byte>(stream._dataStream.ToArray());
+				var br = new BinaryReader(new MemoryStream(data.Array, data.Offset, data.Count, false));
+				var counts = new StreamCounts
+				{
+					Data = data,
+					Positions = br.ReadUInt32(),
+					Normals = br.ReadUInt32(),
+					Uniques = br.ReadUInt32(),
+					Triangles = br.ReadUInt32(),
+					Polygons = br.ReadUInt32()
+				};
+				br.BaseStream.Seek(sizeof(float) * 3 * ((long)counts.Positions + counts.Normals) +
+					(long)counts.Uniques * (IndexReader.IndexSize(counts.Positions) + IndexReader.IndexSize(counts.Normals)), SeekOrigin.Current);
+				var uniqueSize = IndexReader.IndexSize(counts.Uniques);
+				for (uint p = 0; p < counts.Polygons; p++)
+				{
+					br.ReadByte();
+					var indicesCount = br.ReadUInt32();
+					counts.PolygonIndices += indicesCount;
+					br.BaseStream.Seek((long)indicesCount * uniqueSize, SeekOrigin.Current);
+				}
+				result.Add(counts);
+			}
+			return result;
+		}
+
+		private static int MergedLength(List<StreamCounts> counts)
+		{
+			var parts = counts.Where(c => c != null).ToList();
+			if (parts.Count == 0)
+				return 0;
+			uint positions = 0, normals = 0, uniques = 0, polygons = 0;
+			long polygonIndices = 0;
+			foreach (var part in parts)
+			{
+				positions += part.Positions;
+				normals += part.Normals;
+				uniques += part.Uniques;
+				polygons += part.Polygons;
+				polygonIndices += part.PolygonIndices;
+			}
+			var length = HeaderSize +
+				sizeof(float) * 3 * ((long)positions + normals) +
+				(long)uniques * (IndexReader.IndexSize(positions) + IndexReader.IndexSize(normals)) +
+				(long)polygons * (sizeof(byte) + sizeof(int)) +
+				polygonIndices * IndexReader.IndexSize(uniques);
+			return checked((int)length);
 		}
 
-     
 		public PositionsNormalsIndicesBinaryStreamWriter AsPNIBinaryStram()
 		{
 			PositionsNormalsIndicesBinaryStreamWriter w = new PositionsNormalsIndicesBinaryStreamWriter();
@@ -286,7 +457,7 @@ namespace Xbim.ModelGeometry.Scene
 				_IndexReaderByteSize = IndexSize(MaxSize);
 			}
 
-			protected byte IndexSize(uint MaxSize)
+			internal static byte IndexSize(uint MaxSize)
 			{
 				if (MaxSize <= 0xFF) //we will use byte for indices
 					return sizeof(byte);
@@ -354,6 +525,7 @@ namespace Xbim.ModelGeometry.Scene
 		//
 		public void Build<TGeomType>(TGeomType builder) where TGeomType : IXbimTriangulatesToPositionsIndices, new() 
 		{
+			MergePending();
 			_dataStream.Seek(0, SeekOrigin.Begin);
 			BinaryReader br = new BinaryReader(_dataStream);
 			
@@ -436,6 +608,7 @@ namespace Xbim.ModelGeometry.Scene
         /// a start position that is equal to the length of the mesh. The Entity Label is also sent to int.MinValue</returns>
         public XbimMeshFragment BuildWithNormals<TGeomType>(TGeomType builder, XbimMatrix3D transform, short modelId=0) where TGeomType : IXbimTriangulatesToPositionsNormalsIndices
         {
+            MergePending();
             _dataStream.Seek(0, SeekOrigin.Begin);
             BinaryReader br = new BinaryReader(_dataStream);
            
@@ -561,6 +734,7 @@ namespace Xbim.ModelGeometry.Scene
 
 		public void BuildPNI<TGeomType>(TGeomType builder) where TGeomType : IXbimTriangulatesToSimplePositionsNormalsIndices, new()
 		{
+			MergePending();
 			_dataStream.Seek(0, SeekOrigin.Begin);
 			BinaryReader br = new BinaryReader(_dataStream);
 